@@ -32,6 +32,7 @@ let package = Package(
     ],
     dependencies: [
         .package(url: "https://github.com/apple/swift-system", .upToNextMinor(from: "1.3.0")),
+        .package(url: "https://github.com/apple/swift-atomics.git", from: "1.2.0"),
         .package(url: "https://github.com/swiftwasm/WasmKit.git", from: "0.1.5"),
         .package(url: "https://github.com/apple/swift-protobuf.git", from: "1.22.0"),
         .package(url: "https://github.com/hyperoslo/Cache.git", from: "7.4.0")
@@ -42,6 +43,7 @@ let package = Package(
             dependencies: [
                 .product(name: "WasmKit", package: "WasmKit"),
                 .product(name: "SystemPackage", package: "swift-system"),
+                .product(name: "Atomics", package: "swift-atomics"),
                 "WasmSwiftProtobuf",
             ],
             resources: [
@@ -107,6 +109,8 @@ let package = Package(
             dependencies: [
                 "Protobuf",
                 "AsyncWasm",
+                "MusicWasm",
+                "WasmObjCProtobuf",
             ],
             publicHeadersPath: "include"
         ),
@@ -120,6 +124,12 @@ let package = Package(
                 .unsafeFlags(["-fno-objc-arc"])
             ]
         ),
+        .executableTarget(
+            name: "ProtobufBench",
+            dependencies: [
+                "WasmObjCProtobuf",
+            ]
+        ),
         .target(
             name: "MobileFFI",
             dependencies: [
@@ -129,7 +139,8 @@ let package = Package(
         .testTarget(
             name: "AsyncWasmTests",
             dependencies: [
-                "AsyncWasm"
+                "AsyncWasm",
+                .target(name: "AsyncWasmKit", condition: .when(platforms: [.watchOS, .macOS]))
             ],
             resources: [
                 .copy("Resources/base.wasm"),
@@ -138,6 +138,14 @@ open class AsyncWasmEngine: NSObject, AsyncWasmProtocol {
     public func set(copts: [String: Data]) async throws {
         self.copts = copts
     }
+    /// Called on every engine state change, before the delegate.
+    /// Subclasses override it to keep what they derived from the guest in sync with the loaded module.
+    open func didChange(state: EngineState) {}
     
+    func notify(state: EngineState) {
+        didChange(state: state)
+        delegate?.stateChanged(state: state)
+    }
+
 }
 
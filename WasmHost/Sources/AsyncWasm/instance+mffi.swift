@@ -45,9 +45,9 @@ extension AsyncWasmEngine: AsyncifyWasmProvider {
     }
     public func stateChanged(state: MobileFFI.EngineState) {
         do {
-            self.delegate?.stateChanged(state: try EngineState(from: state))
+            self.notify(state: try EngineState(from: state))
         } catch {
-            self.delegate?.stateChanged(state: .failed(error))
+            self.notify(state: .failed(error))
         }
     }
     public func setSharedPreferences(key: String, value: Data) {
@@ -46,9 +46,9 @@ extension AsyncWasmKit.AsyncifyWasm: WasmInstance {}
 extension AsyncWasmEngine: AsyncWasmKit.AsyncifyWasmProvider {
     public func stateChanged(state: AsyncWasmKit.EngineState) {
         do {
-            self.delegate?.stateChanged(state: try EngineState(from: state))
+            self.notify(state: try EngineState(from: state))
         } catch {
-            self.delegate?.stateChanged(state: .failed(error))
+            self.notify(state: .failed(error))
         }
     }
     public func flowOptions() throws -> AsyncifyOptions? {
@@ -72,9 +72,9 @@ extension MobileFFI.AsyncifyWasm: WasmInstance {}
 extension AsyncWasmEngine: MobileFFI.AsyncifyWasmProvider {
     public func stateChanged(state: MobileFFI.EngineState) {
         do {
-            self.delegate?.stateChanged(state: try EngineState(from: state))
+            self.notify(state: try EngineState(from: state))
         } catch {
-            self.delegate?.stateChanged(state: .failed(error))
+            self.notify(state: .failed(error))
         }
     }
     public func flowOptions() throws -> MobileFFI.FlowOptions {
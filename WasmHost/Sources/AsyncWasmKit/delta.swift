@@ -0,0 +1,115 @@
+//
+//  delta.swift
+//  WasmHost
+//
+//  Created by L7Studio on 19/10/26.
+//
+import Foundation
+import CryptoKit
+
+enum WasmUpdateError: Error {
+    case integrityMismatch(expected: String, actual: String)
+    case truncated(expected: Int64, actual: Int64)
+    case invalidPatch(String)
+    /// the version publishes a sha that is not a hex encoded SHA-256
+    case invalidSha(String)
+}
+
+/// Binary delta between two wasm modules.
+///
+/// Layout (integers are big endian):
+/// ```
+/// "WAPD" | version: u8 = 1 | target size: u64 | op* | END
+/// COPY = 0x01 | offset: u64 | len: u32   // bytes copied from the installed module
+/// ADD  = 0x02 | len: u32 | bytes[len]     // new bytes carried by the patch
+/// END  = 0x00
+/// ```
+/// Patches are published next to the full module as `<from id>_<to id>.patch`.
+enum WasmPatch {
+    static let magic = Data("WAPD".utf8)
+    static let version: UInt8 = 1
+    private static let chunkSize = 1 << 20
+
+    /// Apply `patch` on `base` and write the resulting module to `output`.
+    static func apply(base: URL, patch: URL, to output: URL) throws {
+        let source = try Data(contentsOf: base, options: .alwaysMapped)
+        let delta = try Data(contentsOf: patch, options: .alwaysMapped)
+        var reader = Reader(data: delta)
+        guard try reader.read(count: magic.count) == magic, try reader.read(UInt8.self) == version else {
+            throw WasmUpdateError.invalidPatch("bad header")
+        }
+        let targetSize = try reader.read(UInt64.self)
+
+        FileManager.default.createFile(atPath: output.path, contents: nil)
+        let handle = try FileHandle(forWritingTo: output)
+        defer { try? handle.close() }
+        var written: UInt64 = 0
+        loop: while true {
+            switch try reader.read(UInt8.self) {
+            case 0x00:
+                break loop
+            case 0x01:
+                let offset = try reader.read(UInt64.self)
+                let len = UInt64(try reader.read(UInt32.self))
+                guard offset + len <= UInt64(source.count) else {
+                    throw WasmUpdateError.invalidPatch("copy out of range")
+                }
+                var pos = Int(offset)
+                let end = Int(offset + len)
+                while pos < end {
+                    let next = min(pos + chunkSize, end)
+                    handle.write(source[source.startIndex + pos..<source.startIndex + next])
+                    pos = next
+                }
+                written += len
+            case 0x02:
+                let len = Int(try reader.read(UInt32.self))
+                handle.write(try reader.read(count: len))
+                written += UInt64(len)
+            case let op:
+                throw WasmUpdateError.invalidPatch("unknown op \(op)")
+            }
+        }
+        guard written == targetSize else {
+            throw WasmUpdateError.truncated(expected: Int64(targetSize), actual: Int64(written))
+        }
+    }
+
+    private struct Reader {
+        let data: Data
+        var offset = 0
+
+        mutating func read(count: Int) throws -> Data {
+            guard count >= 0, offset + count <= data.count else {
+                throw WasmUpdateError.invalidPatch("unexpected end of patch")
+            }
+            let start = data.startIndex + offset
+            offset += count
+            return data[start..<start + count]
+        }
+
+        mutating func read<T: FixedWidthInteger>(_ type: T.Type) throws -> T {
+            let bytes = try read(count: MemoryLayout<T>.size)
+            return bytes.reduce(T.zero) { $0 << 8 | T($1) }
+        }
+    }
+}
+
+extension URL {
+    /// Hex encoded SHA-256 of the file, read in chunks so modules are never fully loaded in memory
+    func sha256() throws -> String {
+        let handle = try FileHandle(forReadingFrom: self)
+        defer { try? handle.close() }
+        var hasher = SHA256()
+        while true {
+            let chunk = handle.readData(ofLength: 1 << 20)
+            if chunk.isEmpty { break }
+            hasher.update(data: chunk)
+        }
+        return hasher.finalize().map { String(format: "%02hhx", $0) }.joined()
+    }
+
+    var fileSize: Int64 {
+        ((try? FileManager.default.attributesOfItem(atPath: path))?[.size] as? NSNumber)?.int64Value ?? -1
+    }
+}
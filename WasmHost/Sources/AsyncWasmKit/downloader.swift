@@ -6,11 +6,29 @@
 //
 
 import Foundation
+import CryptoKit
 
 extension AsyncDownloader {
     public enum Event {
         case progress(currentBytes: Int64, totalBytes: Int64)
-        case success(url: URL)
+        /// `expectedBytes` is the length of the whole file announced by the server, `-1` when unknown
+        case success(url: URL, expectedBytes: Int64)
+    }
+    
+    /// Length of the whole file announced by `response`, for a resumed (206) download
+    /// it is the total of the `Content-Range` header, not the length of the range.
+    static func expectedBytes(of response: URLResponse?) -> Int64 {
+        guard let response = response as? HTTPURLResponse else {
+            return response?.expectedContentLength ?? -1
+        }
+        if response.statusCode == 206 {
+            guard let range = response.value(forHTTPHeaderField: "Content-Range"),
+                  let total = range.split(separator: "/").last.flatMap({ Int64($0) }) else {
+                return -1
+            }
+            return total
+        }
+        return response.expectedContentLength
     }
 }
 class AsyncDownloader: NSObject {
@@ -19,6 +37,12 @@ class AsyncDownloader: NSObject {
     fileprivate var continuation: AsyncThrowingStream<Event, Error>.Continuation?
     
     fileprivate lazy var task: URLSessionDownloadTask = {
+        // resume an interrupted download with a range request when possible
+        discardStaleResumeData()
+        if let resumeData = try? Data(contentsOf: resumeDataURL) {
+            try? FileManager.default.removeItem(at: resumeDataURL)
+            return AsyncDownloaderSession.shared.sessionManager.downloadTask(withResumeData: resumeData)
+        }
         var req = URLRequest(url: url)
         // to fix content-length
         req.setValue("", forHTTPHeaderField: "Accept-Encoding")
@@ -26,9 +50,33 @@ class AsyncDownloader: NSObject {
         return task
     }()
     
-    init(url: URL, destination: URL) {
+    /// Resume data of an interrupted download is kept next to the destination, keyed by
+    /// the source and the version so a staging path reused by another download never resumes
+    /// with bytes of a different file.
+    let resumeDataURL: URL
+    
+    init(url: URL, destination: URL, version: String) {
         self.url = url
         self.destination = destination
+        self.resumeDataURL = Self.resumeDataURL(for: url, version: version, destination: destination)
+    }
+    
+    /// `<destination>.<key>.resume`, the key is a digest of `version` and `url`
+    static func resumeDataURL(for url: URL, version: String, destination: URL) -> URL {
+        let digest = SHA256.hash(data: Data("\(version)\n\(url.absoluteString)".utf8))
+        let key = digest.prefix(8).map { String(format: "%02hhx", $0) }.joined()
+        return destination.appendingPathExtension(key).appendingPathExtension("resume")
+    }
+    
+    /// Remove resume data left for `destination` by downloads of another source or version
+    func discardStaleResumeData() {
+        let directory = destination.deletingLastPathComponent()
+        let prefix = destination.lastPathComponent + "."
+        guard let names = try? FileManager.default.contentsOfDirectory(atPath: directory.path) else { return }
+        for name in names where name.hasPrefix(prefix) && name.hasSuffix(".resume")
+            && name != resumeDataURL.lastPathComponent {
+            try? FileManager.default.removeItem(at: directory.appendingPathComponent(name))
+        }
     }
     
     public var isDownloading: Bool {
@@ -40,7 +88,11 @@ class AsyncDownloader: NSObject {
             self.continuation = continuation
             task.resume()
             continuation.onTermination = { @Sendable [weak self] _ in
-                self?.task.cancel()
+                guard let self, self.task.state == .running else { return }
+                let resumeDataURL = self.resumeDataURL
+                self.task.cancel { resumeData in
+                    try? resumeData?.write(to: resumeDataURL, options: .atomic)
+                }
             }
         }
     }
@@ -65,8 +117,8 @@ final class AsyncDownloaderSession: NSObject, URLSessionDownloadDelegate {
         return URLSession(configuration: configuration, delegate: self, delegateQueue: .main)
     }()
     
-    func download(url: URL, destination: URL) -> AsyncDownloader {
-        let downloader = AsyncDownloader(url: url, destination: destination)
+    func download(url: URL, destination: URL, version: String) -> AsyncDownloader {
+        let downloader = AsyncDownloader(url: url, destination: destination, version: version)
         self.items[downloader.task.taskIdentifier] = downloader
         return downloader
     }
@@ -122,19 +174,34 @@ extension AsyncDownloaderSession {
                 continuation.finish(throwing: error)
             }
         }
-        if !fileManager.fileExists(atPath: downloader.destination.path) {
-            do {
-                try fileManager.moveItem(at: location, to: downloader.destination)
-                continuation.yield(.success(url: downloader.destination))
-                continuation.finish()
-            } catch {
-                continuation.finish(throwing: error)
+        if let response = downloadTask.response as? HTTPURLResponse,
+           !(200..<300).contains(response.statusCode) {
+            continuation.finish(throwing: URLError(.badServerResponse))
+            return
+        }
+        do {
+            // destination is a staging file, a leftover from a previous attempt is stale
+            if fileManager.fileExists(atPath: downloader.destination.path) {
+                try fileManager.removeItem(at: downloader.destination)
             }
-        } else {
-            continuation.yield(.success(url: downloader.destination))
+            try fileManager.moveItem(at: location, to: downloader.destination)
+            try? fileManager.removeItem(at: downloader.resumeDataURL)
+            continuation.yield(.success(url: downloader.destination,
+                                        expectedBytes: AsyncDownloader.expectedBytes(of: downloadTask.response)))
             continuation.finish()
+        } catch {
+            continuation.finish(throwing: error)
+        }
+    }
+    
+    func urlSession(_ session: URLSession, task: URLSessionTask, didCompleteWithError error: Error?) {
+        guard let downloader = items.removeValue(forKey: task.taskIdentifier), let error else {
+            return
+        }
+        if let resumeData = (error as NSError).userInfo[NSURLSessionDownloadTaskResumeData] as? Data {
+            try? resumeData.write(to: downloader.resumeDataURL, options: .atomic)
         }
-       
+        downloader.continuation?.finish(throwing: error)
     }
     
     func urlSessionDidFinishEvents(forBackgroundURLSession session: URLSession) {
@@ -12,15 +12,6 @@ import WasmKit
 #if canImport(JavaScriptCore)
 import JavaScriptCore
 #endif
-#if canImport(CoreGraphics)
-import CoreGraphics
-#endif
-#if canImport(ImageIO)
-import ImageIO
-#endif
-#if canImport(AVFoundation)
-import AVFoundation
-#endif
 extension WAFuture {
     ///  Process future
     /// - Parameters:
@@ -128,16 +119,25 @@ extension WAFuture {
                         "multipart/form-data; boundary=\(boundary)", forHTTPHeaderField: "Content-Type"
                     )
                 }
-                return try await session.command(for: req, id: cmd.requestID, usePtr: true, instance: instance)
+                return try await WasmTracer.span("http", category: "delegate") {
+                    try await session.command(for: req, id: cmd.requestID, usePtr: true, instance: instance)
+                }
             case let .regex(regex):
-                return try regex.command(for: cmd.requestID, memory: memory)
-                
+                return try WasmTracer.span("regex", category: "delegate") {
+                    try regex.command(for: cmd.requestID, memory: memory)
+                }
             case let .js(js):
-                return try js.command(for: cmd.requestID)
+                return try WasmTracer.span("js", category: "delegate") {
+                    try js.command(for: cmd.requestID)
+                }
             case let .ws(ws):
-                return try await ws.command(for: cmd.requestID, fnPtr: fnPtr, instance: instance)
+                return try await WasmTracer.span("ws", category: "delegate") {
+                    try await ws.command(for: cmd.requestID, fnPtr: fnPtr, instance: instance)
+                }
             case let .fd(fd):
-                return try await fd.command(for: cmd.requestID)
+                return try await WasmTracer.span("fd", category: "delegate") {
+                    try await fd.command(for: cmd.requestID)
+                }
             default:
                 fatalError()
             }
@@ -369,7 +369,9 @@ extension AsyncifyAction.WebSocket {
                 index: outPtr
             ), to: argsPtr
         )
-        try callback([.i32(outPtr), .i32(fnPtr), .i32(argsPtr)])
+        try WasmTracer.span("callback", category: "guest") {
+            try callback([.i32(outPtr), .i32(fnPtr), .i32(argsPtr)])
+        }
     }
     
     var req: URLRequest {
@@ -443,50 +445,7 @@ extension AsyncifyAction.FileDescriptor {
             fd.content.data = .raw(try Data(contentsOf: file))
         case .metadata:
             fd.status = 1
-            fd.metadata = Google_Protobuf_Struct()
-            let mime = file.pathExtension.mimeType()
-            fd.metadata.fields["mime"] = Google_Protobuf_Value(stringValue: mime)
-            let attributes = try FileManager.default.attributesOfItem(atPath: file.path)
-            if let fileSize = attributes[.size] as? Double {
-                fd.metadata.fields["file_size"] = Google_Protobuf_Value(numberValue: fileSize)
-            }
-            if let date = attributes[.creationDate] as? Date {
-                fd.metadata.fields["created_at"] = Google_Protobuf_Value(numberValue: date.timeIntervalSince1970)
-            }
-            if let date = attributes[.modificationDate] as? Date {
-                fd.metadata.fields["modified_at"] = Google_Protobuf_Value(numberValue: date.timeIntervalSince1970)
-            }
-            fd.metadata.fields["is_file"] = Google_Protobuf_Value(boolValue: file.isFileURL)
-            fd.metadata.fields["is_dir"] = Google_Protobuf_Value(boolValue: !file.isFileURL)
-            
-            switch mime {
-            case let x where x.hasPrefix("image/"):
-#if canImport(CoreGraphics)
-                if let provider = CGDataProvider(url: file as CFURL),
-                   let source = CGImageSourceCreateWithDataProvider(provider, nil),
-                   let metadata = CGImageSourceCopyPropertiesAtIndex(source, 0, nil) as? [AnyHashable: Any] {
-                    if let width = metadata["PixelWidth"] as? CGFloat, let height = metadata["PixelHeight"] as? CGFloat {
-                        fd.metadata.fields["resolution"] = Google_Protobuf_Value(listValue: Google_Protobuf_ListValue(values: [Google_Protobuf_Value(numberValue: width), Google_Protobuf_Value(numberValue: height)]))
-                    }
-                    
-                }
-#endif
-            case let x where x.hasPrefix("video/") || x.hasPrefix("audio/"):
-                let asset = AVURLAsset(url: file, options: [
-                    AVURLAssetPreferPreciseDurationAndTimingKey: NSNumber(value: true)
-                ])
-                if let track = asset.tracks(withMediaType: .video).first {
-                    let size = track.naturalSize.applying(track.preferredTransform)
-                    fd.metadata.fields["resolution"] = Google_Protobuf_Value(listValue: Google_Protobuf_ListValue(values: [Google_Protobuf_Value(numberValue: size.width), Google_Protobuf_Value(numberValue: size.height)]))
-                }
-                if #available(macOS 12.0, iOS 15.0, watchOS 8.0, *) {
-                    let duration = try await asset.load(.duration)
-                    fd.metadata.fields["duration"] = Google_Protobuf_Value(numberValue: duration.seconds)
-                } else {
-                    fd.metadata.fields["duration"] = Google_Protobuf_Value(numberValue: asset.duration.seconds)
-                }
-            default: break
-            }
+            fd.metadata = try await MediaMetadataIndex.shared.metadata(for: file)
         case let .write(write):
             switch write.enc {
             case "base64":
@@ -4,8 +4,16 @@
 //
 //  Created by L7Studio on 1/4/25.
 //
+import Atomics
 import Foundation
+import OSLog
 import WasmSwiftProtobuf
+#if canImport(UIKit)
+import UIKit
+#endif
+#if os(watchOS)
+import WatchKit
+#endif
 actor AsyncifyWasmInternalPool {
     private let maxSize: Int
     private var available: [AsyncifyWasmInternal] = []
@@ -23,13 +31,28 @@ actor AsyncifyWasmInternalPool {
         }
     }
     
+    private var waiters = 0
+    
     func getInstance() async throws -> AsyncifyWasmInternal {
+        waiters += 1
+        defer { waiters -= 1 }
         while available.isEmpty {
             try await Task.sleep(nanoseconds: 100_000_000) // Wait 100ms if no instances available
         }
         return available.removeFirst()
     }
     
+    /// Instance for background work (e.g. update checks), `nil` when taking one could delay an interactive call.
+    func getIdleInstance() -> AsyncifyWasmInternal? {
+        guard !isSaturated else { return nil }
+        return available.removeFirst()
+    }
+    
+    /// Keep one instance free for interactive calls unless the pool only has one
+    var isSaturated: Bool {
+        waiters > 0 || available.count <= (maxSize > 1 ? 1 : 0)
+    }
+    
     func returnInstance(_ instance: AsyncifyWasmInternal) {
         available.append(instance)
     }
@@ -45,42 +68,174 @@ actor AsyncifyWasmInternalPool {
     }
 }
 
-actor WasmTaskManager {
-    static let shared = WasmTaskManager()
-    var tasks: [UInt32: Task<Data, Error>] = [:]
-    func release() {
-        for (_, task) in tasks {
-            task.cancel()
+/// Tasks started by `get_async`, keyed by their `outPtr`.
+///
+/// The import registers the task on the guest thread before returning to the guest, `call` and
+/// parent `get_async` tasks take it back once the guest reports the pointer. Both sides are
+/// wait-free: an open addressing table of atomic keys and values probed at most `capacity` times.
+/// Every `AsyncifyWasmInternal` owns its registry, `outPtr`s are addresses in its own memory and
+/// `cancelAll()` only affects that instance.
+final class WasmTaskRegistry {
+    typealias Value = Task<Data, Error>
+    private final class Box {
+        let task: Value
+        init(_ task: Value) {
+            self.task = task
         }
-        tasks.removeAll()
     }
+    private static let empty: UInt32 = 0
+    private static let tombstone: UInt32 = .max
     
-    nonisolated func run(_ task: Task<Data, Error>, key: UInt32) {
-        let sema = DispatchSemaphore(value: 0)
-        Task {
-            defer {
-                sema.signal()
+    let capacity: Int
+    private let keys: [UnsafeAtomic<UInt32>]
+    private let values: [UnsafeAtomic<Unmanaged<Box>?>]
+    // only used when every slot is taken
+    private let overflowLock = NSLock()
+    private var overflow: [UInt32: Value] = [:]
+    
+    init(capacity: Int = 1024) {
+        precondition(capacity > 0 && capacity & (capacity - 1) == 0, "capacity must be a power of two")
+        self.capacity = capacity
+        self.keys = (0..<capacity).map { _ in UnsafeAtomic<UInt32>.create(Self.empty) }
+        self.values = (0..<capacity).map { _ in UnsafeAtomic<Unmanaged<Box>?>.create(nil) }
+    }
+    
+    deinit {
+        cancelAll()
+        keys.forEach { $0.destroy() }
+        values.forEach { $0.destroy() }
+    }
+    
+    private func slot(for key: UInt32) -> Int {
+        // pointers are aligned, mix the low bits before masking
+        Int(truncatingIfNeeded: key &* 2_654_435_761) & (capacity - 1)
+    }
+    
+    /// Register `task` for `key`, replacing and cancelling a task still registered for it.
+    ///
+    /// A task is left behind when its call is abandoned before taking it, the guest then frees and
+    /// reuses its `outPtr`, so the newest task of a key is the only one that may be taken.
+    func insert(_ task: Value, for key: UInt32) {
+        precondition(key != Self.empty && key != Self.tombstone, "invalid task key \(key.hex)")
+        let box = Unmanaged.passRetained(Box(task))
+        var free: Int?
+        var idx = slot(for: key)
+        for _ in 0..<capacity {
+            let current = keys[idx].load(ordering: .acquiring)
+            if current == Self.empty {
+                break
+            }
+            if current == key, replace(at: idx, with: box) {
+                return
+            }
+            if current == Self.tombstone, free == nil {
+                free = idx
+            }
+            idx = (idx + 1) & (capacity - 1)
+        }
+        // the key isn't registered, claim the first reusable slot of its probe sequence
+        idx = free ?? idx
+        for _ in 0..<capacity {
+            let current = keys[idx].load(ordering: .acquiring)
+            if current == Self.empty || current == Self.tombstone,
+               keys[idx].compareExchange(expected: current, desired: key, ordering: .acquiringAndReleasing).exchanged {
+                values[idx].store(box, ordering: .releasing)
+                return
             }
-            await self._run(task, key: key)
+            idx = (idx + 1) & (capacity - 1)
         }
-        sema.wait()
+        box.release()
+        overflowLock.lock()
+        let stale = overflow.updateValue(task, forKey: key)
+        overflowLock.unlock()
+        stale?.cancel()
     }
     
-    private func _run(_ task: Task<Data, Error>, key: UInt32) {
-        tasks[key] = Task {
-            defer {
-                self.tasks.removeValue(forKey: key)
+    // Swaps the task of an occupied slot, fails when the slot is being taken.
+    private func replace(at idx: Int, with box: Unmanaged<Box>) -> Bool {
+        while let current = values[idx].load(ordering: .acquiring) {
+            if values[idx].compareExchange(expected: current, desired: box, ordering: .acquiringAndReleasing).exchanged {
+                current.takeRetainedValue().task.cancel()
+                return true
             }
-            return try await task.value
         }
+        return false
+    }
+    
+    /// Remove and return the task registered for `key`, every task result is consumed once.
+    func take(_ key: UInt32) -> Value? {
+        var idx = slot(for: key)
+        for _ in 0..<capacity {
+            let current = keys[idx].load(ordering: .acquiring)
+            if current == Self.empty {
+                break
+            }
+            if current == key {
+                guard let box = values[idx].exchange(nil, ordering: .acquiringAndReleasing) else {
+                    return nil
+                }
+                keys[idx].store(Self.tombstone, ordering: .releasing)
+                return box.takeRetainedValue().task
+            }
+            idx = (idx + 1) & (capacity - 1)
+        }
+        overflowLock.lock()
+        defer { overflowLock.unlock() }
+        return overflow.removeValue(forKey: key)
+    }
+    
+    func cancelAll() {
+        for idx in 0..<capacity {
+            if let box = values[idx].exchange(nil, ordering: .acquiringAndReleasing) {
+                keys[idx].store(Self.tombstone, ordering: .releasing)
+                box.takeRetainedValue().task.cancel()
+            }
+        }
+        overflowLock.lock()
+        let pending = overflow
+        overflow.removeAll()
+        overflowLock.unlock()
+        for (_, task) in pending {
+            task.cancel()
+        }
+    }
+}
+
+/// Polling interval of `WasmUpdateManager`, backs off exponentially while no update is found
+struct WasmUpdateSchedule {
+    var minInterval: TimeInterval = 60
+    var maxInterval: TimeInterval = 6 * 60 * 60
+    var multiplier: Double = 2
+    /// relative random spread so devices do not poll in lockstep
+    var jitter: Double = 0.2
+    /// retry delay when the check was skipped (pool saturated, app in background)
+    var deferredInterval: TimeInterval = 15
+    private(set) var interval: TimeInterval = 60
+    
+    mutating func updated() {
+        interval = minInterval
+    }
+    
+    mutating func unchanged() {
+        interval = min(max(interval, minInterval) * multiplier, maxInterval)
+    }
+    
+    func delay(deferred: Bool) -> TimeInterval {
+        let base = deferred ? deferredInterval : interval
+        return base * Double.random(in: (1 - jitter)...(1 + jitter))
     }
 }
 
 actor WasmUpdateManager {
     let rootDir: URL
     static let currentVersionKey = "async_wasm_kit_current_version"
+    private static let log = OSLog(subsystem: "wasm", category: "host")
     weak var delegate: AsyncifyWasmUpdaterDelegate?
     var isFirstLaunch: Bool = true
+    var schedule = WasmUpdateSchedule()
+    private var ticker: Task<Void, Never>?
+    private var isSuspended = false
+    private var observers: [NSObjectProtocol] = []
     var current: EngineVersion? {
         didSet {
             if current?.hasURL == true, let data = try? current?.serializedData() {
@@ -105,55 +260,194 @@ actor WasmUpdateManager {
         startTicker()
     }
     
-    func ticker(interval: TimeInterval) -> AsyncStream<Date> {
-        return AsyncStream { continuation in
-            Task {
-                while true {
-                    continuation.yield(Date()) // Send current timestamp
-                    try? await Task.sleep(nanoseconds: UInt64(interval * 1_000_000_000))
-                }
-            }
+    func stop() {
+        ticker?.cancel()
+        ticker = nil
+        for observer in observers {
+            NotificationCenter.default.removeObserver(observer)
         }
+        observers.removeAll()
+    }
+    
+    func setSuspended(_ suspended: Bool) {
+        isSuspended = suspended
+    }
+    
+    enum CheckResult {
+        case updated
+        case unchanged
+        /// skipped, the pool had no idle instance or the app is in background
+        case deferred
     }
-    private func check() async throws {
-        guard let version = try await self.delegate?.version() else {
-            fatalError("unable to get version")
+    
+    private func check() async throws -> CheckResult {
+        if isSuspended {
+            return .deferred
+        }
+        guard let delegate = self.delegate else {
+            // the owner was released while the ticker was alive, there is nothing left to update
+            debugPrint("-- WasmUpdateManager delegate released, stopping")
+            stop()
+            return .deferred
+        }
+        let version: EngineVersion
+        do {
+            version = try await delegate.version(ifNoneMatch: current?.etag)
+        } catch AsyncifyWasmError.poolSaturated {
+            return .deferred
         }
         if let url = URL(string: version.next.url) {
+            if let current, current.id == version.next.id
+                || (version.next.hasEtag && current.etag == version.next.etag) {
+                if isFirstLaunch {
+                    self.isFirstLaunch = false
+                    self.delegate?.stateChanged(state: .running(current))
+                }
+                return .unchanged
+            }
             let dst = self.rootDir.appendingPathComponent("\(version.next.id).wasm")
-            if FileManager.default.fileExists(atPath: dst.path) {
-                var next = version.next
-                next.url = dst.absoluteString
-                self.current = next
-                self.delegate?.stateChanged(state: .reload(next))
-            } else {
+            if !FileManager.default.fileExists(atPath: dst.path) {
                 self.delegate?.stateChanged(state: .updating(0))
-                let downloader = AsyncDownloaderSession.shared.download(url: url, destination: dst)
-                for try await event in downloader.events {
-                    switch event {
-                    case let .progress(currentBytes, totalBytes):
-                        self.delegate?.stateChanged(state: .updating(Double(currentBytes) / Double(totalBytes)))
-                    case let .success(url):
-                        var next = version.next
-                        next.url = url.absoluteString
-                        self.current = next
-                        self.delegate?.stateChanged(state: .reload(next))
-                    }
-                }
+                try await install(version.next, from: url, to: dst)
             }
+            var next = version.next
+            next.url = dst.absoluteString
+            self.current = next
+            self.isFirstLaunch = false
+            self.delegate?.stateChanged(state: .reload(next))
+            return .updated
         } else if isFirstLaunch {
             self.isFirstLaunch = false
             self.delegate?.stateChanged(state: .reload(version))
         }
+        return .unchanged
+    }
+    
+    /// Download `next` into a staging file and move it to `dst` only once it is verified,
+    /// `dst` existing means the module is complete so the pool is never fed a truncated module.
+    /// A binary delta against the installed module is tried first, the full module is the fallback.
+    private func install(_ next: EngineVersion, from url: URL, to dst: URL) async throws {
+        let staging = dst.appendingPathExtension("download")
+        if let current = self.current, current.id != next.id,
+           let base = URL(string: current.url), FileManager.default.fileExists(atPath: base.path) {
+            let patchURL = url.deletingLastPathComponent().appendingPathComponent("\(current.id)_\(next.id).patch")
+            let patch = self.rootDir.appendingPathComponent(patchURL.lastPathComponent)
+            do {
+                try await download(patchURL, to: patch, version: next.id)
+                try WasmPatch.apply(base: base, patch: patch, to: staging)
+                try Self.verify(staging, for: next)
+                try? FileManager.default.removeItem(at: patch)
+                try FileManager.default.moveItem(at: staging, to: dst)
+                return
+            } catch {
+                debugPrint("-- WasmUpdateManager delta update failed \(error), downloading full module")
+                try? FileManager.default.removeItem(at: patch)
+                try? FileManager.default.removeItem(at: staging)
+            }
+        }
+        try await download(url, to: staging, version: next.id)
+        do {
+            try Self.verify(staging, for: next)
+        } catch {
+            try? FileManager.default.removeItem(at: staging)
+            throw error
+        }
+        try FileManager.default.moveItem(at: staging, to: dst)
+    }
+    
+    /// Download `url` to `dst` and check its length against the one announced by the server,
+    /// a truncated file is removed.
+    private func download(_ url: URL, to dst: URL, version: String) async throws {
+        var expected: Int64 = -1
+        let downloader = AsyncDownloaderSession.shared.download(url: url, destination: dst, version: version)
+        for try await event in downloader.events {
+            switch event {
+            case let .progress(currentBytes, totalBytes):
+                expected = totalBytes
+                self.delegate?.stateChanged(state: .updating(Double(currentBytes) / Double(totalBytes)))
+            case let .success(_, expectedBytes):
+                // progress callbacks are not guaranteed, the response is the reference when it has a length
+                if expectedBytes > 0 {
+                    expected = expectedBytes
+                }
+            }
+        }
+        let actual = dst.fileSize
+        if expected > 0, actual != expected {
+            try? FileManager.default.removeItem(at: dst)
+            throw WasmUpdateError.truncated(expected: expected, actual: actual)
+        }
+    }
+    
+    /// Compare the SHA-256 of the module with the one published in the version.
+    /// A malformed sha fails the install, a version without one is installed unchecked and logged.
+    static func verify(_ file: URL, for version: EngineVersion) throws {
+        guard version.hasSha, !version.sha.isEmpty else {
+            os_log(.error, log: log, "WasmUpdateManager: version %{public}@ has no sha, %{public}@ is not verified",
+                   version.id, file.lastPathComponent)
+            return
+        }
+        guard version.sha.count == 64, version.sha.allSatisfy(\.isHexDigit) else {
+            throw WasmUpdateError.invalidSha(version.sha)
+        }
+        let actual = try file.sha256()
+        guard actual.caseInsensitiveCompare(version.sha) == .orderedSame else {
+            throw WasmUpdateError.integrityMismatch(expected: version.sha, actual: actual)
+        }
     }
     
     private func startTicker() {
-        Task {
-            for await _ in ticker(interval: 60.0) {
+        ticker?.cancel()
+        observeLifecycle()
+        ticker = Task { [weak self] in
+            while !Task.isCancelled {
+                guard let self else { return }
                 debugPrint("-- WasmUpdateManager begin check")
-                try await check()
-                debugPrint("-- WasmUpdateManager finish check")
+                let delay = await self.tick()
+                debugPrint("-- WasmUpdateManager finish check, next in \(Int(delay))s")
+                try? await Task.sleep(nanoseconds: UInt64(delay * 1_000_000_000))
             }
         }
     }
+    
+    /// - Returns: seconds until the next check
+    private func tick() async -> TimeInterval {
+        do {
+            switch try await check() {
+            case .updated:
+                schedule.updated()
+            case .unchanged:
+                schedule.unchanged()
+            case .deferred:
+                return schedule.delay(deferred: true)
+            }
+        } catch {
+            debugPrint("-- WasmUpdateManager check failed \(error)")
+            schedule.unchanged()
+        }
+        return schedule.delay(deferred: false)
+    }
+    
+    private func observeLifecycle() {
+        guard observers.isEmpty else { return }
+#if os(watchOS)
+        let background = WKExtension.applicationDidEnterBackgroundNotification
+        let foreground = WKExtension.applicationWillEnterForegroundNotification
+#elseif canImport(UIKit)
+        let background = UIApplication.didEnterBackgroundNotification
+        let foreground = UIApplication.willEnterForegroundNotification
+#else
+        return
+#endif
+#if os(watchOS) || canImport(UIKit)
+        observers = [
+            NotificationCenter.default.addObserver(forName: background, object: nil, queue: nil) { [weak self] _ in
+                Task { await self?.setSuspended(true) }
+            },
+            NotificationCenter.default.addObserver(forName: foreground, object: nil, queue: nil) { [weak self] _ in
+                Task { await self?.setSuspended(false) }
+            },
+        ]
+#endif
+    }
 }
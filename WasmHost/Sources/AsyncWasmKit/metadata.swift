@@ -0,0 +1,196 @@
+//
+//  metadata.swift
+//  WasmHost
+//
+//  Created by L7Studio on 19/10/26.
+//
+import Foundation
+import SwiftProtobuf
+import WasmSwiftProtobuf
+#if canImport(CoreGraphics)
+import CoreGraphics
+#endif
+#if canImport(ImageIO)
+import ImageIO
+#endif
+#if canImport(AVFoundation)
+import AVFoundation
+#endif
+import OSLog
+
+/// Media metadata index used by the fd `.metadata` action.
+///
+/// Probing a media file builds an `AVURLAsset`/`CGImageSource` and loads its duration, guests listing
+/// a library ask for it on every item again and again. Entries are keyed by `(path, size, mtime)`,
+/// kept in memory and persisted to `store`, a file is only re-probed when its size or mtime changed.
+/// At most `maxEntries` files are kept, the least recently used ones are dropped first.
+actor MediaMetadataIndex {
+    static let shared = MediaMetadataIndex(
+        store: FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first!
+            .appendingPathComponent("wasm")
+            .appendingPathComponent("media_metadata.plist"))
+
+    struct Key: Hashable, Codable {
+        let path: String
+        let size: UInt64
+        let mtime: TimeInterval
+    }
+    /// On disk representation, `metadata` is a serialized `Google_Protobuf_Struct`
+    struct Entry: Codable {
+        let key: Key
+        let metadata: Data
+    }
+
+    typealias Probe = @Sendable (URL) async throws -> Google_Protobuf_Struct
+
+    let store: URL
+    /// maximum number of files kept in the index
+    let maxEntries: Int
+    private var entries: [String: (key: Key, metadata: Google_Protobuf_Struct, lastAccess: UInt64)] = [:]
+    private var clock: UInt64 = 0
+    private var inflight: [Key: Task<Google_Protobuf_Struct, Error>] = [:]
+    private var isLoaded = false
+    private var flushTask: Task<Void, Never>?
+    private let log = OSLog(subsystem: "wasm", category: "host")
+    private let probe: Probe
+
+    init(store: URL, maxEntries: Int = 4096, probe: @escaping Probe = MediaMetadataIndex.probe(file:)) {
+        self.store = store
+        self.maxEntries = max(1, maxEntries)
+        self.probe = probe
+    }
+
+    /// Metadata of a single file, probed only when the file is new or changed.
+    func metadata(for file: URL) async throws -> Google_Protobuf_Struct {
+        loadIfNeeded()
+        let key = try Self.key(for: file)
+        if let entry = entries[key.path], entry.key == key {
+            clock += 1
+            entries[key.path]?.lastAccess = clock
+            return entry.metadata
+        }
+        if let task = inflight[key] {
+            return try await task.value
+        }
+        let probe = self.probe
+        let task = Task.detached(priority: .utility) {
+            try await probe(file)
+        }
+        inflight[key] = task
+        defer {
+            inflight.removeValue(forKey: key)
+        }
+        let metadata = try await task.value
+        insert(metadata, for: key)
+        scheduleFlush()
+        return metadata
+    }
+
+    private func insert(_ metadata: Google_Protobuf_Struct, for key: Key) {
+        // a lookup of the changed file may have stored its newer metadata while this probe ran
+        if let current = entries[key.path], current.key.mtime > key.mtime {
+            return
+        }
+        clock += 1
+        entries[key.path] = (key, metadata, clock)
+        guard entries.count > maxEntries else { return }
+        // evict a batch at once so a full index does not scan its entries on every insert
+        let excess = entries.count - maxEntries + max(maxEntries / 8, 1)
+        let evicted = entries.sorted { $0.value.lastAccess < $1.value.lastAccess }.prefix(excess)
+        for (path, _) in evicted {
+            entries.removeValue(forKey: path)
+        }
+    }
+
+    private static func key(for file: URL) throws -> Key {
+        let attributes = try FileManager.default.attributesOfItem(atPath: file.path)
+        return Key(path: file.path,
+                   size: (attributes[.size] as? NSNumber)?.uint64Value ?? 0,
+                   mtime: (attributes[.modificationDate] as? Date)?.timeIntervalSince1970 ?? 0)
+    }
+
+    static func probe(file: URL) async throws -> Google_Protobuf_Struct {
+        var metadata = Google_Protobuf_Struct()
+        let mime = file.pathExtension.mimeType()
+        metadata.fields["mime"] = Google_Protobuf_Value(stringValue: mime)
+        let attributes = try FileManager.default.attributesOfItem(atPath: file.path)
+        if let fileSize = attributes[.size] as? Double {
+            metadata.fields["file_size"] = Google_Protobuf_Value(numberValue: fileSize)
+        }
+        if let date = attributes[.creationDate] as? Date {
+            metadata.fields["created_at"] = Google_Protobuf_Value(numberValue: date.timeIntervalSince1970)
+        }
+        if let date = attributes[.modificationDate] as? Date {
+            metadata.fields["modified_at"] = Google_Protobuf_Value(numberValue: date.timeIntervalSince1970)
+        }
+        metadata.fields["is_file"] = Google_Protobuf_Value(boolValue: file.isFileURL)
+        metadata.fields["is_dir"] = Google_Protobuf_Value(boolValue: !file.isFileURL)
+
+        switch mime {
+        case let x where x.hasPrefix("image/"):
+#if canImport(CoreGraphics)
+            if let provider = CGDataProvider(url: file as CFURL),
+               let source = CGImageSourceCreateWithDataProvider(provider, nil),
+               let props = CGImageSourceCopyPropertiesAtIndex(source, 0, nil) as? [AnyHashable: Any] {
+                if let width = props["PixelWidth"] as? CGFloat, let height = props["PixelHeight"] as? CGFloat {
+                    metadata.fields["resolution"] = Google_Protobuf_Value(listValue: Google_Protobuf_ListValue(values: [Google_Protobuf_Value(numberValue: width), Google_Protobuf_Value(numberValue: height)]))
+                }
+            }
+#endif
+        case let x where x.hasPrefix("video/") || x.hasPrefix("audio/"):
+            let asset = AVURLAsset(url: file, options: [
+                AVURLAssetPreferPreciseDurationAndTimingKey: NSNumber(value: true)
+            ])
+            if let track = asset.tracks(withMediaType: .video).first {
+                let size = track.naturalSize.applying(track.preferredTransform)
+                metadata.fields["resolution"] = Google_Protobuf_Value(listValue: Google_Protobuf_ListValue(values: [Google_Protobuf_Value(numberValue: size.width), Google_Protobuf_Value(numberValue: size.height)]))
+            }
+            if #available(macOS 12.0, iOS 15.0, watchOS 8.0, *) {
+                let duration = try await asset.load(.duration)
+                metadata.fields["duration"] = Google_Protobuf_Value(numberValue: duration.seconds)
+            } else {
+                metadata.fields["duration"] = Google_Protobuf_Value(numberValue: asset.duration.seconds)
+            }
+        default: break
+        }
+        return metadata
+    }
+
+    // MARK: - Persistence
+
+    private func loadIfNeeded() {
+        guard !isLoaded else { return }
+        isLoaded = true
+        guard let data = try? Data(contentsOf: store),
+              let stored = try? PropertyListDecoder().decode([Entry].self, from: data) else {
+            return
+        }
+        for entry in stored {
+            if let metadata = try? Google_Protobuf_Struct(serializedBytes: entry.metadata) {
+                insert(metadata, for: entry.key)
+            }
+        }
+    }
+
+    /// Coalesce writes, a library listing updates many entries in a burst
+    private func scheduleFlush() {
+        guard flushTask == nil else { return }
+        flushTask = Task {
+            try? await Task.sleep(nanoseconds: 2_000_000_000)
+            self.flush()
+        }
+    }
+
+    private func flush() {
+        flushTask = nil
+        let stored = entries.values.compactMap { entry in
+            (try? entry.metadata.serializedData()).map { Entry(key: entry.key, metadata: $0) }
+        }
+        do {
+            try FileManager.default.createDirectory(at: store.deletingLastPathComponent(), withIntermediateDirectories: true)
+            try PropertyListEncoder().encode(stored).write(to: store, options: .atomic)
+        } catch {
+            os_log(.error, log: log, "MediaMetadataIndex: unable to persist %{public}@", "\(error)")
+        }
+    }
+}
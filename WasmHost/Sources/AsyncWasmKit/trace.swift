@@ -0,0 +1,265 @@
+//
+//  trace.swift
+//  WasmHost
+//
+//  Created by L7Studio on 19/10/26.
+//
+import Atomics
+import Foundation
+import WasmSwiftProtobuf
+
+/// Call tracing for the wasm host.
+///
+/// Spans cover pool checkout, the guest `call`, every delegate action of `get`/`get_async`,
+/// `callback` re-entry and result decoding. They are correlated by the `requestID` of the
+/// command being served and exported as Chrome trace / Perfetto JSON, one track per request.
+///
+/// Disabled unless `WASM_ENABLE_TRACING` is set (or `isEnabled` is toggled at runtime), a span then
+/// costs one atomic load. Recording is lock-free: a span claims the next slot of a fixed ring and
+/// writes it as atomic words bracketed by the slot's sequence number, readers keep only the slots
+/// whose sequence number didn't move while they were copied. The lock only serializes readers.
+public final class WasmTracer {
+    public static let shared = WasmTracer(capacity: 1 << 14)
+
+    private static let enabled = ManagedAtomic<Bool>(
+        ["true", "yes", "1"].contains(ProcessInfo.processInfo.environment["WASM_ENABLE_TRACING"]?.lowercased() ?? ""))
+
+    public static var isEnabled: Bool {
+        get { enabled.load(ordering: .relaxed) }
+        set { enabled.store(newValue, ordering: .relaxed) }
+    }
+
+    /// `requestID` of the command being served by the current task
+    @TaskLocal static var requestID: UUID?
+
+    struct Event: Equatable {
+        var name: String
+        var category: String
+        var start: UInt64
+        var duration: UInt64
+        var thread: UInt64
+        var request: UUID?
+    }
+
+    // words of a slot, the sequence number first
+    private enum Word: Int, CaseIterable {
+        case sequence, name, nameCount, category, categoryCount, start, duration, thread, requestHigh, requestLow, hasRequest
+    }
+    // count of a StaticString stored as its unicode scalar
+    private static let scalarCount = UInt64.max
+    private static let nullUUID: uuid_t = (0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+
+    let capacity: Int
+    private let dropped = ManagedAtomic<Int>(0)
+    // ticket of the next event, slot `i & (capacity - 1)` has sequence 2i+1 while ticket i is
+    // written and 2i+2 once it is complete
+    private let head = ManagedAtomic<Int>(0)
+    private let words: UnsafeMutablePointer<UnsafeAtomic<UInt64>.Storage>
+    // serializes snapshot and reset
+    private let lock: os_unfair_lock_t
+    /// first ticket returned by `snapshot`, guarded by `lock`
+    private var origin = 0
+
+    init(capacity: Int) {
+        precondition(capacity > 0 && capacity & (capacity - 1) == 0, "capacity must be a power of two")
+        self.capacity = capacity
+        self.lock = .allocate(capacity: 1)
+        self.lock.initialize(to: os_unfair_lock())
+        self.words = .allocate(capacity: capacity * Word.allCases.count)
+        self.words.initialize(repeating: UnsafeAtomic<UInt64>.Storage(0), count: capacity * Word.allCases.count)
+    }
+
+    deinit {
+        words.deinitialize(count: capacity * Word.allCases.count)
+        words.deallocate()
+        lock.deinitialize(count: 1)
+        lock.deallocate()
+    }
+
+    private func word(_ word: Word, of slot: Int) -> UnsafeAtomic<UInt64> {
+        UnsafeAtomic(at: words + slot * Word.allCases.count + word.rawValue)
+    }
+
+    /// Events dropped because their slot was still being written a whole ring ago
+    var droppedCount: Int {
+        dropped.load(ordering: .relaxed)
+    }
+
+    func record(name: StaticString, category: StaticString, start: UInt64, duration: UInt64, thread: UInt64, request: UUID?) {
+        let ticket = head.loadThenWrappingIncrement(ordering: .relaxed)
+        let slot = ticket & (capacity - 1)
+        let sequence = word(.sequence, of: slot)
+        // the previous lap of this slot must be complete, a writer stalled for a whole ring keeps it
+        let previous = ticket < capacity ? 0 : UInt64(2 * (ticket - capacity) + 2)
+        guard sequence.compareExchange(expected: previous, desired: UInt64(2 * ticket + 1), ordering: .relaxed).exchanged else {
+            dropped.wrappingIncrement(ordering: .relaxed)
+            return
+        }
+        atomicMemoryFence(ordering: .releasing)
+        let (namePointer, nameCount) = Self.encode(name)
+        let (categoryPointer, categoryCount) = Self.encode(category)
+        word(.name, of: slot).store(namePointer, ordering: .relaxed)
+        word(.nameCount, of: slot).store(nameCount, ordering: .relaxed)
+        word(.category, of: slot).store(categoryPointer, ordering: .relaxed)
+        word(.categoryCount, of: slot).store(categoryCount, ordering: .relaxed)
+        word(.start, of: slot).store(start, ordering: .relaxed)
+        word(.duration, of: slot).store(duration, ordering: .relaxed)
+        word(.thread, of: slot).store(thread, ordering: .relaxed)
+        let uuid = request?.uuid ?? Self.nullUUID
+        withUnsafeBytes(of: uuid) { bytes in
+            word(.requestHigh, of: slot).store(bytes.loadUnaligned(as: UInt64.self), ordering: .relaxed)
+            word(.requestLow, of: slot).store(bytes.loadUnaligned(fromByteOffset: 8, as: UInt64.self), ordering: .relaxed)
+        }
+        word(.hasRequest, of: slot).store(request == nil ? 0 : 1, ordering: .relaxed)
+        sequence.store(UInt64(2 * ticket + 2), ordering: .releasing)
+    }
+
+    // the event of `ticket`, nil when it was overwritten or is being written
+    private func read(_ ticket: Int) -> Event? {
+        let slot = ticket & (capacity - 1)
+        let sequence = word(.sequence, of: slot)
+        let expected = UInt64(2 * ticket + 2)
+        guard sequence.load(ordering: .acquiring) == expected else {
+            return nil
+        }
+        let name = (word(.name, of: slot).load(ordering: .relaxed), word(.nameCount, of: slot).load(ordering: .relaxed))
+        let category = (word(.category, of: slot).load(ordering: .relaxed), word(.categoryCount, of: slot).load(ordering: .relaxed))
+        let start = word(.start, of: slot).load(ordering: .relaxed)
+        let duration = word(.duration, of: slot).load(ordering: .relaxed)
+        let thread = word(.thread, of: slot).load(ordering: .relaxed)
+        var uuid = Self.nullUUID
+        withUnsafeMutableBytes(of: &uuid) { bytes in
+            bytes.storeBytes(of: word(.requestHigh, of: slot).load(ordering: .relaxed), as: UInt64.self)
+            bytes.storeBytes(of: word(.requestLow, of: slot).load(ordering: .relaxed), toByteOffset: 8, as: UInt64.self)
+        }
+        let hasRequest = word(.hasRequest, of: slot).load(ordering: .relaxed) != 0
+        atomicMemoryFence(ordering: .acquiring)
+        guard sequence.load(ordering: .relaxed) == expected else {
+            return nil
+        }
+        return Event(name: Self.decode(name), category: Self.decode(category), start: start, duration: duration,
+                     thread: thread, request: hasRequest ? UUID(uuid: uuid) : nil)
+    }
+
+    /// Completed events still in the ring buffer, oldest first
+    func snapshot() -> [Event] {
+        os_unfair_lock_lock(lock)
+        defer { os_unfair_lock_unlock(lock) }
+        let end = head.load(ordering: .relaxed)
+        var ret: [Event] = []
+        ret.reserveCapacity(min(end - origin, capacity))
+        for ticket in max(origin, end - capacity)..<end {
+            if let event = read(ticket) {
+                ret.append(event)
+            }
+        }
+        return ret
+    }
+
+    public func reset() {
+        os_unfair_lock_lock(lock)
+        origin = head.load(ordering: .relaxed)
+        os_unfair_lock_unlock(lock)
+    }
+
+    private static func encode(_ string: StaticString) -> (UInt64, UInt64) {
+        guard string.hasPointerRepresentation else {
+            return (UInt64(string.unicodeScalar.value), scalarCount)
+        }
+        return (UInt64(UInt(bitPattern: string.utf8Start)), UInt64(string.utf8CodeUnitCount))
+    }
+
+    private static func decode(_ string: (pointer: UInt64, count: UInt64)) -> String {
+        if string.count == scalarCount {
+            return Unicode.Scalar(UInt32(truncatingIfNeeded: string.pointer)).map { String($0) } ?? ""
+        }
+        guard let start = UnsafePointer<UInt8>(bitPattern: UInt(string.pointer)) else {
+            return ""
+        }
+        return String(decoding: UnsafeBufferPointer(start: start, count: Int(string.count)), as: UTF8.self)
+    }
+
+    /// Chrome trace event format, loadable in `chrome://tracing` and https://ui.perfetto.dev
+    public func chromeTrace() -> Data {
+        var lanes: [UUID: Int] = [:]
+        var out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":["
+        var first = true
+        for event in snapshot() {
+            let lane: Int
+            if let request = event.request {
+                lane = lanes[request] ?? {
+                    let lane = lanes.count + 1
+                    lanes[request] = lane
+                    return lane
+                }()
+            } else {
+                lane = 0
+            }
+            if !first { out += "," }
+            first = false
+            out += "{\"ph\":\"X\",\"pid\":1,\"tid\":\(lane)"
+            out += ",\"name\":\"\(event.name)\",\"cat\":\"\(event.category)\""
+            out += ",\"ts\":\(Double(event.start) / 1_000),\"dur\":\(Double(event.duration) / 1_000)"
+            out += ",\"args\":{\"thread\":\(event.thread)"
+            if let request = event.request {
+                out += ",\"request_id\":\"\(request.uuidString)\""
+            }
+            out += "}}"
+        }
+        // name the tracks after their request
+        for (request, lane) in lanes {
+            out += "\(first ? "" : ","){\"ph\":\"M\",\"pid\":1,\"tid\":\(lane),\"name\":\"thread_name\",\"args\":{\"name\":\"\(request.uuidString)\"}}"
+            first = false
+        }
+        out += "]}"
+        return Data(out.utf8)
+    }
+
+    public func export(to url: URL) throws {
+        try chromeTrace().write(to: url, options: .atomic)
+    }
+}
+
+extension WasmTracer {
+    static var now: UInt64 {
+        DispatchTime.now().uptimeNanoseconds
+    }
+
+    static var thread: UInt64 {
+        var tid: UInt64 = 0
+        pthread_threadid_np(nil, &tid)
+        return tid
+    }
+
+    @discardableResult
+    static func span<R>(_ name: StaticString, category: StaticString = "host", body: () throws -> R) rethrows -> R {
+        guard isEnabled else { return try body() }
+        let start = now
+        let tid = thread
+        defer {
+            shared.record(name: name, category: category, start: start, duration: now - start, thread: tid, request: requestID)
+        }
+        return try body()
+    }
+
+    @discardableResult
+    static func span<R>(_ name: StaticString, category: StaticString = "host", body: () async throws -> R) async rethrows -> R {
+        guard isEnabled else { return try await body() }
+        let start = now
+        let tid = thread
+        defer {
+            shared.record(name: name, category: category, start: start, duration: now - start, thread: tid, request: requestID)
+        }
+        return try await body()
+    }
+
+    /// Run `body` with the `requestID` of the serialized command `cmd` bound to the task,
+    /// the command is only decoded when tracing is enabled.
+    static func request<R>(_ cmd: Data, body: () async throws -> R) async rethrows -> R {
+        guard isEnabled, requestID == nil,
+              let id = try? AsyncifyCommand(serializedBytes: cmd).requestID else {
+            return try await body()
+        }
+        return try await $requestID.withValue(UUID(uuidString: id) ?? UUID(), operation: body)
+    }
+}
@@ -44,7 +44,9 @@ public protocol AsyncifyWasmProvider: AnyObject {
     func stateChanged(state: EngineState)
 }
 protocol AsyncifyWasmUpdaterDelegate: AsyncifyWasmProvider {
-    func version() async throws -> EngineVersion
+    /// Update check, runs on an idle pool instance and throws `AsyncifyWasmError.poolSaturated` when there is none
+    /// - Parameter etag: etag of the installed module, the guest may answer without `next` when it still matches
+    func version(ifNoneMatch etag: String?) async throws -> EngineVersion
 }
 public class AsyncifyWasm: AsyncifyWasmUpdaterDelegate {
     let _opts: Options
@@ -74,7 +76,15 @@ public class AsyncifyWasm: AsyncifyWasmUpdaterDelegate {
     }
     
     public func call(cmd: Data) async throws -> Data {
-        let wasm = try await pool.getInstance()
+        try await WasmTracer.request(cmd) {
+            let wasm = try await WasmTracer.span("pool.checkout", category: "pool") {
+                try await pool.getInstance()
+            }
+            return try await call(cmd: cmd, with: wasm)
+        }
+    }
+    
+    func call(cmd: Data, with wasm: AsyncifyWasmInternal) async throws -> Data {
         do {
             let ret = try await wasm.call(cmd: cmd)
             await pool.returnInstance(wasm)
@@ -107,16 +117,21 @@ public class AsyncifyWasm: AsyncifyWasmUpdaterDelegate {
     }
     
     public func release() async {
+        await updater.stop()
         await pool.release()
     }
     
 }
 enum AsyncifyWasmError: Error {
     case missingFlowOptions
+    case poolSaturated
+    case missingTask(UInt32)
 }
 extension AsyncifyWasm {
     func cast<T>(_ data: Data) async throws -> T where T: SwiftProtobuf.Message {
-        return try T(serializedBytes: data)
+        return try WasmTracer.span("decode") {
+            try T(serializedBytes: data)
+        }
     }
     
     func call<T>(_ cmd: AsyncifyCommand) async throws -> T where T: SwiftProtobuf.Message {
@@ -130,16 +145,24 @@ extension AsyncifyWasm {
         cmd.options.contentType = contentType
         return try await call(cmd: cmd.serializedData())
     }
-    func version() async throws -> EngineVersion {
+    func version(ifNoneMatch etag: String?) async throws -> EngineVersion {
         var caller = AsyncifyCommand.Call()
         caller.id = "ENGINE_CALL_ID_GET_VERSION"
+        if let etag, !etag.isEmpty {
+            caller.args.fields["if_none_match"] = Google_Protobuf_Value(stringValue: etag)
+        }
         guard var opts = try self.flowOptions() else {
             throw AsyncifyWasmError.missingFlowOptions
         }
         opts.uid = "c26b9659-e3ba-40b4-b993-bed11ced0457"
+        opts.contentType = "application/grpc"
         var cmd = AsyncifyCommand(call: caller)
         cmd.options = opts
-        return try await call(cmd)
+        // never take an instance away from an interactive call
+        guard let wasm = await pool.getIdleInstance() else {
+            throw AsyncifyWasmError.poolSaturated
+        }
+        return try await cast(await call(cmd: cmd.serializedData(), with: wasm))
     }
 }
 extension AsyncifyCommand {
@@ -153,7 +176,10 @@ extension AsyncifyCommand {
 
 class AsyncifyWasmInternal {
     let instance: Instance
+    let tasks: WasmTaskRegistry
     public init(path: String) throws {
+        let tasks = WasmTaskRegistry()
+        self.tasks = tasks
         let module = try parseWasm(filePath: SystemPackage.FilePath(path))
         let engine = Engine()
         let store = Store(engine: engine)
@@ -291,7 +317,7 @@ class AsyncifyWasmInternal {
                     )
                     debugPrint("[\(outPtr.hex)] enqueue task \(args.map { $0.i32.hex })")
                     debugPrint("[\(outPtr.hex)] input <\(args[2].i32.hex)> \(input.debugDescription)")
-                    WasmTaskManager.shared.run(Task(priority: .background) {
+                    tasks.insert(Task(priority: .background) {
                         // - store tasks with key `outPtr`
                         debugPrint("[\(outPtr.hex)] async started")
                         defer {
@@ -307,14 +333,25 @@ class AsyncifyWasmInternal {
                                                            callback: true)
                         try Task.checkCancellation()
                         // execute `fn`
-                        try callback([.i32(outPtr), .i32(fnPtr), .i32(argsPtr[0])])
-                        try Task.checkCancellation()
+                        try WasmTracer.span("callback", category: "guest") {
+                            try callback([.i32(outPtr), .i32(fnPtr), .i32(argsPtr[0])])
+                        }
                         let result = memory.load(fromByteOffset: outPtr, as: WAFuture.self)
+                        // take the child before anything can throw, it must not outlive this task
+                        // in the registry
+                        let child = result.callback != 0 && result.index != 0 ? tasks.take(result.index) : nil
+                        if Task.isCancelled {
+                            child?.cancel()
+                            throw CancellationError()
+                        }
                         var val: Data
                         // wasm call another async `get` function
                         if result.callback != 0 && result.index != 0 {
                             debugPrint("[\(outPtr.hex)] call child \(result.index.hex)")
-                            val = try await WasmTaskManager.shared.tasks[result.index]!.value
+                            guard let child else {
+                                throw AsyncifyWasmError.missingTask(result.index)
+                            }
+                            val = try await child.value
                         } else {
                             val = result.data(in: memory)
                             do {
@@ -332,7 +369,7 @@ class AsyncifyWasmInternal {
                         } catch {}
                         debugPrint("[\(outPtr.hex)] dequeue task")
                         return val
-                    }, key: outPtr)
+                    }, for: outPtr)
                     return []
                 }
             })
@@ -352,12 +389,21 @@ class AsyncifyWasmInternal {
         let outPtr = try allocator([.i32(UInt32(MemoryLayout<WAFuture>.size))])[0].i32
         // copy input to heap
         let inputPtr = try memory.set(data: cmd, in: allocator)
-        try caller([.i32(outPtr), .i32(inputPtr), .i32(UInt32(cmd.count))])
+        try WasmTracer.span("guest.call", category: "guest") {
+            try caller([.i32(outPtr), .i32(inputPtr), .i32(UInt32(cmd.count))])
+        }
         // extract `outPtr`
         let result = memory.load(fromByteOffset: outPtr, as: WAFuture.self)
-        try Task.checkCancellation()
-        if result.index != 0, let task = await WasmTaskManager.shared.tasks[result.index] {
-            return try await task.value
+        // taken before the cancellation check so an abandoned call leaves nothing registered
+        let task = result.index != 0 ? tasks.take(result.index) : nil
+        if Task.isCancelled {
+            task?.cancel()
+            throw CancellationError()
+        }
+        if let task {
+            return try await WasmTracer.span("guest.await", category: "guest") {
+                try await task.value
+            }
         }
         defer {
             // clean
@@ -371,7 +417,7 @@ class AsyncifyWasmInternal {
     }
     
     public func release() async {
-        await WasmTaskManager.shared.release()
+        tasks.cancelAll()
     }
     
     deinit {
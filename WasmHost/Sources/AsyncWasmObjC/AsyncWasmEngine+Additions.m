@@ -6,7 +6,34 @@
 //
 
 #import "AsyncWasmEngine+Additions.h"
-@import Protobuf;
+
+static void WAParseMessage(NSData *_Nullable data,
+                           NSError *_Nullable error,
+                           Class clazz,
+                           WAMessageCompletionHandler completionHandler) {
+    if (error != nil ) {
+        completionHandler(nil, error);
+        return;
+    }
+    // results often carry large `bytes` payloads (GPBAny, TypesBytes), reference them
+    // from the response instead of copying them
+    GPBCodedInputStream *input = [GPBCodedInputStream streamWithData:data ?: [NSData data]
+                                                             options:GPBCodedInputStreamOptionZeroCopyBytes];
+    id ret = [clazz parseFromCodedInputStream:input extensionRegistry:nil error:&error];
+    if (error != nil ) {
+        completionHandler(nil, error);
+        return;
+    }
+    completionHandler(ret, nil);
+}
+
+WADataCompletionHandler WAMessageDataHandler(Class messageClass,
+                                             WAMessageCompletionHandler completionHandler) {
+    return ^(NSData *_Nullable data, NSError *_Nullable error) {
+        WAParseMessage(data, error, messageClass, completionHandler);
+    };
+}
+
 @implementation AsyncWasmEngine (Protobuf)
 -(void)performSelector:(SEL)selector
                   args:(NSArray*)args
@@ -28,25 +55,19 @@
     [inv invoke];
 }
 
+-(void)versionMessageWithCompletionHandler:(void(^)(WAEngineVersion *_Nullable, NSError *_Nullable))completionHandler {
+    [self versionWithCompletionHandler:WAMessageDataHandler(WAEngineVersion.class, completionHandler)];
+}
 
 -(void)cast:(NSData*)data
       error:(NSError* _Nullable)error
       clazz:(Class)clazz
 completionHandler:(void(^)(id _Nullable, NSError * _Nullable))completionHandler {
-    if (error != nil ) {
-        completionHandler(nil, error);
-        return;
-    }
-    if (![clazz isSubclassOfClass: GPBMessage.class]) {
+    if (error == nil && ![clazz isSubclassOfClass: GPBMessage.class]) {
         completionHandler(nil, [NSError errorWithDomain:[AsyncifyWasmConstants errorDomain] code:-1 userInfo:@{NSLocalizedFailureReasonErrorKey: @"required subsclass of GPBMessage"}]);
         return;
     }
-    id ret = [[clazz alloc] initWithData:data error:&error];
-    if (error != nil ) {
-        completionHandler(nil, error);
-        return;
-    }
-    completionHandler(ret, nil);
+    WAParseMessage(data, error, clazz, completionHandler);
 }
 
 
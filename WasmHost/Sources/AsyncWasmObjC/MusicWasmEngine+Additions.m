@@ -0,0 +1,64 @@
+//
+//  MusicWasmEngine+Additions.m
+//  WasmHost
+//
+//  Created by L7Studio on 19/10/26.
+//
+
+#import "MusicWasmEngine+Additions.h"
+
+@implementation MusicWasmEngine (Protobuf)
+-(void)detailsMessageWithVideoId:(NSString *)vid
+               completionHandler:(void(^)(WAMusicTrackDetails *_Nullable, NSError *_Nullable))completionHandler {
+    [self detailsWithVideoId:vid
+           completionHandler:WAMessageDataHandler(WAMusicTrackDetails.class, completionHandler)];
+}
+
+-(void)transcriptMessageWithVideoId:(NSString *)vid
+                  completionHandler:(void(^)(WAMusicTranscript *_Nullable, NSError *_Nullable))completionHandler {
+    [self transcriptWithVideoId:vid
+              completionHandler:WAMessageDataHandler(WAMusicTranscript.class, completionHandler)];
+}
+
+-(void)discoverMessageWithCategory:(NSString *)category
+                           country:(nullable NSString *)country
+                      continuation:(nullable NSString *)continuation
+                 completionHandler:(void(^)(WAMusicListTracks *_Nullable, NSError *_Nullable))completionHandler {
+    [self getDiscoverWithCategory:category
+                          country:country
+                     continuation:continuation
+                completionHandler:WAMessageDataHandler(WAMusicListTracks.class, completionHandler)];
+}
+
+-(void)suggestionMessageWithKeyword:(NSString *)keyword
+                  completionHandler:(void(^)(WAMusicListSuggestions *_Nullable, NSError *_Nullable))completionHandler {
+    [self suggestionWithKeyword:keyword
+              completionHandler:WAMessageDataHandler(WAMusicListSuggestions.class, completionHandler)];
+}
+
+-(void)searchMessageWithKeyword:(NSString *)keyword
+                          scope:(NSString *)scope
+                   continuation:(nullable NSString *)continuation
+              completionHandler:(void(^)(WAMusicListTracks *_Nullable, NSError *_Nullable))completionHandler {
+    [self searchWithKeyword:keyword
+                      scope:scope
+               continuation:continuation
+          completionHandler:WAMessageDataHandler(WAMusicListTracks.class, completionHandler)];
+}
+
+-(void)tracksMessageWithPlaylistId:(NSString *)pid
+                      continuation:(nullable NSString *)continuation
+                 completionHandler:(void(^)(WAMusicListTracks *_Nullable, NSError *_Nullable))completionHandler {
+    [self trackWithPlaylistId:pid
+                 continuation:continuation
+            completionHandler:WAMessageDataHandler(WAMusicListTracks.class, completionHandler)];
+}
+
+-(void)relatedMessageWithVideoId:(NSString *)vid
+                    continuation:(nullable NSString *)continuation
+               completionHandler:(void(^)(WAMusicListTracks *_Nullable, NSError *_Nullable))completionHandler {
+    [self relatedWithVideoId:vid
+                continuation:continuation
+           completionHandler:WAMessageDataHandler(WAMusicListTracks.class, completionHandler)];
+}
+@end
@@ -7,14 +7,26 @@
 
 #import <Foundation/Foundation.h>
 @import AsyncWasm;
+@import Protobuf;
+@import WasmObjCProtobuf;
 NS_ASSUME_NONNULL_BEGIN
 
+typedef void (^WADataCompletionHandler)(NSData *_Nullable, NSError *_Nullable);
+typedef void (^WAMessageCompletionHandler)(id _Nullable, NSError *_Nullable);
+
+/// Returns a handler for the `NSData` result of an engine call that parses it
+/// as a `messageClass` message and passes that to `completionHandler`.
+/// `messageClass` must be a `GPBMessage` subclass, it is not checked at runtime.
+FOUNDATION_EXPORT WADataCompletionHandler WAMessageDataHandler(Class messageClass,
+                                                               WAMessageCompletionHandler completionHandler);
+
 @interface AsyncWasmEngine (Protobuf)
 -(void)performSelector:(SEL)selector
                   args:(NSArray*)args
                  clazz:(Class)clazz
      completionHandler:(void(^)(id _Nullable, NSError *_Nullable)) completionHandler;
 
+-(void)versionMessageWithCompletionHandler:(void(^)(WAEngineVersion *_Nullable, NSError *_Nullable))completionHandler;
 @end
 
 NS_ASSUME_NONNULL_END
@@ -8,5 +8,6 @@
 #ifndef AsyncWasmObjC_h
 #define AsyncWasmObjC_h
 #include "AsyncWasmEngine+Additions.h"
+#include "MusicWasmEngine+Additions.h"
 
 #endif /* MusicWasmObjC_h */
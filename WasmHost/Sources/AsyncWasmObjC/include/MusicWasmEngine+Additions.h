@@ -0,0 +1,46 @@
+//
+//  MusicWasmEngine+Additions.h
+//  WasmHost
+//
+//  Created by L7Studio on 19/10/26.
+//
+
+#import <Foundation/Foundation.h>
+#import "AsyncWasmEngine+Additions.h"
+@import MusicWasm;
+NS_ASSUME_NONNULL_BEGIN
+
+/// Typed variants of the `MusicWasmEngine` calls, one per `MusicActionID`.
+/// The result is parsed straight into the message class of the call, unlike
+/// `performSelector:args:clazz:completionHandler:` no invocation is built and
+/// the arguments are not boxed.
+@interface MusicWasmEngine (Protobuf)
+-(void)detailsMessageWithVideoId:(NSString *)vid
+               completionHandler:(void(^)(WAMusicTrackDetails *_Nullable, NSError *_Nullable))completionHandler;
+
+-(void)transcriptMessageWithVideoId:(NSString *)vid
+                  completionHandler:(void(^)(WAMusicTranscript *_Nullable, NSError *_Nullable))completionHandler;
+
+-(void)discoverMessageWithCategory:(NSString *)category
+                           country:(nullable NSString *)country
+                      continuation:(nullable NSString *)continuation
+                 completionHandler:(void(^)(WAMusicListTracks *_Nullable, NSError *_Nullable))completionHandler;
+
+-(void)suggestionMessageWithKeyword:(NSString *)keyword
+                  completionHandler:(void(^)(WAMusicListSuggestions *_Nullable, NSError *_Nullable))completionHandler;
+
+-(void)searchMessageWithKeyword:(NSString *)keyword
+                          scope:(NSString *)scope
+                   continuation:(nullable NSString *)continuation
+              completionHandler:(void(^)(WAMusicListTracks *_Nullable, NSError *_Nullable))completionHandler;
+
+-(void)tracksMessageWithPlaylistId:(NSString *)pid
+                      continuation:(nullable NSString *)continuation
+                 completionHandler:(void(^)(WAMusicListTracks *_Nullable, NSError *_Nullable))completionHandler;
+
+-(void)relatedMessageWithVideoId:(NSString *)vid
+                    continuation:(nullable NSString *)continuation
+               completionHandler:(void(^)(WAMusicListTracks *_Nullable, NSError *_Nullable))completionHandler;
+@end
+
+NS_ASSUME_NONNULL_END
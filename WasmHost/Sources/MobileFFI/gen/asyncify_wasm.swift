@@ -27,6 +27,9 @@ fileprivate struct UniffiVTableCallbackInterfaceAsyncifyWasmProvider {
 
 // This file was autogenerated by some hot garbage in the `uniffi` crate.
 // Trust me, you don't want to mess with it!
+//
+// Patched after generation, see patches/asyncify_wasm.swift.patch. Regenerate
+// with `make bindings`, which applies the patch again.
 
 // swiftlint:disable all
 import Foundation
@@ -41,6 +44,9 @@ import asyncify_wasmFFI
 @_silgen_name("ffi_asyncify_wasm_uniffi_contract_version")
 fileprivate func ffi_asyncify_wasm_uniffi_contract_version() -> UInt32
 
+@_silgen_name("ffi_asyncify_wasm_rustbuffer_alloc")
+fileprivate func ffi_asyncify_wasm_rustbuffer_alloc(_ size: Int32, _ out_status: UnsafeMutablePointer<RustCallStatus>) -> RustBuffer
+
 @_silgen_name("ffi_asyncify_wasm_rustbuffer_from_bytes")
 fileprivate func ffi_asyncify_wasm_rustbuffer_from_bytes(_ bytes: ForeignBytes, _ out_status: UnsafeMutablePointer<RustCallStatus>) -> RustBuffer
 
@@ -146,6 +152,17 @@ fileprivate extension RustBuffer {
         try! rustCall { ffi_asyncify_wasm_rustbuffer_from_bytes(ForeignBytes(bufferPointer: ptr), $0) }
     }
 
+    // Allocate a new buffer of exactly `size` bytes, for callers that write
+    // the contents in place instead of copying them from a Swift array.
+    static func alloc(size: Int) -> RustBuffer {
+        try! rustCall { ffi_asyncify_wasm_rustbuffer_alloc(Int32(size), $0) }
+    }
+
+    // A view of the contents, valid until the buffer is deallocated.
+    var bytes: UnsafeRawBufferPointer {
+        UnsafeRawBufferPointer(start: data, count: Int(len))
+    }
+
     // Frees the buffer in place.
     // The buffer must not be used after this is called.
     func deallocate() {
@@ -166,16 +183,6 @@ fileprivate extension ForeignBytes {
 // Helper classes/extensions that don't change.
 // Someday, this will be in a library of its own.
 
-fileprivate extension Data {
-    init(rustBuffer: RustBuffer) {
-        self.init(
-            bytesNoCopy: rustBuffer.data!,
-            count: Int(rustBuffer.len),
-            deallocator: .none
-        )
-    }
-}
-
 // Define reader functionality.  Normally this would be defined in a class or
 // struct, but we use standalone functions instead in order to make external
 // types work.
@@ -189,57 +196,51 @@ fileprivate extension Data {
 //   files will try define the same type.
 //
 // Instead, the read() method and these helper functions input a tuple of data
+//
+// The data is a view of the RustBuffer being lifted, so reading never copies
+// the buffer; only the values built from it (strings, `Data`) copy their bytes.
 
-fileprivate func createReader(data: Data) -> (data: Data, offset: Data.Index) {
-    (data: data, offset: 0)
+fileprivate func createReader(rustBuffer: RustBuffer) -> (data: UnsafeRawBufferPointer, offset: Int) {
+    (data: rustBuffer.bytes, offset: 0)
 }
 
 // Reads an integer at the current offset, in big-endian order, and advances
 // the offset on success. Throws if reading the integer would move the
 // offset past the end of the buffer.
-fileprivate func readInt<T: FixedWidthInteger>(_ reader: inout (data: Data, offset: Data.Index)) throws -> T {
-    let range = reader.offset..<reader.offset + MemoryLayout<T>.size
-    guard reader.data.count >= range.upperBound else {
+fileprivate func readInt<T: FixedWidthInteger>(_ reader: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> T {
+    let size = MemoryLayout<T>.size
+    guard reader.data.count - reader.offset >= size else {
         throw UniffiInternalError.bufferOverflow
     }
-    if T.self == UInt8.self {
-        let value = reader.data[reader.offset]
-        reader.offset += 1
-        return value as! T
-    }
-    var value: T = 0
-    let _ = withUnsafeMutableBytes(of: &value, { reader.data.copyBytes(to: $0, from: range)})
-    reader.offset = range.upperBound
-    return value.bigEndian
+    let value = reader.data.loadUnaligned(fromByteOffset: reader.offset, as: T.self)
+    reader.offset += size
+    return T(bigEndian: value)
 }
 
 // Reads an arbitrary number of bytes, to be used to read
-// raw bytes, this is useful when lifting strings
-fileprivate func readBytes(_ reader: inout (data: Data, offset: Data.Index), count: Int) throws -> Array<UInt8> {
-    let range = reader.offset..<(reader.offset+count)
-    guard reader.data.count >= range.upperBound else {
+// raw bytes, this is useful when lifting strings. The result is a view
+// of the buffer being read, callers copy what they keep.
+fileprivate func readBytes(_ reader: inout (data: UnsafeRawBufferPointer, offset: Int), count: Int) throws -> UnsafeRawBufferPointer {
+    guard count >= 0, reader.data.count - reader.offset >= count else {
         throw UniffiInternalError.bufferOverflow
     }
-    var value = [UInt8](repeating: 0, count: count)
-    value.withUnsafeMutableBufferPointer({ buffer in
-        reader.data.copyBytes(to: buffer, from: range)
-    })
-    reader.offset = range.upperBound
+    let value = UnsafeRawBufferPointer(rebasing: reader.data[reader.offset..<reader.offset + count])
+    reader.offset += count
     return value
 }
 
 // Reads a float at the current offset.
-fileprivate func readFloat(_ reader: inout (data: Data, offset: Data.Index)) throws -> Float {
+fileprivate func readFloat(_ reader: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> Float {
     return Float(bitPattern: try readInt(&reader))
 }
 
 // Reads a float at the current offset.
-fileprivate func readDouble(_ reader: inout (data: Data, offset: Data.Index)) throws -> Double {
+fileprivate func readDouble(_ reader: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> Double {
     return Double(bitPattern: try readInt(&reader))
 }
 
 // Indicates if the offset has reached the end of the buffer.
-fileprivate func hasRemaining(_ reader: (data: Data, offset: Data.Index)) -> Bool {
+fileprivate func hasRemaining(_ reader: (data: UnsafeRawBufferPointer, offset: Int)) -> Bool {
     return reader.offset < reader.data.count
 }
 
@@ -247,8 +248,12 @@ fileprivate func hasRemaining(_ reader: (data: Data, offset: Data.Index)) -> Boo
 // struct, but we use standalone functions instead in order to make external
 // types work.  See the above discussion on Readers for details.
 
+// The records lowered through a writer are a few fixed-width fields and short
+// strings, starting with this much room they are written without regrowing.
 fileprivate func createWriter() -> [UInt8] {
-    return []
+    var writer = [UInt8]()
+    writer.reserveCapacity(64)
+    return writer
 }
 
 fileprivate func writeBytes<S>(_ writer: inout [UInt8], _ byteArr: S) where S: Sequence, S.Element == UInt8 {
@@ -280,7 +285,7 @@ fileprivate protocol FfiConverter {
 
     static func lift(_ value: FfiType) throws -> SwiftType
     static func lower(_ value: SwiftType) -> FfiType
-    static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> SwiftType
+    static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> SwiftType
     static func write(_ value: SwiftType, into buf: inout [UInt8])
 }
 
@@ -312,12 +317,14 @@ extension FfiConverterRustBuffer {
     @_documentation(visibility: private)
 #endif
     public static func lift(_ buf: RustBuffer) throws -> SwiftType {
-        var reader = createReader(data: Data(rustBuffer: buf))
+        defer {
+            buf.deallocate()
+        }
+        var reader = createReader(rustBuffer: buf)
         let value = try read(from: &reader)
         if hasRemaining(reader) {
             throw UniffiInternalError.incompleteData
         }
-        buf.deallocate()
         return value
     }
 
@@ -522,7 +529,7 @@ fileprivate struct FfiConverterUInt32: FfiConverterPrimitive {
     typealias FfiType = UInt32
     typealias SwiftType = UInt32
 
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> UInt32 {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> UInt32 {
         return try lift(readInt(&buf))
     }
 
@@ -538,7 +545,7 @@ fileprivate struct FfiConverterUInt64: FfiConverterPrimitive {
     typealias FfiType = UInt64
     typealias SwiftType = UInt64
 
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> UInt64 {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> UInt64 {
         return try lift(readInt(&buf))
     }
 
@@ -554,7 +561,7 @@ fileprivate struct FfiConverterDouble: FfiConverterPrimitive {
     typealias FfiType = Double
     typealias SwiftType = Double
 
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> Double {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> Double {
         return try lift(readDouble(&buf))
     }
 
@@ -582,19 +589,14 @@ fileprivate struct FfiConverterString: FfiConverter {
     }
 
     public static func lower(_ value: String) -> RustBuffer {
-        return value.utf8CString.withUnsafeBufferPointer { ptr in
-            // The swift string gives us int8_t, we want uint8_t.
-            ptr.withMemoryRebound(to: UInt8.self) { ptr in
-                // The swift string gives us a trailing null byte, we don't want it.
-                let buf = UnsafeBufferPointer(rebasing: ptr.prefix(upTo: ptr.count - 1))
-                return RustBuffer.from(buf)
-            }
-        }
+        // Native strings are contiguous UTF-8 already, Rust copies them once.
+        var value = value
+        return value.withUTF8 { RustBuffer.from($0) }
     }
 
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> String {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> String {
         let len: Int32 = try readInt(&buf)
-        return String(bytes: try readBytes(&buf, count: Int(len)), encoding: String.Encoding.utf8)!
+        return String(decoding: try readBytes(&buf, count: Int(len)), as: UTF8.self)
     }
 
     public static func write(_ value: String, into buf: inout [UInt8]) {
@@ -610,7 +612,48 @@ fileprivate struct FfiConverterString: FfiConverter {
 fileprivate struct FfiConverterData: FfiConverterRustBuffer {
     typealias SwiftType = Data
 
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> Data {
+    // The lifted `Data` adopts the RustBuffer, which is freed with it.
+    public static func lift(_ buf: RustBuffer) throws -> Data {
+        var reader = createReader(rustBuffer: buf)
+        let len: Int32
+        do {
+            len = try readInt(&reader)
+            _ = try readBytes(&reader, count: Int(len))
+        } catch {
+            buf.deallocate()
+            throw error
+        }
+        if hasRemaining(reader) {
+            buf.deallocate()
+            throw UniffiInternalError.incompleteData
+        }
+        if len == 0 {
+            buf.deallocate()
+            return Data()
+        }
+        return Data(
+            bytesNoCopy: buf.data! + MemoryLayout<Int32>.size,
+            count: Int(len),
+            deallocator: .custom { _, _ in buf.deallocate() }
+        )
+    }
+
+    // Writes the length prefix and bytes straight into an exactly sized RustBuffer.
+    public static func lower(_ value: Data) -> RustBuffer {
+        return lower(value, headerSize: 0)
+    }
+
+    // Same, leaving `headerSize` bytes in front for the caller to fill.
+    static func lower(_ value: Data, headerSize: Int) -> RustBuffer {
+        let prefixSize = MemoryLayout<Int32>.size
+        let buf = RustBuffer.alloc(size: headerSize + prefixSize + value.count)
+        let bytes = UnsafeMutableRawBufferPointer(start: buf.data, count: Int(buf.len))
+        bytes.storeBytes(of: Int32(value.count).bigEndian, toByteOffset: headerSize, as: Int32.self)
+        value.copyBytes(to: buf.data! + headerSize + prefixSize, count: value.count)
+        return buf
+    }
+
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> Data {
         let len: Int32 = try readInt(&buf)
         return Data(try readBytes(&buf, count: Int(len)))
     }
@@ -748,7 +791,7 @@ public struct FfiConverterTypeAsyncifyWasm: FfiConverter {
         return value.uniffiClonePointer()
     }
 
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> AsyncifyWasm {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> AsyncifyWasm {
         let v: UInt64 = try readInt(&buf)
         // The Rust code won't compile if a pointer won't fit in a UInt64.
         // We have to go via `UInt` because that's the thing that's the size of a pointer.
@@ -1058,7 +1101,7 @@ public struct FfiConverterTypeAsyncifyWasmProvider: FfiConverter {
         return ptr
     }
 
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> AsyncifyWasmProvider {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> AsyncifyWasmProvider {
         let v: UInt64 = try readInt(&buf)
         // The Rust code won't compile if a pointer won't fit in a UInt64.
         // We have to go via `UInt` because that's the thing that's the size of a pointer.
@@ -1116,7 +1159,7 @@ extension Options: Sendable {}
 @_documentation(visibility: private)
 #endif
 public struct FfiConverterTypeOptions: FfiConverterRustBuffer {
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> Options {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> Options {
         return
             try Options(
                 wasm: FfiConverterOptionTypeWasmOptions.read(from: &buf), 
@@ -1198,7 +1241,7 @@ extension UpdateOptions: Equatable, Hashable {
 @_documentation(visibility: private)
 #endif
 public struct FfiConverterTypeUpdateOptions: FfiConverterRustBuffer {
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> UpdateOptions {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> UpdateOptions {
         return
             try UpdateOptions(
                 bundleDir: FfiConverterString.read(from: &buf), 
@@ -1292,7 +1335,7 @@ extension WaFuture: Equatable, Hashable {
 @_documentation(visibility: private)
 #endif
 public struct FfiConverterTypeWaFuture: FfiConverterRustBuffer {
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> WaFuture {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> WaFuture {
         return
             try WaFuture(
                 data: FfiConverterUInt32.read(from: &buf), 
@@ -1370,7 +1413,7 @@ extension WaString: Equatable, Hashable {
 @_documentation(visibility: private)
 #endif
 public struct FfiConverterTypeWaString: FfiConverterRustBuffer {
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> WaString {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> WaString {
         return
             try WaString(
                 ptr: FfiConverterUInt32.read(from: &buf), 
@@ -1415,7 +1458,7 @@ public enum AsyncifyWasmError {
 public struct FfiConverterTypeAsyncifyWasmError: FfiConverterRustBuffer {
     typealias SwiftType = AsyncifyWasmError
 
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> AsyncifyWasmError {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> AsyncifyWasmError {
         let variant: Int32 = try readInt(&buf)
         switch variant {
 
@@ -1501,7 +1544,7 @@ extension EngineState: Sendable {}
 public struct FfiConverterTypeEngineState: FfiConverterRustBuffer {
     typealias SwiftType = EngineState
 
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> EngineState {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> EngineState {
         let variant: Int32 = try readInt(&buf)
         switch variant {
         
@@ -1621,7 +1664,7 @@ extension WasmOptions: Sendable {}
 public struct FfiConverterTypeWasmOptions: FfiConverterRustBuffer {
     typealias SwiftType = WasmOptions
 
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> WasmOptions {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> WasmOptions {
         let variant: Int32 = try readInt(&buf)
         switch variant {
         
@@ -1683,7 +1726,7 @@ fileprivate struct FfiConverterOptionUInt64: FfiConverterRustBuffer {
         FfiConverterUInt64.write(value, into: &buf)
     }
 
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> SwiftType {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> SwiftType {
         switch try readInt(&buf) as Int8 {
         case 0: return nil
         case 1: return try FfiConverterUInt64.read(from: &buf)
@@ -1707,7 +1750,7 @@ fileprivate struct FfiConverterOptionString: FfiConverterRustBuffer {
         FfiConverterString.write(value, into: &buf)
     }
 
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> SwiftType {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> SwiftType {
         switch try readInt(&buf) as Int8 {
         case 0: return nil
         case 1: return try FfiConverterString.read(from: &buf)
@@ -1722,6 +1765,18 @@ fileprivate struct FfiConverterOptionString: FfiConverterRustBuffer {
 fileprivate struct FfiConverterOptionData: FfiConverterRustBuffer {
     typealias SwiftType = Data?
 
+    // Preferences can be large, lower them without the intermediate [UInt8].
+    public static func lower(_ value: SwiftType) -> RustBuffer {
+        guard let value = value else {
+            let buf = RustBuffer.alloc(size: 1)
+            buf.data!.pointee = 0
+            return buf
+        }
+        let buf = FfiConverterData.lower(value, headerSize: 1)
+        buf.data!.pointee = 1
+        return buf
+    }
+
     public static func write(_ value: SwiftType, into buf: inout [UInt8]) {
         guard let value = value else {
             writeInt(&buf, Int8(0))
@@ -1731,7 +1786,7 @@ fileprivate struct FfiConverterOptionData: FfiConverterRustBuffer {
         FfiConverterData.write(value, into: &buf)
     }
 
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> SwiftType {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> SwiftType {
         switch try readInt(&buf) as Int8 {
         case 0: return nil
         case 1: return try FfiConverterData.read(from: &buf)
@@ -1755,7 +1810,7 @@ fileprivate struct FfiConverterOptionTypeAsyncifyWasmProvider: FfiConverterRustB
         FfiConverterTypeAsyncifyWasmProvider.write(value, into: &buf)
     }
 
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> SwiftType {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> SwiftType {
         switch try readInt(&buf) as Int8 {
         case 0: return nil
         case 1: return try FfiConverterTypeAsyncifyWasmProvider.read(from: &buf)
@@ -1779,7 +1834,7 @@ fileprivate struct FfiConverterOptionTypeOptions: FfiConverterRustBuffer {
         FfiConverterTypeOptions.write(value, into: &buf)
     }
 
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> SwiftType {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> SwiftType {
         switch try readInt(&buf) as Int8 {
         case 0: return nil
         case 1: return try FfiConverterTypeOptions.read(from: &buf)
@@ -1803,7 +1858,7 @@ fileprivate struct FfiConverterOptionTypeWasmOptions: FfiConverterRustBuffer {
         FfiConverterTypeWasmOptions.write(value, into: &buf)
     }
 
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> SwiftType {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> SwiftType {
         switch try readInt(&buf) as Int8 {
         case 0: return nil
         case 1: return try FfiConverterTypeWasmOptions.read(from: &buf)
@@ -1823,7 +1878,7 @@ public typealias EngineVersion = Data
 @_documentation(visibility: private)
 #endif
 public struct FfiConverterTypeEngineVersion: FfiConverter {
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> EngineVersion {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> EngineVersion {
         return try FfiConverterData.read(from: &buf)
     }
 
@@ -1867,7 +1922,7 @@ public typealias FlowOptions = Data
 @_documentation(visibility: private)
 #endif
 public struct FfiConverterTypeFlowOptions: FfiConverter {
-    public static func read(from buf: inout (data: Data, offset: Data.Index)) throws -> FlowOptions {
+    public static func read(from buf: inout (data: UnsafeRawBufferPointer, offset: Int)) throws -> FlowOptions {
         return try FfiConverterData.read(from: &buf)
     }
 
@@ -51,26 +51,21 @@ public func `default`() async throws -> MusicWasmProtocol {
 public extension MusicWasmEngine {
 	internal static let kMaxRetryCount = 10
 	
+	/// Details of a track, its formats limited to the playable ones with the best first.
 	func details(vid: String) async throws -> MusicTrackDetails {
 		var attempts = 0
 		
 		while attempts < Self.kMaxRetryCount {
 			attempts += 1
-			let val: MusicTrackDetails = try await cast(await details(vid: vid))
-			if val.formats.isEmpty {
-				WALogger.host.debug("[\(vid)] \(attempts) retrying...")
-				try await Task.sleep(nanoseconds: UInt64(backoff(attempts: attempts) * 1_000_000_000))
-				continue
-			}
-			if let url = val.formats.first?.url, let url = URL(string: url) {
-				var req = URLRequest(url: url)
-				req.httpMethod = "HEAD"
-				let resp = try await URLSession.shared.data(for: req)
-				let status = (resp.1 as? HTTPURLResponse)?.statusCode ?? -1
-				if status == 200 {
-					return val
-				}
+			var val: MusicTrackDetails = try await cast(await details(vid: vid))
+			// only call the guest again when none of the formats answers
+			let formats = await formatValidator.playable(val.formats)
+			if !formats.isEmpty {
+				val.formats = formats
+				return val
 			}
+			WALogger.host.debug("[\(vid)] \(attempts) no playable format, retrying...")
+			try await Task.sleep(nanoseconds: UInt64(backoff(attempts: attempts) * 1_000_000_000))
 		}
 		throw Constants.Error.maximumRetryExceededError.error()
 	}
@@ -161,6 +156,32 @@ public extension MusicWasmEngine {
 
 @objc
 public class MusicWasmEngine: TaskWasmEngine, MusicWasmProtocol {
+	/// Cache of the list calls (discover, search, tracks, related and suggestion), nil to always call the guest.
+	/// It is read by concurrent calls, so it is only set at init.
+	public let responseCache: MusicResponseCache?
+	/// Probes the formats returned by `details`
+	public let formatValidator = MusicFormatValidator()
+	
+	public required init() {
+		self.responseCache = MusicResponseCache()
+		super.init()
+	}
+	
+	public required init(wasmDir: URL? = nil) {
+		self.responseCache = MusicResponseCache()
+		super.init(wasmDir: wasmDir)
+	}
+	
+	public required convenience init(wasmDir: URL? = nil, file: URL?) throws {
+		try self.init(wasmDir: wasmDir, file: file, responseCache: MusicResponseCache())
+	}
+	
+	/// - Parameter responseCache: cache of the list calls, nil to always call the guest
+	public init(wasmDir: URL? = nil, file: URL?, responseCache: MusicResponseCache?) throws {
+		self.responseCache = responseCache
+		try super.init(wasmDir: wasmDir, file: file)
+	}
+	
 	@objc(detailsWithVideoId:completionHandler:)
 	public func details(vid: String) async throws -> Data {
 		try await data(id: MusicActionID.details, args: detailsArgs(vid: vid))
@@ -173,25 +194,49 @@ public class MusicWasmEngine: TaskWasmEngine, MusicWasmProtocol {
 	
 	@objc(getDiscoverWithCategory:country:continuation:completionHandler:)
 	public func discover(category: String, country: String?, continuation: String?) async throws -> Data {
-		return try await data(id: MusicActionID.discover, args: discoverArgs(category: category, country: country, continuation: continuation))
+		return try await cachedData(id: MusicActionID.discover, args: discoverArgs(category: category, country: country, continuation: continuation))
 	}
 	
 	@objc(suggestionWithKeyword:completionHandler:)
 	public func suggestion(keyword: String) async throws -> Data {
-		return try await data(id: MusicActionID.suggestion, args: suggestionArgs(keyword: keyword))
+		return try await cachedData(id: MusicActionID.suggestion, args: suggestionArgs(keyword: keyword))
 	}
 	
 	@objc(searchWithKeyword:scope:continuation:completionHandler:)
 	public func search(keyword: String, scope: String, continuation: String?) async throws -> Data {
-		return try await data(id: MusicActionID.search, args: searchArgs(keyword: keyword, scope: scope, continuation: continuation))
+		return try await cachedData(id: MusicActionID.search, args: searchArgs(keyword: keyword, scope: scope, continuation: continuation))
 	}
 	
 	@objc(trackWithPlaylistId:continuation:completionHandler:)
 	public func tracks(pid: String, continuation: String?) async throws -> Data {
-		return try await data(id: MusicActionID.tracks, args: tracksArgs(pid: pid, continuation: continuation))
+		return try await cachedData(id: MusicActionID.tracks, args: tracksArgs(pid: pid, continuation: continuation))
 	}
 	@objc(relatedWithVideoId:continuation:completionHandler:)
 	public func related(vid: String, continuation: String?) async throws -> Data {
-		return try await data(id: MusicActionID.related, args: relatedArgs(vid: vid, continuation: continuation))
+		return try await cachedData(id: MusicActionID.related, args: relatedArgs(vid: vid, continuation: continuation))
+	}
+	
+	/// Drop every cached list response, the next calls go to the guest.
+	@objc
+	public func removeCachedResponses() {
+		responseCache?.removeAll()
+	}
+	
+	public override func didChange(state: EngineState) {
+		super.didChange(state: state)
+		if case .reload = state {
+			// responses of the previous module
+			responseCache?.removeAll()
+		}
+	}
+	
+	func cachedData(id: MusicActionID, args: [String: Google_Protobuf_Value]) async throws -> Data {
+		guard let responseCache else {
+			return try await data(id: id, args: args)
+		}
+		let key = MusicResponseCache.Key(id: id.rawValue, args: args, premium: premium, copts: copts)
+		return try await responseCache.data(for: key) { [self] in
+			try await data(id: id, args: args)
+		}
 	}
 }
@@ -0,0 +1,137 @@
+//
+//  FormatValidator.swift
+//  WasmHost
+//
+//  Created by L7Studio on 19/10/26.
+//
+import AsyncWasm
+import Foundation
+import WasmSwiftProtobuf
+
+/// Checks which formats of a track can be played.
+///
+/// All the candidates are probed with concurrent `HEAD` requests. A result is cached per URL until the
+/// format expires (`exp`), failures only for `failureTTL` since they are often transient.
+public final class MusicFormatValidator: @unchecked Sendable {
+	struct Probe {
+		let reachable: Bool
+		let latency: TimeInterval
+		let expires: Date
+	}
+
+	/// Timeout of a single `HEAD` request
+	public var timeout: TimeInterval = 8
+	/// How long a failed probe is remembered
+	public var failureTTL: TimeInterval = 30
+	/// How long a successful probe is remembered when the format has no `exp`
+	public var defaultTTL: TimeInterval = 5 * 60
+	let session: URLSession
+	private let lock = NSLock()
+	private var probes: [String: Probe] = [:]
+
+	public init(session: URLSession = .shared) {
+		self.session = session
+	}
+
+	/// Rank of a format quality, higher is better. Knows the `AUDIO_QUALITY_*` names and
+	/// video qualities like `hd720` or `1080p`.
+	static func rank(quality: String) -> Int {
+		let quality = quality.uppercased()
+		// the height is the first run of digits, `1080p60` is 1080 lines at 60 fps
+		if let height = Int(quality.drop(while: { !$0.isNumber }).prefix(while: \.isNumber)), height > 0 {
+			return height
+		}
+		if quality.contains("HIGH") { return 3 }
+		if quality.contains("MEDIUM") { return 2 }
+		if quality.contains("LOW") { return 1 }
+		return 0
+	}
+
+	/// Returns the playable formats, best first, or an empty array when none answers.
+	///
+	/// Formats of the kind of the first one (audio or video) come first, then higher qualities.
+	/// The formats are probed concurrently. As soon as a format is reachable and no better format
+	/// is still being probed, the remaining probes are cancelled: among formats of the same
+	/// quality the first one to answer, the one with the lowest latency, wins. Formats known to be
+	/// unreachable are left out, the ones whose probe was cancelled are kept after the reachable ones.
+	public func playable(_ formats: [MusicTrackDetails.Format]) async -> [MusicTrackDetails.Format] {
+		// the guest lists its preferred kind (audio or video) first, keep to it before comparing qualities
+		let kind = formats.first?.mimeType.split(separator: "/").first
+		let scores = formats.map { format in
+			Self.rank(quality: format.quality) + (format.mimeType.split(separator: "/").first == kind ? 1 << 20 : 0)
+		}
+		let candidates = formats.enumerated()
+			.filter { URL(string: $0.element.url) != nil }
+			.sorted { scores[$0.offset] > scores[$1.offset] }
+		let results = await withTaskGroup(of: (Int, Probe).self) { group -> [Int: Probe] in
+			for (idx, format) in candidates {
+				group.addTask { (idx, await self.probe(format)) }
+			}
+			var results = [Int: Probe]()
+			var pending = Set(candidates.map { $0.offset })
+			for await (idx, probe) in group {
+				pending.remove(idx)
+				results[idx] = probe
+				let best = results.filter { $0.value.reachable }.keys.map { scores[$0] }.max()
+				let remaining = pending.map { scores[$0] }.max()
+				if let best, best >= remaining ?? .min {
+					group.cancelAll()
+					break
+				}
+			}
+			return results
+		}
+		let reachable = results.filter { $0.value.reachable }
+			.sorted {
+				let (lhs, rhs) = (scores[$0.key], scores[$1.key])
+				return lhs != rhs ? lhs > rhs : $0.value.latency < $1.value.latency
+			}
+			.map { formats[$0.key] }
+		guard !reachable.isEmpty else {
+			return []
+		}
+		let unknown = candidates.filter { results[$0.offset] == nil }.map { $0.element }
+		return reachable + unknown
+	}
+
+	func probe(_ format: MusicTrackDetails.Format) async -> Probe {
+		let now = Date()
+		lock.lock()
+		let cached = probes[format.url]
+		lock.unlock()
+		if let cached, cached.expires > now {
+			return cached
+		}
+		let expires = format.hasExp ? Date(timeIntervalSince1970: TimeInterval(format.exp)) : now.addingTimeInterval(defaultTTL)
+		guard expires > now, let url = URL(string: format.url) else {
+			return Probe(reachable: false, latency: .infinity, expires: now)
+		}
+		var req = URLRequest(url: url, timeoutInterval: timeout)
+		req.httpMethod = "HEAD"
+		let start = ProcessInfo.processInfo.systemUptime
+		let status: Int
+		do {
+			let resp = try await session.data(for: req)
+			status = (resp.1 as? HTTPURLResponse)?.statusCode ?? -1
+		} catch is CancellationError {
+			return Probe(reachable: false, latency: .infinity, expires: now)
+		} catch {
+			if Task.isCancelled {
+				return Probe(reachable: false, latency: .infinity, expires: now)
+			}
+			status = -1
+		}
+		let reachable = (200..<300).contains(status)
+		let probe = Probe(reachable: reachable,
+						  latency: ProcessInfo.processInfo.systemUptime - start,
+						  expires: reachable ? expires : min(expires, now.addingTimeInterval(failureTTL)))
+		if !reachable {
+			WALogger.host.debug("[\(format.id)] HEAD \(status)")
+		}
+		lock.lock()
+		probes[format.url] = probe
+		probes = probes.filter { $0.value.expires > now }
+		lock.unlock()
+		return probe
+	}
+}
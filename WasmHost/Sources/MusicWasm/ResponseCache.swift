@@ -0,0 +1,225 @@
+//
+//  ResponseCache.swift
+//  WasmHost
+//
+//  Created by L7Studio on 19/10/26.
+//
+import Foundation
+import SwiftProtobuf
+import WasmSwiftProtobuf
+
+/// In-memory cache of raw guest responses, keyed by call and arguments.
+///
+/// Entries are spread over independently locked shards. A fresh entry is returned as is, a stale one
+/// (older than `ttl` but within `staleWhileRevalidate`) is returned while a single background call
+/// refreshes it. Identical calls running at the same time share one guest call. Each shard evicts the
+/// least recently used entries once it holds more than its part of `byteBudget`.
+public final class MusicResponseCache: @unchecked Sendable {
+	public struct Configuration {
+		/// How long a response is returned without calling the guest
+		public var ttl: TimeInterval = 60
+		/// How long past `ttl` a response is still returned while it is refreshed
+		public var staleWhileRevalidate: TimeInterval = 5 * 60
+		/// Upper bound of the cached response bytes
+		public var byteBudget: Int = 8 << 20
+		/// Number of shards, rounded up to a power of two
+		public var shardCount: Int = 16
+
+		public init() {}
+	}
+
+	/// Monotonic time in seconds
+	public typealias Clock = @Sendable () -> TimeInterval
+
+	public struct Key: Hashable {
+		let id: String
+		let args: String
+		let premium: Bool
+		let options: Int
+
+		/// - Parameters:
+		///   - id: action id
+		///   - args: action arguments, the `keyword` is matched case and whitespace insensitively
+		///   - premium: premium flag of the engine
+		///   - copts: call options of the engine
+		public init(id: String, args: [String: Google_Protobuf_Value], premium: Bool, copts: [String: Data]) {
+			self.id = id
+			self.args = args.keys.sorted().map { name in
+				let value = args[name]!
+				guard case let .stringValue(str) = value.kind else {
+					return "\(name)=\(value.textFormatString())"
+				}
+				return "\(name)=\(name == "keyword" ? Self.normalized(keyword: str) : str)"
+			}.joined(separator: "\u{1F}")
+			self.premium = premium
+			var hasher = Hasher()
+			for name in copts.keys.sorted() {
+				hasher.combine(name)
+				hasher.combine(copts[name]!)
+			}
+			self.options = hasher.finalize()
+		}
+
+		static func normalized(keyword: String) -> String {
+			keyword.lowercased()
+				.split(whereSeparator: { $0.isWhitespace })
+				.joined(separator: " ")
+		}
+	}
+
+	private struct Entry {
+		let data: Data
+		let storedAt: TimeInterval
+		let cost: Int
+		var lastAccess: UInt64
+	}
+
+	private final class Shard {
+		let lock = NSLock()
+		var entries: [Key: Entry] = [:]
+		var inflight: [Key: Task<Data, Error>] = [:]
+		var bytes = 0
+		var clock: UInt64 = 0
+		// bumped by removeAll, calls started before it don't store their response
+		var generation = 0
+
+		func locked<T>(_ body: () throws -> T) rethrows -> T {
+			lock.lock()
+			defer { lock.unlock() }
+			return try body()
+		}
+	}
+
+	public let configuration: Configuration
+	private let shards: [Shard]
+	private let shardBudget: Int
+	private let now: Clock
+
+	/// - Parameters:
+	///   - configuration: ttl and size of the cache
+	///   - now: clock the entry ages are measured with, the system uptime by default
+	public init(configuration: Configuration = Configuration(),
+				now: @escaping Clock = { ProcessInfo.processInfo.systemUptime }) {
+		var count = 1
+		while count < max(configuration.shardCount, 1) {
+			count <<= 1
+		}
+		self.configuration = configuration
+		self.shards = (0..<count).map { _ in Shard() }
+		self.shardBudget = max(configuration.byteBudget / count, 0)
+		self.now = now
+	}
+
+	/// Bytes held by all shards
+	public var totalBytes: Int {
+		shards.reduce(0) { total, shard in total + shard.locked { shard.bytes } }
+	}
+
+	/// Guest call running for `key`, if any
+	func inflight(for key: Key) -> Task<Data, Error>? {
+		let shard = self.shard(for: key)
+		return shard.locked { shard.inflight[key] }
+	}
+
+	/// Drops every response, including the ones of calls still running.
+	public func removeAll() {
+		for shard in shards {
+			shard.locked {
+				shard.entries.removeAll()
+				shard.inflight.removeAll()
+				shard.bytes = 0
+				shard.generation += 1
+			}
+		}
+	}
+
+	/// Returns the cached response for `key`, calling `fetch` when there is none.
+	/// - Parameters:
+	///   - key: call key
+	///   - fetch: performs the guest call, only successful non empty responses are cached
+	/// - Returns: response bytes
+	public func data(for key: Key, fetch: @escaping @Sendable () async throws -> Data) async throws -> Data {
+		let shard = self.shard(for: key)
+		let now = self.now()
+		let (cached, task): (Data?, Task<Data, Error>?) = shard.locked {
+			if var entry = shard.entries[key] {
+				let age = now - entry.storedAt
+				if age < configuration.ttl + configuration.staleWhileRevalidate {
+					shard.clock += 1
+					entry.lastAccess = shard.clock
+					shard.entries[key] = entry
+					if age >= configuration.ttl, shard.inflight[key] == nil {
+						WALogger.host.debug("[cache] revalidating \(key.id)")
+						shard.inflight[key] = start(key, in: shard, fetch: fetch)
+					}
+					return (entry.data, nil)
+				}
+				shard.entries[key] = nil
+				shard.bytes -= entry.cost
+			}
+			if let task = shard.inflight[key] {
+				return (nil, task)
+			}
+			let task = start(key, in: shard, fetch: fetch)
+			shard.inflight[key] = task
+			return (nil, task)
+		}
+		if let cached {
+			return cached
+		}
+		return try await task!.value
+	}
+
+	// must be called with the shard lock held
+	private func start(_ key: Key, in shard: Shard, fetch: @escaping @Sendable () async throws -> Data) -> Task<Data, Error> {
+		let generation = shard.generation
+		return Task {
+			do {
+				let data = try await fetch()
+				store(data, for: key, in: shard, generation: generation)
+				return data
+			} catch {
+				shard.locked {
+					if generation == shard.generation {
+						shard.inflight[key] = nil
+					}
+				}
+				throw error
+			}
+		}
+	}
+
+	private func store(_ data: Data, for key: Key, in shard: Shard, generation: Int) {
+		let now = self.now()
+		let cost = data.count + key.args.utf8.count
+		shard.locked {
+			guard generation == shard.generation else {
+				return
+			}
+			shard.inflight[key] = nil
+			guard !data.isEmpty, cost <= shardBudget else {
+				return
+			}
+			if let old = shard.entries.removeValue(forKey: key) {
+				shard.bytes -= old.cost
+			}
+			let lifetime = configuration.ttl + configuration.staleWhileRevalidate
+			for (key, entry) in shard.entries where now - entry.storedAt >= lifetime {
+				shard.entries[key] = nil
+				shard.bytes -= entry.cost
+			}
+			while shard.bytes + cost > shardBudget,
+				  let oldest = shard.entries.min(by: { $0.value.lastAccess < $1.value.lastAccess }) {
+				shard.entries[oldest.key] = nil
+				shard.bytes -= oldest.value.cost
+			}
+			shard.clock += 1
+			shard.entries[key] = Entry(data: data, storedAt: now, cost: cost, lastAccess: shard.clock)
+			shard.bytes += cost
+		}
+	}
+
+	private func shard(for key: Key) -> Shard {
+		shards[key.hashValue & (shards.count - 1)]
+	}
+}
@@ -0,0 +1,161 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#import "GPBArena_PackagePrivate.h"
+
+#import <Foundation/Foundation.h>
+#import <os/lock.h>
+
+// Blocks start small so tiny messages don't pay for a large block, and double
+// up to this size.
+static const size_t kMinBlockSize = 4 * 1024;
+static const size_t kMaxBlockSize = 1024 * 1024;
+static const size_t kAlignment = 16;
+
+typedef struct GPBArenaBlock {
+  struct GPBArenaBlock *next;
+  size_t size;
+  size_t used;
+  uint8_t data[] __attribute__((aligned(16)));
+} GPBArenaBlock;
+
+struct GPBArena {
+  os_unfair_lock lock;
+  // The block being filled, followed by the full ones.
+  GPBArenaBlock *head;
+  size_t nextBlockSize;
+  // The allocator owns the arena, references to the arena are references to
+  // the allocator so CF objects and messages share a single count.
+  CFAllocatorRef allocator;
+};
+
+static void RaiseAllocationFailure(size_t size) {
+  [NSException raise:NSMallocException format:@"Failed to allocate %lu bytes", (unsigned long)size];
+}
+
+static GPBArenaBlock *NewBlock(size_t size) {
+  GPBArenaBlock *block = calloc(1, sizeof(GPBArenaBlock) + size);
+  if (block) {
+    block->size = size;
+  }
+  return block;
+}
+
+static void ArenaFree(const void *info) {
+  GPBArena *arena = (GPBArena *)info;
+  GPBArenaBlock *block = arena->head;
+  while (block) {
+    GPBArenaBlock *next = block->next;
+    free(block);
+    block = next;
+  }
+  free(arena);
+}
+
+#pragma mark - CFAllocator
+
+// CF needs the size of an allocation to reallocate it, it is stored in front of
+// the returned pointer (kAlignment bytes to keep the result aligned).
+
+static void *AllocatorAllocate(CFIndex size, __unused CFOptionFlags hint, void *info) {
+  uint8_t *result = GPBArenaAllocate((GPBArena *)info, kAlignment + (size_t)size);
+  *(size_t *)result = (size_t)size;
+  return result + kAlignment;
+}
+
+static void *AllocatorReallocate(void *ptr, CFIndex newSize, CFOptionFlags hint, void *info) {
+  size_t oldSize = *(size_t *)((uint8_t *)ptr - kAlignment);
+  if ((size_t)newSize <= oldSize) {
+    return ptr;
+  }
+  void *result = AllocatorAllocate(newSize, hint, info);
+  memcpy(result, ptr, oldSize);
+  return result;
+}
+
+static void AllocatorDeallocate(__unused void *ptr, __unused void *info) {
+  // Freed with the arena.
+}
+
+#pragma mark - Arena
+
+GPBArena *GPBArenaCreate(size_t sizeHint) {
+  GPBArena *arena = calloc(1, sizeof(GPBArena));
+  if (!arena) {
+    RaiseAllocationFailure(sizeof(GPBArena));
+  }
+  arena->lock = OS_UNFAIR_LOCK_INIT;
+  size_t size = kMinBlockSize;
+  while (size < sizeHint && size < kMaxBlockSize) {
+    size *= 2;
+  }
+  arena->nextBlockSize = size;
+
+  CFAllocatorContext context = {
+      .version = 0,
+      .info = arena,
+      .retain = NULL,
+      .release = ArenaFree,
+      .copyDescription = NULL,
+      .allocate = AllocatorAllocate,
+      .reallocate = AllocatorReallocate,
+      .deallocate = AllocatorDeallocate,
+      .preferredSize = NULL,
+  };
+  arena->allocator = CFAllocatorCreate(kCFAllocatorDefault, &context);
+  if (!arena->allocator) {
+    free(arena);
+    [NSException raise:NSMallocException format:@"Failed to create the arena allocator"];
+  }
+  return arena;
+}
+
+void GPBArenaRetain(GPBArena *arena) { CFRetain(arena->allocator); }
+
+void GPBArenaRelease(GPBArena *arena) { CFRelease(arena->allocator); }
+
+CFAllocatorRef GPBArenaGetAllocator(GPBArena *arena) { return arena->allocator; }
+
+void *GPBArenaAllocate(GPBArena *arena, size_t size) {
+  size = (size + kAlignment - 1) & ~(kAlignment - 1);
+  os_unfair_lock_lock(&arena->lock);
+  GPBArenaBlock *block = arena->head;
+  if (!block || block->size - block->used < size) {
+    if (size > arena->nextBlockSize / 4) {
+      // Large allocations get a block of their own, kept behind the head so
+      // the space left in the head is still used.
+      GPBArenaBlock *large = NewBlock(size);
+      if (!large) {
+        os_unfair_lock_unlock(&arena->lock);
+        RaiseAllocationFailure(size);
+      }
+      if (block) {
+        large->next = block->next;
+        block->next = large;
+      } else {
+        arena->head = large;
+      }
+      large->used = size;
+      os_unfair_lock_unlock(&arena->lock);
+      return large->data;
+    }
+    block = NewBlock(arena->nextBlockSize);
+    if (!block) {
+      os_unfair_lock_unlock(&arena->lock);
+      RaiseAllocationFailure(arena->nextBlockSize);
+    }
+    block->next = arena->head;
+    arena->head = block;
+    if (arena->nextBlockSize < kMaxBlockSize) {
+      arena->nextBlockSize *= 2;
+    }
+  }
+  void *result = block->data + block->used;
+  block->used += size;
+  os_unfair_lock_unlock(&arena->lock);
+  return result;
+}
@@ -0,0 +1,41 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+// This header is private to the ProtobolBuffers library and must NOT be
+// included by any sources outside this library. The contents of this file are
+// subject to change at any time without notice.
+
+#import <CoreFoundation/CoreFoundation.h>
+
+CF_EXTERN_C_BEGIN
+
+// A bump allocator a parsed message tree is allocated from.
+//
+// Memory handed out by an arena is never freed on its own, all of it is freed
+// at once when the last reference to the arena goes away. Everything allocated
+// from the arena (messages and the CF objects created with its allocator) holds
+// a reference, so anything escaping the tree stays valid.
+//
+// Allocation is thread safe, objects of a parsed tree can be mutated (and grow)
+// from any thread.
+typedef struct GPBArena GPBArena;
+
+// Creates an arena with one reference. |sizeHint| is the expected total size
+// of the allocations, it is only used to size the first block.
+GPBArena *GPBArenaCreate(size_t sizeHint);
+
+void GPBArenaRetain(GPBArena *arena);
+void GPBArenaRelease(GPBArena *arena);
+
+// Returns zero filled, 16 byte aligned memory.
+void *GPBArenaAllocate(GPBArena *arena, size_t size);
+
+// An allocator allocating from |arena|, CF objects created with it keep the
+// arena alive. Deallocating is a no-op.
+CFAllocatorRef GPBArenaGetAllocator(GPBArena *arena);
+
+CF_EXTERN_C_END
@@ -8,6 +8,9 @@
 #import "GPBArray.h"
 #import "GPBArray_PackagePrivate.h"
 
+#import <stdatomic.h>
+
+#import "GPBCodedInputStream_PackagePrivate.h"
 #import "GPBMessage.h"
 #import "GPBMessage_PackagePrivate.h"
 
@@ -2539,4 +2542,184 @@ static BOOL ArrayDefault_IsValidValue(int32_t value) {
 
 @end
 
+static id NewMessageInRange(Class messageClass, NSData *data, GPBCodedInputStreamOptions options,
+                            id<GPBExtensionRegistry> extensionRegistry, NSRange range)
+    __attribute__((ns_returns_retained));
+
+// Parses the message encoded at range of data, malformed messages parse as empty ones.
+static id NewMessageInRange(Class messageClass, NSData *data, GPBCodedInputStreamOptions options,
+                            id<GPBExtensionRegistry> extensionRegistry, NSRange range) {
+  GPBMessage *message = [[messageClass alloc] init];
+  GPBCodedInputStream *input = [[GPBCodedInputStream alloc] initWithData:data options:options];
+  input->state_.bufferPos = range.location;
+  input->state_.currentLimit = NSMaxRange(range);
+  @try {
+    [message mergeFromCodedInputStream:input extensionRegistry:extensionRegistry endingTag:0];
+    [input checkLastTagWas:0];
+  } @catch (NSException *exception) {
+#ifdef DEBUG
+    NSLog(@"Failed to parse lazy %@: %@", messageClass, exception);
+#endif
+    [message release];
+    message = [[messageClass alloc] init];
+  }
+  [input release];
+  return message;
+}
+
+@implementation GPBLazyMessageArray {
+  Class _messageClass;
+  NSData *_data;
+  GPBCodedInputStreamOptions _options;
+  id<GPBExtensionRegistry> _extensionRegistry;
+  NSUInteger _count;
+  NSUInteger _capacity;
+  NSRange *_ranges;
+  // Parsed messages, nil until read.
+  _Atomic(id) *_messages;
+  // Once mutated, all the messages are parsed and moved here.
+  NSMutableArray *_array;
+}
+
+- (instancetype)initWithMessageClass:(Class)messageClass
+                               input:(GPBCodedInputStream *)input
+                   extensionRegistry:(id<GPBExtensionRegistry>)extensionRegistry {
+  if ((self = [super init])) {
+    _messageClass = messageClass;
+    GPBCodedInputStreamFreezeInput(input);
+    _data = [input->state_.data retain];
+    // Elements are parsed one at a time long after the parse, an arena each
+    // would cost more than it saves.
+    _options = input->state_.options & ~GPBCodedInputStreamOptionArena;
+    _extensionRegistry = [extensionRegistry retain];
+  }
+  return self;
+}
+
+- (void)dealloc {
+  for (NSUInteger i = 0; i < _count; ++i) {
+    [atomic_load(&_messages[i]) release];
+  }
+  free(_ranges);
+  free(_messages);
+  [_data release];
+  [_extensionRegistry release];
+  [_array release];
+  [super dealloc];
+}
+
+- (void)addMessageInRange:(NSRange)range input:(GPBCodedInputStream *)input {
+  if (_array || input->state_.data != _data) {
+    // Mutated already or merging another input, no point in being lazy.
+    id message = NewMessageInRange(_messageClass, input->state_.data, input->state_.options,
+                                   _extensionRegistry, range);
+    [[self materializedArray] addObject:message];
+    [message release];
+    return;
+  }
+  if (_count == _capacity) {
+    NSUInteger newCapacity = CapacityFromCount(_count);
+    NSRange *ranges = reallocf(_ranges, newCapacity * sizeof(NSRange));
+    _Atomic(id) *messages = reallocf(_messages, newCapacity * sizeof(id));
+    if (!ranges || !messages) {
+      free(ranges);
+      free(messages);
+      _ranges = NULL;
+      _messages = NULL;
+      _count = _capacity = 0;
+      [NSException raise:NSMallocException
+                  format:@"Failed to allocate %lu bytes",
+                         (unsigned long)(newCapacity * (sizeof(NSRange) + sizeof(id)))];
+    }
+    _ranges = ranges;
+    _messages = messages;
+    _capacity = newCapacity;
+  }
+  _ranges[_count] = range;
+  atomic_init(&_messages[_count], nil);
+  ++_count;
+}
+
+// Reads can happen from several threads, the first one to parse a message wins.
+- (id)messageAtIndex:(NSUInteger)idx {
+  id message = atomic_load(&_messages[idx]);
+  if (message) {
+    return message;
+  }
+
+  message = NewMessageInRange(_messageClass, _data, _options, _extensionRegistry, _ranges[idx]);
+  id expected = nil;
+  if (atomic_compare_exchange_strong(&_messages[idx], &expected, message)) {
+    return message;
+  }
+  [message release];
+  return expected;
+}
+
+// Parses everything and switches to a regular array, mutations go there.
+- (NSMutableArray *)materializedArray {
+  if (_array == nil) {
+    NSMutableArray *array = [[NSMutableArray alloc] initWithCapacity:_count];
+    for (NSUInteger i = 0; i < _count; ++i) {
+      [array addObject:[self messageAtIndex:i]];
+    }
+    for (NSUInteger i = 0; i < _count; ++i) {
+      [atomic_load(&_messages[i]) release];
+    }
+    free(_ranges);
+    free(_messages);
+    _ranges = NULL;
+    _messages = NULL;
+    _count = _capacity = 0;
+    _array = array;
+  }
+  return _array;
+}
+
+- (BOOL)isMessageParsedAtIndex:(NSUInteger)idx {
+  return _array != nil || atomic_load(&_messages[idx]) != nil;
+}
+
+#pragma mark Required NSArray overrides
+
+- (NSUInteger)count {
+  return _array ? [_array count] : _count;
+}
+
+- (id)objectAtIndex:(NSUInteger)idx {
+  if (_array) {
+    return [_array objectAtIndex:idx];
+  }
+  if (idx >= _count) {
+    [NSException raise:NSRangeException
+                format:@"Index (%lu) beyond bounds (%lu)", (unsigned long)idx,
+                       (unsigned long)_count];
+  }
+  return [self messageAtIndex:idx];
+}
+
+#pragma mark Required NSMutableArray overrides
+
+- (void)insertObject:(id)anObject atIndex:(NSUInteger)idx {
+  [[self materializedArray] insertObject:anObject atIndex:idx];
+}
+
+- (void)removeObjectAtIndex:(NSUInteger)idx {
+  [[self materializedArray] removeObjectAtIndex:idx];
+}
+
+- (void)addObject:(id)anObject {
+  [[self materializedArray] addObject:anObject];
+}
+
+- (void)removeLastObject {
+  [[self materializedArray] removeLastObject];
+}
+
+- (void)replaceObjectAtIndex:(NSUInteger)idx withObject:(id)anObject {
+  [[self materializedArray] replaceObjectAtIndex:idx withObject:anObject];
+}
+
+@end
+
 #pragma clang diagnostic pop
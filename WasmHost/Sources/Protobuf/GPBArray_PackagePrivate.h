@@ -105,3 +105,18 @@
   GPB_UNSAFE_UNRETAINED GPBMessage *_autocreator;
 }
 @end
+
+// Array of a lazy repeated message field (see GPBFieldDescriptor.lazy). It
+// holds the input the message was parsed from and the ranges of its messages,
+// each message is parsed the first time it is read. Mutating the array parses
+// all the remaining messages.
+@interface GPBLazyMessageArray : NSMutableArray
+- (instancetype)initWithMessageClass:(Class)messageClass
+                               input:(GPBCodedInputStream *)input
+                   extensionRegistry:(id<GPBExtensionRegistry>)extensionRegistry;
+// Adds the message encoded at range of the input.
+- (void)addMessageInRange:(NSRange)range input:(GPBCodedInputStream *)input;
+// Whether the message at idx was parsed already, messages not read yet can't
+// be inspected without parsing them.
+- (BOOL)isMessageParsedAtIndex:(NSUInteger)idx;
+@end
@@ -48,6 +48,43 @@ typedef NS_ENUM(NSInteger, GPBCodedInputStreamErrorCode) {
   GPBCodedInputStreamErrorRecursionDepthExceeded = -106,
 };
 
+/**
+ * Options controlling how a @c GPBCodedInputStream materializes the values it
+ * reads.
+ **/
+typedef NS_OPTIONS(uint32_t, GPBCodedInputStreamOptions) {
+  /** Values are fully decoded and validated as they are read. */
+  GPBCodedInputStreamOptionNone = 0,
+  /**
+   * String values keep a reference to their bytes in the input data and only
+   * build and validate their @c NSString on first use. Meant for large
+   * responses where most strings are never read.
+   *
+   * @note Invalid UTF-8 is not reported as a parse error, such strings read
+   *       as empty strings. The input data stays alive as long as any string
+   *       created from it.
+   **/
+  GPBCodedInputStreamOptionLazyStrings = 1 << 0,
+  /**
+   * Messages, strings, bytes and arrays of messages/strings/bytes parsed from
+   * the stream are allocated from a single arena instead of one heap block
+   * each. The arena is freed at once when the parsed message tree (and
+   * anything retained from it) is released.
+   *
+   * @note Memory in the arena is only reclaimed with the whole arena, objects
+   *       removed from the tree or arrays grown after the parse keep their
+   *       memory until then. Meant for read mostly responses.
+   **/
+  GPBCodedInputStreamOptionArena = 1 << 1,
+  /**
+   * Bytes values are returned as ranges of the input data instead of copies.
+   * Each of them keeps the input data alive, so multi-MB payloads cost no
+   * extra copy but a small value still referenced pins the whole input.
+   * Values shorter than a few hundred bytes are still copied.
+   **/
+  GPBCodedInputStreamOptionZeroCopyBytes = 1 << 2,
+};
+
 CF_EXTERN_C_END
 
 /**
@@ -81,6 +118,29 @@ __attribute__((objc_subclassing_restricted))
  **/
 - (instancetype)initWithData:(NSData *)data;
 
+/**
+ * Creates a new stream wrapping some data.
+ *
+ * @param data    The data to wrap inside the stream.
+ * @param options How values read from the stream are materialized.
+ *
+ * @return A newly instanced GPBCodedInputStream.
+ **/
++ (instancetype)streamWithData:(NSData *)data options:(GPBCodedInputStreamOptions)options;
+
+/**
+ * Initializes a stream wrapping some data.
+ *
+ * @param data    The data to wrap inside the stream.
+ * @param options How values read from the stream are materialized.
+ *
+ * @return A newly initialized GPBCodedInputStream.
+ **/
+- (instancetype)initWithData:(NSData *)data options:(GPBCodedInputStreamOptions)options;
+
+/** The options the stream was created with. */
+@property(nonatomic, readonly) GPBCodedInputStreamOptions options;
+
 /**
  * Attempts to read a field tag, returning zero if we have reached EOF.
  * Protocol message parsers use this to read tags, since a protocol message
@@ -8,6 +8,8 @@
 #import "GPBCodedInputStream.h"
 #import "GPBCodedInputStream_PackagePrivate.h"
 
+#import <stdatomic.h>
+
 #import "GPBDictionary.h"
 #import "GPBDictionary_PackagePrivate.h"
 #import "GPBMessage.h"
@@ -109,7 +111,11 @@ static int64_t ReadRawLittleEndian64(GPBCodedInputStreamState *state) {
   return value;
 }
 
-static int64_t ReadRawVarint64(GPBCodedInputStreamState *state) {
+// Longest encoding of a varint.
+static const size_t kMaxVarintBytes = 10;
+
+GPB_NOINLINE
+static int64_t ReadRawVarint64Slow(GPBCodedInputStreamState *state) {
   int32_t shift = 0;
   int64_t result = 0;
   while (shift < 64) {
@@ -124,6 +130,64 @@ static int64_t ReadRawVarint64(GPBCodedInputStreamState *state) {
   return 0;
 }
 
+// Decodes a varint that is known to have kMaxVarintBytes readable, the terminating
+// byte is found with a bit scan over the first eight bytes and the 7 bit groups
+// are packed together with shifts and masks instead of a loop over the bytes.
+GPB_INLINE int64_t ReadRawVarint64Fast(GPBCodedInputStreamState *state) {
+  const uint8_t *ptr = state->bytes + state->bufferPos;
+  uint64_t word;
+  memcpy(&word, ptr, sizeof(word));
+  word = OSSwapLittleToHostInt64(word);
+  // Bit 7 of each byte that ends the varint.
+  uint64_t stops = ~word & 0x8080808080808080ULL;
+  uint64_t value;
+  size_t length;
+  if (stops != 0) {
+    // Keep the bytes up to and including the first stop.
+    word &= stops ^ (stops - 1);
+    length = (__builtin_ctzll(stops) >> 3) + 1;
+  } else {
+    length = sizeof(word);
+  }
+  value = word & 0x7F7F7F7F7F7F7F7FULL;
+  value = (value & 0x007F007F007F007FULL) | ((value & 0x7F007F007F007F00ULL) >> 1);
+  value = (value & 0x00003FFF00003FFFULL) | ((value & 0x3FFF00003FFF0000ULL) >> 2);
+  value = (value & 0x000000000FFFFFFFULL) | ((value & 0x0FFFFFFF00000000ULL) >> 4);
+  if (stops == 0) {
+    uint8_t b = ptr[8];
+    value |= (uint64_t)(b & 0x7F) << 56;
+    length = 9;
+    if (b & 0x80) {
+      b = ptr[9];
+      value |= (uint64_t)(b & 0x7F) << 63;
+      length = 10;
+      if (b & 0x80) {
+        state->bufferPos += length;
+        GPBRaiseStreamError(GPBCodedInputStreamErrorInvalidVarInt, @"Invalid VarInt64");
+      }
+    }
+  }
+  state->bufferPos += length;
+  return (int64_t)value;
+}
+
+static int64_t ReadRawVarint64(GPBCodedInputStreamState *state) {
+  size_t pos = state->bufferPos;
+  if (pos < state->bufferSize && pos < state->currentLimit) {
+    // Tags and small values are a single byte.
+    uint8_t b = state->bytes[pos];
+    if (b < 0x80) {
+      state->bufferPos = pos + 1;
+      return b;
+    }
+    size_t end = MIN(state->bufferSize, state->currentLimit);
+    if (end - pos >= kMaxVarintBytes) {
+      return ReadRawVarint64Fast(state);
+    }
+  }
+  return ReadRawVarint64Slow(state);
+}
+
 static int32_t ReadRawVarint32(GPBCodedInputStreamState *state) {
   return (int32_t)ReadRawVarint64(state);
 }
@@ -221,6 +285,106 @@ int32_t GPBCodedInputStreamReadTag(GPBCodedInputStreamState *state) {
   return state->lastTag;
 }
 
+// Shorter strings are cheap to build (and often tagged pointers), they are always
+// created eagerly.
+static const size_t kLazyStringMinLength = 16;
+// Below this, copying the bytes is cheaper than the NSData and deallocator
+// block referencing the input.
+static const size_t kZeroCopyBytesMinLength = 256;
+
+// NSString backed by a slice of the input data, the real string is built from
+// the UTF-8 bytes the first time any of its characters are needed.
+@interface GPBLazyString : NSString {
+ @private
+  NSData *data_;
+  const uint8_t *bytes_;
+  NSUInteger byteLength_;
+  NSString *string_;
+}
+- (instancetype)initWithData:(NSData *)data
+                       bytes:(const uint8_t *)bytes
+                      length:(NSUInteger)length;
+@end
+
+@implementation GPBLazyString
+
+- (instancetype)initWithData:(NSData *)data
+                       bytes:(const uint8_t *)bytes
+                      length:(NSUInteger)length {
+  if ((self = [super init])) {
+    data_ = [data retain];
+    bytes_ = bytes;
+    byteLength_ = length;
+  }
+  return self;
+}
+
+- (void)dealloc {
+  [string_ release];
+  [data_ release];
+  [super dealloc];
+}
+
+// Messages can be read from several threads, the first one to build the
+// string wins.
+- (NSString *)materializedString {
+  _Atomic(NSString *) *stringPtr = (_Atomic(NSString *) *)&string_;
+  NSString *string = atomic_load(stringPtr);
+  if (string) {
+    return string;
+  }
+
+  string = [[NSString alloc] initWithBytes:bytes_ length:byteLength_ encoding:NSUTF8StringEncoding];
+  if (!string) {
+#ifdef DEBUG
+    NSLog(@"UTF-8 failure, is some field type 'string' when it should be "
+          @"'bytes'?");
+#endif
+    string = @"";
+  }
+  NSString *expected = nil;
+  if (atomic_compare_exchange_strong(stringPtr, &expected, string)) {
+    return string;
+  }
+  [string release];
+  return expected;
+}
+
+- (NSUInteger)length {
+  return [[self materializedString] length];
+}
+
+- (unichar)characterAtIndex:(NSUInteger)index {
+  return [[self materializedString] characterAtIndex:index];
+}
+
+- (void)getCharacters:(unichar *)buffer range:(NSRange)range {
+  [[self materializedString] getCharacters:buffer range:range];
+}
+
+- (const char *)UTF8String {
+  return [[self materializedString] UTF8String];
+}
+
+- (NSUInteger)hash {
+  return [[self materializedString] hash];
+}
+
+- (BOOL)isEqual:(id)other {
+  return [[self materializedString] isEqual:other];
+}
+
+- (BOOL)isEqualToString:(NSString *)other {
+  return [[self materializedString] isEqualToString:other];
+}
+
+- (id)copyWithZone:(__unused NSZone *)zone {
+  // Copies are plain strings, they don't keep the input data alive.
+  return [[self materializedString] retain];
+}
+
+@end
+
 NSString *GPBCodedInputStreamReadRetainedString(GPBCodedInputStreamState *state) {
   uint64_t size = GPBCodedInputStreamReadUInt64(state);
   CheckFieldSize(size);
@@ -231,9 +395,23 @@ NSString *GPBCodedInputStreamReadRetainedString(GPBCodedInputStreamState *state)
   } else {
     size_t size2 = (size_t)size;  // Cast safe on 32bit because of CheckFieldSize() above.
     CheckSize(state, size2);
-    result = [[NSString alloc] initWithBytes:&state->bytes[state->bufferPos]
-                                      length:ns_size
-                                    encoding:NSUTF8StringEncoding];
+    if ((state->options & GPBCodedInputStreamOptionLazyStrings) != 0 &&
+        size2 >= kLazyStringMinLength) {
+      result = [[GPBLazyString alloc] initWithData:state->data
+                                             bytes:&state->bytes[state->bufferPos]
+                                            length:ns_size];
+      state->bufferPos += size;
+      return result;
+    }
+    if (state->arena) {
+      result = (NSString *)CFStringCreateWithBytes(GPBArenaGetAllocator(state->arena),
+                                                   &state->bytes[state->bufferPos],
+                                                   (CFIndex)size2, kCFStringEncodingUTF8, false);
+    } else {
+      result = [[NSString alloc] initWithBytes:&state->bytes[state->bufferPos]
+                                        length:ns_size
+                                      encoding:NSUTF8StringEncoding];
+    }
     state->bufferPos += size;
     if (!result) {
 #ifdef DEBUG
@@ -247,13 +425,42 @@ NSString *GPBCodedInputStreamReadRetainedString(GPBCodedInputStreamState *state)
   return result;
 }
 
+static NSData *NewDataReferencingInput(GPBCodedInputStreamState *state, size_t size)
+    __attribute__((ns_returns_retained));
+
+// Returns the next |size| bytes of the input without copying them, the result
+// keeps the input alive.
+static NSData *NewDataReferencingInput(GPBCodedInputStreamState *state, size_t size) {
+  // Something parsed from the input may outlive the stream (lazy strings/messages, zero copy
+  // bytes), the result must keep the input alive as long as it lives.
+  NSData *owner = [state->data retain];
+  NSData *result = [[NSData alloc] initWithBytesNoCopy:(void *)(state->bytes + state->bufferPos)
+                                                length:size
+                                           deallocator:^(__unused void *bytes,
+                                                         __unused NSUInteger length) {
+                                             [owner release];
+                                           }];
+  state->bufferPos += size;
+  return result;
+}
+
 NSData *GPBCodedInputStreamReadRetainedBytes(GPBCodedInputStreamState *state) {
   uint64_t size = GPBCodedInputStreamReadUInt64(state);
   CheckFieldSize(size);
   size_t size2 = (size_t)size;  // Cast safe on 32bit because of CheckFieldSize() above.
   CheckSize(state, size2);
+  if ((state->options & GPBCodedInputStreamOptionZeroCopyBytes) != 0 &&
+      size2 >= kZeroCopyBytesMinLength) {
+    return NewDataReferencingInput(state, size2);
+  }
   NSUInteger ns_size = (NSUInteger)size;
-  NSData *result = [[NSData alloc] initWithBytes:state->bytes + state->bufferPos length:ns_size];
+  NSData *result;
+  if (state->arena) {
+    result = (NSData *)CFDataCreate(GPBArenaGetAllocator(state->arena),
+                                    state->bytes + state->bufferPos, (CFIndex)size2);
+  } else {
+    result = [[NSData alloc] initWithBytes:state->bytes + state->bufferPos length:ns_size];
+  }
   state->bufferPos += size;
   return result;
 }
@@ -263,12 +470,18 @@ NSData *GPBCodedInputStreamReadRetainedBytesNoCopy(GPBCodedInputStreamState *sta
   CheckFieldSize(size);
   size_t size2 = (size_t)size;  // Cast safe on 32bit because of CheckFieldSize() above.
   CheckSize(state, size2);
-  NSUInteger ns_size = (NSUInteger)size;
-  // Cast is safe because freeWhenDone is NO.
-  NSData *result = [[NSData alloc] initWithBytesNoCopy:(void *)(state->bytes + state->bufferPos)
-                                                length:ns_size
-                                          freeWhenDone:NO];
-  state->bufferPos += size;
+  return NewDataReferencingInput(state, size2);
+}
+
+NSRange GPBCodedInputStreamReadLengthDelimitedRange(GPBCodedInputStreamState *state) {
+  uint64_t length = GPBCodedInputStreamReadUInt64(state);
+  CheckFieldSize(length);
+  size_t length2 = (size_t)length;  // Cast safe on 32bit because of CheckFieldSize() above.
+  // Same checks as reading a message.
+  size_t oldLimit = GPBCodedInputStreamPushLimit(state, length2);
+  NSRange result = NSMakeRange(state->bufferPos, length2);
+  state->bufferPos += length2;
+  GPBCodedInputStreamPopLimit(state, oldLimit);
   return result;
 }
 
@@ -361,20 +574,64 @@ void GPBCodedInputStreamCheckLastTagWas(GPBCodedInputStreamState *state, int32_t
 }
 
 - (instancetype)initWithData:(NSData *)data {
+  return [self initWithData:data options:GPBCodedInputStreamOptionNone];
+}
+
++ (instancetype)streamWithData:(NSData *)data options:(GPBCodedInputStreamOptions)options {
+  return [[[self alloc] initWithData:data options:options] autorelease];
+}
+
+- (instancetype)initWithData:(NSData *)data options:(GPBCodedInputStreamOptions)options {
   if ((self = [super init])) {
 #ifdef DEBUG
     NSCAssert([self class] == [GPBCodedInputStream class],
               @"Subclassing of GPBCodedInputStream is not allowed.");
 #endif
-    buffer_ = [data retain];
-    state_.bytes = (const uint8_t *)[data bytes];
-    state_.bufferSize = [data length];
+    // Lazy strings and zero copy bytes keep referencing the input after the parse, make sure it
+    // can't change under them. Lazy message fields depend on the descriptor, they freeze the input
+    // when they are met (GPBCodedInputStreamFreezeInput).
+    if ((options & (GPBCodedInputStreamOptionLazyStrings | GPBCodedInputStreamOptionZeroCopyBytes)) !=
+        0) {
+      buffer_ = [data copy];
+    } else {
+      buffer_ = [data retain];
+    }
+    state_.bytes = (const uint8_t *)[buffer_ bytes];
+    state_.bufferSize = [buffer_ length];
     state_.currentLimit = state_.bufferSize;
+    state_.options = options;
+    state_.data = buffer_;
+    if ((options & GPBCodedInputStreamOptionArena) != 0) {
+      // Parsed objects take roughly twice the size of their encoding.
+      state_.arena = GPBArenaCreate(2 * state_.bufferSize);
+    }
   }
   return self;
 }
 
+void GPBCodedInputStreamFreezeInput(GPBCodedInputStream *input) {
+  NSData *frozen = [input->buffer_ copy];
+  if (frozen == input->buffer_) {
+    // Immutable already.
+    [frozen release];
+    return;
+  }
+  // Positions are offsets, only the base moves. The caller may still be reading from the
+  // previous bytes, keep them alive until the parse returns.
+  [input->buffer_ autorelease];
+  input->buffer_ = frozen;
+  input->state_.bytes = (const uint8_t *)[frozen bytes];
+  input->state_.data = frozen;
+}
+
+- (GPBCodedInputStreamOptions)options {
+  return state_.options;
+}
+
 - (void)dealloc {
+  if (state_.arena) {
+    GPBArenaRelease(state_.arena);
+  }
   [buffer_ release];
   [super dealloc];
 }
@@ -524,6 +781,18 @@ void GPBCodedInputStreamCheckLastTagWas(GPBCodedInputStreamState *state, int32_t
   GPBCodedInputStreamPopLimit(&state_, oldLimit);
 }
 
+- (void)readMessage:(GPBMessage *)message fieldMask:(GPBCompiledFieldMask *)fieldMask {
+  CheckRecursionLimit(&state_);
+  uint64_t length = GPBCodedInputStreamReadUInt64(&state_);
+  CheckFieldSize(length);
+  size_t length2 = (size_t)length;  // Cast safe on 32bit because of CheckFieldSize() above.
+  size_t oldLimit = GPBCodedInputStreamPushLimit(&state_, length2);
+  ++state_.recursionDepth;
+  [message mergeFromCodedInputStream:self fieldMask:fieldMask];
+  --state_.recursionDepth;
+  GPBCodedInputStreamPopLimit(&state_, oldLimit);
+}
+
 - (void)readMapEntry:(id)mapDictionary
     extensionRegistry:(id<GPBExtensionRegistry>)extensionRegistry
                 field:(GPBFieldDescriptor *)field
@@ -11,9 +11,11 @@
 
 #import "GPBCodedInputStream.h"
 
+#import "GPBArena_PackagePrivate.h"
 #import "GPBDescriptor.h"
 #import "GPBUnknownFieldSet.h"
 
+@class GPBCompiledFieldMask;
 @class GPBUnknownFieldSet;
 
 typedef struct GPBCodedInputStreamState {
@@ -28,6 +30,12 @@ typedef struct GPBCodedInputStreamState {
   size_t currentLimit;
   int32_t lastTag;
   NSUInteger recursionDepth;
+
+  GPBCodedInputStreamOptions options;
+  // The data `bytes` points into, retained by the owning stream.
+  GPB_UNSAFE_UNRETAINED NSData *data;
+  // Set with GPBCodedInputStreamOptionArena, owned by the stream.
+  GPBArena *arena;
 } GPBCodedInputStreamState;
 
 @interface GPBCodedInputStream () {
@@ -49,6 +57,9 @@ typedef struct GPBCodedInputStreamState {
 - (void)readUnknownGroup:(int32_t)fieldNumber message:(GPBUnknownFieldSet *)message;
 #pragma clang diagnostic pop
 
+// Reads a message, keeping only the fields of `fieldMask`.
+- (void)readMessage:(GPBMessage *)message fieldMask:(GPBCompiledFieldMask *)fieldMask;
+
 // Reads a map entry.
 - (void)readMapEntry:(id)mapDictionary
     extensionRegistry:(id<GPBExtensionRegistry>)extensionRegistry
@@ -81,6 +92,8 @@ NSData *GPBCodedInputStreamReadRetainedBytes(GPBCodedInputStreamState *state)
     __attribute((ns_returns_retained));
 NSData *GPBCodedInputStreamReadRetainedBytesNoCopy(GPBCodedInputStreamState *state)
     __attribute((ns_returns_retained));
+// Skips a length delimited value, returning the range of its bytes in the input.
+NSRange GPBCodedInputStreamReadLengthDelimitedRange(GPBCodedInputStreamState *state);
 NSData *GPBCodedInputStreamReadRetainedBytesToEndGroupNoCopy(GPBCodedInputStreamState *state,
                                                              int32_t fieldNumber)
     __attribute((ns_returns_retained));
@@ -91,4 +104,8 @@ size_t GPBCodedInputStreamBytesUntilLimit(GPBCodedInputStreamState *state);
 BOOL GPBCodedInputStreamIsAtEnd(GPBCodedInputStreamState *state);
 void GPBCodedInputStreamCheckLastTagWas(GPBCodedInputStreamState *state, int32_t value);
 
+// Replaces mutable input with an immutable copy, for values that keep referencing the input after
+// the parse. Only the first call on mutable input copies.
+void GPBCodedInputStreamFreezeInput(GPBCodedInputStream *input);
+
 CF_EXTERN_C_END
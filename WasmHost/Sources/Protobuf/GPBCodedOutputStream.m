@@ -201,6 +201,14 @@ static void GPBWriteRawLittleEndian64(GPBOutputBufferState *state, int64_t value
   return self;
 }
 
+- (instancetype)initWithBytes:(uint8_t *)bytes length:(size_t)length {
+  if ((self = [super init])) {
+    state_.bytes = bytes;
+    state_.size = length;
+  }
+  return self;
+}
+
 + (instancetype)streamWithOutputStream:(NSOutputStream *)output {
   NSMutableData *data = [NSMutableData dataWithLength:PAGE_SIZE];
   return [[[self alloc] initWithOutputStream:output data:data] autorelease];
@@ -88,4 +88,12 @@ size_t GPBComputeEnumSize(int32_t fieldNumber, int32_t value) __attribute__((con
 
 CF_EXTERN_C_END
 
+@interface GPBCodedOutputStream ()
+
+// Writes straight into |bytes|, which must outlive the stream. Writing more
+// than |length| bytes raises GPBCodedOutputStreamException_OutOfSpace.
+- (instancetype)initWithBytes:(uint8_t *)bytes length:(size_t)length;
+
+@end
+
 NS_ASSUME_NONNULL_END
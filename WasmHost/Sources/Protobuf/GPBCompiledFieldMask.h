@@ -0,0 +1,82 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#import <Foundation/Foundation.h>
+
+#import "GPBDescriptor.h"
+
+@class GPBFieldMask;
+
+NS_ASSUME_NONNULL_BEGIN
+
+CF_EXTERN_C_BEGIN
+
+/** NSError domain used for @c GPBCompiledFieldMask errors. */
+extern NSString *const GPBCompiledFieldMaskErrorDomain;
+
+/** Error code for NSError with @c GPBCompiledFieldMaskErrorDomain. */
+typedef NS_ENUM(NSInteger, GPBCompiledFieldMaskErrorCode) {
+  /** A path names a field the message does not have. */
+  GPBCompiledFieldMaskErrorUnknownField = -100,
+  /** A path continues past a field that is not a message or repeated message. */
+  GPBCompiledFieldMaskErrorNotAMessage = -101,
+};
+
+CF_EXTERN_C_END
+
+/**
+ * A field mask resolved against a message descriptor, used to parse only some
+ * of the fields of a message.
+ *
+ * Paths are dot separated field names, in the form used by
+ * @c google.protobuf.FieldMask: "tracks.id" selects the @c id of every element
+ * of the repeated @c tracks field. The proto field names are expected, the
+ * ObjC property names are accepted too. A path ending on a message field
+ * selects the whole message. Unlike @c google.protobuf.FieldMask, a path can go
+ * through repeated message fields; maps and groups can only end a path.
+ *
+ * The mask is immutable, compile it once and reuse it for every parse.
+ **/
+__attribute__((objc_subclassing_restricted))
+@interface GPBCompiledFieldMask : NSObject
+
+/** The descriptor of the messages the mask applies to. */
+@property(nonatomic, readonly, strong) GPBDescriptor *descriptor;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Compiles the given paths.
+ *
+ * @param paths      The paths of the fields to keep.
+ * @param descriptor The descriptor of the message the paths start from.
+ * @param errorPtr   An optional error pointer to fill in with a failure reason
+ *                   if a path can not be resolved.
+ *
+ * @return The compiled mask, or nil if a path can not be resolved.
+ **/
++ (nullable instancetype)fieldMaskWithPaths:(NSArray<NSString *> *)paths
+                                 descriptor:(GPBDescriptor *)descriptor
+                                      error:(NSError **)errorPtr;
+
+/**
+ * Compiles the paths of a @c google.protobuf.FieldMask.
+ *
+ * @param fieldMask  The mask to compile.
+ * @param descriptor The descriptor of the message the paths start from.
+ * @param errorPtr   An optional error pointer to fill in with a failure reason
+ *                   if a path can not be resolved.
+ *
+ * @return The compiled mask, or nil if a path can not be resolved.
+ **/
++ (nullable instancetype)fieldMaskWithFieldMask:(GPBFieldMask *)fieldMask
+                                     descriptor:(GPBDescriptor *)descriptor
+                                          error:(NSError **)errorPtr;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,155 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#import "GPBCompiledFieldMask.h"
+#import "GPBCompiledFieldMask_PackagePrivate.h"
+
+#import "GPBFieldMask.pbobjc.h"
+#import "GPBMessage.h"
+#import "GPBMessage_PackagePrivate.h"
+#import "GPBUtilities_PackagePrivate.h"
+
+NSString *const GPBCompiledFieldMaskErrorDomain =
+    GPBNSStringifySymbol(GPBCompiledFieldMaskErrorDomain);
+
+static NSError *FieldMaskError(GPBCompiledFieldMaskErrorCode code, NSString *reason) {
+  return [NSError errorWithDomain:GPBCompiledFieldMaskErrorDomain
+                             code:code
+                         userInfo:@{GPBErrorReasonKey : reason}];
+}
+
+// Matches the proto name (the text format name) first, the ObjC name second.
+static GPBFieldDescriptor *FieldMaskFieldNamed(GPBDescriptor *descriptor, NSString *name) {
+  for (GPBFieldDescriptor *field in descriptor->fields_) {
+    if ([name isEqualToString:field.textFormatName]) {
+      return field;
+    }
+  }
+  for (GPBFieldDescriptor *field in descriptor->fields_) {
+    if ([name isEqualToString:field.name]) {
+      return field;
+    }
+  }
+  return nil;
+}
+
+// The paths are first merged into a tree of dictionaries keyed by field
+// number, a value is either the subtree of a message field or NSNull when the
+// whole field is kept.
+static BOOL AddFieldMaskPath(NSMutableDictionary *tree, GPBDescriptor *descriptor, NSString *path,
+                             NSError **errorPtr) {
+  NSArray<NSString *> *components = [path componentsSeparatedByString:@"."];
+  NSUInteger count = components.count;
+  for (NSUInteger i = 0; i < count; ++i) {
+    GPBFieldDescriptor *field = FieldMaskFieldNamed(descriptor, components[i]);
+    if (!field) {
+      if (errorPtr) {
+        NSString *reason = [NSString stringWithFormat:@"%@ has no field named %@ (path %@)",
+                                                      descriptor.name, components[i], path];
+        *errorPtr = FieldMaskError(GPBCompiledFieldMaskErrorUnknownField, reason);
+      }
+      return NO;
+    }
+    NSNumber *key = @(GPBFieldNumber(field));
+    id subtree = tree[key];
+    if (subtree == [NSNull null]) {
+      // The whole field is kept already.
+      return YES;
+    }
+    if (i + 1 == count) {
+      tree[key] = [NSNull null];
+      return YES;
+    }
+    if (GPBGetFieldDataType(field) != GPBDataTypeMessage || field.fieldType == GPBFieldTypeMap) {
+      if (errorPtr) {
+        NSString *reason = [NSString stringWithFormat:@"%@.%@ is not a message field (path %@)",
+                                                      descriptor.name, components[i], path];
+        *errorPtr = FieldMaskError(GPBCompiledFieldMaskErrorNotAMessage, reason);
+      }
+      return NO;
+    }
+    if (!subtree) {
+      subtree = [NSMutableDictionary dictionary];
+      tree[key] = subtree;
+    }
+    tree = subtree;
+    descriptor = [field.msgClass descriptor];
+  }
+  return YES;
+}
+
+@implementation GPBCompiledFieldMask
+
+@synthesize descriptor = descriptor_;
+
+- (instancetype)initWithDescriptor:(GPBDescriptor *)descriptor tree:(NSDictionary *)tree {
+  if ((self = [super init])) {
+    descriptor_ = [descriptor retain];
+    NSArray<NSNumber *> *numbers = [tree.allKeys sortedArrayUsingSelector:@selector(compare:)];
+    count_ = (uint32_t)numbers.count;
+    entries_ = count_ ? calloc(count_, sizeof(GPBCompiledFieldMaskEntry)) : NULL;
+    const GPBFieldTagTable *tagTable = GPBDescriptorTagTable(descriptor);
+    for (uint32_t i = 0; i < count_; ++i) {
+      GPBCompiledFieldMaskEntry *entry = &entries_[i];
+      entry->number = numbers[i].unsignedIntValue;
+      entry->tagEntry = *GPBFieldTagTableLookup(tagTable, entry->number);
+      id subtree = tree[numbers[i]];
+      if (subtree != [NSNull null]) {
+        entry->submask = [[GPBCompiledFieldMask alloc]
+            initWithDescriptor:[entry->tagEntry.field.msgClass descriptor]
+                          tree:subtree];
+      }
+    }
+  }
+  return self;
+}
+
+- (void)dealloc {
+  for (uint32_t i = 0; i < count_; ++i) {
+    [entries_[i].submask release];
+  }
+  free(entries_);
+  [descriptor_ release];
+  [super dealloc];
+}
+
++ (instancetype)fieldMaskWithPaths:(NSArray<NSString *> *)paths
+                        descriptor:(GPBDescriptor *)descriptor
+                             error:(NSError **)errorPtr {
+  NSMutableDictionary *tree = [NSMutableDictionary dictionary];
+  for (NSString *path in paths) {
+    if (!AddFieldMaskPath(tree, descriptor, path, errorPtr)) {
+      return nil;
+    }
+  }
+  if (errorPtr) {
+    *errorPtr = nil;
+  }
+  return [[[self alloc] initWithDescriptor:descriptor tree:tree] autorelease];
+}
+
++ (instancetype)fieldMaskWithFieldMask:(GPBFieldMask *)fieldMask
+                            descriptor:(GPBDescriptor *)descriptor
+                                 error:(NSError **)errorPtr {
+  return [self fieldMaskWithPaths:fieldMask.pathsArray descriptor:descriptor error:errorPtr];
+}
+
+- (NSString *)description {
+  NSMutableArray<NSString *> *paths = [NSMutableArray array];
+  for (uint32_t i = 0; i < count_; ++i) {
+    NSString *name = entries_[i].tagEntry.field.name;
+    GPBCompiledFieldMask *submask = entries_[i].submask;
+    if (submask) {
+      [paths addObject:[NSString stringWithFormat:@"%@ %@", name, submask]];
+    } else {
+      [paths addObject:name];
+    }
+  }
+  return [NSString stringWithFormat:@"{%@}", [paths componentsJoinedByString:@", "]];
+}
+
+@end
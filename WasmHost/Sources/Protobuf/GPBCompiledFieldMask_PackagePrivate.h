@@ -0,0 +1,51 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+// This header is private to the ProtobolBuffers library and must NOT be
+// included by any sources outside this library. The contents of this file are
+// subject to change at any time without notice.
+
+#import "GPBCompiledFieldMask.h"
+
+#import "GPBDescriptor_PackagePrivate.h"
+
+// One field kept by a GPBCompiledFieldMask.
+typedef struct GPBCompiledFieldMaskEntry {
+  // Copied from the tag table of the descriptor.
+  GPBFieldTagEntry tagEntry;
+  uint32_t number;
+  // The fields to keep in the messages of the field, nil to keep them whole.
+  // Retained.
+  GPBCompiledFieldMask *submask;
+} GPBCompiledFieldMaskEntry;
+
+@interface GPBCompiledFieldMask () {
+ @package
+  GPBDescriptor *descriptor_;
+  uint32_t count_;
+  // Sorted by field number.
+  GPBCompiledFieldMaskEntry *entries_;
+}
+@end
+
+CF_EXTERN_C_BEGIN
+
+// Returns the entry of the field with the given number, NULL if the mask
+// doesn't keep the field. Masks only name a handful of fields, a scan beats
+// anything fancier.
+GPB_INLINE const GPBCompiledFieldMaskEntry *GPBCompiledFieldMaskLookup(GPBCompiledFieldMask *mask,
+                                                                       uint32_t fieldNumber) {
+  const GPBCompiledFieldMaskEntry *entries = mask->entries_;
+  for (uint32_t i = 0; i < mask->count_; ++i) {
+    if (entries[i].number >= fieldNumber) {
+      return entries[i].number == fieldNumber ? &entries[i] : NULL;
+    }
+  }
+  return NULL;
+}
+
+CF_EXTERN_C_END
@@ -193,6 +193,20 @@ __attribute__((objc_subclassing_restricted))
 /** Descriptor for the enum if this field is an enum. */
 @property(nonatomic, readonly, strong, nullable) GPBEnumDescriptor *enumDescriptor;
 
+/**
+ * Whether the messages of this field are parsed lazily. When set, parsing
+ * keeps the wire bytes of each message and only decodes a message the first
+ * time it is read from the array, so long lists cost what is actually
+ * displayed.
+ *
+ * Only supported on repeated message fields, defaults to NO. Set it before
+ * messages using the field are parsed.
+ *
+ * @note Malformed lazy messages read as empty messages instead of failing the
+ *       parse, and their required fields are not checked by -isInitialized.
+ **/
+@property(nonatomic, readwrite, getter=isLazy) BOOL lazy;
+
 /**
  * Checks whether the given enum raw value is a valid enum value.
  *
@@ -9,6 +9,7 @@
 #import "GPBDescriptor_PackagePrivate.h"
 
 #import <objc/runtime.h>
+#import <stdatomic.h>
 
 #import "GPBMessage.h"
 #import "GPBMessage_PackagePrivate.h"
@@ -71,6 +72,8 @@ static NSArray *NewFieldsArrayForHasIndex(int hasIndex, NSArray *allMessageField
   Class messageClass_;
   NSString *messageName_;
   const GPBFileDescription *fileDescription_;
+  // Built on first use, see -file.
+  GPBFileDescriptor *file_;
   BOOL wireFormat_;
 }
 
@@ -84,7 +87,7 @@ static NSArray *NewFieldsArrayForHasIndex(int hasIndex, NSArray *allMessageField
 + (instancetype)allocDescriptorForClass:(Class)messageClass
                             messageName:(NSString *)messageName
                         fileDescription:(GPBFileDescription *)fileDescription
-                                 fields:(void *)fieldDescriptions
+                                 fields:(const void *)fieldDescriptions
                              fieldCount:(uint32_t)fieldCount
                             storageSize:(uint32_t)storageSize
                                   flags:(GPBDescriptorInitializationFlags)flags {
@@ -118,17 +121,19 @@ static NSArray *NewFieldsArrayForHasIndex(int hasIndex, NSArray *allMessageField
       (fieldCount ? [[NSMutableArray alloc] initWithCapacity:fieldCount] : nil);
   BOOL fieldsIncludeDefault = (flags & GPBDescriptorInitializationFlag_FieldsWithDefault) != 0;
 
+  // The descriptions are only read from here on, so generated code can keep
+  // them in const tables; the field descriptors just hold onto them.
   void *desc;
   GPBFieldFlags mergedFieldFlags = GPBFieldNone;
   for (uint32_t i = 0; i < fieldCount; ++i) {
     // Need correctly typed pointer for array indexing below to work.
     if (fieldsIncludeDefault) {
-      desc = &(((GPBMessageFieldDescriptionWithDefault *)fieldDescriptions)[i]);
+      desc = (void *)&(((const GPBMessageFieldDescriptionWithDefault *)fieldDescriptions)[i]);
       mergedFieldFlags |=
-          (((GPBMessageFieldDescriptionWithDefault *)fieldDescriptions)[i]).core.flags;
+          (((const GPBMessageFieldDescriptionWithDefault *)fieldDescriptions)[i]).core.flags;
     } else {
-      desc = &(((GPBMessageFieldDescription *)fieldDescriptions)[i]);
-      mergedFieldFlags |= (((GPBMessageFieldDescription *)fieldDescriptions)[i]).flags;
+      desc = (void *)&(((const GPBMessageFieldDescription *)fieldDescriptions)[i]);
+      mergedFieldFlags |= (((const GPBMessageFieldDescription *)fieldDescriptions)[i]).flags;
     }
     GPBFieldDescriptor *fieldDescriptor =
         [[GPBFieldDescriptor alloc] initWithFieldDescription:desc descriptorFlags:flags];
@@ -289,6 +294,8 @@ static NSArray *NewFieldsArrayForHasIndex(int hasIndex, NSArray *allMessageField
   [messageName_ release];
   [fields_ release];
   [oneofs_ release];
+  [file_ release];
+  free(tagTable_);
   [super dealloc];
 }
 
@@ -363,28 +370,38 @@ static NSArray *NewFieldsArrayForHasIndex(int hasIndex, NSArray *allMessageField
 }
 
 - (GPBFileDescriptor *)file {
-  @synchronized(self) {
-    GPBFileDescriptor *result = objc_getAssociatedObject(self, &kFileDescriptorCacheKey);
-    if (!result) {
+  _Atomic(GPBFileDescriptor *) *filePtr = (_Atomic(GPBFileDescriptor *) *)&file_;
+  GPBFileDescriptor *result = atomic_load(filePtr);
+  if (result) {
+    return result;
+  }
+  // Descriptors from the legacy startup path are given their file.
+  result = objc_getAssociatedObject(self, &kFileDescriptorCacheKey);
+  if (result) {
+    return result;
+  }
+
 #if defined(DEBUG) && DEBUG
-      NSAssert(fileDescription_ != NULL, @"Internal error in generation/startup");
+  NSAssert(fileDescription_ != NULL, @"Internal error in generation/startup");
 #endif
-      // `package` and `prefix` can both be NULL if there wasn't one for the file.
-      NSString *package = fileDescription_->package ? @(fileDescription_->package) : @"";
-      if (fileDescription_->prefix) {
-        result = [[GPBFileDescriptor alloc] initWithPackage:package
-                                                 objcPrefix:@(fileDescription_->prefix)
-                                                     syntax:fileDescription_->syntax];
+  // `package` and `prefix` can both be NULL if there wasn't one for the file.
+  NSString *package = fileDescription_->package ? @(fileDescription_->package) : @"";
+  if (fileDescription_->prefix) {
+    result = [[GPBFileDescriptor alloc] initWithPackage:package
+                                             objcPrefix:@(fileDescription_->prefix)
+                                                 syntax:fileDescription_->syntax];
 
-      } else {
-        result = [[GPBFileDescriptor alloc] initWithPackage:package
-                                                     syntax:fileDescription_->syntax];
-      }
-      objc_setAssociatedObject(result, &kFileDescriptorCacheKey, result,
-                               OBJC_ASSOCIATION_RETAIN_NONATOMIC);
-    }
-    return result;
+  } else {
+    result = [[GPBFileDescriptor alloc] initWithPackage:package
+                                                 syntax:fileDescription_->syntax];
+  }
+  GPBFileDescriptor *expected = nil;
+  if (!atomic_compare_exchange_strong(filePtr, &expected, result)) {
+    // Some other thread built it, drop this one and return what got set.
+    [result release];
+    return expected;
   }
+  return result;
 }
 
 - (GPBDescriptor *)containingType {
@@ -607,6 +624,69 @@ static NSArray *NewFieldsArrayForHasIndex(int hasIndex, NSArray *allMessageField
 
 @end
 
+static GPBFieldTagTable *NewTagTable(NSArray *fields) {
+  uint32_t fieldCount = (uint32_t)fields.count;
+  uint32_t maxNumber = 0;
+  for (GPBFieldDescriptor *field in fields) {
+    maxNumber = MAX(maxNumber, GPBFieldNumber(field));
+  }
+
+  // Fields are almost always numbered 1...N, index those directly by number
+  // and only hash when that would waste too much memory.
+  BOOL dense = (maxNumber < 64) || (maxNumber <= 4 * fieldCount);
+  uint32_t count;
+  if (dense) {
+    count = maxNumber + 1;
+  } else {
+    // Load factor of at most 1/2 keeps the probe sequences short.
+    count = 1;
+    while (count < 2 * fieldCount) count <<= 1;
+  }
+  size_t size = sizeof(GPBFieldTagTable) + count * sizeof(GPBFieldTagEntry);
+  GPBFieldTagTable *table = calloc(1, size);
+  if (!table) {
+    [NSException raise:NSMallocException format:@"Failed to allocate %zu bytes", size];
+  }
+  table->dense = dense;
+  table->count = count;
+
+  for (GPBFieldDescriptor *field in fields) {
+    uint32_t number = GPBFieldNumber(field);
+    uint32_t i = number;
+    if (!dense) {
+      i = (number * 2654435761U) & (count - 1);
+      while (table->entries[i].field) {
+        i = (i + 1) & (count - 1);
+      }
+    }
+    GPBFieldTagEntry *entry = &table->entries[i];
+    entry->field = field;
+    entry->tag = GPBFieldTag(field);
+    if ((field->description_->flags & GPBFieldRepeated) != 0 && !GPBFieldDataTypeIsObject(field)) {
+      entry->alternateTag = GPBFieldAlternateTag(field);
+    }
+  }
+  return table;
+}
+
+GPBFieldTagTable *GPBDescriptorTagTable(GPBDescriptor *self) {
+  _Atomic(GPBFieldTagTable *) *tablePtr = (_Atomic(GPBFieldTagTable *) *)&self->tagTable_;
+  GPBFieldTagTable *table = atomic_load(tablePtr);
+  if (table) {
+    return table;
+  }
+
+  GPBFieldTagTable *expected = NULL;
+  table = NewTagTable(self->fields_);
+  if (atomic_compare_exchange_strong(tablePtr, &expected, table)) {
+    return table;
+  }
+
+  // Some other thread built it, drop this one and return what got set.
+  free(table);
+  return expected;
+}
+
 uint32_t GPBFieldTag(GPBFieldDescriptor *self) {
   GPBMessageFieldDescription *description = self->description_;
   GPBWireFormat format;
@@ -778,6 +858,19 @@ uint32_t GPBFieldAlternateTag(GPBFieldDescriptor *self) {
   return (description_->flags & GPBFieldPacked) != 0;
 }
 
+- (BOOL)isLazy {
+  return lazy_;
+}
+
+- (void)setLazy:(BOOL)lazy {
+  if (lazy && !((description_->flags & GPBFieldRepeated) != 0 &&
+                description_->dataType == GPBDataTypeMessage)) {
+    [NSException raise:NSInvalidArgumentException
+                format:@"Field %@ can't be lazy, only repeated message fields can", self.name];
+  }
+  lazy_ = lazy;
+}
+
 - (BOOL)isValidEnumValue:(int32_t)value {
   NSAssert(description_->dataType == GPBDataTypeEnum, @"Field Must be of type GPBDataTypeEnum");
   return enumDescriptor_.enumVerifier(value);
@@ -994,19 +1087,22 @@ uint32_t GPBFieldAlternateTag(GPBFieldDescriptor *self) {
 }
 
 - (void)calcValueNameOffsets {
-  @synchronized(self) {
-    if (nameOffsets_ != NULL) {
-      return;
-    }
-    uint32_t *offsets = malloc(valueCount_ * sizeof(uint32_t));
-    if (!offsets) return;
-    const char *scan = valueNames_;
-    for (uint32_t i = 0; i < valueCount_; ++i) {
-      offsets[i] = (uint32_t)(scan - valueNames_);
-      while (*scan != '\0') ++scan;
-      ++scan;  // Step over the null.
-    }
-    nameOffsets_ = offsets;
+  _Atomic(uint32_t *) *offsetsPtr = (_Atomic(uint32_t *) *)&nameOffsets_;
+  if (atomic_load(offsetsPtr) != NULL) {
+    return;
+  }
+  uint32_t *offsets = malloc(valueCount_ * sizeof(uint32_t));
+  if (!offsets) return;
+  const char *scan = valueNames_;
+  for (uint32_t i = 0; i < valueCount_; ++i) {
+    offsets[i] = (uint32_t)(scan - valueNames_);
+    while (*scan != '\0') ++scan;
+    ++scan;  // Step over the null.
+  }
+  uint32_t *expected = NULL;
+  if (!atomic_compare_exchange_strong(offsetsPtr, &expected, offsets)) {
+    // Some other thread filled them in.
+    free(offsets);
   }
 }
 
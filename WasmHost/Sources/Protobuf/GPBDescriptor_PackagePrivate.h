@@ -183,18 +183,41 @@ typedef NS_OPTIONS(uint32_t, GPBDescriptorInitializationFlags) {
   GPBDescriptorInitializationFlag_ClosedEnumSupportKnown = 1 << 4,
 };
 
+// One field of a GPBFieldTagTable.
+typedef struct GPBFieldTagEntry {
+  GPB_UNSAFE_UNRETAINED GPBFieldDescriptor *field;
+  uint32_t tag;
+  // For repeated primitive fields, the tag of the other packed/unpacked form
+  // (see GPBFieldAlternateTag()), zero for all other fields.
+  uint32_t alternateTag;
+} GPBFieldTagEntry;
+
+// Tag dispatch table of a message, maps field numbers to their fields so the
+// parser finds the field for a tag without scanning the fields. Dense tables
+// are indexed directly by field number, messages with sparse numbering use an
+// open addressed hash of the field number.
+typedef struct GPBFieldTagTable {
+  BOOL dense;
+  // Number of entries, a power of two for hashed tables.
+  uint32_t count;
+  GPBFieldTagEntry entries[];
+} GPBFieldTagTable;
+
 @interface GPBDescriptor () {
  @package
   NSArray *fields_;
   NSArray *oneofs_;
   uint32_t storageSize_;
+  // Built on first use, see GPBDescriptorTagTable().
+  GPBFieldTagTable *tagTable_;
 }
 
 // fieldDescriptions and fileDescription have to be long lived, they are held as raw pointers.
+// fieldDescriptions are never written to, they can live in const tables.
 + (instancetype)allocDescriptorForClass:(Class)messageClass
                             messageName:(NSString *)messageName
                         fileDescription:(GPBFileDescription *)fileDescription
-                                 fields:(void *)fieldDescriptions
+                                 fields:(const void *)fieldDescriptions
                              fieldCount:(uint32_t)fieldCount
                             storageSize:(uint32_t)storageSize
                                   flags:(GPBDescriptorInitializationFlags)flags;
@@ -256,6 +279,7 @@ typedef NS_OPTIONS(uint32_t, GPBDescriptorInitializationFlags) {
  @package
   GPBMessageFieldDescription *description_;
   GPB_UNSAFE_UNRETAINED GPBOneofDescriptor *containingOneof_;
+  BOOL lazy_;
 }
 @end
 
@@ -354,10 +378,38 @@ GPB_INLINE BOOL GPBFieldIsClosedEnum(GPBFieldDescriptor *field) {
   return (field->description_->flags & GPBFieldClosedEnum) != 0;
 }
 
+GPB_INLINE BOOL GPBFieldIsLazy(GPBFieldDescriptor *field) {
+  return field->lazy_;
+}
+
 #pragma clang diagnostic pop
 
 uint32_t GPBFieldTag(GPBFieldDescriptor *self);
 
+// Returns the tag dispatch table of the descriptor, building it on first use.
+// Safe to call from any thread.
+GPBFieldTagTable *GPBDescriptorTagTable(GPBDescriptor *self);
+
+// Returns the entry for the field with the given number, NULL if the message
+// has no such field.
+GPB_INLINE const GPBFieldTagEntry *GPBFieldTagTableLookup(const GPBFieldTagTable *table,
+                                                          uint32_t fieldNumber) {
+  if (table->dense) {
+    if (fieldNumber >= table->count) return NULL;
+    const GPBFieldTagEntry *entry = &table->entries[fieldNumber];
+    return entry->field ? entry : NULL;
+  }
+  uint32_t mask = table->count - 1;
+  uint32_t i = (fieldNumber * 2654435761U) & mask;
+  while (table->entries[i].field) {
+    if (GPBFieldNumber(table->entries[i].field) == fieldNumber) {
+      return &table->entries[i];
+    }
+    i = (i + 1) & mask;
+  }
+  return NULL;
+}
+
 // For repeated fields, alternateWireType is the wireType with the opposite
 // value for the packable property.  i.e. - if the field was marked packed it
 // would be the wire type for unpacked; if the field was marked unpacked, it
@@ -20,12 +20,9 @@
 #import "GPBUtilities_PackagePrivate.h"
 
 // ------------------------------ NOTE ------------------------------
-// At the moment, this is all using NSNumbers in NSDictionaries under
-// the hood, but it is all hidden so we can come back and optimize
-// with direct CFDictionary usage later.  The reason that wasn't
-// done yet is needing to support 32bit iOS builds.  Otherwise
-// it would be pretty simple to store all this data in CFDictionaries
-// directly.
+// The dictionaries with integer keys store their entries unboxed in
+// open addressing hash tables (see DictMap below), the ones with
+// string keys still use NSNumbers in NSDictionaries under the hood.
 // ------------------------------------------------------------------
 
 // Direct access is use for speed, to avoid even internally declaring things
@@ -506,6 +503,345 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   }
 }
 
+#pragma mark - Integer keyed storage
+
+// The dictionaries with integer keys store their entries in an open addressing
+// hash table instead of boxing them into an NSMutableDictionary. Keys and
+// values are widened to 64 bits (objects are stored retained), collisions are
+// resolved by linear probing and removals shift the following entries back, so
+// there are no tombstones. Key 0 marks empty slots, its own entry is kept aside.
+
+typedef struct DictMapSlot {
+  uint64_t key;
+  uint64_t value;
+} DictMapSlot;
+
+typedef struct DictMap {
+  DictMapSlot *slots;
+  // A power of 2, 0 until the first entry is added.
+  NSUInteger capacity;
+  // The entries in slots, the one for key 0 excluded.
+  NSUInteger count;
+  BOOL hasZeroKey;
+  uint64_t zeroKeyValue;
+  // Bumped when entries are added or removed, so enumerations can detect it.
+  unsigned long mutations;
+} DictMap;
+
+static const NSUInteger kDictMapMinCapacity = 8;
+
+GPB_INLINE NSUInteger DictMapHash(uint64_t key) {
+  // MurmurHash3's finalizer, consecutive keys end up spread over the table.
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return (NSUInteger)key;
+}
+
+GPB_INLINE NSUInteger DictMapCount(const DictMap *map) {
+  return map->count + (map->hasZeroKey ? 1 : 0);
+}
+
+static DictMapSlot *DictMapAllocateSlots(NSUInteger capacity) {
+  DictMapSlot *slots = calloc(capacity, sizeof(DictMapSlot));
+  if (!slots) {
+    [NSException raise:NSMallocException
+                format:@"Failed to allocate %lu bytes",
+                       (unsigned long)(capacity * sizeof(DictMapSlot))];
+  }
+  return slots;
+}
+
+static void DictMapRehash(DictMap *map, NSUInteger capacity) {
+  DictMapSlot *slots = DictMapAllocateSlots(capacity);
+  NSUInteger mask = capacity - 1;
+  for (NSUInteger i = 0; i < map->capacity; ++i) {
+    DictMapSlot *slot = &map->slots[i];
+    if (slot->key) {
+      NSUInteger j = DictMapHash(slot->key) & mask;
+      while (slots[j].key) {
+        j = (j + 1) & mask;
+      }
+      slots[j] = *slot;
+    }
+  }
+  free(map->slots);
+  map->slots = slots;
+  map->capacity = capacity;
+}
+
+// Grows the table so it holds |count| entries without going over a 3/4 load.
+static void DictMapReserve(DictMap *map, NSUInteger count) {
+  if (count == 0) {
+    return;
+  }
+  NSUInteger capacity = MAX(map->capacity, kDictMapMinCapacity);
+  while (count > capacity / 4 * 3) {
+    capacity *= 2;
+  }
+  if (capacity != map->capacity) {
+    DictMapRehash(map, capacity);
+  }
+}
+
+// Returns the value stored for |key|, NULL if there is none.
+static uint64_t *DictMapFind(DictMap *map, uint64_t key) {
+  if (key == 0) {
+    return map->hasZeroKey ? &map->zeroKeyValue : NULL;
+  }
+  if (map->capacity == 0) {
+    return NULL;
+  }
+  NSUInteger mask = map->capacity - 1;
+  NSUInteger i = DictMapHash(key) & mask;
+  // The load is kept under 3/4, there is always an empty slot to stop at.
+  while (YES) {
+    DictMapSlot *slot = &map->slots[i];
+    if (slot->key == key) {
+      return &slot->value;
+    }
+    if (slot->key == 0) {
+      return NULL;
+    }
+    i = (i + 1) & mask;
+  }
+}
+
+// Returns the value stored for |key|, adding a zero value if there is none
+// (|*inserted| is then YES).
+static uint64_t *DictMapInsert(DictMap *map, uint64_t key, BOOL *inserted) {
+  if (key == 0) {
+    *inserted = !map->hasZeroKey;
+    if (*inserted) {
+      map->hasZeroKey = YES;
+      map->zeroKeyValue = 0;
+      ++map->mutations;
+    }
+    return &map->zeroKeyValue;
+  }
+  if (map->count + 1 > map->capacity / 4 * 3) {
+    DictMapReserve(map, map->count + 1);
+  }
+  NSUInteger mask = map->capacity - 1;
+  NSUInteger i = DictMapHash(key) & mask;
+  while (map->slots[i].key) {
+    if (map->slots[i].key == key) {
+      *inserted = NO;
+      return &map->slots[i].value;
+    }
+    i = (i + 1) & mask;
+  }
+  map->slots[i].key = key;
+  map->slots[i].value = 0;
+  ++map->count;
+  ++map->mutations;
+  *inserted = YES;
+  return &map->slots[i].value;
+}
+
+GPB_INLINE void DictMapSet(DictMap *map, uint64_t key, uint64_t value) {
+  BOOL inserted;
+  *DictMapInsert(map, key, &inserted) = value;
+}
+
+// Removes the entry for |key|, its value is returned in |value| (if not NULL).
+static BOOL DictMapRemove(DictMap *map, uint64_t key, uint64_t *value) {
+  if (key == 0) {
+    if (!map->hasZeroKey) {
+      return NO;
+    }
+    if (value) {
+      *value = map->zeroKeyValue;
+    }
+    map->hasZeroKey = NO;
+    ++map->mutations;
+    return YES;
+  }
+  if (map->capacity == 0) {
+    return NO;
+  }
+  NSUInteger mask = map->capacity - 1;
+  NSUInteger hole = DictMapHash(key) & mask;
+  while (map->slots[hole].key != key) {
+    if (map->slots[hole].key == 0) {
+      return NO;
+    }
+    hole = (hole + 1) & mask;
+  }
+  if (value) {
+    *value = map->slots[hole].value;
+  }
+  // Move back the entries following the hole that can't be reached anymore
+  // from their hash position otherwise.
+  NSUInteger i = hole;
+  while (YES) {
+    i = (i + 1) & mask;
+    uint64_t otherKey = map->slots[i].key;
+    if (otherKey == 0) {
+      break;
+    }
+    NSUInteger home = DictMapHash(otherKey) & mask;
+    if (((i - home) & mask) >= ((i - hole) & mask)) {
+      map->slots[hole] = map->slots[i];
+      hole = i;
+    }
+  }
+  map->slots[hole].key = 0;
+  map->slots[hole].value = 0;
+  --map->count;
+  ++map->mutations;
+  return YES;
+}
+
+static void DictMapRemoveAll(DictMap *map) {
+  free(map->slots);
+  map->slots = NULL;
+  map->capacity = 0;
+  map->count = 0;
+  map->hasZeroKey = NO;
+  ++map->mutations;
+}
+
+// Copies the entries of |other| into the empty |map|.
+static void DictMapCopy(DictMap *map, const DictMap *other) {
+  NSCAssert(DictMapCount(map) == 0, @"Copying into a non empty map");
+  if (other->count) {
+    map->slots = DictMapAllocateSlots(other->capacity);
+    memcpy(map->slots, other->slots, other->capacity * sizeof(DictMapSlot));
+    map->capacity = other->capacity;
+    map->count = other->count;
+  }
+  map->hasZeroKey = other->hasZeroKey;
+  map->zeroKeyValue = other->zeroKeyValue;
+}
+
+// Iterates over the entries, |*index| must start at 0.
+static BOOL DictMapNext(const DictMap *map, NSUInteger *index, uint64_t *key, uint64_t *value) {
+  NSUInteger i = *index;
+  if (i == 0) {
+    i = 1;
+    if (map->hasZeroKey) {
+      *index = i;
+      *key = 0;
+      *value = map->zeroKeyValue;
+      return YES;
+    }
+  }
+  for (; i <= map->capacity; ++i) {
+    const DictMapSlot *slot = &map->slots[i - 1];
+    if (slot->key) {
+      *index = i + 1;
+      *key = slot->key;
+      *value = slot->value;
+      return YES;
+    }
+  }
+  *index = i;
+  return NO;
+}
+
+static void DictMapCheckMutations(const DictMap *map, unsigned long mutations) {
+  if (map->mutations != mutations) {
+    [NSException raise:NSGenericException
+                format:@"Dictionary was mutated while being enumerated"];
+  }
+}
+
+GPB_INLINE uint64_t DictMapWrapUInt32(uint32_t value) { return value; }
+GPB_INLINE uint32_t DictMapUnwrapUInt32(uint64_t value) { return (uint32_t)value; }
+GPB_INLINE uint64_t DictMapWrapInt32(int32_t value) { return (uint32_t)value; }
+GPB_INLINE int32_t DictMapUnwrapInt32(uint64_t value) { return (int32_t)(uint32_t)value; }
+GPB_INLINE uint64_t DictMapWrapUInt64(uint64_t value) { return value; }
+GPB_INLINE uint64_t DictMapUnwrapUInt64(uint64_t value) { return value; }
+GPB_INLINE uint64_t DictMapWrapInt64(int64_t value) { return (uint64_t)value; }
+GPB_INLINE int64_t DictMapUnwrapInt64(uint64_t value) { return (int64_t)value; }
+GPB_INLINE uint64_t DictMapWrapBool(BOOL value) { return value ? 1 : 0; }
+GPB_INLINE BOOL DictMapUnwrapBool(uint64_t value) { return value != 0; }
+GPB_INLINE uint64_t DictMapWrapEnum(int32_t value) { return (uint32_t)value; }
+GPB_INLINE int32_t DictMapUnwrapEnum(uint64_t value) { return (int32_t)(uint32_t)value; }
+GPB_INLINE uint64_t DictMapWrapObject(id value) { return (uintptr_t)value; }
+GPB_INLINE id DictMapUnwrapObject(uint64_t value) { return (id)(uintptr_t)value; }
+
+GPB_INLINE uint64_t DictMapWrapFloat(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+GPB_INLINE float DictMapUnwrapFloat(uint64_t value) {
+  uint32_t bits = (uint32_t)value;
+  float result;
+  memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+GPB_INLINE uint64_t DictMapWrapDouble(double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+GPB_INLINE double DictMapUnwrapDouble(uint64_t value) {
+  double result;
+  memcpy(&result, &value, sizeof(result));
+  return result;
+}
+
+// Values compare the way the boxed entries of the NSDictionary storage did, so NaN equals itself
+// as before. Only the float types need boxing, the other slots hold their value as is.
+GPB_INLINE BOOL DictMapEqualUInt32(uint64_t a, uint64_t b) { return a == b; }
+GPB_INLINE BOOL DictMapEqualInt32(uint64_t a, uint64_t b) { return a == b; }
+GPB_INLINE BOOL DictMapEqualUInt64(uint64_t a, uint64_t b) { return a == b; }
+GPB_INLINE BOOL DictMapEqualInt64(uint64_t a, uint64_t b) { return a == b; }
+GPB_INLINE BOOL DictMapEqualBool(uint64_t a, uint64_t b) { return a == b; }
+GPB_INLINE BOOL DictMapEqualEnum(uint64_t a, uint64_t b) { return a == b; }
+
+static BOOL DictMapEqualFloat(uint64_t a, uint64_t b) {
+  return [@(DictMapUnwrapFloat(a)) isEqual:@(DictMapUnwrapFloat(b))];
+}
+
+static BOOL DictMapEqualDouble(uint64_t a, uint64_t b) {
+  return [@(DictMapUnwrapDouble(a)) isEqual:@(DictMapUnwrapDouble(b))];
+}
+
+static BOOL DictMapEqualObject(uint64_t a, uint64_t b) {
+  return [DictMapUnwrapObject(a) isEqual:DictMapUnwrapObject(b)];
+}
+
+// Stores a retained |object|, releasing the one it replaces.
+static void DictMapSetObject(DictMap *map, uint64_t key, id object) {
+  BOOL inserted;
+  uint64_t *value = DictMapInsert(map, key, &inserted);
+  id old = inserted ? nil : DictMapUnwrapObject(*value);
+  *value = DictMapWrapObject([object retain]);
+  [old release];
+}
+
+static void DictMapRemoveObject(DictMap *map, uint64_t key) {
+  uint64_t value;
+  if (DictMapRemove(map, key, &value)) {
+    [DictMapUnwrapObject(value) release];
+  }
+}
+
+static void DictMapRetainObjects(const DictMap *map) {
+  NSUInteger index = 0;
+  uint64_t key, value;
+  while (DictMapNext(map, &index, &key, &value)) {
+    [DictMapUnwrapObject(value) retain];
+  }
+}
+
+static void DictMapReleaseObjects(const DictMap *map) {
+  NSUInteger index = 0;
+  uint64_t key, value;
+  while (DictMapNext(map, &index, &key, &value)) {
+    [DictMapUnwrapObject(value) release];
+  }
+}
+
 //
 // Macros for the common basic cases.
 //
@@ -514,8 +850,15 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 // clang-format off
 
 //%PDDM-DEFINE DICTIONARY_IMPL_FOR_POD_KEY(KEY_NAME, KEY_TYPE)
-//%DICTIONARY_POD_IMPL_FOR_KEY(KEY_NAME, KEY_TYPE, , POD)
-//%DICTIONARY_POD_KEY_TO_OBJECT_IMPL(KEY_NAME, KEY_TYPE, Object, id)
+//%DICTIONARY_HASH_KEY_TO_POD_IMPL(KEY_NAME, KEY_TYPE, UInt32, uint32_t)
+//%DICTIONARY_HASH_KEY_TO_POD_IMPL(KEY_NAME, KEY_TYPE, Int32, int32_t)
+//%DICTIONARY_HASH_KEY_TO_POD_IMPL(KEY_NAME, KEY_TYPE, UInt64, uint64_t)
+//%DICTIONARY_HASH_KEY_TO_POD_IMPL(KEY_NAME, KEY_TYPE, Int64, int64_t)
+//%DICTIONARY_HASH_KEY_TO_POD_IMPL(KEY_NAME, KEY_TYPE, Bool, BOOL)
+//%DICTIONARY_HASH_KEY_TO_POD_IMPL(KEY_NAME, KEY_TYPE, Float, float)
+//%DICTIONARY_HASH_KEY_TO_POD_IMPL(KEY_NAME, KEY_TYPE, Double, double)
+//%DICTIONARY_HASH_KEY_TO_ENUM_IMPL(KEY_NAME, KEY_TYPE, Enum, int32_t)
+//%DICTIONARY_HASH_KEY_TO_OBJECT_IMPL(KEY_NAME, KEY_TYPE, Object, id)
 
 //%PDDM-DEFINE DICTIONARY_POD_IMPL_FOR_KEY(KEY_NAME, KEY_TYPE, KisP, KHELPER)
 //%DICTIONARY_KEY_TO_POD_IMPL(KEY_NAME, KEY_TYPE, KisP, UInt32, uint32_t, KHELPER)
@@ -832,6 +1175,342 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 //%  [_dictionary removeAllObjects];
 //%}
 
+//
+// Integer keys, stored in a DictMap
+//
+
+//%PDDM-DEFINE DICTIONARY_HASH_KEY_TO_POD_IMPL(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE)
+//%DICTIONARY_HASH_COMMON_IMPL(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE, POD, VALUE_NAME, value)
+
+//%PDDM-DEFINE DICTIONARY_HASH_KEY_TO_OBJECT_IMPL(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE)
+//%DICTIONARY_HASH_COMMON_IMPL(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE, OBJECT, Object, object)
+
+//%PDDM-DEFINE DICTIONARY_HASH_COMMON_IMPL(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE, VHELPER, VNAME, VNAME_VAR)
+//%#pragma mark - KEY_NAME -> VALUE_NAME
+//%
+//%@implementation GPB##KEY_NAME##VALUE_NAME##Dictionary {
+//% @package
+//%  DictMap _map;
+//%}
+//%
+//%- (instancetype)init {
+//%  return [self initWith##VNAME##s:NULL forKeys:NULL count:0];
+//%}
+//%
+//%- (instancetype)initWith##VNAME##s:(const VALUE_TYPE [])##VNAME_VAR##s
+//%                ##VNAME$S##  forKeys:(const KEY_TYPE [])keys
+//%                ##VNAME$S##    count:(NSUInteger)count {
+//%  self = [super init];
+//%  if (self) {
+//%    if (count && VNAME_VAR##s && keys) {
+//%      DictMapReserve(&_map, count);
+//%      for (NSUInteger i = 0; i < count; ++i) {
+//%DICTIONARY_VALIDATE_VALUE_##VHELPER(VNAME_VAR##s[i], ______)        DICTIONARY_HASH_SET_##VHELPER(KEY_NAME, keys[i], VALUE_NAME, VNAME_VAR##s[i])
+//%      }
+//%    }
+//%  }
+//%  return self;
+//%}
+//%
+//%- (instancetype)initWithDictionary:(GPB##KEY_NAME##VALUE_NAME##Dictionary *)dictionary {
+//%  self = [self initWith##VNAME##s:NULL forKeys:NULL count:0];
+//%  if (self) {
+//%    if (dictionary) {
+//%      DictMapCopy(&_map, &dictionary->_map);
+//%DICTIONARY_HASH_RETAIN_ALL_##VHELPER()    }
+//%  }
+//%  return self;
+//%}
+//%
+//%- (instancetype)initWithCapacity:(NSUInteger)numItems {
+//%  self = [self initWith##VNAME##s:NULL forKeys:NULL count:0];
+//%  if (self) {
+//%    DictMapReserve(&_map, numItems);
+//%  }
+//%  return self;
+//%}
+//%
+//%DICTIONARY_HASH_IMMUTABLE_CORE(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE, VHELPER, VNAME, VNAME_VAR, )
+//%
+//%VALUE_FOR_KEY_HASH_##VHELPER(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE)
+//%
+//%DICTIONARY_HASH_MUTABLE_CORE(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE, VHELPER, VNAME, VNAME_VAR, )
+//%
+//%@end
+//%
+
+//%PDDM-DEFINE DICTIONARY_HASH_KEY_TO_ENUM_IMPL(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE)
+//%#pragma mark - KEY_NAME -> VALUE_NAME
+//%
+//%@implementation GPB##KEY_NAME##VALUE_NAME##Dictionary {
+//% @package
+//%  DictMap _map;
+//%  GPBEnumValidationFunc _validationFunc;
+//%}
+//%
+//%@synthesize validationFunc = _validationFunc;
+//%
+//%- (instancetype)init {
+//%  return [self initWithValidationFunction:NULL rawValues:NULL forKeys:NULL count:0];
+//%}
+//%
+//%- (instancetype)initWithValidationFunction:(GPBEnumValidationFunc)func {
+//%  return [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+//%}
+//%
+//%- (instancetype)initWithValidationFunction:(GPBEnumValidationFunc)func
+//%                                 rawValues:(const VALUE_TYPE [])rawValues
+//%                                   forKeys:(const KEY_TYPE [])keys
+//%                                     count:(NSUInteger)count {
+//%  self = [super init];
+//%  if (self) {
+//%    _validationFunc = (func != NULL ? func : DictDefault_IsValidValue);
+//%    if (count && rawValues && keys) {
+//%      DictMapReserve(&_map, count);
+//%      for (NSUInteger i = 0; i < count; ++i) {
+//%        DICTIONARY_HASH_SET_POD(KEY_NAME, keys[i], VALUE_NAME, rawValues[i])
+//%      }
+//%    }
+//%  }
+//%  return self;
+//%}
+//%
+//%- (instancetype)initWithDictionary:(GPB##KEY_NAME##VALUE_NAME##Dictionary *)dictionary {
+//%  self = [self initWithValidationFunction:dictionary.validationFunc
+//%                                rawValues:NULL
+//%                                  forKeys:NULL
+//%                                    count:0];
+//%  if (self) {
+//%    if (dictionary) {
+//%      DictMapCopy(&_map, &dictionary->_map);
+//%    }
+//%  }
+//%  return self;
+//%}
+//%
+//%- (instancetype)initWithValidationFunction:(GPBEnumValidationFunc)func
+//%                                  capacity:(NSUInteger)numItems {
+//%  self = [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+//%  if (self) {
+//%    DictMapReserve(&_map, numItems);
+//%  }
+//%  return self;
+//%}
+//%
+//%DICTIONARY_HASH_IMMUTABLE_CORE(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE, POD, Value, value, Raw)
+//%
+//%- (BOOL)getEnum:(VALUE_TYPE *)value forKey:(KEY_TYPE)key {
+//%  uint64_t *slot = DictMapFind(&_map, DictMapWrap##KEY_NAME(key));
+//%  if (slot && value) {
+//%    VALUE_TYPE result = DictMapUnwrap##VALUE_NAME(*slot);
+//%    if (!_validationFunc(result)) {
+//%      result = kGPBUnrecognizedEnumeratorValue;
+//%    }
+//%    *value = result;
+//%  }
+//%  return (slot != NULL);
+//%}
+//%
+//%- (BOOL)getRawValue:(VALUE_TYPE *)rawValue forKey:(KEY_TYPE)key {
+//%  uint64_t *slot = DictMapFind(&_map, DictMapWrap##KEY_NAME(key));
+//%  if (slot && rawValue) {
+//%    *rawValue = DictMapUnwrap##VALUE_NAME(*slot);
+//%  }
+//%  return (slot != NULL);
+//%}
+//%
+//%- (void)enumerateKeysAndEnumsUsingBlock:
+//%    (void (NS_NOESCAPE ^)(KEY_TYPE key, VALUE_TYPE value, BOOL *stop))block {
+//%  GPBEnumValidationFunc func = _validationFunc;
+//%  BOOL stop = NO;
+//%  unsigned long mutations = _map.mutations;
+//%  NSUInteger index = 0;
+//%  uint64_t key, slot;
+//%  while (DictMapNext(&_map, &index, &key, &slot)) {
+//%    VALUE_TYPE unwrapped = DictMapUnwrap##VALUE_NAME(slot);
+//%    if (!func(unwrapped)) {
+//%      unwrapped = kGPBUnrecognizedEnumeratorValue;
+//%    }
+//%    block(DictMapUnwrap##KEY_NAME(key), unwrapped, &stop);
+//%    if (stop) {
+//%      break;
+//%    }
+//%    DictMapCheckMutations(&_map, mutations);
+//%  }
+//%}
+//%
+//%DICTIONARY_HASH_MUTABLE_CORE2(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE, POD, Value, Enum, value, Raw)
+//%
+//%- (void)setEnum:(VALUE_TYPE)value forKey:(KEY_TYPE)key {
+//%  if (!_validationFunc(value)) {
+//%    [NSException raise:NSInvalidArgumentException
+//%                format:@"GPB##KEY_NAME##VALUE_NAME##Dictionary: Attempt to set an unknown enum value (%d)",
+//%                       value];
+//%  }
+//%
+//%  DICTIONARY_HASH_SET_POD(KEY_NAME, key, VALUE_NAME, value)
+//%  if (_autocreator) {
+//%    GPBAutocreatedDictionaryModified(_autocreator, self);
+//%  }
+//%}
+//%
+//%@end
+//%
+
+//%PDDM-DEFINE DICTIONARY_HASH_IMMUTABLE_CORE(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE, VHELPER, VNAME, VNAME_VAR, ACCESSOR_NAME)
+//%- (void)dealloc {
+//%  NSAssert(!_autocreator,
+//%           @"%@: Autocreator must be cleared before release, autocreator: %@",
+//%           [self class], _autocreator);
+//%DICTIONARY_HASH_REMOVE_ALL_##VHELPER()
+//%  [super dealloc];
+//%}
+//%
+//%- (instancetype)copyWithZone:(NSZone *)zone {
+//%  return [[GPB##KEY_NAME##VALUE_NAME##Dictionary allocWithZone:zone] initWithDictionary:self];
+//%}
+//%
+//%- (BOOL)isEqual:(id)other {
+//%  if (self == other) {
+//%    return YES;
+//%  }
+//%  if (![other isKindOfClass:[GPB##KEY_NAME##VALUE_NAME##Dictionary class]]) {
+//%    return NO;
+//%  }
+//%  GPB##KEY_NAME##VALUE_NAME##Dictionary *otherDictionary = other;
+//%  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+//%    return NO;
+//%  }
+//%  NSUInteger index = 0;
+//%  uint64_t key, slot;
+//%  while (DictMapNext(&_map, &index, &key, &slot)) {
+//%    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+//%    if (!otherSlot) {
+//%      return NO;
+//%    }
+//%    if (!DictMapEqual##VALUE_NAME(slot, *otherSlot)) {
+//%      return NO;
+//%    }
+//%  }
+//%  return YES;
+//%}
+//%
+//%- (NSUInteger)hash {
+//%  return DictMapCount(&_map);
+//%}
+//%
+//%- (NSString *)description {
+//%  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+//%  NSUInteger index = 0;
+//%  uint64_t key, slot;
+//%  while (DictMapNext(&_map, &index, &key, &slot)) {
+//%    entries[@(DictMapUnwrap##KEY_NAME(key))] = WRAPPED##VHELPER(DictMapUnwrap##VALUE_NAME(slot));
+//%  }
+//%  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
+//%}
+//%
+//%- (NSUInteger)count {
+//%  return DictMapCount(&_map);
+//%}
+//%
+//%- (void)enumerateKeysAnd##ACCESSOR_NAME##VNAME##sUsingBlock:
+//%    (void (NS_NOESCAPE ^)(KEY_TYPE key, VALUE_TYPE VNAME_VAR, BOOL *stop))block {
+//%  BOOL stop = NO;
+//%  unsigned long mutations = _map.mutations;
+//%  NSUInteger index = 0;
+//%  uint64_t key, slot;
+//%  while (DictMapNext(&_map, &index, &key, &slot)) {
+//%    block(DictMapUnwrap##KEY_NAME(key), DictMapUnwrap##VALUE_NAME(slot), &stop);
+//%    if (stop) {
+//%      break;
+//%    }
+//%    DictMapCheckMutations(&_map, mutations);
+//%  }
+//%}
+//%
+//%HASH_EXTRA_METHODS_##VHELPER(KEY_NAME, VALUE_NAME)- (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
+//%  NSUInteger count = DictMapCount(&_map);
+//%  if (count == 0) {
+//%    return 0;
+//%  }
+//%
+//%  GPBDataType valueDataType = GPBGetFieldDataType(field);
+//%  GPBDataType keyDataType = field.mapKeyDataType;
+//%  size_t result = 0;
+//%  NSUInteger index = 0;
+//%  uint64_t key, slot;
+//%  while (DictMapNext(&_map, &index, &key, &slot)) {
+//%    size_t msgSize = ComputeDict##KEY_NAME##FieldSize(DictMapUnwrap##KEY_NAME(key), kMapKeyFieldNumber, keyDataType);
+//%    msgSize += ComputeDict##VALUE_NAME##FieldSize(DictMapUnwrap##VALUE_NAME(slot), kMapValueFieldNumber, valueDataType);
+//%    result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
+//%  }
+//%  size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
+//%  result += tagSize * count;
+//%  return result;
+//%}
+//%
+//%- (void)writeToCodedOutputStream:(GPBCodedOutputStream *)outputStream
+//%                         asField:(GPBFieldDescriptor *)field {
+//%  GPBDataType valueDataType = GPBGetFieldDataType(field);
+//%  GPBDataType keyDataType = field.mapKeyDataType;
+//%  uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
+//%  NSUInteger index = 0;
+//%  uint64_t key, slot;
+//%  while (DictMapNext(&_map, &index, &key, &slot)) {
+//%    [outputStream writeInt32NoTag:tag];
+//%    // Write the size of the message.
+//%    KEY_TYPE unwrappedKey = DictMapUnwrap##KEY_NAME(key);
+//%    VALUE_TYPE unwrappedValue = DictMapUnwrap##VALUE_NAME(slot);
+//%    size_t msgSize = ComputeDict##KEY_NAME##FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
+//%    msgSize += ComputeDict##VALUE_NAME##FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
+//%    [outputStream writeInt32NoTag:(int32_t)msgSize];
+//%    // Write the fields.
+//%    WriteDict##KEY_NAME##Field(outputStream, unwrappedKey, kMapKeyFieldNumber, keyDataType);
+//%    WriteDict##VALUE_NAME##Field(outputStream, unwrappedValue, kMapValueFieldNumber, valueDataType);
+//%  }
+//%}
+//%
+//%SERIAL_DATA_FOR_ENTRY_##VHELPER(KEY_NAME, VALUE_NAME)- (void)setGPBGenericValue:(GPBGenericValue *)value
+//%     forGPBGenericValueKey:(GPBGenericValue *)key {
+//%DICTIONARY_HASH_SET_GPBVALUE_##VHELPER(KEY_NAME, VALUE_NAME)
+//%}
+//%
+//%- (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
+//%  [self enumerateKeysAnd##ACCESSOR_NAME##VNAME##sUsingBlock:^(KEY_TYPE key, VALUE_TYPE VNAME_VAR, __unused BOOL *stop) {
+//%      block(TEXT_FORMAT_OBJ##KEY_NAME(key), TEXT_FORMAT_OBJ##VALUE_NAME(VNAME_VAR));
+//%  }];
+//%}
+//%PDDM-DEFINE DICTIONARY_HASH_MUTABLE_CORE(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE, VHELPER, VNAME, VNAME_VAR, ACCESSOR_NAME)
+//%DICTIONARY_HASH_MUTABLE_CORE2(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE, VHELPER, VNAME, VNAME, VNAME_VAR, ACCESSOR_NAME)
+//%PDDM-DEFINE DICTIONARY_HASH_MUTABLE_CORE2(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE, VHELPER, VNAME, VNAME_REMOVE, VNAME_VAR, ACCESSOR_NAME)
+//%- (void)add##ACCESSOR_NAME##EntriesFromDictionary:(GPB##KEY_NAME##VALUE_NAME##Dictionary *)otherDictionary {
+//%  if (otherDictionary) {
+//%    NSUInteger index = 0;
+//%    uint64_t key, slot;
+//%    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+//%      DICTIONARY_HASH_SET_SLOT_##VHELPER(key, slot)
+//%    }
+//%    if (_autocreator) {
+//%      GPBAutocreatedDictionaryModified(_autocreator, self);
+//%    }
+//%  }
+//%}
+//%
+//%- (void)set##ACCESSOR_NAME##VNAME##:(VALUE_TYPE)VNAME_VAR forKey:(KEY_TYPE)key {
+//%DICTIONARY_VALIDATE_VALUE_##VHELPER(VNAME_VAR, )  DICTIONARY_HASH_SET_##VHELPER(KEY_NAME, key, VALUE_NAME, VNAME_VAR)
+//%  if (_autocreator) {
+//%    GPBAutocreatedDictionaryModified(_autocreator, self);
+//%  }
+//%}
+//%
+//%- (void)remove##VNAME_REMOVE##ForKey:(KEY_TYPE)aKey {
+//%  DICTIONARY_HASH_REMOVE_##VHELPER(KEY_NAME, aKey)
+//%}
+//%
+//%- (void)removeAll {
+//%DICTIONARY_HASH_REMOVE_ALL_##VHELPER()
+//%}
+
 //
 // Custom Generation for Bool keys
 //
@@ -982,6 +1661,28 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 //%  }
 //%  return (wrapped != NULL);
 //%}
+//%PDDM-DEFINE VALUE_FOR_KEY_HASH_POD(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE)
+//%- (BOOL)get##VALUE_NAME##:(nullable VALUE_TYPE *)value forKey:(KEY_TYPE)key {
+//%  uint64_t *slot = DictMapFind(&_map, DictMapWrap##KEY_NAME(key));
+//%  if (slot && value) {
+//%    *value = DictMapUnwrap##VALUE_NAME(*slot);
+//%  }
+//%  return (slot != NULL);
+//%}
+//%PDDM-DEFINE DICTIONARY_HASH_SET_POD(KEY_NAME, KEY, VALUE_NAME, VALUE)
+//%DictMapSet(&_map, DictMapWrap##KEY_NAME(KEY), DictMapWrap##VALUE_NAME(VALUE));
+//%PDDM-DEFINE DICTIONARY_HASH_SET_SLOT_POD(KEY, SLOT)
+//%DictMapSet(&_map, KEY, SLOT);
+//%PDDM-DEFINE DICTIONARY_HASH_SET_GPBVALUE_POD(KEY_NAME, VALUE_NAME)
+//%  DictMapSet(&_map, DictMapWrap##KEY_NAME(key->value##KEY_NAME), DictMapWrap##VALUE_NAME(value->value##VALUE_NAME));
+//%PDDM-DEFINE DICTIONARY_HASH_REMOVE_POD(KEY_NAME, KEY)
+//%DictMapRemove(&_map, DictMapWrap##KEY_NAME(KEY), NULL);
+//%PDDM-DEFINE DICTIONARY_HASH_REMOVE_ALL_POD()
+//%  DictMapRemoveAll(&_map);
+//%PDDM-DEFINE DICTIONARY_HASH_RETAIN_ALL_POD()
+// Empty
+//%PDDM-DEFINE HASH_EXTRA_METHODS_POD(KEY_NAME, VALUE_NAME)
+// Empty
 //%PDDM-DEFINE WRAPPEDPOD(VALUE)
 //%@(VALUE)
 //%PDDM-DEFINE UNWRAPUInt32(VALUE)
@@ -1183,6 +1884,52 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 //%  VALUE_TYPE result = [_dictionary objectForKey:WRAPPED##KHELPER(key)];
 //%  return result;
 //%}
+//%PDDM-DEFINE VALUE_FOR_KEY_HASH_OBJECT(KEY_NAME, KEY_TYPE, VALUE_NAME, VALUE_TYPE)
+//%- (VALUE_TYPE)objectForKey:(KEY_TYPE)key {
+//%  uint64_t *slot = DictMapFind(&_map, DictMapWrap##KEY_NAME(key));
+//%  return slot ? DictMapUnwrapObject(*slot) : nil;
+//%}
+//%PDDM-DEFINE DICTIONARY_HASH_SET_OBJECT(KEY_NAME, KEY, VALUE_NAME, VALUE)
+//%DictMapSetObject(&_map, DictMapWrap##KEY_NAME(KEY), VALUE);
+//%PDDM-DEFINE DICTIONARY_HASH_SET_SLOT_OBJECT(KEY, SLOT)
+//%DictMapSetObject(&_map, KEY, DictMapUnwrapObject(SLOT));
+//%PDDM-DEFINE DICTIONARY_HASH_SET_GPBVALUE_OBJECT(KEY_NAME, VALUE_NAME)
+//%  DictMapSetObject(&_map, DictMapWrap##KEY_NAME(key->value##KEY_NAME), value->valueString);
+//%PDDM-DEFINE DICTIONARY_HASH_REMOVE_OBJECT(KEY_NAME, KEY)
+//%DictMapRemoveObject(&_map, DictMapWrap##KEY_NAME(KEY));
+//%PDDM-DEFINE DICTIONARY_HASH_REMOVE_ALL_OBJECT()
+//%  DictMapReleaseObjects(&_map);
+//%  DictMapRemoveAll(&_map);
+//%PDDM-DEFINE DICTIONARY_HASH_RETAIN_ALL_OBJECT()
+//%      DictMapRetainObjects(&_map);
+//%
+//%PDDM-DEFINE HASH_EXTRA_METHODS_OBJECT(KEY_NAME, VALUE_NAME)
+//%- (BOOL)isInitialized {
+//%  NSUInteger index = 0;
+//%  uint64_t key, slot;
+//%  while (DictMapNext(&_map, &index, &key, &slot)) {
+//%    GPBMessage *msg = DictMapUnwrapObject(slot);
+//%    if (!msg.initialized) {
+//%      return NO;
+//%    }
+//%  }
+//%  return YES;
+//%}
+//%
+//%- (instancetype)deepCopyWithZone:(NSZone *)zone {
+//%  GPB##KEY_NAME##VALUE_NAME##Dictionary *newDict =
+//%      [[GPB##KEY_NAME##VALUE_NAME##Dictionary alloc] initWithCapacity:DictMapCount(&_map)];
+//%  NSUInteger index = 0;
+//%  uint64_t key, slot;
+//%  while (DictMapNext(&_map, &index, &key, &slot)) {
+//%    GPBMessage *copiedMsg = [DictMapUnwrapObject(slot) copyWithZone:zone];
+//%    DictMapSetObject(&newDict->_map, key, copiedMsg);
+//%    [copiedMsg release];
+//%  }
+//%  return newDict;
+//%}
+//%
+//%
 //%PDDM-DEFINE WRAPPEDOBJECT(VALUE)
 //%VALUE
 //%PDDM-DEFINE UNWRAPString(VALUE)
@@ -1374,7 +2121,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBUInt32UInt32Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -1386,10 +2133,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapUInt32(keys[i]), DictMapWrapUInt32(values[i]));
       }
     }
   }
@@ -1400,21 +2147,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithUInt32s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithUInt32s:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithUInt32s:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -1430,39 +2181,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBUInt32UInt32Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualUInt32(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapUInt32(key))] = @(DictMapUnwrapUInt32(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndUInt32sUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, uint32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedIntValue], [aValue unsignedIntValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapUInt32(key), DictMapUnwrapUInt32(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -1470,12 +2240,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt32FieldSize([aKey unsignedIntValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictUInt32FieldSize([aValue unsignedIntValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictUInt32FieldSize(DictMapUnwrapUInt32(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictUInt32FieldSize(DictMapUnwrapUInt32(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -1488,15 +2257,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint32_t unwrappedKey = [aKey unsignedIntValue];
-    uint32_t unwrappedValue = [aValue unsignedIntValue];
+    uint32_t unwrappedKey = DictMapUnwrapUInt32(key);
+    uint32_t unwrappedValue = DictMapUnwrapUInt32(slot);
     size_t msgSize = ComputeDictUInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictUInt32FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -1508,7 +2275,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueUInt32) forKey:@(key->valueUInt32)];
+  DictMapSet(&_map, DictMapWrapUInt32(key->valueUInt32), DictMapWrapUInt32(value->valueUInt32));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -1518,16 +2285,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getUInt32:(nullable uint32_t *)value forKey:(uint32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped unsignedIntValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt32(key));
+  if (slot && value) {
+    *value = DictMapUnwrapUInt32(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBUInt32UInt32Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -1535,18 +2306,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setUInt32:(uint32_t)value forKey:(uint32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapUInt32(key), DictMapWrapUInt32(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeUInt32ForKey:(uint32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapUInt32(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -1555,7 +2326,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBUInt32Int32Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -1567,10 +2338,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapUInt32(keys[i]), DictMapWrapInt32(values[i]));
       }
     }
   }
@@ -1581,21 +2352,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithInt32s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithInt32s:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithInt32s:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -1611,39 +2386,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBUInt32Int32Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualInt32(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapUInt32(key))] = @(DictMapUnwrapInt32(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndInt32sUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, int32_t value, BOOL *stop))block {
-  BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedIntValue], [aValue intValue], &stop);
+  BOOL stop = NO;
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapUInt32(key), DictMapUnwrapInt32(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -1651,12 +2445,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt32FieldSize([aKey unsignedIntValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictInt32FieldSize([aValue intValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictUInt32FieldSize(DictMapUnwrapUInt32(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictInt32FieldSize(DictMapUnwrapInt32(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -1669,15 +2462,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint32_t unwrappedKey = [aKey unsignedIntValue];
-    int32_t unwrappedValue = [aValue intValue];
+    uint32_t unwrappedKey = DictMapUnwrapUInt32(key);
+    int32_t unwrappedValue = DictMapUnwrapInt32(slot);
     size_t msgSize = ComputeDictUInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictInt32FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -1689,7 +2480,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueInt32) forKey:@(key->valueUInt32)];
+  DictMapSet(&_map, DictMapWrapUInt32(key->valueUInt32), DictMapWrapInt32(value->valueInt32));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -1699,16 +2490,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getInt32:(nullable int32_t *)value forKey:(uint32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped intValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt32(key));
+  if (slot && value) {
+    *value = DictMapUnwrapInt32(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBUInt32Int32Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -1716,18 +2511,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setInt32:(int32_t)value forKey:(uint32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapUInt32(key), DictMapWrapInt32(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeInt32ForKey:(uint32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapUInt32(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -1736,7 +2531,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBUInt32UInt64Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -1748,10 +2543,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapUInt32(keys[i]), DictMapWrapUInt64(values[i]));
       }
     }
   }
@@ -1762,21 +2557,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithUInt64s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithUInt64s:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithUInt64s:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -1792,39 +2591,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBUInt32UInt64Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualUInt64(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapUInt32(key))] = @(DictMapUnwrapUInt64(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndUInt64sUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, uint64_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedIntValue], [aValue unsignedLongLongValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapUInt32(key), DictMapUnwrapUInt64(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -1832,12 +2650,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt32FieldSize([aKey unsignedIntValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictUInt64FieldSize([aValue unsignedLongLongValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictUInt32FieldSize(DictMapUnwrapUInt32(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictUInt64FieldSize(DictMapUnwrapUInt64(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -1850,15 +2667,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint32_t unwrappedKey = [aKey unsignedIntValue];
-    uint64_t unwrappedValue = [aValue unsignedLongLongValue];
+    uint32_t unwrappedKey = DictMapUnwrapUInt32(key);
+    uint64_t unwrappedValue = DictMapUnwrapUInt64(slot);
     size_t msgSize = ComputeDictUInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictUInt64FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -1870,7 +2685,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueUInt64) forKey:@(key->valueUInt32)];
+  DictMapSet(&_map, DictMapWrapUInt32(key->valueUInt32), DictMapWrapUInt64(value->valueUInt64));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -1880,16 +2695,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getUInt64:(nullable uint64_t *)value forKey:(uint32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped unsignedLongLongValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt32(key));
+  if (slot && value) {
+    *value = DictMapUnwrapUInt64(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBUInt32UInt64Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -1897,18 +2716,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setUInt64:(uint64_t)value forKey:(uint32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapUInt32(key), DictMapWrapUInt64(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeUInt64ForKey:(uint32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapUInt32(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -1917,7 +2736,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBUInt32Int64Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -1929,10 +2748,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapUInt32(keys[i]), DictMapWrapInt64(values[i]));
       }
     }
   }
@@ -1943,21 +2762,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithInt64s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithInt64s:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithInt64s:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -1973,39 +2796,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBUInt32Int64Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualInt64(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapUInt32(key))] = @(DictMapUnwrapInt64(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndInt64sUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, int64_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedIntValue], [aValue longLongValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapUInt32(key), DictMapUnwrapInt64(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -2013,12 +2855,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt32FieldSize([aKey unsignedIntValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictInt64FieldSize([aValue longLongValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictUInt32FieldSize(DictMapUnwrapUInt32(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictInt64FieldSize(DictMapUnwrapInt64(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -2031,15 +2872,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint32_t unwrappedKey = [aKey unsignedIntValue];
-    int64_t unwrappedValue = [aValue longLongValue];
+    uint32_t unwrappedKey = DictMapUnwrapUInt32(key);
+    int64_t unwrappedValue = DictMapUnwrapInt64(slot);
     size_t msgSize = ComputeDictUInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictInt64FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -2051,7 +2890,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueInt64) forKey:@(key->valueUInt32)];
+  DictMapSet(&_map, DictMapWrapUInt32(key->valueUInt32), DictMapWrapInt64(value->valueInt64));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -2061,16 +2900,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getInt64:(nullable int64_t *)value forKey:(uint32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped longLongValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt32(key));
+  if (slot && value) {
+    *value = DictMapUnwrapInt64(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBUInt32Int64Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -2078,18 +2921,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setInt64:(int64_t)value forKey:(uint32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapUInt32(key), DictMapWrapInt64(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeInt64ForKey:(uint32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapUInt32(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -2098,7 +2941,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBUInt32BoolDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -2110,10 +2953,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                         count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapUInt32(keys[i]), DictMapWrapBool(values[i]));
       }
     }
   }
@@ -2124,21 +2967,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithBools:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithBools:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithBools:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -2154,39 +3001,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBUInt32BoolDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualBool(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapUInt32(key))] = @(DictMapUnwrapBool(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndBoolsUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, BOOL value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedIntValue], [aValue boolValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapUInt32(key), DictMapUnwrapBool(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -2194,12 +3060,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt32FieldSize([aKey unsignedIntValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictBoolFieldSize([aValue boolValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictUInt32FieldSize(DictMapUnwrapUInt32(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictBoolFieldSize(DictMapUnwrapBool(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -2212,15 +3077,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint32_t unwrappedKey = [aKey unsignedIntValue];
-    BOOL unwrappedValue = [aValue boolValue];
+    uint32_t unwrappedKey = DictMapUnwrapUInt32(key);
+    BOOL unwrappedValue = DictMapUnwrapBool(slot);
     size_t msgSize = ComputeDictUInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictBoolFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -2232,7 +3095,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueBool) forKey:@(key->valueUInt32)];
+  DictMapSet(&_map, DictMapWrapUInt32(key->valueUInt32), DictMapWrapBool(value->valueBool));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -2242,16 +3105,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getBool:(nullable BOOL *)value forKey:(uint32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped boolValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt32(key));
+  if (slot && value) {
+    *value = DictMapUnwrapBool(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBUInt32BoolDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -2259,18 +3126,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setBool:(BOOL)value forKey:(uint32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapUInt32(key), DictMapWrapBool(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeBoolForKey:(uint32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapUInt32(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -2279,7 +3146,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBUInt32FloatDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -2291,10 +3158,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapUInt32(keys[i]), DictMapWrapFloat(values[i]));
       }
     }
   }
@@ -2305,21 +3172,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithFloats:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithFloats:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithFloats:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -2335,39 +3206,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBUInt32FloatDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualFloat(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapUInt32(key))] = @(DictMapUnwrapFloat(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndFloatsUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, float value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedIntValue], [aValue floatValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapUInt32(key), DictMapUnwrapFloat(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -2375,12 +3265,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt32FieldSize([aKey unsignedIntValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictFloatFieldSize([aValue floatValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictUInt32FieldSize(DictMapUnwrapUInt32(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictFloatFieldSize(DictMapUnwrapFloat(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -2393,15 +3282,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint32_t unwrappedKey = [aKey unsignedIntValue];
-    float unwrappedValue = [aValue floatValue];
+    uint32_t unwrappedKey = DictMapUnwrapUInt32(key);
+    float unwrappedValue = DictMapUnwrapFloat(slot);
     size_t msgSize = ComputeDictUInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictFloatFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -2413,7 +3300,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueFloat) forKey:@(key->valueUInt32)];
+  DictMapSet(&_map, DictMapWrapUInt32(key->valueUInt32), DictMapWrapFloat(value->valueFloat));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -2423,16 +3310,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getFloat:(nullable float *)value forKey:(uint32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped floatValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt32(key));
+  if (slot && value) {
+    *value = DictMapUnwrapFloat(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBUInt32FloatDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -2440,18 +3331,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setFloat:(float)value forKey:(uint32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapUInt32(key), DictMapWrapFloat(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeFloatForKey:(uint32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapUInt32(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -2460,7 +3351,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBUInt32DoubleDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -2472,10 +3363,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapUInt32(keys[i]), DictMapWrapDouble(values[i]));
       }
     }
   }
@@ -2486,21 +3377,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithDoubles:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithDoubles:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithDoubles:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -2516,39 +3411,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBUInt32DoubleDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualDouble(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapUInt32(key))] = @(DictMapUnwrapDouble(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndDoublesUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, double value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedIntValue], [aValue doubleValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapUInt32(key), DictMapUnwrapDouble(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -2556,12 +3470,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt32FieldSize([aKey unsignedIntValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictDoubleFieldSize([aValue doubleValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictUInt32FieldSize(DictMapUnwrapUInt32(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictDoubleFieldSize(DictMapUnwrapDouble(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -2574,15 +3487,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint32_t unwrappedKey = [aKey unsignedIntValue];
-    double unwrappedValue = [aValue doubleValue];
+    uint32_t unwrappedKey = DictMapUnwrapUInt32(key);
+    double unwrappedValue = DictMapUnwrapDouble(slot);
     size_t msgSize = ComputeDictUInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictDoubleFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -2594,7 +3505,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueDouble) forKey:@(key->valueUInt32)];
+  DictMapSet(&_map, DictMapWrapUInt32(key->valueUInt32), DictMapWrapDouble(value->valueDouble));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -2604,16 +3515,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getDouble:(nullable double *)value forKey:(uint32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped doubleValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt32(key));
+  if (slot && value) {
+    *value = DictMapUnwrapDouble(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBUInt32DoubleDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -2621,18 +3536,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setDouble:(double)value forKey:(uint32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapUInt32(key), DictMapWrapDouble(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeDoubleForKey:(uint32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapUInt32(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -2641,7 +3556,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBUInt32EnumDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
   GPBEnumValidationFunc _validationFunc;
 }
 
@@ -2661,11 +3576,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                                      count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     _validationFunc = (func != NULL ? func : DictDefault_IsValidValue);
     if (count && rawValues && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(rawValues[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapUInt32(keys[i]), DictMapWrapEnum(rawValues[i]));
       }
     }
   }
@@ -2679,22 +3594,26 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                                     count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithValidationFunction:(GPBEnumValidationFunc)func
-                                  capacity:(__unused NSUInteger)numItems {
-  return [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+                                  capacity:(NSUInteger)numItems {
+  self = [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -2710,39 +3629,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBUInt32EnumDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualEnum(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapUInt32(key))] = @(DictMapUnwrapEnum(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndRawValuesUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, int32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedIntValue], [aValue intValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapUInt32(key), DictMapUnwrapEnum(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -2750,12 +3688,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt32FieldSize([aKey unsignedIntValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictEnumFieldSize([aValue intValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictUInt32FieldSize(DictMapUnwrapUInt32(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictEnumFieldSize(DictMapUnwrapEnum(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -2768,15 +3705,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint32_t unwrappedKey = [aKey unsignedIntValue];
-    int32_t unwrappedValue = [aValue intValue];
+    uint32_t unwrappedKey = DictMapUnwrapUInt32(key);
+    int32_t unwrappedValue = DictMapUnwrapEnum(slot);
     size_t msgSize = ComputeDictUInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictEnumFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -2801,7 +3736,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueEnum) forKey:@(key->valueUInt32)];
+  DictMapSet(&_map, DictMapWrapUInt32(key->valueUInt32), DictMapWrapEnum(value->valueEnum));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -2811,47 +3746,52 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getEnum:(int32_t *)value forKey:(uint32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    int32_t result = [wrapped intValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt32(key));
+  if (slot && value) {
+    int32_t result = DictMapUnwrapEnum(*slot);
     if (!_validationFunc(result)) {
       result = kGPBUnrecognizedEnumeratorValue;
     }
     *value = result;
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (BOOL)getRawValue:(int32_t *)rawValue forKey:(uint32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && rawValue) {
-    *rawValue = [wrapped intValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt32(key));
+  if (slot && rawValue) {
+    *rawValue = DictMapUnwrapEnum(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)enumerateKeysAndEnumsUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, int32_t value, BOOL *stop))block {
   GPBEnumValidationFunc func = _validationFunc;
   BOOL stop = NO;
-  NSEnumerator *keys = [_dictionary keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = _dictionary[aKey];
-      int32_t unwrapped = [aValue intValue];
-      if (!func(unwrapped)) {
-        unwrapped = kGPBUnrecognizedEnumeratorValue;
-      }
-    block([aKey unsignedIntValue], unwrapped, &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    int32_t unwrapped = DictMapUnwrapEnum(slot);
+    if (!func(unwrapped)) {
+      unwrapped = kGPBUnrecognizedEnumeratorValue;
+    }
+    block(DictMapUnwrapUInt32(key), unwrapped, &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (void)addRawEntriesFromDictionary:(GPBUInt32EnumDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -2859,18 +3799,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setRawValue:(int32_t)value forKey:(uint32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapUInt32(key), DictMapWrapEnum(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeEnumForKey:(uint32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapUInt32(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 - (void)setEnum:(int32_t)value forKey:(uint32_t)key {
@@ -2880,7 +3820,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                        value];
   }
 
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapUInt32(key), DictMapWrapEnum(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
@@ -2892,7 +3832,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBUInt32ObjectDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -2904,14 +3844,14 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && objects && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
         if (!objects[i]) {
           [NSException raise:NSInvalidArgumentException
                       format:@"Attempting to add nil object to a Dictionary"];
         }
-        [_dictionary setObject:objects[i] forKey:@(keys[i])];
+        DictMapSetObject(&_map, DictMapWrapUInt32(keys[i]), objects[i]);
       }
     }
   }
@@ -2922,21 +3862,27 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithObjects:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
+      DictMapRetainObjects(&_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithObjects:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithObjects:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapReleaseObjects(&_map);
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -2952,38 +3898,61 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBUInt32ObjectDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualObject(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapUInt32(key))] = DictMapUnwrapObject(slot);
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndObjectsUsingBlock:
     (void (NS_NOESCAPE ^)(uint32_t key, id object, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    id aObject = internal[aKey];
-    block([aKey unsignedIntValue], aObject, &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapUInt32(key), DictMapUnwrapObject(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (BOOL)isInitialized {
-  for (GPBMessage *msg in [_dictionary objectEnumerator]) {
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    GPBMessage *msg = DictMapUnwrapObject(slot);
     if (!msg.initialized) {
       return NO;
     }
@@ -2993,22 +3962,19 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (instancetype)deepCopyWithZone:(NSZone *)zone {
   GPBUInt32ObjectDictionary *newDict =
-      [[GPBUInt32ObjectDictionary alloc] init];
-  NSEnumerator *keys = [_dictionary keyEnumerator];
-  id aKey;
-  NSMutableDictionary *internalDict = newDict->_dictionary;
-  while ((aKey = [keys nextObject])) {
-    GPBMessage *msg = _dictionary[aKey];
-    GPBMessage *copiedMsg = [msg copyWithZone:zone];
-    [internalDict setObject:copiedMsg forKey:aKey];
+      [[GPBUInt32ObjectDictionary alloc] initWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    GPBMessage *copiedMsg = [DictMapUnwrapObject(slot) copyWithZone:zone];
+    DictMapSetObject(&newDict->_map, key, copiedMsg);
     [copiedMsg release];
   }
   return newDict;
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -3016,12 +3982,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    id aObject = internal[aKey];
-    size_t msgSize = ComputeDictUInt32FieldSize([aKey unsignedIntValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictObjectFieldSize(aObject, kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictUInt32FieldSize(DictMapUnwrapUInt32(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictObjectFieldSize(DictMapUnwrapObject(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -3034,15 +3999,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    id aObject = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint32_t unwrappedKey = [aKey unsignedIntValue];
-    id unwrappedValue = aObject;
+    uint32_t unwrappedKey = DictMapUnwrapUInt32(key);
+    id unwrappedValue = DictMapUnwrapObject(slot);
     size_t msgSize = ComputeDictUInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictObjectFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -3054,7 +4017,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:value->valueString forKey:@(key->valueUInt32)];
+  DictMapSetObject(&_map, DictMapWrapUInt32(key->valueUInt32), value->valueString);
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -3064,13 +4027,17 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (id)objectForKey:(uint32_t)key {
-  id result = [_dictionary objectForKey:@(key)];
-  return result;
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt32(key));
+  return slot ? DictMapUnwrapObject(*slot) : nil;
 }
 
 - (void)addEntriesFromDictionary:(GPBUInt32ObjectDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSetObject(&_map, key, DictMapUnwrapObject(slot));
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -3082,18 +4049,19 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     [NSException raise:NSInvalidArgumentException
                 format:@"Attempting to add nil object to a Dictionary"];
   }
-  [_dictionary setObject:object forKey:@(key)];
+  DictMapSetObject(&_map, DictMapWrapUInt32(key), object);
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeObjectForKey:(uint32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemoveObject(&_map, DictMapWrapUInt32(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapReleaseObjects(&_map);
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -3105,7 +4073,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBInt32UInt32Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -3117,10 +4085,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapInt32(keys[i]), DictMapWrapUInt32(values[i]));
       }
     }
   }
@@ -3131,21 +4099,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithUInt32s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithUInt32s:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithUInt32s:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -3161,39 +4133,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBInt32UInt32Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualUInt32(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapInt32(key))] = @(DictMapUnwrapUInt32(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndUInt32sUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, uint32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey intValue], [aValue unsignedIntValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapInt32(key), DictMapUnwrapUInt32(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -3201,12 +4192,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt32FieldSize([aKey intValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictUInt32FieldSize([aValue unsignedIntValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictInt32FieldSize(DictMapUnwrapInt32(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictUInt32FieldSize(DictMapUnwrapUInt32(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -3219,15 +4209,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int32_t unwrappedKey = [aKey intValue];
-    uint32_t unwrappedValue = [aValue unsignedIntValue];
+    int32_t unwrappedKey = DictMapUnwrapInt32(key);
+    uint32_t unwrappedValue = DictMapUnwrapUInt32(slot);
     size_t msgSize = ComputeDictInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictUInt32FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -3239,7 +4227,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueUInt32) forKey:@(key->valueInt32)];
+  DictMapSet(&_map, DictMapWrapInt32(key->valueInt32), DictMapWrapUInt32(value->valueUInt32));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -3249,16 +4237,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getUInt32:(nullable uint32_t *)value forKey:(int32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped unsignedIntValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt32(key));
+  if (slot && value) {
+    *value = DictMapUnwrapUInt32(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBInt32UInt32Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -3266,18 +4258,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setUInt32:(uint32_t)value forKey:(int32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapInt32(key), DictMapWrapUInt32(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeUInt32ForKey:(int32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapInt32(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -3286,7 +4278,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBInt32Int32Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -3298,10 +4290,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapInt32(keys[i]), DictMapWrapInt32(values[i]));
       }
     }
   }
@@ -3312,21 +4304,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithInt32s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithInt32s:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithInt32s:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -3342,39 +4338,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBInt32Int32Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualInt32(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapInt32(key))] = @(DictMapUnwrapInt32(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndInt32sUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, int32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey intValue], [aValue intValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapInt32(key), DictMapUnwrapInt32(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -3382,12 +4397,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt32FieldSize([aKey intValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictInt32FieldSize([aValue intValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictInt32FieldSize(DictMapUnwrapInt32(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictInt32FieldSize(DictMapUnwrapInt32(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -3400,15 +4414,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int32_t unwrappedKey = [aKey intValue];
-    int32_t unwrappedValue = [aValue intValue];
+    int32_t unwrappedKey = DictMapUnwrapInt32(key);
+    int32_t unwrappedValue = DictMapUnwrapInt32(slot);
     size_t msgSize = ComputeDictInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictInt32FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -3420,7 +4432,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueInt32) forKey:@(key->valueInt32)];
+  DictMapSet(&_map, DictMapWrapInt32(key->valueInt32), DictMapWrapInt32(value->valueInt32));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -3430,16 +4442,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getInt32:(nullable int32_t *)value forKey:(int32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped intValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt32(key));
+  if (slot && value) {
+    *value = DictMapUnwrapInt32(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBInt32Int32Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -3447,18 +4463,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setInt32:(int32_t)value forKey:(int32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapInt32(key), DictMapWrapInt32(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeInt32ForKey:(int32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapInt32(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -3467,7 +4483,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBInt32UInt64Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -3479,10 +4495,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapInt32(keys[i]), DictMapWrapUInt64(values[i]));
       }
     }
   }
@@ -3493,21 +4509,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithUInt64s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithUInt64s:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithUInt64s:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -3523,39 +4543,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBInt32UInt64Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualUInt64(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapInt32(key))] = @(DictMapUnwrapUInt64(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndUInt64sUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, uint64_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey intValue], [aValue unsignedLongLongValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapInt32(key), DictMapUnwrapUInt64(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -3563,12 +4602,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt32FieldSize([aKey intValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictUInt64FieldSize([aValue unsignedLongLongValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictInt32FieldSize(DictMapUnwrapInt32(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictUInt64FieldSize(DictMapUnwrapUInt64(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -3581,15 +4619,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int32_t unwrappedKey = [aKey intValue];
-    uint64_t unwrappedValue = [aValue unsignedLongLongValue];
+    int32_t unwrappedKey = DictMapUnwrapInt32(key);
+    uint64_t unwrappedValue = DictMapUnwrapUInt64(slot);
     size_t msgSize = ComputeDictInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictUInt64FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -3601,7 +4637,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueUInt64) forKey:@(key->valueInt32)];
+  DictMapSet(&_map, DictMapWrapInt32(key->valueInt32), DictMapWrapUInt64(value->valueUInt64));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -3611,16 +4647,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getUInt64:(nullable uint64_t *)value forKey:(int32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped unsignedLongLongValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt32(key));
+  if (slot && value) {
+    *value = DictMapUnwrapUInt64(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBInt32UInt64Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -3628,18 +4668,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setUInt64:(uint64_t)value forKey:(int32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapInt32(key), DictMapWrapUInt64(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeUInt64ForKey:(int32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapInt32(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -3648,7 +4688,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBInt32Int64Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -3660,10 +4700,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapInt32(keys[i]), DictMapWrapInt64(values[i]));
       }
     }
   }
@@ -3674,21 +4714,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithInt64s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithInt64s:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithInt64s:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -3704,39 +4748,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBInt32Int64Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualInt64(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapInt32(key))] = @(DictMapUnwrapInt64(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndInt64sUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, int64_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey intValue], [aValue longLongValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapInt32(key), DictMapUnwrapInt64(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -3744,12 +4807,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt32FieldSize([aKey intValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictInt64FieldSize([aValue longLongValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictInt32FieldSize(DictMapUnwrapInt32(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictInt64FieldSize(DictMapUnwrapInt64(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -3762,15 +4824,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int32_t unwrappedKey = [aKey intValue];
-    int64_t unwrappedValue = [aValue longLongValue];
+    int32_t unwrappedKey = DictMapUnwrapInt32(key);
+    int64_t unwrappedValue = DictMapUnwrapInt64(slot);
     size_t msgSize = ComputeDictInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictInt64FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -3782,7 +4842,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueInt64) forKey:@(key->valueInt32)];
+  DictMapSet(&_map, DictMapWrapInt32(key->valueInt32), DictMapWrapInt64(value->valueInt64));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -3792,16 +4852,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getInt64:(nullable int64_t *)value forKey:(int32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped longLongValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt32(key));
+  if (slot && value) {
+    *value = DictMapUnwrapInt64(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBInt32Int64Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -3809,18 +4873,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setInt64:(int64_t)value forKey:(int32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapInt32(key), DictMapWrapInt64(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeInt64ForKey:(int32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapInt32(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -3829,7 +4893,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBInt32BoolDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -3841,10 +4905,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                         count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapInt32(keys[i]), DictMapWrapBool(values[i]));
       }
     }
   }
@@ -3855,21 +4919,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithBools:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithBools:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithBools:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -3885,39 +4953,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBInt32BoolDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualBool(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapInt32(key))] = @(DictMapUnwrapBool(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndBoolsUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, BOOL value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey intValue], [aValue boolValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapInt32(key), DictMapUnwrapBool(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -3925,12 +5012,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt32FieldSize([aKey intValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictBoolFieldSize([aValue boolValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictInt32FieldSize(DictMapUnwrapInt32(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictBoolFieldSize(DictMapUnwrapBool(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -3943,15 +5029,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int32_t unwrappedKey = [aKey intValue];
-    BOOL unwrappedValue = [aValue boolValue];
+    int32_t unwrappedKey = DictMapUnwrapInt32(key);
+    BOOL unwrappedValue = DictMapUnwrapBool(slot);
     size_t msgSize = ComputeDictInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictBoolFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -3963,7 +5047,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueBool) forKey:@(key->valueInt32)];
+  DictMapSet(&_map, DictMapWrapInt32(key->valueInt32), DictMapWrapBool(value->valueBool));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -3973,16 +5057,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getBool:(nullable BOOL *)value forKey:(int32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped boolValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt32(key));
+  if (slot && value) {
+    *value = DictMapUnwrapBool(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBInt32BoolDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -3990,18 +5078,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setBool:(BOOL)value forKey:(int32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapInt32(key), DictMapWrapBool(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeBoolForKey:(int32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapInt32(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -4010,7 +5098,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBInt32FloatDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -4022,10 +5110,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapInt32(keys[i]), DictMapWrapFloat(values[i]));
       }
     }
   }
@@ -4036,21 +5124,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithFloats:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithFloats:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithFloats:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -4066,39 +5158,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBInt32FloatDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualFloat(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapInt32(key))] = @(DictMapUnwrapFloat(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndFloatsUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, float value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey intValue], [aValue floatValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapInt32(key), DictMapUnwrapFloat(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -4106,12 +5217,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt32FieldSize([aKey intValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictFloatFieldSize([aValue floatValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictInt32FieldSize(DictMapUnwrapInt32(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictFloatFieldSize(DictMapUnwrapFloat(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -4124,15 +5234,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int32_t unwrappedKey = [aKey intValue];
-    float unwrappedValue = [aValue floatValue];
+    int32_t unwrappedKey = DictMapUnwrapInt32(key);
+    float unwrappedValue = DictMapUnwrapFloat(slot);
     size_t msgSize = ComputeDictInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictFloatFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -4144,7 +5252,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueFloat) forKey:@(key->valueInt32)];
+  DictMapSet(&_map, DictMapWrapInt32(key->valueInt32), DictMapWrapFloat(value->valueFloat));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -4154,16 +5262,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getFloat:(nullable float *)value forKey:(int32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped floatValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt32(key));
+  if (slot && value) {
+    *value = DictMapUnwrapFloat(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBInt32FloatDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -4171,18 +5283,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setFloat:(float)value forKey:(int32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapInt32(key), DictMapWrapFloat(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeFloatForKey:(int32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapInt32(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -4191,7 +5303,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBInt32DoubleDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -4203,10 +5315,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapInt32(keys[i]), DictMapWrapDouble(values[i]));
       }
     }
   }
@@ -4217,21 +5329,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithDoubles:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithDoubles:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithDoubles:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -4247,39 +5363,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBInt32DoubleDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualDouble(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapInt32(key))] = @(DictMapUnwrapDouble(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndDoublesUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, double value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey intValue], [aValue doubleValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapInt32(key), DictMapUnwrapDouble(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -4287,12 +5422,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt32FieldSize([aKey intValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictDoubleFieldSize([aValue doubleValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictInt32FieldSize(DictMapUnwrapInt32(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictDoubleFieldSize(DictMapUnwrapDouble(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -4305,15 +5439,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int32_t unwrappedKey = [aKey intValue];
-    double unwrappedValue = [aValue doubleValue];
+    int32_t unwrappedKey = DictMapUnwrapInt32(key);
+    double unwrappedValue = DictMapUnwrapDouble(slot);
     size_t msgSize = ComputeDictInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictDoubleFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -4325,7 +5457,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueDouble) forKey:@(key->valueInt32)];
+  DictMapSet(&_map, DictMapWrapInt32(key->valueInt32), DictMapWrapDouble(value->valueDouble));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -4335,16 +5467,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getDouble:(nullable double *)value forKey:(int32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped doubleValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt32(key));
+  if (slot && value) {
+    *value = DictMapUnwrapDouble(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBInt32DoubleDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -4352,18 +5488,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setDouble:(double)value forKey:(int32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapInt32(key), DictMapWrapDouble(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeDoubleForKey:(int32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapInt32(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -4372,7 +5508,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBInt32EnumDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
   GPBEnumValidationFunc _validationFunc;
 }
 
@@ -4392,11 +5528,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                                      count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     _validationFunc = (func != NULL ? func : DictDefault_IsValidValue);
     if (count && rawValues && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(rawValues[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapInt32(keys[i]), DictMapWrapEnum(rawValues[i]));
       }
     }
   }
@@ -4410,22 +5546,26 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                                     count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithValidationFunction:(GPBEnumValidationFunc)func
-                                  capacity:(__unused NSUInteger)numItems {
-  return [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+                                  capacity:(NSUInteger)numItems {
+  self = [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -4441,39 +5581,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBInt32EnumDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualEnum(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapInt32(key))] = @(DictMapUnwrapEnum(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndRawValuesUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, int32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey intValue], [aValue intValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapInt32(key), DictMapUnwrapEnum(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -4481,12 +5640,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt32FieldSize([aKey intValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictEnumFieldSize([aValue intValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictInt32FieldSize(DictMapUnwrapInt32(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictEnumFieldSize(DictMapUnwrapEnum(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -4499,15 +5657,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int32_t unwrappedKey = [aKey intValue];
-    int32_t unwrappedValue = [aValue intValue];
+    int32_t unwrappedKey = DictMapUnwrapInt32(key);
+    int32_t unwrappedValue = DictMapUnwrapEnum(slot);
     size_t msgSize = ComputeDictInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictEnumFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -4532,7 +5688,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueEnum) forKey:@(key->valueInt32)];
+  DictMapSet(&_map, DictMapWrapInt32(key->valueInt32), DictMapWrapEnum(value->valueEnum));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -4542,47 +5698,52 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getEnum:(int32_t *)value forKey:(int32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    int32_t result = [wrapped intValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt32(key));
+  if (slot && value) {
+    int32_t result = DictMapUnwrapEnum(*slot);
     if (!_validationFunc(result)) {
       result = kGPBUnrecognizedEnumeratorValue;
     }
     *value = result;
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (BOOL)getRawValue:(int32_t *)rawValue forKey:(int32_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && rawValue) {
-    *rawValue = [wrapped intValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt32(key));
+  if (slot && rawValue) {
+    *rawValue = DictMapUnwrapEnum(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)enumerateKeysAndEnumsUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, int32_t value, BOOL *stop))block {
   GPBEnumValidationFunc func = _validationFunc;
   BOOL stop = NO;
-  NSEnumerator *keys = [_dictionary keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = _dictionary[aKey];
-      int32_t unwrapped = [aValue intValue];
-      if (!func(unwrapped)) {
-        unwrapped = kGPBUnrecognizedEnumeratorValue;
-      }
-    block([aKey intValue], unwrapped, &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    int32_t unwrapped = DictMapUnwrapEnum(slot);
+    if (!func(unwrapped)) {
+      unwrapped = kGPBUnrecognizedEnumeratorValue;
+    }
+    block(DictMapUnwrapInt32(key), unwrapped, &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (void)addRawEntriesFromDictionary:(GPBInt32EnumDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -4590,18 +5751,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setRawValue:(int32_t)value forKey:(int32_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapInt32(key), DictMapWrapEnum(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeEnumForKey:(int32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapInt32(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 - (void)setEnum:(int32_t)value forKey:(int32_t)key {
@@ -4611,7 +5772,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                        value];
   }
 
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapInt32(key), DictMapWrapEnum(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
@@ -4623,7 +5784,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBInt32ObjectDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -4635,14 +5796,14 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && objects && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
         if (!objects[i]) {
           [NSException raise:NSInvalidArgumentException
                       format:@"Attempting to add nil object to a Dictionary"];
         }
-        [_dictionary setObject:objects[i] forKey:@(keys[i])];
+        DictMapSetObject(&_map, DictMapWrapInt32(keys[i]), objects[i]);
       }
     }
   }
@@ -4653,21 +5814,27 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithObjects:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
+      DictMapRetainObjects(&_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithObjects:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithObjects:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapReleaseObjects(&_map);
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -4683,38 +5850,61 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBInt32ObjectDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualObject(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapInt32(key))] = DictMapUnwrapObject(slot);
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndObjectsUsingBlock:
     (void (NS_NOESCAPE ^)(int32_t key, id object, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    id aObject = internal[aKey];
-    block([aKey intValue], aObject, &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapInt32(key), DictMapUnwrapObject(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (BOOL)isInitialized {
-  for (GPBMessage *msg in [_dictionary objectEnumerator]) {
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    GPBMessage *msg = DictMapUnwrapObject(slot);
     if (!msg.initialized) {
       return NO;
     }
@@ -4724,22 +5914,19 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (instancetype)deepCopyWithZone:(NSZone *)zone {
   GPBInt32ObjectDictionary *newDict =
-      [[GPBInt32ObjectDictionary alloc] init];
-  NSEnumerator *keys = [_dictionary keyEnumerator];
-  id aKey;
-  NSMutableDictionary *internalDict = newDict->_dictionary;
-  while ((aKey = [keys nextObject])) {
-    GPBMessage *msg = _dictionary[aKey];
-    GPBMessage *copiedMsg = [msg copyWithZone:zone];
-    [internalDict setObject:copiedMsg forKey:aKey];
+      [[GPBInt32ObjectDictionary alloc] initWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    GPBMessage *copiedMsg = [DictMapUnwrapObject(slot) copyWithZone:zone];
+    DictMapSetObject(&newDict->_map, key, copiedMsg);
     [copiedMsg release];
   }
   return newDict;
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -4747,12 +5934,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    id aObject = internal[aKey];
-    size_t msgSize = ComputeDictInt32FieldSize([aKey intValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictObjectFieldSize(aObject, kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictInt32FieldSize(DictMapUnwrapInt32(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictObjectFieldSize(DictMapUnwrapObject(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -4765,15 +5951,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    id aObject = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int32_t unwrappedKey = [aKey intValue];
-    id unwrappedValue = aObject;
+    int32_t unwrappedKey = DictMapUnwrapInt32(key);
+    id unwrappedValue = DictMapUnwrapObject(slot);
     size_t msgSize = ComputeDictInt32FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictObjectFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -4785,7 +5969,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:value->valueString forKey:@(key->valueInt32)];
+  DictMapSetObject(&_map, DictMapWrapInt32(key->valueInt32), value->valueString);
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -4795,13 +5979,17 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (id)objectForKey:(int32_t)key {
-  id result = [_dictionary objectForKey:@(key)];
-  return result;
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt32(key));
+  return slot ? DictMapUnwrapObject(*slot) : nil;
 }
 
 - (void)addEntriesFromDictionary:(GPBInt32ObjectDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSetObject(&_map, key, DictMapUnwrapObject(slot));
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -4813,18 +6001,19 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     [NSException raise:NSInvalidArgumentException
                 format:@"Attempting to add nil object to a Dictionary"];
   }
-  [_dictionary setObject:object forKey:@(key)];
+  DictMapSetObject(&_map, DictMapWrapInt32(key), object);
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeObjectForKey:(int32_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemoveObject(&_map, DictMapWrapInt32(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapReleaseObjects(&_map);
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -4836,7 +6025,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBUInt64UInt32Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -4848,10 +6037,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapUInt64(keys[i]), DictMapWrapUInt32(values[i]));
       }
     }
   }
@@ -4862,21 +6051,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithUInt32s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithUInt32s:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithUInt32s:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -4892,39 +6085,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBUInt64UInt32Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualUInt32(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapUInt64(key))] = @(DictMapUnwrapUInt32(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndUInt32sUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, uint32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedLongLongValue], [aValue unsignedIntValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapUInt64(key), DictMapUnwrapUInt32(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -4932,12 +6144,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt64FieldSize([aKey unsignedLongLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictUInt32FieldSize([aValue unsignedIntValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictUInt64FieldSize(DictMapUnwrapUInt64(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictUInt32FieldSize(DictMapUnwrapUInt32(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -4949,16 +6160,14 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                          asField:(GPBFieldDescriptor *)field {
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
-  uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint64_t unwrappedKey = [aKey unsignedLongLongValue];
-    uint32_t unwrappedValue = [aValue unsignedIntValue];
+    uint64_t unwrappedKey = DictMapUnwrapUInt64(key);
+    uint32_t unwrappedValue = DictMapUnwrapUInt32(slot);
     size_t msgSize = ComputeDictUInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictUInt32FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -4970,7 +6179,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueUInt32) forKey:@(key->valueUInt64)];
+  DictMapSet(&_map, DictMapWrapUInt64(key->valueUInt64), DictMapWrapUInt32(value->valueUInt32));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -4980,16 +6189,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getUInt32:(nullable uint32_t *)value forKey:(uint64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped unsignedIntValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt64(key));
+  if (slot && value) {
+    *value = DictMapUnwrapUInt32(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBUInt64UInt32Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -4997,18 +6210,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setUInt32:(uint32_t)value forKey:(uint64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapUInt64(key), DictMapWrapUInt32(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeUInt32ForKey:(uint64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapUInt64(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -5017,7 +6230,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBUInt64Int32Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -5029,10 +6242,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapUInt64(keys[i]), DictMapWrapInt32(values[i]));
       }
     }
   }
@@ -5043,21 +6256,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithInt32s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithInt32s:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithInt32s:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -5073,39 +6290,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBUInt64Int32Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualInt32(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapUInt64(key))] = @(DictMapUnwrapInt32(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndInt32sUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, int32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedLongLongValue], [aValue intValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapUInt64(key), DictMapUnwrapInt32(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -5113,12 +6349,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt64FieldSize([aKey unsignedLongLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictInt32FieldSize([aValue intValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictUInt64FieldSize(DictMapUnwrapUInt64(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictInt32FieldSize(DictMapUnwrapInt32(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -5131,15 +6366,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint64_t unwrappedKey = [aKey unsignedLongLongValue];
-    int32_t unwrappedValue = [aValue intValue];
+    uint64_t unwrappedKey = DictMapUnwrapUInt64(key);
+    int32_t unwrappedValue = DictMapUnwrapInt32(slot);
     size_t msgSize = ComputeDictUInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictInt32FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -5151,7 +6384,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueInt32) forKey:@(key->valueUInt64)];
+  DictMapSet(&_map, DictMapWrapUInt64(key->valueUInt64), DictMapWrapInt32(value->valueInt32));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -5161,16 +6394,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getInt32:(nullable int32_t *)value forKey:(uint64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped intValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt64(key));
+  if (slot && value) {
+    *value = DictMapUnwrapInt32(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBUInt64Int32Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -5178,18 +6415,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setInt32:(int32_t)value forKey:(uint64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapUInt64(key), DictMapWrapInt32(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeInt32ForKey:(uint64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapUInt64(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -5198,7 +6435,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBUInt64UInt64Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -5210,10 +6447,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapUInt64(keys[i]), DictMapWrapUInt64(values[i]));
       }
     }
   }
@@ -5224,21 +6461,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithUInt64s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithUInt64s:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithUInt64s:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -5254,39 +6495,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBUInt64UInt64Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualUInt64(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapUInt64(key))] = @(DictMapUnwrapUInt64(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndUInt64sUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, uint64_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedLongLongValue], [aValue unsignedLongLongValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapUInt64(key), DictMapUnwrapUInt64(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -5294,12 +6554,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt64FieldSize([aKey unsignedLongLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictUInt64FieldSize([aValue unsignedLongLongValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictUInt64FieldSize(DictMapUnwrapUInt64(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictUInt64FieldSize(DictMapUnwrapUInt64(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -5312,15 +6571,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint64_t unwrappedKey = [aKey unsignedLongLongValue];
-    uint64_t unwrappedValue = [aValue unsignedLongLongValue];
+    uint64_t unwrappedKey = DictMapUnwrapUInt64(key);
+    uint64_t unwrappedValue = DictMapUnwrapUInt64(slot);
     size_t msgSize = ComputeDictUInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictUInt64FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -5332,7 +6589,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueUInt64) forKey:@(key->valueUInt64)];
+  DictMapSet(&_map, DictMapWrapUInt64(key->valueUInt64), DictMapWrapUInt64(value->valueUInt64));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -5342,16 +6599,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getUInt64:(nullable uint64_t *)value forKey:(uint64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped unsignedLongLongValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt64(key));
+  if (slot && value) {
+    *value = DictMapUnwrapUInt64(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBUInt64UInt64Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -5359,18 +6620,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setUInt64:(uint64_t)value forKey:(uint64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapUInt64(key), DictMapWrapUInt64(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeUInt64ForKey:(uint64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapUInt64(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -5379,7 +6640,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBUInt64Int64Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -5391,10 +6652,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapUInt64(keys[i]), DictMapWrapInt64(values[i]));
       }
     }
   }
@@ -5405,21 +6666,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithInt64s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithInt64s:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithInt64s:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -5435,39 +6700,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBUInt64Int64Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualInt64(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapUInt64(key))] = @(DictMapUnwrapInt64(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndInt64sUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, int64_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedLongLongValue], [aValue longLongValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapUInt64(key), DictMapUnwrapInt64(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -5475,12 +6759,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt64FieldSize([aKey unsignedLongLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictInt64FieldSize([aValue longLongValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictUInt64FieldSize(DictMapUnwrapUInt64(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictInt64FieldSize(DictMapUnwrapInt64(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -5493,15 +6776,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint64_t unwrappedKey = [aKey unsignedLongLongValue];
-    int64_t unwrappedValue = [aValue longLongValue];
+    uint64_t unwrappedKey = DictMapUnwrapUInt64(key);
+    int64_t unwrappedValue = DictMapUnwrapInt64(slot);
     size_t msgSize = ComputeDictUInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictInt64FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -5513,7 +6794,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueInt64) forKey:@(key->valueUInt64)];
+  DictMapSet(&_map, DictMapWrapUInt64(key->valueUInt64), DictMapWrapInt64(value->valueInt64));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -5523,16 +6804,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getInt64:(nullable int64_t *)value forKey:(uint64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped longLongValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt64(key));
+  if (slot && value) {
+    *value = DictMapUnwrapInt64(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBUInt64Int64Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -5540,18 +6825,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setInt64:(int64_t)value forKey:(uint64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapUInt64(key), DictMapWrapInt64(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeInt64ForKey:(uint64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapUInt64(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -5560,7 +6845,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBUInt64BoolDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -5572,10 +6857,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                         count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapUInt64(keys[i]), DictMapWrapBool(values[i]));
       }
     }
   }
@@ -5586,21 +6871,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithBools:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithBools:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithBools:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -5616,39 +6905,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBUInt64BoolDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualBool(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapUInt64(key))] = @(DictMapUnwrapBool(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndBoolsUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, BOOL value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedLongLongValue], [aValue boolValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapUInt64(key), DictMapUnwrapBool(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -5656,12 +6964,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt64FieldSize([aKey unsignedLongLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictBoolFieldSize([aValue boolValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictUInt64FieldSize(DictMapUnwrapUInt64(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictBoolFieldSize(DictMapUnwrapBool(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -5674,15 +6981,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint64_t unwrappedKey = [aKey unsignedLongLongValue];
-    BOOL unwrappedValue = [aValue boolValue];
+    uint64_t unwrappedKey = DictMapUnwrapUInt64(key);
+    BOOL unwrappedValue = DictMapUnwrapBool(slot);
     size_t msgSize = ComputeDictUInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictBoolFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -5694,7 +6999,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueBool) forKey:@(key->valueUInt64)];
+  DictMapSet(&_map, DictMapWrapUInt64(key->valueUInt64), DictMapWrapBool(value->valueBool));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -5704,16 +7009,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getBool:(nullable BOOL *)value forKey:(uint64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped boolValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt64(key));
+  if (slot && value) {
+    *value = DictMapUnwrapBool(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBUInt64BoolDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -5721,18 +7030,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setBool:(BOOL)value forKey:(uint64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapUInt64(key), DictMapWrapBool(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeBoolForKey:(uint64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapUInt64(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -5741,7 +7050,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBUInt64FloatDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -5753,10 +7062,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapUInt64(keys[i]), DictMapWrapFloat(values[i]));
       }
     }
   }
@@ -5767,21 +7076,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithFloats:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithFloats:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithFloats:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -5797,39 +7110,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBUInt64FloatDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualFloat(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapUInt64(key))] = @(DictMapUnwrapFloat(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndFloatsUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, float value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedLongLongValue], [aValue floatValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapUInt64(key), DictMapUnwrapFloat(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -5837,12 +7169,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt64FieldSize([aKey unsignedLongLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictFloatFieldSize([aValue floatValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictUInt64FieldSize(DictMapUnwrapUInt64(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictFloatFieldSize(DictMapUnwrapFloat(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -5855,15 +7186,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint64_t unwrappedKey = [aKey unsignedLongLongValue];
-    float unwrappedValue = [aValue floatValue];
+    uint64_t unwrappedKey = DictMapUnwrapUInt64(key);
+    float unwrappedValue = DictMapUnwrapFloat(slot);
     size_t msgSize = ComputeDictUInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictFloatFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -5875,7 +7204,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueFloat) forKey:@(key->valueUInt64)];
+  DictMapSet(&_map, DictMapWrapUInt64(key->valueUInt64), DictMapWrapFloat(value->valueFloat));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -5885,16 +7214,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getFloat:(nullable float *)value forKey:(uint64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped floatValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt64(key));
+  if (slot && value) {
+    *value = DictMapUnwrapFloat(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBUInt64FloatDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -5902,18 +7235,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setFloat:(float)value forKey:(uint64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapUInt64(key), DictMapWrapFloat(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeFloatForKey:(uint64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapUInt64(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -5922,7 +7255,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBUInt64DoubleDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -5934,10 +7267,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapUInt64(keys[i]), DictMapWrapDouble(values[i]));
       }
     }
   }
@@ -5948,21 +7281,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithDoubles:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithDoubles:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithDoubles:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -5978,39 +7315,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBUInt64DoubleDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualDouble(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapUInt64(key))] = @(DictMapUnwrapDouble(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndDoublesUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, double value, BOOL *stop))block {
-  BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedLongLongValue], [aValue doubleValue], &stop);
+  BOOL stop = NO;
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapUInt64(key), DictMapUnwrapDouble(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -6018,12 +7374,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt64FieldSize([aKey unsignedLongLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictDoubleFieldSize([aValue doubleValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictUInt64FieldSize(DictMapUnwrapUInt64(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictDoubleFieldSize(DictMapUnwrapDouble(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -6036,15 +7391,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint64_t unwrappedKey = [aKey unsignedLongLongValue];
-    double unwrappedValue = [aValue doubleValue];
+    uint64_t unwrappedKey = DictMapUnwrapUInt64(key);
+    double unwrappedValue = DictMapUnwrapDouble(slot);
     size_t msgSize = ComputeDictUInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictDoubleFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -6056,7 +7409,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueDouble) forKey:@(key->valueUInt64)];
+  DictMapSet(&_map, DictMapWrapUInt64(key->valueUInt64), DictMapWrapDouble(value->valueDouble));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -6066,16 +7419,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getDouble:(nullable double *)value forKey:(uint64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped doubleValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt64(key));
+  if (slot && value) {
+    *value = DictMapUnwrapDouble(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBUInt64DoubleDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -6083,18 +7440,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setDouble:(double)value forKey:(uint64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapUInt64(key), DictMapWrapDouble(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeDoubleForKey:(uint64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapUInt64(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -6103,7 +7460,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBUInt64EnumDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
   GPBEnumValidationFunc _validationFunc;
 }
 
@@ -6123,11 +7480,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                                      count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     _validationFunc = (func != NULL ? func : DictDefault_IsValidValue);
     if (count && rawValues && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(rawValues[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapUInt64(keys[i]), DictMapWrapEnum(rawValues[i]));
       }
     }
   }
@@ -6141,22 +7498,26 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                                     count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithValidationFunction:(GPBEnumValidationFunc)func
-                                  capacity:(__unused NSUInteger)numItems {
-  return [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+                                  capacity:(NSUInteger)numItems {
+  self = [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -6172,39 +7533,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBUInt64EnumDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualEnum(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapUInt64(key))] = @(DictMapUnwrapEnum(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndRawValuesUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, int32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey unsignedLongLongValue], [aValue intValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapUInt64(key), DictMapUnwrapEnum(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -6212,12 +7592,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictUInt64FieldSize([aKey unsignedLongLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictEnumFieldSize([aValue intValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictUInt64FieldSize(DictMapUnwrapUInt64(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictEnumFieldSize(DictMapUnwrapEnum(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -6230,15 +7609,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint64_t unwrappedKey = [aKey unsignedLongLongValue];
-    int32_t unwrappedValue = [aValue intValue];
+    uint64_t unwrappedKey = DictMapUnwrapUInt64(key);
+    int32_t unwrappedValue = DictMapUnwrapEnum(slot);
     size_t msgSize = ComputeDictUInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictEnumFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -6263,7 +7640,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueEnum) forKey:@(key->valueUInt64)];
+  DictMapSet(&_map, DictMapWrapUInt64(key->valueUInt64), DictMapWrapEnum(value->valueEnum));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -6273,47 +7650,52 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getEnum:(int32_t *)value forKey:(uint64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    int32_t result = [wrapped intValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt64(key));
+  if (slot && value) {
+    int32_t result = DictMapUnwrapEnum(*slot);
     if (!_validationFunc(result)) {
       result = kGPBUnrecognizedEnumeratorValue;
     }
     *value = result;
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (BOOL)getRawValue:(int32_t *)rawValue forKey:(uint64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && rawValue) {
-    *rawValue = [wrapped intValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt64(key));
+  if (slot && rawValue) {
+    *rawValue = DictMapUnwrapEnum(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)enumerateKeysAndEnumsUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, int32_t value, BOOL *stop))block {
   GPBEnumValidationFunc func = _validationFunc;
   BOOL stop = NO;
-  NSEnumerator *keys = [_dictionary keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = _dictionary[aKey];
-      int32_t unwrapped = [aValue intValue];
-      if (!func(unwrapped)) {
-        unwrapped = kGPBUnrecognizedEnumeratorValue;
-      }
-    block([aKey unsignedLongLongValue], unwrapped, &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    int32_t unwrapped = DictMapUnwrapEnum(slot);
+    if (!func(unwrapped)) {
+      unwrapped = kGPBUnrecognizedEnumeratorValue;
+    }
+    block(DictMapUnwrapUInt64(key), unwrapped, &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (void)addRawEntriesFromDictionary:(GPBUInt64EnumDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -6321,18 +7703,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setRawValue:(int32_t)value forKey:(uint64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapUInt64(key), DictMapWrapEnum(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeEnumForKey:(uint64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapUInt64(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 - (void)setEnum:(int32_t)value forKey:(uint64_t)key {
@@ -6342,7 +7724,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                        value];
   }
 
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapUInt64(key), DictMapWrapEnum(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
@@ -6354,7 +7736,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBUInt64ObjectDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -6366,14 +7748,14 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && objects && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
         if (!objects[i]) {
           [NSException raise:NSInvalidArgumentException
                       format:@"Attempting to add nil object to a Dictionary"];
         }
-        [_dictionary setObject:objects[i] forKey:@(keys[i])];
+        DictMapSetObject(&_map, DictMapWrapUInt64(keys[i]), objects[i]);
       }
     }
   }
@@ -6384,21 +7766,27 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithObjects:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
+      DictMapRetainObjects(&_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithObjects:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithObjects:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapReleaseObjects(&_map);
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -6414,38 +7802,61 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBUInt64ObjectDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualObject(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapUInt64(key))] = DictMapUnwrapObject(slot);
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndObjectsUsingBlock:
     (void (NS_NOESCAPE ^)(uint64_t key, id object, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    id aObject = internal[aKey];
-    block([aKey unsignedLongLongValue], aObject, &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapUInt64(key), DictMapUnwrapObject(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (BOOL)isInitialized {
-  for (GPBMessage *msg in [_dictionary objectEnumerator]) {
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    GPBMessage *msg = DictMapUnwrapObject(slot);
     if (!msg.initialized) {
       return NO;
     }
@@ -6455,22 +7866,19 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (instancetype)deepCopyWithZone:(NSZone *)zone {
   GPBUInt64ObjectDictionary *newDict =
-      [[GPBUInt64ObjectDictionary alloc] init];
-  NSEnumerator *keys = [_dictionary keyEnumerator];
-  id aKey;
-  NSMutableDictionary *internalDict = newDict->_dictionary;
-  while ((aKey = [keys nextObject])) {
-    GPBMessage *msg = _dictionary[aKey];
-    GPBMessage *copiedMsg = [msg copyWithZone:zone];
-    [internalDict setObject:copiedMsg forKey:aKey];
+      [[GPBUInt64ObjectDictionary alloc] initWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    GPBMessage *copiedMsg = [DictMapUnwrapObject(slot) copyWithZone:zone];
+    DictMapSetObject(&newDict->_map, key, copiedMsg);
     [copiedMsg release];
   }
   return newDict;
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -6478,12 +7886,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    id aObject = internal[aKey];
-    size_t msgSize = ComputeDictUInt64FieldSize([aKey unsignedLongLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictObjectFieldSize(aObject, kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictUInt64FieldSize(DictMapUnwrapUInt64(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictObjectFieldSize(DictMapUnwrapObject(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -6496,15 +7903,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    id aObject = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    uint64_t unwrappedKey = [aKey unsignedLongLongValue];
-    id unwrappedValue = aObject;
+    uint64_t unwrappedKey = DictMapUnwrapUInt64(key);
+    id unwrappedValue = DictMapUnwrapObject(slot);
     size_t msgSize = ComputeDictUInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictObjectFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -6516,7 +7921,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:value->valueString forKey:@(key->valueUInt64)];
+  DictMapSetObject(&_map, DictMapWrapUInt64(key->valueUInt64), value->valueString);
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -6526,13 +7931,17 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (id)objectForKey:(uint64_t)key {
-  id result = [_dictionary objectForKey:@(key)];
-  return result;
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapUInt64(key));
+  return slot ? DictMapUnwrapObject(*slot) : nil;
 }
 
 - (void)addEntriesFromDictionary:(GPBUInt64ObjectDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSetObject(&_map, key, DictMapUnwrapObject(slot));
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -6544,18 +7953,19 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     [NSException raise:NSInvalidArgumentException
                 format:@"Attempting to add nil object to a Dictionary"];
   }
-  [_dictionary setObject:object forKey:@(key)];
+  DictMapSetObject(&_map, DictMapWrapUInt64(key), object);
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeObjectForKey:(uint64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemoveObject(&_map, DictMapWrapUInt64(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapReleaseObjects(&_map);
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -6567,7 +7977,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBInt64UInt32Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -6579,10 +7989,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapInt64(keys[i]), DictMapWrapUInt32(values[i]));
       }
     }
   }
@@ -6593,21 +8003,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithUInt32s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithUInt32s:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithUInt32s:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -6623,39 +8037,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBInt64UInt32Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualUInt32(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapInt64(key))] = @(DictMapUnwrapUInt32(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndUInt32sUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, uint32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey longLongValue], [aValue unsignedIntValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapInt64(key), DictMapUnwrapUInt32(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -6663,12 +8096,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt64FieldSize([aKey longLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictUInt32FieldSize([aValue unsignedIntValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictInt64FieldSize(DictMapUnwrapInt64(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictUInt32FieldSize(DictMapUnwrapUInt32(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -6681,15 +8113,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int64_t unwrappedKey = [aKey longLongValue];
-    uint32_t unwrappedValue = [aValue unsignedIntValue];
+    int64_t unwrappedKey = DictMapUnwrapInt64(key);
+    uint32_t unwrappedValue = DictMapUnwrapUInt32(slot);
     size_t msgSize = ComputeDictInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictUInt32FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -6701,7 +8131,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueUInt32) forKey:@(key->valueInt64)];
+  DictMapSet(&_map, DictMapWrapInt64(key->valueInt64), DictMapWrapUInt32(value->valueUInt32));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -6711,16 +8141,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getUInt32:(nullable uint32_t *)value forKey:(int64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped unsignedIntValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt64(key));
+  if (slot && value) {
+    *value = DictMapUnwrapUInt32(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBInt64UInt32Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -6728,18 +8162,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setUInt32:(uint32_t)value forKey:(int64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapInt64(key), DictMapWrapUInt32(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeUInt32ForKey:(int64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapInt64(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -6748,7 +8182,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBInt64Int32Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -6760,10 +8194,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapInt64(keys[i]), DictMapWrapInt32(values[i]));
       }
     }
   }
@@ -6774,21 +8208,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithInt32s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithInt32s:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithInt32s:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -6804,39 +8242,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBInt64Int32Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualInt32(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapInt64(key))] = @(DictMapUnwrapInt32(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndInt32sUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, int32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey longLongValue], [aValue intValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapInt64(key), DictMapUnwrapInt32(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -6844,12 +8301,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt64FieldSize([aKey longLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictInt32FieldSize([aValue intValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictInt64FieldSize(DictMapUnwrapInt64(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictInt32FieldSize(DictMapUnwrapInt32(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -6862,15 +8318,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int64_t unwrappedKey = [aKey longLongValue];
-    int32_t unwrappedValue = [aValue intValue];
+    int64_t unwrappedKey = DictMapUnwrapInt64(key);
+    int32_t unwrappedValue = DictMapUnwrapInt32(slot);
     size_t msgSize = ComputeDictInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictInt32FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -6882,7 +8336,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueInt32) forKey:@(key->valueInt64)];
+  DictMapSet(&_map, DictMapWrapInt64(key->valueInt64), DictMapWrapInt32(value->valueInt32));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -6892,16 +8346,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getInt32:(nullable int32_t *)value forKey:(int64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped intValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt64(key));
+  if (slot && value) {
+    *value = DictMapUnwrapInt32(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBInt64Int32Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -6909,18 +8367,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setInt32:(int32_t)value forKey:(int64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapInt64(key), DictMapWrapInt32(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeInt32ForKey:(int64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapInt64(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -6929,7 +8387,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBInt64UInt64Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -6941,10 +8399,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapInt64(keys[i]), DictMapWrapUInt64(values[i]));
       }
     }
   }
@@ -6955,21 +8413,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithUInt64s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithUInt64s:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithUInt64s:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -6985,39 +8447,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBInt64UInt64Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualUInt64(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapInt64(key))] = @(DictMapUnwrapUInt64(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndUInt64sUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, uint64_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey longLongValue], [aValue unsignedLongLongValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapInt64(key), DictMapUnwrapUInt64(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -7025,12 +8506,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt64FieldSize([aKey longLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictUInt64FieldSize([aValue unsignedLongLongValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictInt64FieldSize(DictMapUnwrapInt64(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictUInt64FieldSize(DictMapUnwrapUInt64(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -7043,15 +8523,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int64_t unwrappedKey = [aKey longLongValue];
-    uint64_t unwrappedValue = [aValue unsignedLongLongValue];
+    int64_t unwrappedKey = DictMapUnwrapInt64(key);
+    uint64_t unwrappedValue = DictMapUnwrapUInt64(slot);
     size_t msgSize = ComputeDictInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictUInt64FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -7063,7 +8541,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueUInt64) forKey:@(key->valueInt64)];
+  DictMapSet(&_map, DictMapWrapInt64(key->valueInt64), DictMapWrapUInt64(value->valueUInt64));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -7073,16 +8551,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getUInt64:(nullable uint64_t *)value forKey:(int64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped unsignedLongLongValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt64(key));
+  if (slot && value) {
+    *value = DictMapUnwrapUInt64(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBInt64UInt64Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -7090,18 +8572,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setUInt64:(uint64_t)value forKey:(int64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapInt64(key), DictMapWrapUInt64(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeUInt64ForKey:(int64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapInt64(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -7110,7 +8592,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBInt64Int64Dictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -7122,10 +8604,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapInt64(keys[i]), DictMapWrapInt64(values[i]));
       }
     }
   }
@@ -7136,21 +8618,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithInt64s:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithInt64s:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithInt64s:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -7165,40 +8651,59 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   if (![other isKindOfClass:[GPBInt64Int64Dictionary class]]) {
     return NO;
   }
-  GPBInt64Int64Dictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  GPBInt64Int64Dictionary *otherDictionary = other;
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualInt64(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapInt64(key))] = @(DictMapUnwrapInt64(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndInt64sUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, int64_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey longLongValue], [aValue longLongValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapInt64(key), DictMapUnwrapInt64(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -7206,12 +8711,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt64FieldSize([aKey longLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictInt64FieldSize([aValue longLongValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictInt64FieldSize(DictMapUnwrapInt64(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictInt64FieldSize(DictMapUnwrapInt64(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -7224,15 +8728,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int64_t unwrappedKey = [aKey longLongValue];
-    int64_t unwrappedValue = [aValue longLongValue];
+    int64_t unwrappedKey = DictMapUnwrapInt64(key);
+    int64_t unwrappedValue = DictMapUnwrapInt64(slot);
     size_t msgSize = ComputeDictInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictInt64FieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -7244,7 +8746,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueInt64) forKey:@(key->valueInt64)];
+  DictMapSet(&_map, DictMapWrapInt64(key->valueInt64), DictMapWrapInt64(value->valueInt64));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -7254,16 +8756,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getInt64:(nullable int64_t *)value forKey:(int64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped longLongValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt64(key));
+  if (slot && value) {
+    *value = DictMapUnwrapInt64(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBInt64Int64Dictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -7271,18 +8777,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setInt64:(int64_t)value forKey:(int64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapInt64(key), DictMapWrapInt64(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeInt64ForKey:(int64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapInt64(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -7291,7 +8797,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBInt64BoolDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -7303,10 +8809,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                         count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapInt64(keys[i]), DictMapWrapBool(values[i]));
       }
     }
   }
@@ -7317,21 +8823,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithBools:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithBools:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithBools:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -7347,39 +8857,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBInt64BoolDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualBool(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapInt64(key))] = @(DictMapUnwrapBool(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndBoolsUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, BOOL value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey longLongValue], [aValue boolValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapInt64(key), DictMapUnwrapBool(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -7387,12 +8916,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt64FieldSize([aKey longLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictBoolFieldSize([aValue boolValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictInt64FieldSize(DictMapUnwrapInt64(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictBoolFieldSize(DictMapUnwrapBool(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -7405,15 +8933,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int64_t unwrappedKey = [aKey longLongValue];
-    BOOL unwrappedValue = [aValue boolValue];
+    int64_t unwrappedKey = DictMapUnwrapInt64(key);
+    BOOL unwrappedValue = DictMapUnwrapBool(slot);
     size_t msgSize = ComputeDictInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictBoolFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -7425,7 +8951,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueBool) forKey:@(key->valueInt64)];
+  DictMapSet(&_map, DictMapWrapInt64(key->valueInt64), DictMapWrapBool(value->valueBool));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -7435,16 +8961,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getBool:(nullable BOOL *)value forKey:(int64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped boolValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt64(key));
+  if (slot && value) {
+    *value = DictMapUnwrapBool(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBInt64BoolDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -7452,18 +8982,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setBool:(BOOL)value forKey:(int64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapInt64(key), DictMapWrapBool(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeBoolForKey:(int64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapInt64(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -7472,7 +9002,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBInt64FloatDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -7484,10 +9014,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                          count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapInt64(keys[i]), DictMapWrapFloat(values[i]));
       }
     }
   }
@@ -7498,21 +9028,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithFloats:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithFloats:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithFloats:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -7528,39 +9062,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBInt64FloatDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualFloat(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapInt64(key))] = @(DictMapUnwrapFloat(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndFloatsUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, float value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey longLongValue], [aValue floatValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapInt64(key), DictMapUnwrapFloat(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -7568,12 +9121,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt64FieldSize([aKey longLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictFloatFieldSize([aValue floatValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictInt64FieldSize(DictMapUnwrapInt64(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictFloatFieldSize(DictMapUnwrapFloat(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -7586,15 +9138,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int64_t unwrappedKey = [aKey longLongValue];
-    float unwrappedValue = [aValue floatValue];
+    int64_t unwrappedKey = DictMapUnwrapInt64(key);
+    float unwrappedValue = DictMapUnwrapFloat(slot);
     size_t msgSize = ComputeDictInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictFloatFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -7606,7 +9156,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueFloat) forKey:@(key->valueInt64)];
+  DictMapSet(&_map, DictMapWrapInt64(key->valueInt64), DictMapWrapFloat(value->valueFloat));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -7616,16 +9166,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getFloat:(nullable float *)value forKey:(int64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped floatValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt64(key));
+  if (slot && value) {
+    *value = DictMapUnwrapFloat(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBInt64FloatDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -7633,18 +9187,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setFloat:(float)value forKey:(int64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapInt64(key), DictMapWrapFloat(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeFloatForKey:(int64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapInt64(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -7653,7 +9207,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBInt64DoubleDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -7665,10 +9219,10 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && values && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(values[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapInt64(keys[i]), DictMapWrapDouble(values[i]));
       }
     }
   }
@@ -7679,21 +9233,25 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithDoubles:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithDoubles:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithDoubles:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -7709,39 +9267,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBInt64DoubleDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualDouble(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapInt64(key))] = @(DictMapUnwrapDouble(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndDoublesUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, double value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey longLongValue], [aValue doubleValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapInt64(key), DictMapUnwrapDouble(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -7749,12 +9326,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt64FieldSize([aKey longLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictDoubleFieldSize([aValue doubleValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictInt64FieldSize(DictMapUnwrapInt64(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictDoubleFieldSize(DictMapUnwrapDouble(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -7767,15 +9343,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int64_t unwrappedKey = [aKey longLongValue];
-    double unwrappedValue = [aValue doubleValue];
+    int64_t unwrappedKey = DictMapUnwrapInt64(key);
+    double unwrappedValue = DictMapUnwrapDouble(slot);
     size_t msgSize = ComputeDictInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictDoubleFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -7787,7 +9361,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueDouble) forKey:@(key->valueInt64)];
+  DictMapSet(&_map, DictMapWrapInt64(key->valueInt64), DictMapWrapDouble(value->valueDouble));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -7797,16 +9371,20 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getDouble:(nullable double *)value forKey:(int64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    *value = [wrapped doubleValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt64(key));
+  if (slot && value) {
+    *value = DictMapUnwrapDouble(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)addEntriesFromDictionary:(GPBInt64DoubleDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -7814,18 +9392,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setDouble:(double)value forKey:(int64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapInt64(key), DictMapWrapDouble(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeDoubleForKey:(int64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapInt64(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 @end
@@ -7834,7 +9412,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBInt64EnumDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
   GPBEnumValidationFunc _validationFunc;
 }
 
@@ -7854,11 +9432,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                                      count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     _validationFunc = (func != NULL ? func : DictDefault_IsValidValue);
     if (count && rawValues && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
-        [_dictionary setObject:@(rawValues[i]) forKey:@(keys[i])];
+        DictMapSet(&_map, DictMapWrapInt64(keys[i]), DictMapWrapEnum(rawValues[i]));
       }
     }
   }
@@ -7872,22 +9450,26 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                                     count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
     }
   }
   return self;
 }
 
 - (instancetype)initWithValidationFunction:(GPBEnumValidationFunc)func
-                                  capacity:(__unused NSUInteger)numItems {
-  return [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+                                  capacity:(NSUInteger)numItems {
+  self = [self initWithValidationFunction:func rawValues:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -7903,39 +9485,58 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBInt64EnumDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualEnum(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapInt64(key))] = @(DictMapUnwrapEnum(slot));
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndRawValuesUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, int32_t value, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    block([aKey longLongValue], [aValue intValue], &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapInt64(key), DictMapUnwrapEnum(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -7943,12 +9544,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
-    size_t msgSize = ComputeDictInt64FieldSize([aKey longLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictEnumFieldSize([aValue intValue], kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictInt64FieldSize(DictMapUnwrapInt64(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictEnumFieldSize(DictMapUnwrapEnum(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -7961,15 +9561,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int64_t unwrappedKey = [aKey longLongValue];
-    int32_t unwrappedValue = [aValue intValue];
+    int64_t unwrappedKey = DictMapUnwrapInt64(key);
+    int32_t unwrappedValue = DictMapUnwrapEnum(slot);
     size_t msgSize = ComputeDictInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictEnumFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -7994,7 +9592,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:@(value->valueEnum) forKey:@(key->valueInt64)];
+  DictMapSet(&_map, DictMapWrapInt64(key->valueInt64), DictMapWrapEnum(value->valueEnum));
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -8004,47 +9602,52 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (BOOL)getEnum:(int32_t *)value forKey:(int64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && value) {
-    int32_t result = [wrapped intValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt64(key));
+  if (slot && value) {
+    int32_t result = DictMapUnwrapEnum(*slot);
     if (!_validationFunc(result)) {
       result = kGPBUnrecognizedEnumeratorValue;
     }
     *value = result;
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (BOOL)getRawValue:(int32_t *)rawValue forKey:(int64_t)key {
-  NSNumber *wrapped = [_dictionary objectForKey:@(key)];
-  if (wrapped && rawValue) {
-    *rawValue = [wrapped intValue];
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt64(key));
+  if (slot && rawValue) {
+    *rawValue = DictMapUnwrapEnum(*slot);
   }
-  return (wrapped != NULL);
+  return (slot != NULL);
 }
 
 - (void)enumerateKeysAndEnumsUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, int32_t value, BOOL *stop))block {
   GPBEnumValidationFunc func = _validationFunc;
   BOOL stop = NO;
-  NSEnumerator *keys = [_dictionary keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    NSNumber *aValue = _dictionary[aKey];
-      int32_t unwrapped = [aValue intValue];
-      if (!func(unwrapped)) {
-        unwrapped = kGPBUnrecognizedEnumeratorValue;
-      }
-    block([aKey longLongValue], unwrapped, &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    int32_t unwrapped = DictMapUnwrapEnum(slot);
+    if (!func(unwrapped)) {
+      unwrapped = kGPBUnrecognizedEnumeratorValue;
+    }
+    block(DictMapUnwrapInt64(key), unwrapped, &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (void)addRawEntriesFromDictionary:(GPBInt64EnumDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSet(&_map, key, slot);
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -8052,18 +9655,18 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (void)setRawValue:(int32_t)value forKey:(int64_t)key {
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapInt64(key), DictMapWrapEnum(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeEnumForKey:(int64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemove(&_map, DictMapWrapInt64(aKey), NULL);
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapRemoveAll(&_map);
 }
 
 - (void)setEnum:(int32_t)value forKey:(int64_t)key {
@@ -8073,7 +9676,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                        value];
   }
 
-  [_dictionary setObject:@(value) forKey:@(key)];
+  DictMapSet(&_map, DictMapWrapInt64(key), DictMapWrapEnum(value));
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
@@ -8085,7 +9688,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 @implementation GPBInt64ObjectDictionary {
  @package
-  NSMutableDictionary *_dictionary;
+  DictMap _map;
 }
 
 - (instancetype)init {
@@ -8097,14 +9700,14 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
                           count:(NSUInteger)count {
   self = [super init];
   if (self) {
-    _dictionary = [[NSMutableDictionary alloc] init];
     if (count && objects && keys) {
+      DictMapReserve(&_map, count);
       for (NSUInteger i = 0; i < count; ++i) {
         if (!objects[i]) {
           [NSException raise:NSInvalidArgumentException
                       format:@"Attempting to add nil object to a Dictionary"];
         }
-        [_dictionary setObject:objects[i] forKey:@(keys[i])];
+        DictMapSetObject(&_map, DictMapWrapInt64(keys[i]), objects[i]);
       }
     }
   }
@@ -8115,21 +9718,27 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   self = [self initWithObjects:NULL forKeys:NULL count:0];
   if (self) {
     if (dictionary) {
-      [_dictionary addEntriesFromDictionary:dictionary->_dictionary];
+      DictMapCopy(&_map, &dictionary->_map);
+      DictMapRetainObjects(&_map);
     }
   }
   return self;
 }
 
-- (instancetype)initWithCapacity:(__unused NSUInteger)numItems {
-  return [self initWithObjects:NULL forKeys:NULL count:0];
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+  self = [self initWithObjects:NULL forKeys:NULL count:0];
+  if (self) {
+    DictMapReserve(&_map, numItems);
+  }
+  return self;
 }
 
 - (void)dealloc {
   NSAssert(!_autocreator,
            @"%@: Autocreator must be cleared before release, autocreator: %@",
            [self class], _autocreator);
-  [_dictionary release];
+  DictMapReleaseObjects(&_map);
+  DictMapRemoveAll(&_map);
   [super dealloc];
 }
 
@@ -8145,38 +9754,61 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     return NO;
   }
   GPBInt64ObjectDictionary *otherDictionary = other;
-  return [_dictionary isEqual:otherDictionary->_dictionary];
+  if (DictMapCount(&_map) != DictMapCount(&otherDictionary->_map)) {
+    return NO;
+  }
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    uint64_t *otherSlot = DictMapFind(&otherDictionary->_map, key);
+    if (!otherSlot) {
+      return NO;
+    }
+    if (!DictMapEqualObject(slot, *otherSlot)) {
+      return NO;
+    }
+  }
+  return YES;
 }
 
 - (NSUInteger)hash {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (NSString *)description {
-  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, _dictionary];
+  NSMutableDictionary *entries = [NSMutableDictionary dictionaryWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    entries[@(DictMapUnwrapInt64(key))] = DictMapUnwrapObject(slot);
+  }
+  return [NSString stringWithFormat:@"<%@ %p> { %@ }", [self class], self, entries];
 }
 
 - (NSUInteger)count {
-  return _dictionary.count;
+  return DictMapCount(&_map);
 }
 
 - (void)enumerateKeysAndObjectsUsingBlock:
     (void (NS_NOESCAPE ^)(int64_t key, id object, BOOL *stop))block {
   BOOL stop = NO;
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    id aObject = internal[aKey];
-    block([aKey longLongValue], aObject, &stop);
+  unsigned long mutations = _map.mutations;
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    block(DictMapUnwrapInt64(key), DictMapUnwrapObject(slot), &stop);
     if (stop) {
       break;
     }
+    DictMapCheckMutations(&_map, mutations);
   }
 }
 
 - (BOOL)isInitialized {
-  for (GPBMessage *msg in [_dictionary objectEnumerator]) {
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    GPBMessage *msg = DictMapUnwrapObject(slot);
     if (!msg.initialized) {
       return NO;
     }
@@ -8186,22 +9818,19 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (instancetype)deepCopyWithZone:(NSZone *)zone {
   GPBInt64ObjectDictionary *newDict =
-      [[GPBInt64ObjectDictionary alloc] init];
-  NSEnumerator *keys = [_dictionary keyEnumerator];
-  id aKey;
-  NSMutableDictionary *internalDict = newDict->_dictionary;
-  while ((aKey = [keys nextObject])) {
-    GPBMessage *msg = _dictionary[aKey];
-    GPBMessage *copiedMsg = [msg copyWithZone:zone];
-    [internalDict setObject:copiedMsg forKey:aKey];
+      [[GPBInt64ObjectDictionary alloc] initWithCapacity:DictMapCount(&_map)];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    GPBMessage *copiedMsg = [DictMapUnwrapObject(slot) copyWithZone:zone];
+    DictMapSetObject(&newDict->_map, key, copiedMsg);
     [copiedMsg release];
   }
   return newDict;
 }
 
 - (size_t)computeSerializedSizeAsField:(GPBFieldDescriptor *)field {
-  NSDictionary *internal = _dictionary;
-  NSUInteger count = internal.count;
+  NSUInteger count = DictMapCount(&_map);
   if (count == 0) {
     return 0;
   }
@@ -8209,12 +9838,11 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   size_t result = 0;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    id aObject = internal[aKey];
-    size_t msgSize = ComputeDictInt64FieldSize([aKey longLongValue], kMapKeyFieldNumber, keyDataType);
-    msgSize += ComputeDictObjectFieldSize(aObject, kMapValueFieldNumber, valueDataType);
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
+    size_t msgSize = ComputeDictInt64FieldSize(DictMapUnwrapInt64(key), kMapKeyFieldNumber, keyDataType);
+    msgSize += ComputeDictObjectFieldSize(DictMapUnwrapObject(slot), kMapValueFieldNumber, valueDataType);
     result += GPBComputeRawVarint32SizeForInteger(msgSize) + msgSize;
   }
   size_t tagSize = GPBComputeWireFormatTagSize(GPBFieldNumber(field), GPBDataTypeMessage);
@@ -8227,15 +9855,13 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
   GPBDataType valueDataType = GPBGetFieldDataType(field);
   GPBDataType keyDataType = field.mapKeyDataType;
   uint32_t tag = GPBWireFormatMakeTag(GPBFieldNumber(field), GPBWireFormatLengthDelimited);
-  NSDictionary *internal = _dictionary;
-  NSEnumerator *keys = [internal keyEnumerator];
-  NSNumber *aKey;
-  while ((aKey = [keys nextObject])) {
-    id aObject = internal[aKey];
+  NSUInteger index = 0;
+  uint64_t key, slot;
+  while (DictMapNext(&_map, &index, &key, &slot)) {
     [outputStream writeInt32NoTag:tag];
     // Write the size of the message.
-    int64_t unwrappedKey = [aKey longLongValue];
-    id unwrappedValue = aObject;
+    int64_t unwrappedKey = DictMapUnwrapInt64(key);
+    id unwrappedValue = DictMapUnwrapObject(slot);
     size_t msgSize = ComputeDictInt64FieldSize(unwrappedKey, kMapKeyFieldNumber, keyDataType);
     msgSize += ComputeDictObjectFieldSize(unwrappedValue, kMapValueFieldNumber, valueDataType);
     [outputStream writeInt32NoTag:(int32_t)msgSize];
@@ -8247,7 +9873,7 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 
 - (void)setGPBGenericValue:(GPBGenericValue *)value
      forGPBGenericValueKey:(GPBGenericValue *)key {
-  [_dictionary setObject:value->valueString forKey:@(key->valueInt64)];
+  DictMapSetObject(&_map, DictMapWrapInt64(key->valueInt64), value->valueString);
 }
 
 - (void)enumerateForTextFormat:(void (NS_NOESCAPE ^)(id keyObj, id valueObj))block {
@@ -8257,13 +9883,17 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
 }
 
 - (id)objectForKey:(int64_t)key {
-  id result = [_dictionary objectForKey:@(key)];
-  return result;
+  uint64_t *slot = DictMapFind(&_map, DictMapWrapInt64(key));
+  return slot ? DictMapUnwrapObject(*slot) : nil;
 }
 
 - (void)addEntriesFromDictionary:(GPBInt64ObjectDictionary *)otherDictionary {
   if (otherDictionary) {
-    [_dictionary addEntriesFromDictionary:otherDictionary->_dictionary];
+    NSUInteger index = 0;
+    uint64_t key, slot;
+    while (DictMapNext(&otherDictionary->_map, &index, &key, &slot)) {
+      DictMapSetObject(&_map, key, DictMapUnwrapObject(slot));
+    }
     if (_autocreator) {
       GPBAutocreatedDictionaryModified(_autocreator, self);
     }
@@ -8275,18 +9905,19 @@ void GPBDictionaryReadEntry(id mapDictionary, GPBCodedInputStream *stream,
     [NSException raise:NSInvalidArgumentException
                 format:@"Attempting to add nil object to a Dictionary"];
   }
-  [_dictionary setObject:object forKey:@(key)];
+  DictMapSetObject(&_map, DictMapWrapInt64(key), object);
   if (_autocreator) {
     GPBAutocreatedDictionaryModified(_autocreator, self);
   }
 }
 
 - (void)removeObjectForKey:(int64_t)aKey {
-  [_dictionary removeObjectForKey:@(aKey)];
+  DictMapRemoveObject(&_map, DictMapWrapInt64(aKey));
 }
 
 - (void)removeAll {
-  [_dictionary removeAllObjects];
+  DictMapReleaseObjects(&_map);
+  DictMapRemoveAll(&_map);
 }
 
 @end
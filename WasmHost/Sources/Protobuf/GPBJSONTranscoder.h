@@ -0,0 +1,108 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#import <Foundation/Foundation.h>
+
+#import "GPBDescriptor.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+CF_EXTERN_C_BEGIN
+
+/** NSError domain used for @c GPBJSONTranscoder errors. */
+extern NSString *const GPBJSONTranscoderErrorDomain;
+
+/**
+ * Error code for NSError with @c GPBJSONTranscoderErrorDomain. Malformed
+ * binary input is reported with @c GPBCodedInputStreamErrorDomain errors.
+ **/
+typedef NS_ENUM(NSInteger, GPBJSONTranscoderErrorCode) {
+  /** The JSON input is not valid JSON. */
+  GPBJSONTranscoderErrorInvalidJSON = -100,
+  /** The JSON input names a field the message does not have. */
+  GPBJSONTranscoderErrorUnknownField = -101,
+  /** A value does not fit the type of its field. */
+  GPBJSONTranscoderErrorInvalidValue = -102,
+  /** The message uses a type the transcoder can't convert (Any, groups). */
+  GPBJSONTranscoderErrorUnsupportedType = -103,
+  /** The input is nested too deep. */
+  GPBJSONTranscoderErrorRecursionDepthExceeded = -104,
+};
+
+/**
+ * Options controlling how @c GPBJSONTranscoder converts.
+ **/
+typedef NS_OPTIONS(uint32_t, GPBJSONTranscoderOptions) {
+  GPBJSONTranscoderOptionNone = 0,
+  /** Binary to JSON: use the proto field names instead of the lowerCamelCase JSON names. */
+  GPBJSONTranscoderOptionProtoFieldNames = 1 << 0,
+  /** Binary to JSON: write enum values as numbers instead of names. */
+  GPBJSONTranscoderOptionEnumsAsNumbers = 1 << 1,
+  /** JSON to binary: skip unknown fields and enum names instead of failing. */
+  GPBJSONTranscoderOptionIgnoreUnknownFields = 1 << 2,
+};
+
+CF_EXTERN_C_END
+
+/**
+ * Converts between the binary wire format and the proto3 JSON mapping without
+ * creating messages.
+ *
+ * The conversion walks the input once, driven by the message descriptor, and
+ * writes straight into a single output buffer. Field names, enum names and
+ * well known type information are computed once per descriptor and cached.
+ *
+ * Fields left at their default are not written to JSON only when they are not
+ * on the wire, and unknown fields of the binary input are dropped. Timestamp,
+ * Duration, FieldMask, Struct, Value, ListValue, Empty and the wrapper types use
+ * their special JSON forms; Any and groups are not supported.
+ *
+ * @note When a singular field appears more than once on the wire, each
+ *       occurrence is written as its own JSON member.
+ **/
+__attribute__((objc_subclassing_restricted))
+@interface GPBJSONTranscoder : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Converts a serialized message to JSON.
+ *
+ * @param data       The serialized message.
+ * @param descriptor The descriptor of the message.
+ * @param options    Options controlling the conversion.
+ * @param errorPtr   An optional error pointer to fill in with a failure reason
+ *                   if the data can not be converted.
+ *
+ * @return The UTF-8 encoded JSON, or nil on failure.
+ **/
++ (nullable NSData *)JSONDataWithMessageData:(NSData *)data
+                                  descriptor:(GPBDescriptor *)descriptor
+                                     options:(GPBJSONTranscoderOptions)options
+                                       error:(NSError **)errorPtr;
+
+/**
+ * Converts JSON to a serialized message.
+ *
+ * Both the lowerCamelCase JSON names and the proto field names are accepted.
+ *
+ * @param JSONData   The UTF-8 encoded JSON.
+ * @param descriptor The descriptor of the message.
+ * @param options    Options controlling the conversion.
+ * @param errorPtr   An optional error pointer to fill in with a failure reason
+ *                   if the JSON can not be converted.
+ *
+ * @return The serialized message, or nil on failure.
+ **/
++ (nullable NSData *)messageDataWithJSONData:(NSData *)JSONData
+                                  descriptor:(GPBDescriptor *)descriptor
+                                     options:(GPBJSONTranscoderOptions)options
+                                       error:(NSError **)errorPtr;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,2440 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#import "GPBJSONTranscoder.h"
+
+#import <math.h>
+#import <objc/runtime.h>
+#import <os/lock.h>
+#import <xlocale.h>
+
+#import "GPBCodedInputStream_PackagePrivate.h"
+#import "GPBDescriptor_PackagePrivate.h"
+#import "GPBStruct.pbobjc.h"
+#import "GPBUtilities_PackagePrivate.h"
+#import "GPBWireFormat.h"
+
+NSString *const GPBJSONTranscoderErrorDomain = GPBNSStringifySymbol(GPBJSONTranscoderErrorDomain);
+
+// Same limit as GPBCodedInputStream.
+static const int kJSONMaxDepth = 100;
+
+// Range of google.protobuf.Timestamp: 0001-01-01T00:00:00Z to 9999-12-31T23:59:59Z.
+static const int64_t kJSONTimestampMinSeconds = -62135596800LL;
+static const int64_t kJSONTimestampMaxSeconds = 253402300799LL;
+// Range of google.protobuf.Duration: +-10000 years.
+static const int64_t kJSONDurationMaxSeconds = 315576000000LL;
+static const int32_t kJSONMaxNanos = 999999999;
+
+static char kJSONMessageInfoKey;
+static char kJSONEnumInfoKey;
+// Serializes publishing the infos attached to descriptors.
+static os_unfair_lock gJSONInfoLock = OS_UNFAIR_LOCK_INIT;
+
+#pragma mark - Errors
+
+static void RaiseJSONError(GPBJSONTranscoderErrorCode code, NSString *reason)
+    __attribute__((noreturn));
+
+static void RaiseJSONError(GPBJSONTranscoderErrorCode code, NSString *reason) {
+  NSError *error = [NSError errorWithDomain:GPBJSONTranscoderErrorDomain
+                                       code:code
+                                   userInfo:@{GPBErrorReasonKey : reason}];
+  // Raised like the stream errors so both are unwrapped the same way.
+  [[NSException exceptionWithName:GPBCodedInputStreamException
+                           reason:reason
+                         userInfo:@{GPBCodedInputStreamUnderlyingErrorKey : error}] raise];
+  __builtin_unreachable();
+}
+
+static NSError *JSONErrorFromException(NSException *exception) {
+  NSError *error = nil;
+  if ([exception.name isEqual:GPBCodedInputStreamException]) {
+    error = exception.userInfo[GPBCodedInputStreamUnderlyingErrorKey];
+  }
+  if (!error) {
+    NSString *reason = exception.reason;
+    error = [NSError errorWithDomain:GPBMessageErrorDomain
+                                code:GPBMessageErrorCodeOther
+                            userInfo:[reason length] ? @{GPBErrorReasonKey : reason} : nil];
+  }
+  return error;
+}
+
+#pragma mark - Descriptor caches
+
+typedef NS_ENUM(uint8_t, JSONWellKnownType) {
+  JSONWellKnownTypeNone = 0,
+  JSONWellKnownTypeAny,
+  JSONWellKnownTypeTimestamp,
+  JSONWellKnownTypeDuration,
+  JSONWellKnownTypeFieldMask,
+  JSONWellKnownTypeStruct,
+  JSONWellKnownTypeValue,
+  JSONWellKnownTypeListValue,
+  JSONWellKnownTypeEmpty,
+  // DoubleValue, Int64Value, StringValue... written as their `value` field.
+  JSONWellKnownTypeWrapper,
+};
+
+typedef struct JSONFieldInfo {
+  GPB_UNSAFE_UNRETAINED GPBFieldDescriptor *field;
+  uint32_t number;
+  GPBDataType dataType;
+  GPBFieldType fieldType;
+  // Index in the message's oneofs, -1 when the field isn't in one.
+  int32_t oneofIndex;
+  // `"jsonName":` and `"proto_name":`, copied as is to the output. The bare
+  // names are the bytes between the quotes.
+  const char *jsonKey;
+  const char *protoKey;
+  uint32_t jsonKeyLength;
+  uint32_t protoKeyLength;
+} JSONFieldInfo;
+
+// JSON view of a GPBDescriptor, attached to it on first use.
+@interface GPBJSONMessageInfo : NSObject {
+ @package
+  JSONWellKnownType wellKnownType_;
+  uint32_t fieldCount_;
+  uint32_t oneofCount_;
+  // Sorted by field number.
+  JSONFieldInfo *fields_;
+  char *names_;
+}
+@end
+
+@implementation GPBJSONMessageInfo
+
+- (void)dealloc {
+  free(fields_);
+  free(names_);
+  [super dealloc];
+}
+
+@end
+
+// Names of an enum, attached to its GPBEnumDescriptor on first use.
+@interface GPBJSONEnumInfo : NSObject {
+ @package
+  BOOL isNullValue_;
+  uint32_t count_;
+  int32_t *values_;
+  // `"NAME"` for every value, quotes included.
+  const char **names_;
+  uint32_t *nameLengths_;
+  char *nameBytes_;
+}
+@end
+
+@implementation GPBJSONEnumInfo
+
+- (void)dealloc {
+  free(values_);
+  free(names_);
+  free(nameLengths_);
+  free(nameBytes_);
+  [super dealloc];
+}
+
+@end
+
+static void *JSONMalloc(size_t size) {
+  void *result = malloc(MAX(size, (size_t)1));
+  if (!result) {
+    [NSException raise:NSMallocException format:@"Failed to allocate %lu bytes",
+                                                (unsigned long)size];
+  }
+  return result;
+}
+
+static JSONWellKnownType JSONWellKnownTypeForName(NSString *fullName) {
+  if (![fullName hasPrefix:@"google.protobuf."]) {
+    return JSONWellKnownTypeNone;
+  }
+  static NSDictionary<NSString *, NSNumber *> *types;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    types = [@{
+      @"google.protobuf.Any" : @(JSONWellKnownTypeAny),
+      @"google.protobuf.Timestamp" : @(JSONWellKnownTypeTimestamp),
+      @"google.protobuf.Duration" : @(JSONWellKnownTypeDuration),
+      @"google.protobuf.FieldMask" : @(JSONWellKnownTypeFieldMask),
+      @"google.protobuf.Struct" : @(JSONWellKnownTypeStruct),
+      @"google.protobuf.Value" : @(JSONWellKnownTypeValue),
+      @"google.protobuf.ListValue" : @(JSONWellKnownTypeListValue),
+      @"google.protobuf.Empty" : @(JSONWellKnownTypeEmpty),
+      @"google.protobuf.DoubleValue" : @(JSONWellKnownTypeWrapper),
+      @"google.protobuf.FloatValue" : @(JSONWellKnownTypeWrapper),
+      @"google.protobuf.Int64Value" : @(JSONWellKnownTypeWrapper),
+      @"google.protobuf.UInt64Value" : @(JSONWellKnownTypeWrapper),
+      @"google.protobuf.Int32Value" : @(JSONWellKnownTypeWrapper),
+      @"google.protobuf.UInt32Value" : @(JSONWellKnownTypeWrapper),
+      @"google.protobuf.BoolValue" : @(JSONWellKnownTypeWrapper),
+      @"google.protobuf.StringValue" : @(JSONWellKnownTypeWrapper),
+      @"google.protobuf.BytesValue" : @(JSONWellKnownTypeWrapper),
+    } retain];
+  });
+  return (JSONWellKnownType)[types[fullName] unsignedCharValue];
+}
+
+// The proto field name, as used in text format.
+static NSString *JSONProtoFieldName(GPBFieldDescriptor *field) {
+  NSString *name = [field textFormatName];
+  if (name.length) {
+    return name;
+  }
+  // Custom text format names left out at generation time, undo the ObjC naming.
+  name = field.name;
+  if ([name hasSuffix:@"_p"]) {
+    name = [name substringToIndex:name.length - 2];
+  }
+  if (field.fieldType != GPBFieldTypeSingle && [name hasSuffix:@"Array"]) {
+    name = [name substringToIndex:name.length - 5];
+  }
+  return name;
+}
+
+static int CompareJSONFieldInfo(const void *a, const void *b) {
+  uint32_t lhs = ((const JSONFieldInfo *)a)->number;
+  uint32_t rhs = ((const JSONFieldInfo *)b)->number;
+  return (lhs < rhs) ? -1 : (lhs > rhs);
+}
+
+static GPBJSONMessageInfo *NewJSONMessageInfo(GPBDescriptor *descriptor) {
+  GPBJSONMessageInfo *info = [[GPBJSONMessageInfo alloc] init];
+  info->wellKnownType_ = JSONWellKnownTypeForName(descriptor.fullName);
+  NSArray<GPBFieldDescriptor *> *fields = descriptor.fields;
+  uint32_t count = (uint32_t)fields.count;
+  info->fieldCount_ = count;
+  info->fields_ = JSONMalloc(count * sizeof(JSONFieldInfo));
+  NSArray<GPBOneofDescriptor *> *oneofs = descriptor.oneofs;
+  info->oneofCount_ = (uint32_t)oneofs.count;
+
+  NSMutableArray<NSData *> *protoNames = [NSMutableArray arrayWithCapacity:count];
+  size_t namesSize = 0;
+  for (GPBFieldDescriptor *field in fields) {
+    NSData *name = [JSONProtoFieldName(field) dataUsingEncoding:NSUTF8StringEncoding];
+    [protoNames addObject:name];
+    // Both keys are at most the proto name plus `"":`.
+    namesSize += 2 * (name.length + 4);
+  }
+  info->names_ = JSONMalloc(namesSize);
+
+  char *cursor = info->names_;
+  for (uint32_t i = 0; i < count; i++) {
+    GPBFieldDescriptor *field = fields[i];
+    NSData *protoName = protoNames[i];
+    const char *bytes = protoName.bytes;
+    size_t length = protoName.length;
+    JSONFieldInfo *fieldInfo = &info->fields_[i];
+    fieldInfo->field = field;
+    fieldInfo->number = GPBFieldNumber(field);
+    fieldInfo->dataType = GPBGetFieldDataType(field);
+    fieldInfo->fieldType = field.fieldType;
+    GPBOneofDescriptor *oneof = field.containingOneof;
+    fieldInfo->oneofIndex = oneof ? (int32_t)[oneofs indexOfObjectIdenticalTo:oneof] : -1;
+
+    fieldInfo->protoKey = cursor;
+    *cursor++ = '"';
+    memcpy(cursor, bytes, length);
+    cursor += length;
+    *cursor++ = '"';
+    *cursor++ = ':';
+    fieldInfo->protoKeyLength = (uint32_t)(cursor - fieldInfo->protoKey);
+    *cursor++ = '\0';
+
+    // lowerCamelCase: drop the underscores, capitalizing the letter after them.
+    fieldInfo->jsonKey = cursor;
+    *cursor++ = '"';
+    BOOL capitalizeNext = NO;
+    for (size_t n = 0; n < length; n++) {
+      char c = bytes[n];
+      if (c == '_') {
+        capitalizeNext = YES;
+        continue;
+      }
+      if (capitalizeNext && c >= 'a' && c <= 'z') {
+        c = (char)(c - 'a' + 'A');
+      }
+      capitalizeNext = NO;
+      *cursor++ = c;
+    }
+    *cursor++ = '"';
+    *cursor++ = ':';
+    fieldInfo->jsonKeyLength = (uint32_t)(cursor - fieldInfo->jsonKey);
+    *cursor++ = '\0';
+  }
+  qsort(info->fields_, count, sizeof(JSONFieldInfo), CompareJSONFieldInfo);
+  return info;
+}
+
+// Attaches |built| to |owner| unless a racing thread attached one first, and returns the attached
+// info. An attached info is never replaced, it lives as long as its descriptor, so it can be
+// returned without a retain.
+static id PublishJSONInfo(id owner, const void *key, id built) {
+  os_unfair_lock_lock(&gJSONInfoLock);
+  id info = objc_getAssociatedObject(owner, key);
+  if (!info) {
+    objc_setAssociatedObject(owner, key, built, OBJC_ASSOCIATION_RETAIN);
+    info = built;
+  }
+  os_unfair_lock_unlock(&gJSONInfoLock);
+  [built release];
+  return info;
+}
+
+static GPBJSONMessageInfo *JSONInfoForDescriptor(GPBDescriptor *descriptor) {
+  GPBJSONMessageInfo *info = objc_getAssociatedObject(descriptor, &kJSONMessageInfoKey);
+  if (info) {
+    return info;
+  }
+  // Built outside the lock, threads racing here build equal infos and only one is kept.
+  return PublishJSONInfo(descriptor, &kJSONMessageInfoKey, NewJSONMessageInfo(descriptor));
+}
+
+static GPBJSONMessageInfo *JSONInfoForField(GPBFieldDescriptor *field) {
+  return JSONInfoForDescriptor([field.msgClass descriptor]);
+}
+
+static GPBJSONEnumInfo *JSONInfoForEnum(GPBEnumDescriptor *enumDescriptor) {
+  GPBJSONEnumInfo *info = objc_getAssociatedObject(enumDescriptor, &kJSONEnumInfoKey);
+  if (info) {
+    return info;
+  }
+  info = [[GPBJSONEnumInfo alloc] init];
+  info->isNullValue_ = (enumDescriptor == GPBNullValue_EnumDescriptor());
+  uint32_t count = enumDescriptor.enumNameCount;
+  NSMutableArray<NSData *> *names = [NSMutableArray arrayWithCapacity:count];
+  size_t namesSize = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    NSString *name = [enumDescriptor getEnumTextFormatNameForIndex:i] ?: @"";
+    NSData *data = [name dataUsingEncoding:NSUTF8StringEncoding];
+    [names addObject:data];
+    namesSize += data.length + 2;
+  }
+  info->count_ = count;
+  info->values_ = JSONMalloc(count * sizeof(int32_t));
+  info->names_ = JSONMalloc(count * sizeof(const char *));
+  info->nameLengths_ = JSONMalloc(count * sizeof(uint32_t));
+  info->nameBytes_ = JSONMalloc(namesSize);
+  char *cursor = info->nameBytes_;
+  for (uint32_t i = 0; i < count; i++) {
+    int32_t value = 0;
+    [enumDescriptor getValue:&value
+        forEnumTextFormatName:[enumDescriptor getEnumTextFormatNameForIndex:i]];
+    info->values_[i] = value;
+    info->names_[i] = cursor;
+    *cursor++ = '"';
+    memcpy(cursor, names[i].bytes, names[i].length);
+    cursor += names[i].length;
+    *cursor++ = '"';
+    info->nameLengths_[i] = (uint32_t)(cursor - info->names_[i]);
+  }
+  return PublishJSONInfo(enumDescriptor, &kJSONEnumInfoKey, info);
+}
+
+static const JSONFieldInfo *JSONFieldForNumber(GPBJSONMessageInfo *info, uint32_t number) {
+  uint32_t low = 0;
+  uint32_t high = info->fieldCount_;
+  while (low < high) {
+    uint32_t mid = (low + high) / 2;
+    uint32_t midNumber = info->fields_[mid].number;
+    if (midNumber == number) {
+      return &info->fields_[mid];
+    }
+    if (midNumber < number) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return NULL;
+}
+
+static const JSONFieldInfo *JSONFieldForName(GPBJSONMessageInfo *info, const uint8_t *name,
+                                             size_t length) {
+  for (uint32_t i = 0; i < info->fieldCount_; i++) {
+    const JSONFieldInfo *field = &info->fields_[i];
+    if ((field->jsonKeyLength == length + 3 && memcmp(field->jsonKey + 1, name, length) == 0) ||
+        (field->protoKeyLength == length + 3 && memcmp(field->protoKey + 1, name, length) == 0)) {
+      return field;
+    }
+  }
+  return NULL;
+}
+
+static BOOL JSONDataTypeIsPackable(GPBDataType type) {
+  return type != GPBDataTypeString && type != GPBDataTypeBytes && type != GPBDataTypeMessage &&
+         type != GPBDataTypeGroup;
+}
+
+#pragma mark - Output buffer
+
+typedef struct JSONOutput {
+  uint8_t *bytes;
+  size_t length;
+  size_t capacity;
+} JSONOutput;
+
+static void JSONOutputGrow(JSONOutput *out, size_t extra) {
+  size_t capacity = MAX(out->capacity * 2, out->length + extra);
+  uint8_t *bytes = realloc(out->bytes, capacity);
+  if (!bytes) {
+    [NSException raise:NSMallocException format:@"Failed to allocate %lu bytes",
+                                                (unsigned long)capacity];
+  }
+  out->bytes = bytes;
+  out->capacity = capacity;
+}
+
+GPB_INLINE void JSONOutputReserve(JSONOutput *out, size_t extra) {
+  if (out->capacity - out->length < extra) {
+    JSONOutputGrow(out, extra);
+  }
+}
+
+GPB_INLINE void JSONOutputByte(JSONOutput *out, uint8_t byte) {
+  JSONOutputReserve(out, 1);
+  out->bytes[out->length++] = byte;
+}
+
+GPB_INLINE void JSONOutputBytes(JSONOutput *out, const void *bytes, size_t length) {
+  JSONOutputReserve(out, length);
+  memcpy(out->bytes + out->length, bytes, length);
+  out->length += length;
+}
+
+#define JSONOutputLiteral(out, literal) JSONOutputBytes(out, literal, sizeof(literal) - 1)
+
+static NSData *JSONOutputTakeData(JSONOutput *out) {
+  NSData *data = [NSData dataWithBytesNoCopy:out->bytes length:out->length freeWhenDone:YES];
+  out->bytes = NULL;
+  out->length = out->capacity = 0;
+  return data;
+}
+
+#pragma mark - Text helpers
+
+// Length of the UTF-8 sequence starting at |bytes|, 0 if it isn't valid.
+static size_t JSONUTF8SequenceLength(const uint8_t *bytes, size_t remaining) {
+  uint8_t c = bytes[0];
+  if (c < 0x80) {
+    return 1;
+  }
+  if (c < 0xC2) {
+    return 0;
+  }
+  if (c < 0xE0) {
+    return (remaining >= 2 && (bytes[1] & 0xC0) == 0x80) ? 2 : 0;
+  }
+  if (c < 0xF0) {
+    if (remaining < 3 || (bytes[1] & 0xC0) != 0x80 || (bytes[2] & 0xC0) != 0x80) {
+      return 0;
+    }
+    // Overlong forms and UTF-16 surrogates.
+    if ((c == 0xE0 && bytes[1] < 0xA0) || (c == 0xED && bytes[1] >= 0xA0)) {
+      return 0;
+    }
+    return 3;
+  }
+  if (c < 0xF5) {
+    if (remaining < 4 || (bytes[1] & 0xC0) != 0x80 || (bytes[2] & 0xC0) != 0x80 ||
+        (bytes[3] & 0xC0) != 0x80) {
+      return 0;
+    }
+    if ((c == 0xF0 && bytes[1] < 0x90) || (c == 0xF4 && bytes[1] >= 0x90)) {
+      return 0;
+    }
+    return 4;
+  }
+  return 0;
+}
+
+static void JSONOutputString(JSONOutput *out, const uint8_t *bytes, size_t length) {
+  static const char kHex[] = "0123456789abcdef";
+  JSONOutputReserve(out, length + 2);
+  out->bytes[out->length++] = '"';
+  size_t runStart = 0;
+  size_t i = 0;
+  while (i < length) {
+    uint8_t c = bytes[i];
+    if (c >= 0x80) {
+      size_t sequenceLength = JSONUTF8SequenceLength(bytes + i, length - i);
+      if (sequenceLength == 0) {
+        GPBRaiseStreamError(GPBCodedInputStreamErrorInvalidUTF8,
+                            @"Invalid UTF-8 for a string field");
+      }
+      i += sequenceLength;
+      continue;
+    }
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      i++;
+      continue;
+    }
+    JSONOutputBytes(out, bytes + runStart, i - runStart);
+    switch (c) {
+      case '"':
+        JSONOutputLiteral(out, "\\\"");
+        break;
+      case '\\':
+        JSONOutputLiteral(out, "\\\\");
+        break;
+      case '\n':
+        JSONOutputLiteral(out, "\\n");
+        break;
+      case '\r':
+        JSONOutputLiteral(out, "\\r");
+        break;
+      case '\t':
+        JSONOutputLiteral(out, "\\t");
+        break;
+      case '\b':
+        JSONOutputLiteral(out, "\\b");
+        break;
+      case '\f':
+        JSONOutputLiteral(out, "\\f");
+        break;
+      default: {
+        char escape[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF]};
+        JSONOutputBytes(out, escape, sizeof(escape));
+        break;
+      }
+    }
+    runStart = ++i;
+  }
+  JSONOutputBytes(out, bytes + runStart, length - runStart);
+  JSONOutputByte(out, '"');
+}
+
+static void JSONOutputUInt64(JSONOutput *out, uint64_t value) {
+  char digits[20];
+  size_t count = 0;
+  do {
+    digits[sizeof(digits) - ++count] = (char)('0' + value % 10);
+    value /= 10;
+  } while (value);
+  JSONOutputBytes(out, digits + sizeof(digits) - count, count);
+}
+
+static void JSONOutputInt64(JSONOutput *out, int64_t value) {
+  if (value < 0) {
+    JSONOutputByte(out, '-');
+    JSONOutputUInt64(out, (uint64_t)0 - (uint64_t)value);
+  } else {
+    JSONOutputUInt64(out, (uint64_t)value);
+  }
+}
+
+// Writes the shortest of %.*g forms that reads back as the same value, like
+// the JSON printers of the other protobuf runtimes.
+static void JSONOutputDouble(JSONOutput *out, double value, BOOL isFloat) {
+  if (isnan(value)) {
+    JSONOutputLiteral(out, "\"NaN\"");
+    return;
+  }
+  if (isinf(value)) {
+    if (value > 0) {
+      JSONOutputLiteral(out, "\"Infinity\"");
+    } else {
+      JSONOutputLiteral(out, "\"-Infinity\"");
+    }
+    return;
+  }
+  char buffer[32];
+  int precision = isFloat ? FLT_DIG : DBL_DIG;
+  int length = snprintf_l(buffer, sizeof(buffer), NULL, "%.*g", precision, value);
+  BOOL exact = isFloat ? (strtof_l(buffer, NULL, NULL) == (float)value)
+                       : (strtod_l(buffer, NULL, NULL) == value);
+  if (!exact) {
+    precision = isFloat ? FLT_DECIMAL_DIG : DBL_DECIMAL_DIG;
+    length = snprintf_l(buffer, sizeof(buffer), NULL, "%.*g", precision, value);
+  }
+  JSONOutputBytes(out, buffer, (size_t)length);
+}
+
+static void JSONOutputBase64(JSONOutput *out, const uint8_t *bytes, size_t length) {
+  static const char kAlphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  size_t encodedLength = (length + 2) / 3 * 4;
+  JSONOutputReserve(out, encodedLength + 2);
+  uint8_t *cursor = out->bytes + out->length;
+  *cursor++ = '"';
+  size_t i = 0;
+  for (; i + 3 <= length; i += 3) {
+    uint32_t triple = ((uint32_t)bytes[i] << 16) | ((uint32_t)bytes[i + 1] << 8) | bytes[i + 2];
+    *cursor++ = kAlphabet[(triple >> 18) & 0x3F];
+    *cursor++ = kAlphabet[(triple >> 12) & 0x3F];
+    *cursor++ = kAlphabet[(triple >> 6) & 0x3F];
+    *cursor++ = kAlphabet[triple & 0x3F];
+  }
+  if (i < length) {
+    uint32_t triple = (uint32_t)bytes[i] << 16;
+    if (i + 1 < length) {
+      triple |= (uint32_t)bytes[i + 1] << 8;
+    }
+    *cursor++ = kAlphabet[(triple >> 18) & 0x3F];
+    *cursor++ = kAlphabet[(triple >> 12) & 0x3F];
+    *cursor++ = (i + 1 < length) ? kAlphabet[(triple >> 6) & 0x3F] : '=';
+    *cursor++ = '=';
+  }
+  *cursor++ = '"';
+  out->length = (size_t)(cursor - out->bytes);
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date, and back.
+static int64_t JSONDaysFromCivil(int64_t year, unsigned month, unsigned day) {
+  year -= month <= 2;
+  int64_t era = (year >= 0 ? year : year - 399) / 400;
+  unsigned yearOfEra = (unsigned)(year - era * 400);
+  unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+  return era * 146097 + (int64_t)dayOfEra - 719468;
+}
+
+static void JSONCivilFromDays(int64_t days, int64_t *year, unsigned *month, unsigned *day) {
+  days += 719468;
+  int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+  unsigned dayOfEra = (unsigned)(days - era * 146097);
+  unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+  unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+  unsigned shiftedMonth = (5 * dayOfYear + 2) / 153;
+  *day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+  *month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+  *year = (int64_t)yearOfEra + era * 400 + (*month <= 2);
+}
+
+// Writes 0, 3, 6 or 9 fraction digits, as few as the value needs.
+static void JSONOutputNanos(JSONOutput *out, int32_t nanos) {
+  if (nanos == 0) {
+    return;
+  }
+  char digits[10];
+  int count = 9;
+  if (nanos % 1000000 == 0) {
+    nanos /= 1000000;
+    count = 3;
+  } else if (nanos % 1000 == 0) {
+    nanos /= 1000;
+    count = 6;
+  }
+  digits[0] = '.';
+  for (int i = count; i > 0; i--) {
+    digits[i] = (char)('0' + nanos % 10);
+    nanos /= 10;
+  }
+  JSONOutputBytes(out, digits, (size_t)count + 1);
+}
+
+#pragma mark - Binary to JSON
+
+typedef struct ToJSONContext {
+  GPBCodedInputStream *input;
+  GPBCodedInputStreamState *state;
+  JSONOutput out;
+  GPBJSONTranscoderOptions options;
+} ToJSONContext;
+
+static void WriteJSONMessage(ToJSONContext *ctx, GPBJSONMessageInfo *info, int depth);
+
+static void SkipJSONInputField(ToJSONContext *ctx, int32_t tag) {
+  if (![ctx->input skipField:tag]) {
+    GPBRaiseStreamError(GPBCodedInputStreamErrorInvalidTag, @"Unexpected end group tag");
+  }
+}
+
+static void WriteJSONEnum(ToJSONContext *ctx, GPBFieldDescriptor *field, int32_t value) {
+  GPBJSONEnumInfo *info = JSONInfoForEnum(field.enumDescriptor);
+  if (info->isNullValue_) {
+    JSONOutputLiteral(&ctx->out, "null");
+    return;
+  }
+  if ((ctx->options & GPBJSONTranscoderOptionEnumsAsNumbers) == 0) {
+    for (uint32_t i = 0; i < info->count_; i++) {
+      if (info->values_[i] == value) {
+        JSONOutputBytes(&ctx->out, info->names_[i], info->nameLengths_[i]);
+        return;
+      }
+    }
+  }
+  JSONOutputInt64(&ctx->out, value);
+}
+
+// Writes the JSON of one value of |type| read from the input, for |field| (or
+// the value of the map |field|).
+static void WriteJSONValue(ToJSONContext *ctx, GPBFieldDescriptor *field, GPBDataType type,
+                           int depth) {
+  GPBCodedInputStreamState *state = ctx->state;
+  JSONOutput *out = &ctx->out;
+  switch (type) {
+    case GPBDataTypeBool:
+      if (GPBCodedInputStreamReadBool(state)) {
+        JSONOutputLiteral(out, "true");
+      } else {
+        JSONOutputLiteral(out, "false");
+      }
+      break;
+    case GPBDataTypeInt32:
+      JSONOutputInt64(out, GPBCodedInputStreamReadInt32(state));
+      break;
+    case GPBDataTypeSInt32:
+      JSONOutputInt64(out, GPBCodedInputStreamReadSInt32(state));
+      break;
+    case GPBDataTypeSFixed32:
+      JSONOutputInt64(out, GPBCodedInputStreamReadSFixed32(state));
+      break;
+    case GPBDataTypeUInt32:
+      JSONOutputUInt64(out, GPBCodedInputStreamReadUInt32(state));
+      break;
+    case GPBDataTypeFixed32:
+      JSONOutputUInt64(out, GPBCodedInputStreamReadFixed32(state));
+      break;
+    // 64 bit integers are strings in JSON, doubles can't hold all of them.
+    case GPBDataTypeInt64:
+      JSONOutputByte(out, '"');
+      JSONOutputInt64(out, GPBCodedInputStreamReadInt64(state));
+      JSONOutputByte(out, '"');
+      break;
+    case GPBDataTypeSInt64:
+      JSONOutputByte(out, '"');
+      JSONOutputInt64(out, GPBCodedInputStreamReadSInt64(state));
+      JSONOutputByte(out, '"');
+      break;
+    case GPBDataTypeSFixed64:
+      JSONOutputByte(out, '"');
+      JSONOutputInt64(out, GPBCodedInputStreamReadSFixed64(state));
+      JSONOutputByte(out, '"');
+      break;
+    case GPBDataTypeUInt64:
+      JSONOutputByte(out, '"');
+      JSONOutputUInt64(out, GPBCodedInputStreamReadUInt64(state));
+      JSONOutputByte(out, '"');
+      break;
+    case GPBDataTypeFixed64:
+      JSONOutputByte(out, '"');
+      JSONOutputUInt64(out, GPBCodedInputStreamReadFixed64(state));
+      JSONOutputByte(out, '"');
+      break;
+    case GPBDataTypeFloat:
+      JSONOutputDouble(out, GPBCodedInputStreamReadFloat(state), YES);
+      break;
+    case GPBDataTypeDouble:
+      JSONOutputDouble(out, GPBCodedInputStreamReadDouble(state), NO);
+      break;
+    case GPBDataTypeString: {
+      NSRange range = GPBCodedInputStreamReadLengthDelimitedRange(state);
+      JSONOutputString(out, state->bytes + range.location, range.length);
+      break;
+    }
+    case GPBDataTypeBytes: {
+      NSRange range = GPBCodedInputStreamReadLengthDelimitedRange(state);
+      JSONOutputBase64(out, state->bytes + range.location, range.length);
+      break;
+    }
+    case GPBDataTypeEnum:
+      WriteJSONEnum(ctx, field, GPBCodedInputStreamReadEnum(state));
+      break;
+    case GPBDataTypeMessage: {
+      if (depth + 1 >= kJSONMaxDepth) {
+        GPBRaiseStreamError(GPBCodedInputStreamErrorRecursionDepthExceeded, nil);
+      }
+      int32_t length = GPBCodedInputStreamReadInt32(state);
+      size_t oldLimit = GPBCodedInputStreamPushLimit(state, length);
+      WriteJSONMessage(ctx, JSONInfoForField(field), depth + 1);
+      GPBCodedInputStreamCheckLastTagWas(state, 0);
+      GPBCodedInputStreamPopLimit(state, oldLimit);
+      break;
+    }
+    case GPBDataTypeGroup:
+      RaiseJSONError(GPBJSONTranscoderErrorUnsupportedType,
+                     [NSString stringWithFormat:@"Group field %@ has no JSON form", field.name]);
+  }
+}
+
+// Writes the JSON of a value that isn't on the wire.
+static void WriteJSONDefaultValue(ToJSONContext *ctx, GPBFieldDescriptor *field, GPBDataType type,
+                                  int depth) {
+  JSONOutput *out = &ctx->out;
+  switch (type) {
+    case GPBDataTypeBool:
+      JSONOutputLiteral(out, "false");
+      break;
+    case GPBDataTypeInt64:
+    case GPBDataTypeSInt64:
+    case GPBDataTypeSFixed64:
+    case GPBDataTypeUInt64:
+    case GPBDataTypeFixed64:
+      JSONOutputLiteral(out, "\"0\"");
+      break;
+    case GPBDataTypeString:
+    case GPBDataTypeBytes:
+      JSONOutputLiteral(out, "\"\"");
+      break;
+    case GPBDataTypeEnum:
+      WriteJSONEnum(ctx, field, 0);
+      break;
+    case GPBDataTypeMessage:
+    case GPBDataTypeGroup: {
+      // An empty message, well known types have their own default forms.
+      size_t oldLimit = GPBCodedInputStreamPushLimit(ctx->state, 0);
+      WriteJSONMessage(ctx, JSONInfoForField(field), depth + 1);
+      GPBCodedInputStreamPopLimit(ctx->state, oldLimit);
+      break;
+    }
+    default:
+      JSONOutputByte(out, '0');
+      break;
+  }
+}
+
+// Writes the map key of an entry as a JSON string.
+static void WriteJSONMapKey(ToJSONContext *ctx, GPBDataType keyType) {
+  JSONOutput *out = &ctx->out;
+  switch (keyType) {
+    case GPBDataTypeString: {
+      NSRange range = GPBCodedInputStreamReadLengthDelimitedRange(ctx->state);
+      JSONOutputString(out, ctx->state->bytes + range.location, range.length);
+      break;
+    }
+    case GPBDataTypeBool:
+    case GPBDataTypeInt32:
+    case GPBDataTypeSInt32:
+    case GPBDataTypeSFixed32:
+    case GPBDataTypeUInt32:
+    case GPBDataTypeFixed32:
+      JSONOutputByte(out, '"');
+      WriteJSONValue(ctx, nil, keyType, 0);
+      JSONOutputByte(out, '"');
+      break;
+    default:
+      // 64 bit values are already quoted.
+      WriteJSONValue(ctx, nil, keyType, 0);
+      break;
+  }
+}
+
+static void WriteJSONMapEntry(ToJSONContext *ctx, GPBFieldDescriptor *field, int depth) {
+  GPBCodedInputStreamState *state = ctx->state;
+  GPBDataType keyType = field.mapKeyDataType;
+  GPBDataType valueType = GPBGetFieldDataType(field);
+  uint32_t keyTag = GPBWireFormatMakeTag(1, GPBWireFormatForType(keyType, NO));
+  uint32_t valueTag = GPBWireFormatMakeTag(2, GPBWireFormatForType(valueType, NO));
+
+  int32_t length = GPBCodedInputStreamReadInt32(state);
+  size_t oldLimit = GPBCodedInputStreamPushLimit(state, length);
+  // The key and value can come in any order, find them first.
+  size_t keyPosition = SIZE_MAX;
+  size_t valuePosition = SIZE_MAX;
+  while (YES) {
+    int32_t tag = GPBCodedInputStreamReadTag(state);
+    if (tag == 0) {
+      break;
+    }
+    if ((uint32_t)tag == keyTag) {
+      keyPosition = state->bufferPos;
+    } else if ((uint32_t)tag == valueTag) {
+      valuePosition = state->bufferPos;
+    }
+    SkipJSONInputField(ctx, tag);
+  }
+  size_t end = state->bufferPos;
+
+  if (keyPosition != SIZE_MAX) {
+    state->bufferPos = keyPosition;
+    WriteJSONMapKey(ctx, keyType);
+  } else if (keyType == GPBDataTypeString) {
+    JSONOutputLiteral(&ctx->out, "\"\"");
+  } else if (keyType == GPBDataTypeBool) {
+    JSONOutputLiteral(&ctx->out, "\"false\"");
+  } else {
+    JSONOutputLiteral(&ctx->out, "\"0\"");
+  }
+  JSONOutputByte(&ctx->out, ':');
+  if (valuePosition != SIZE_MAX) {
+    state->bufferPos = valuePosition;
+    WriteJSONValue(ctx, field, valueType, depth);
+  } else {
+    WriteJSONDefaultValue(ctx, field, valueType, depth);
+  }
+  state->bufferPos = end;
+  GPBCodedInputStreamPopLimit(state, oldLimit);
+}
+
+// Writes the elements of one occurrence of a repeated or map field.
+static void WriteJSONElements(ToJSONContext *ctx, const JSONFieldInfo *fieldInfo, int32_t tag,
+                              BOOL *first, int depth) {
+  GPBCodedInputStreamState *state = ctx->state;
+  GPBWireFormat wireType = GPBWireFormatGetTagWireType(tag);
+  if (fieldInfo->fieldType == GPBFieldTypeMap) {
+    if (wireType != GPBWireFormatLengthDelimited) {
+      SkipJSONInputField(ctx, tag);
+      return;
+    }
+    if (!*first) {
+      JSONOutputByte(&ctx->out, ',');
+    }
+    *first = NO;
+    WriteJSONMapEntry(ctx, fieldInfo->field, depth);
+    return;
+  }
+  if (wireType == GPBWireFormatLengthDelimited && JSONDataTypeIsPackable(fieldInfo->dataType)) {
+    int32_t length = GPBCodedInputStreamReadInt32(state);
+    size_t oldLimit = GPBCodedInputStreamPushLimit(state, length);
+    while (!GPBCodedInputStreamIsAtEnd(state)) {
+      if (!*first) {
+        JSONOutputByte(&ctx->out, ',');
+      }
+      *first = NO;
+      WriteJSONValue(ctx, fieldInfo->field, fieldInfo->dataType, depth);
+    }
+    GPBCodedInputStreamPopLimit(state, oldLimit);
+    return;
+  }
+  if (wireType != GPBWireFormatForType(fieldInfo->dataType, NO)) {
+    SkipJSONInputField(ctx, tag);
+    return;
+  }
+  if (!*first) {
+    JSONOutputByte(&ctx->out, ',');
+  }
+  *first = NO;
+  WriteJSONValue(ctx, fieldInfo->field, fieldInfo->dataType, depth);
+}
+
+// Writes a repeated field as an array (a map as an object), starting with the
+// occurrence whose tag was just read. Occurrences can be interleaved with other
+// fields, the rest of the message is scanned for them so they all end up in the
+// same array, the caller then skips them.
+static void WriteJSONRepeated(ToJSONContext *ctx, const JSONFieldInfo *fieldInfo, int32_t firstTag,
+                              int depth) {
+  GPBCodedInputStreamState *state = ctx->state;
+  BOOL isMap = fieldInfo->fieldType == GPBFieldTypeMap;
+  JSONOutputByte(&ctx->out, isMap ? '{' : '[');
+  BOOL first = YES;
+  WriteJSONElements(ctx, fieldInfo, firstTag, &first, depth);
+  size_t resume = state->bufferPos;
+  while (YES) {
+    int32_t tag = GPBCodedInputStreamReadTag(state);
+    if (tag == 0) {
+      break;
+    }
+    if (GPBWireFormatGetTagFieldNumber(tag) == fieldInfo->number) {
+      WriteJSONElements(ctx, fieldInfo, tag, &first, depth);
+    } else {
+      SkipJSONInputField(ctx, tag);
+    }
+  }
+  state->bufferPos = resume;
+  JSONOutputByte(&ctx->out, isMap ? '}' : ']');
+}
+
+// Finds the last occurrence of each field of a well known type, returning the
+// number of the last field seen (0 for none). |positions| is indexed by field
+// number - 1 and gets the offset of the value, SIZE_MAX when absent. The input
+// is left at the end of the message.
+static uint32_t ScanJSONWellKnownFields(ToJSONContext *ctx, GPBJSONMessageInfo *info,
+                                        size_t *positions, uint32_t count) {
+  GPBCodedInputStreamState *state = ctx->state;
+  for (uint32_t i = 0; i < count; i++) {
+    positions[i] = SIZE_MAX;
+  }
+  uint32_t last = 0;
+  while (YES) {
+    int32_t tag = GPBCodedInputStreamReadTag(state);
+    if (tag == 0) {
+      break;
+    }
+    uint32_t number = GPBWireFormatGetTagFieldNumber(tag);
+    const JSONFieldInfo *fieldInfo = JSONFieldForNumber(info, number);
+    if (fieldInfo && number <= count &&
+        GPBWireFormatGetTagWireType(tag) == GPBWireFormatForType(fieldInfo->dataType, NO)) {
+      positions[number - 1] = state->bufferPos;
+      last = number;
+    }
+    SkipJSONInputField(ctx, tag);
+  }
+  return last;
+}
+
+static void WriteJSONTimestamp(ToJSONContext *ctx, GPBJSONMessageInfo *info) {
+  GPBCodedInputStreamState *state = ctx->state;
+  size_t positions[2];
+  ScanJSONWellKnownFields(ctx, info, positions, 2);
+  size_t end = state->bufferPos;
+  int64_t seconds = 0;
+  int32_t nanos = 0;
+  if (positions[0] != SIZE_MAX) {
+    state->bufferPos = positions[0];
+    seconds = GPBCodedInputStreamReadInt64(state);
+  }
+  if (positions[1] != SIZE_MAX) {
+    state->bufferPos = positions[1];
+    nanos = GPBCodedInputStreamReadInt32(state);
+  }
+  state->bufferPos = end;
+  if (seconds < kJSONTimestampMinSeconds || seconds > kJSONTimestampMaxSeconds || nanos < 0 ||
+      nanos > kJSONMaxNanos) {
+    RaiseJSONError(GPBJSONTranscoderErrorInvalidValue, @"Timestamp out of range");
+  }
+  int64_t days = seconds / 86400;
+  int64_t secondsOfDay = seconds % 86400;
+  if (secondsOfDay < 0) {
+    secondsOfDay += 86400;
+    days--;
+  }
+  int64_t year;
+  unsigned month, day;
+  JSONCivilFromDays(days, &year, &month, &day);
+  char buffer[32];
+  int length = snprintf_l(buffer, sizeof(buffer), NULL, "\"%04d-%02u-%02uT%02d:%02d:%02d",
+                          (int)year, month, day, (int)(secondsOfDay / 3600),
+                          (int)(secondsOfDay / 60 % 60), (int)(secondsOfDay % 60));
+  JSONOutputBytes(&ctx->out, buffer, (size_t)length);
+  JSONOutputNanos(&ctx->out, nanos);
+  JSONOutputLiteral(&ctx->out, "Z\"");
+}
+
+static void WriteJSONDuration(ToJSONContext *ctx, GPBJSONMessageInfo *info) {
+  GPBCodedInputStreamState *state = ctx->state;
+  size_t positions[2];
+  ScanJSONWellKnownFields(ctx, info, positions, 2);
+  size_t end = state->bufferPos;
+  int64_t seconds = 0;
+  int32_t nanos = 0;
+  if (positions[0] != SIZE_MAX) {
+    state->bufferPos = positions[0];
+    seconds = GPBCodedInputStreamReadInt64(state);
+  }
+  if (positions[1] != SIZE_MAX) {
+    state->bufferPos = positions[1];
+    nanos = GPBCodedInputStreamReadInt32(state);
+  }
+  state->bufferPos = end;
+  if (seconds < -kJSONDurationMaxSeconds || seconds > kJSONDurationMaxSeconds ||
+      nanos < -kJSONMaxNanos || nanos > kJSONMaxNanos || (seconds < 0 && nanos > 0) ||
+      (seconds > 0 && nanos < 0)) {
+    RaiseJSONError(GPBJSONTranscoderErrorInvalidValue, @"Duration out of range");
+  }
+  JSONOutputByte(&ctx->out, '"');
+  if (seconds < 0 || nanos < 0) {
+    JSONOutputByte(&ctx->out, '-');
+  }
+  JSONOutputUInt64(&ctx->out, (uint64_t)llabs(seconds));
+  JSONOutputNanos(&ctx->out, abs(nanos));
+  JSONOutputLiteral(&ctx->out, "s\"");
+}
+
+static void WriteJSONFieldMask(ToJSONContext *ctx) {
+  GPBCodedInputStreamState *state = ctx->state;
+  uint32_t pathsTag = GPBWireFormatMakeTag(GPBFieldMask_FieldNumber_PathsArray,
+                                           GPBWireFormatLengthDelimited);
+  JSONOutput *out = &ctx->out;
+  JSONOutputByte(out, '"');
+  BOOL first = YES;
+  while (YES) {
+    int32_t tag = GPBCodedInputStreamReadTag(state);
+    if (tag == 0) {
+      break;
+    }
+    if ((uint32_t)tag != pathsTag) {
+      SkipJSONInputField(ctx, tag);
+      continue;
+    }
+    NSRange range = GPBCodedInputStreamReadLengthDelimitedRange(state);
+    const uint8_t *path = state->bytes + range.location;
+    if (!first) {
+      JSONOutputByte(out, ',');
+    }
+    first = NO;
+    // Paths are field names, lowerCamelCase them.
+    BOOL capitalizeNext = NO;
+    for (NSUInteger i = 0; i < range.length; i++) {
+      uint8_t c = path[i];
+      if (c == '_') {
+        capitalizeNext = YES;
+        continue;
+      }
+      if (c < 0x20 || c == '"' || c == '\\' || c >= 0x80) {
+        RaiseJSONError(GPBJSONTranscoderErrorInvalidValue, @"FieldMask path isn't a field name");
+      }
+      if (capitalizeNext && c >= 'a' && c <= 'z') {
+        c = (uint8_t)(c - 'a' + 'A');
+      }
+      capitalizeNext = NO;
+      JSONOutputByte(out, c);
+    }
+  }
+  JSONOutputByte(out, '"');
+}
+
+// Struct and ListValue are the JSON form of their only field.
+static void WriteJSONOnlyField(ToJSONContext *ctx, GPBJSONMessageInfo *info, int depth) {
+  const JSONFieldInfo *fieldInfo = &info->fields_[0];
+  BOOL written = NO;
+  while (YES) {
+    int32_t tag = GPBCodedInputStreamReadTag(ctx->state);
+    if (tag == 0) {
+      break;
+    }
+    if (!written && GPBWireFormatGetTagFieldNumber(tag) == fieldInfo->number) {
+      WriteJSONRepeated(ctx, fieldInfo, tag, depth);
+      written = YES;
+    } else {
+      SkipJSONInputField(ctx, tag);
+    }
+  }
+  if (!written) {
+    if (fieldInfo->fieldType == GPBFieldTypeMap) {
+      JSONOutputLiteral(&ctx->out, "{}");
+    } else {
+      JSONOutputLiteral(&ctx->out, "[]");
+    }
+  }
+}
+
+// Wrappers and Value are the JSON form of their last field set.
+static void WriteJSONLastField(ToJSONContext *ctx, GPBJSONMessageInfo *info, int depth) {
+  GPBCodedInputStreamState *state = ctx->state;
+  size_t positions[GPBValue_FieldNumber_ListValue];
+  uint32_t last = ScanJSONWellKnownFields(ctx, info, positions, info->fieldCount_);
+  size_t end = state->bufferPos;
+  if (last == 0) {
+    if (info->wellKnownType_ == JSONWellKnownTypeWrapper) {
+      WriteJSONDefaultValue(ctx, info->fields_[0].field, info->fields_[0].dataType, depth);
+    } else {
+      JSONOutputLiteral(&ctx->out, "null");
+    }
+    return;
+  }
+  const JSONFieldInfo *fieldInfo = JSONFieldForNumber(info, last);
+  state->bufferPos = positions[last - 1];
+  WriteJSONValue(ctx, fieldInfo->field, fieldInfo->dataType, depth);
+  state->bufferPos = end;
+}
+
+// Where the value of each singular field is in a message. A singular field can be on the wire more
+// than once and the parser keeps the last value (merges messages), and only keeps the last field set
+// of a oneof. All arrays are indexed like info->fields_, offsets are the ones of values, SIZE_MAX
+// when absent.
+typedef struct JSONSingularFields {
+  // The occurrence to write.
+  size_t *last;
+  // The first occurrence merged into |last|, only differs from it for messages.
+  size_t *first;
+  // The field set last by index in the message's oneofs.
+  size_t *oneofFields;
+} JSONSingularFields;
+
+// Fills |fields| for the message at the input, leaving the input where it was.
+static void ScanJSONSingularFields(ToJSONContext *ctx, GPBJSONMessageInfo *info,
+                                   JSONSingularFields *fields) {
+  GPBCodedInputStreamState *state = ctx->state;
+  for (uint32_t i = 0; i < info->fieldCount_; i++) {
+    fields->last[i] = fields->first[i] = SIZE_MAX;
+  }
+  for (uint32_t i = 0; i < info->oneofCount_; i++) {
+    fields->oneofFields[i] = SIZE_MAX;
+  }
+  size_t start = state->bufferPos;
+  while (YES) {
+    int32_t tag = GPBCodedInputStreamReadTag(state);
+    if (tag == 0) {
+      break;
+    }
+    const JSONFieldInfo *fieldInfo = JSONFieldForNumber(info, GPBWireFormatGetTagFieldNumber(tag));
+    if (fieldInfo && fieldInfo->fieldType == GPBFieldTypeSingle &&
+        GPBWireFormatGetTagWireType(tag) == GPBWireFormatForType(fieldInfo->dataType, NO)) {
+      size_t index = (size_t)(fieldInfo - info->fields_);
+      // Setting another field of a oneof clears this one, merging starts over.
+      if (fieldInfo->oneofIndex >= 0 && fields->oneofFields[fieldInfo->oneofIndex] != index) {
+        fields->oneofFields[fieldInfo->oneofIndex] = index;
+        fields->first[index] = SIZE_MAX;
+      }
+      if (fields->first[index] == SIZE_MAX || fieldInfo->dataType != GPBDataTypeMessage) {
+        fields->first[index] = state->bufferPos;
+      }
+      fields->last[index] = state->bufferPos;
+    }
+    SkipJSONInputField(ctx, tag);
+  }
+  state->bufferPos = start;
+}
+
+// Writes the merge of the occurrences of a singular message field from the one at |first| to the
+// one at |last|, where the input is. The input is left after the last one.
+static void WriteJSONMergedMessage(ToJSONContext *ctx, const JSONFieldInfo *fieldInfo,
+                                   size_t first, size_t last, int depth) {
+  if (depth + 1 >= kJSONMaxDepth) {
+    GPBRaiseStreamError(GPBCodedInputStreamErrorRecursionDepthExceeded, nil);
+  }
+  GPBCodedInputStreamState *state = ctx->state;
+  uint32_t tag = GPBWireFormatMakeTag(fieldInfo->number, GPBWireFormatLengthDelimited);
+  NSMutableData *merged = [NSMutableData data];
+  state->bufferPos = first;
+  while (YES) {
+    size_t position = state->bufferPos;
+    NSRange range = GPBCodedInputStreamReadLengthDelimitedRange(state);
+    [merged appendBytes:state->bytes + range.location length:range.length];
+    if (position == last) {
+      break;
+    }
+    int32_t nextTag;
+    while ((uint32_t)(nextTag = GPBCodedInputStreamReadTag(state)) != tag) {
+      SkipJSONInputField(ctx, nextTag);
+    }
+  }
+  // Concatenated messages parse as their merge, transcode that.
+  GPBCodedInputStream *outerInput = ctx->input;
+  GPBCodedInputStream *input = [[[GPBCodedInputStream alloc] initWithData:merged] autorelease];
+  ctx->input = input;
+  ctx->state = &input->state_;
+  WriteJSONMessage(ctx, JSONInfoForField(fieldInfo->field), depth + 1);
+  GPBCodedInputStreamCheckLastTagWas(ctx->state, 0);
+  ctx->input = outerInput;
+  ctx->state = state;
+}
+
+static void WriteJSONMessage(ToJSONContext *ctx, GPBJSONMessageInfo *info, int depth) {
+  GPBCodedInputStreamState *state = ctx->state;
+  switch (info->wellKnownType_) {
+    case JSONWellKnownTypeNone:
+      break;
+    case JSONWellKnownTypeAny:
+      RaiseJSONError(GPBJSONTranscoderErrorUnsupportedType,
+                     @"Any has no JSON form without its type");
+    case JSONWellKnownTypeTimestamp:
+      WriteJSONTimestamp(ctx, info);
+      return;
+    case JSONWellKnownTypeDuration:
+      WriteJSONDuration(ctx, info);
+      return;
+    case JSONWellKnownTypeFieldMask:
+      WriteJSONFieldMask(ctx);
+      return;
+    case JSONWellKnownTypeStruct:
+    case JSONWellKnownTypeListValue:
+      WriteJSONOnlyField(ctx, info, depth);
+      return;
+    case JSONWellKnownTypeValue:
+    case JSONWellKnownTypeWrapper:
+      WriteJSONLastField(ctx, info, depth);
+      return;
+    case JSONWellKnownTypeEmpty:
+      break;
+  }
+
+  BOOL useProtoNames = (ctx->options & GPBJSONTranscoderOptionProtoFieldNames) != 0;
+  JSONOutput *out = &ctx->out;
+  JSONOutputByte(out, '{');
+  BOOL first = YES;
+  // Repeated and map fields already written, by index in info->fields_.
+  uint64_t writtenBits[4] = {0, 0, 0, 0};
+  uint8_t *written = (uint8_t *)writtenBits;
+  NSMutableData *writtenData = nil;
+  if (info->fieldCount_ > sizeof(writtenBits) * 8) {
+    writtenData = [NSMutableData dataWithLength:(info->fieldCount_ + 7) / 8];
+    written = writtenData.mutableBytes;
+  }
+  size_t positionsBuffer[96];
+  size_t *positions = positionsBuffer;
+  size_t positionsCount = 2 * (size_t)info->fieldCount_ + info->oneofCount_;
+  NSMutableData *positionsData = nil;
+  if (positionsCount > sizeof(positionsBuffer) / sizeof(size_t)) {
+    positionsData = [NSMutableData dataWithLength:positionsCount * sizeof(size_t)];
+    positions = positionsData.mutableBytes;
+  }
+  JSONSingularFields singular = {positions, positions + info->fieldCount_,
+                                 positions + 2 * info->fieldCount_};
+  ScanJSONSingularFields(ctx, info, &singular);
+  while (YES) {
+    int32_t tag = GPBCodedInputStreamReadTag(state);
+    if (tag == 0) {
+      break;
+    }
+    const JSONFieldInfo *fieldInfo = JSONFieldForNumber(info, GPBWireFormatGetTagFieldNumber(tag));
+    if (!fieldInfo) {
+      SkipJSONInputField(ctx, tag);
+      continue;
+    }
+    if (fieldInfo->fieldType == GPBFieldTypeSingle &&
+        GPBWireFormatGetTagWireType(tag) != GPBWireFormatForType(fieldInfo->dataType, NO)) {
+      // Not the wire type of the field, an unknown field for the parser too.
+      SkipJSONInputField(ctx, tag);
+      continue;
+    }
+    size_t index = (size_t)(fieldInfo - info->fields_);
+    if (fieldInfo->fieldType == GPBFieldTypeSingle) {
+      if (state->bufferPos != singular.last[index] ||
+          (fieldInfo->oneofIndex >= 0 && singular.oneofFields[fieldInfo->oneofIndex] != index)) {
+        // Replaced by a later occurrence, or by another field of its oneof.
+        SkipJSONInputField(ctx, tag);
+        continue;
+      }
+    } else {
+      if (written[index / 8] & (1 << (index % 8))) {
+        SkipJSONInputField(ctx, tag);
+        continue;
+      }
+      written[index / 8] |= (uint8_t)(1 << (index % 8));
+    }
+    if (!first) {
+      JSONOutputByte(out, ',');
+    }
+    first = NO;
+    if (useProtoNames) {
+      JSONOutputBytes(out, fieldInfo->protoKey, fieldInfo->protoKeyLength);
+    } else {
+      JSONOutputBytes(out, fieldInfo->jsonKey, fieldInfo->jsonKeyLength);
+    }
+    if (fieldInfo->fieldType != GPBFieldTypeSingle) {
+      WriteJSONRepeated(ctx, fieldInfo, tag, depth);
+    } else if (singular.first[index] != singular.last[index]) {
+      WriteJSONMergedMessage(ctx, fieldInfo, singular.first[index], singular.last[index], depth);
+    } else {
+      WriteJSONValue(ctx, fieldInfo->field, fieldInfo->dataType, depth);
+    }
+  }
+  JSONOutputByte(out, '}');
+}
+
+#pragma mark - JSON to binary
+
+typedef struct FromJSONContext {
+  const uint8_t *start;
+  const uint8_t *cursor;
+  const uint8_t *end;
+  // The binary output.
+  JSONOutput out;
+  // Unescaped strings, only used for strings with escapes.
+  JSONOutput scratch;
+  GPBJSONTranscoderOptions options;
+} FromJSONContext;
+
+static void RaiseInvalidJSON(FromJSONContext *ctx, NSString *what) __attribute__((noreturn));
+
+static void RaiseInvalidJSON(FromJSONContext *ctx, NSString *what) {
+  RaiseJSONError(GPBJSONTranscoderErrorInvalidJSON,
+                 [NSString stringWithFormat:@"%@ at offset %lu", what,
+                                            (unsigned long)(ctx->cursor - ctx->start)]);
+}
+
+static void RaiseInvalidValue(FromJSONContext *ctx, NSString *what) __attribute__((noreturn));
+
+static void RaiseInvalidValue(FromJSONContext *ctx, NSString *what) {
+  RaiseJSONError(GPBJSONTranscoderErrorInvalidValue,
+                 [NSString stringWithFormat:@"%@ at offset %lu", what,
+                                            (unsigned long)(ctx->cursor - ctx->start)]);
+}
+
+// Skips whitespace, returning the next byte (0 at the end of the input).
+static uint8_t PeekJSON(FromJSONContext *ctx) {
+  while (ctx->cursor < ctx->end) {
+    uint8_t c = *ctx->cursor;
+    if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+      return c;
+    }
+    ctx->cursor++;
+  }
+  return 0;
+}
+
+static void ExpectJSON(FromJSONContext *ctx, uint8_t c) {
+  if (PeekJSON(ctx) != c) {
+    RaiseInvalidJSON(ctx, [NSString stringWithFormat:@"Expected '%c'", c]);
+  }
+  ctx->cursor++;
+}
+
+static BOOL ConsumeJSON(FromJSONContext *ctx, uint8_t c) {
+  if (PeekJSON(ctx) == c) {
+    ctx->cursor++;
+    return YES;
+  }
+  return NO;
+}
+
+static BOOL ConsumeJSONLiteral(FromJSONContext *ctx, const char *literal, size_t length) {
+  if ((size_t)(ctx->end - ctx->cursor) >= length && memcmp(ctx->cursor, literal, length) == 0) {
+    ctx->cursor += length;
+    return YES;
+  }
+  return NO;
+}
+
+// Continues an array or object after an element, NO once |close| was read.
+static BOOL NextJSONElement(FromJSONContext *ctx, uint8_t close) {
+  if (ConsumeJSON(ctx, ',')) {
+    return YES;
+  }
+  ExpectJSON(ctx, close);
+  return NO;
+}
+
+static int JSONHexValue(uint8_t c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+static uint32_t ReadJSONHex4(FromJSONContext *ctx) {
+  if (ctx->end - ctx->cursor < 4) {
+    RaiseInvalidJSON(ctx, @"Truncated \\u escape");
+  }
+  uint32_t value = 0;
+  for (int i = 0; i < 4; i++) {
+    int digit = JSONHexValue(ctx->cursor[i]);
+    if (digit < 0) {
+      RaiseInvalidJSON(ctx, @"Invalid \\u escape");
+    }
+    value = (value << 4) | (uint32_t)digit;
+  }
+  ctx->cursor += 4;
+  return value;
+}
+
+static void AppendJSONCodePoint(JSONOutput *out, uint32_t c) {
+  uint8_t bytes[4];
+  size_t length;
+  if (c < 0x80) {
+    bytes[0] = (uint8_t)c;
+    length = 1;
+  } else if (c < 0x800) {
+    bytes[0] = (uint8_t)(0xC0 | (c >> 6));
+    bytes[1] = (uint8_t)(0x80 | (c & 0x3F));
+    length = 2;
+  } else if (c < 0x10000) {
+    bytes[0] = (uint8_t)(0xE0 | (c >> 12));
+    bytes[1] = (uint8_t)(0x80 | ((c >> 6) & 0x3F));
+    bytes[2] = (uint8_t)(0x80 | (c & 0x3F));
+    length = 3;
+  } else {
+    bytes[0] = (uint8_t)(0xF0 | (c >> 18));
+    bytes[1] = (uint8_t)(0x80 | ((c >> 12) & 0x3F));
+    bytes[2] = (uint8_t)(0x80 | ((c >> 6) & 0x3F));
+    bytes[3] = (uint8_t)(0x80 | (c & 0x3F));
+    length = 4;
+  }
+  JSONOutputBytes(out, bytes, length);
+}
+
+// Reads a string, returning its UTF-8 bytes. Strings without escapes point
+// into the input, the others into ctx->scratch until the next string is read.
+static void ReadJSONString(FromJSONContext *ctx, const uint8_t **outBytes, size_t *outLength) {
+  ExpectJSON(ctx, '"');
+  const uint8_t *runStart = ctx->cursor;
+  BOOL escaped = NO;
+  ctx->scratch.length = 0;
+  while (YES) {
+    if (ctx->cursor >= ctx->end) {
+      RaiseInvalidJSON(ctx, @"Unterminated string");
+    }
+    uint8_t c = *ctx->cursor;
+    if (c == '"') {
+      break;
+    }
+    if (c < 0x20) {
+      RaiseInvalidJSON(ctx, @"Control character in string");
+    }
+    if (c >= 0x80) {
+      size_t sequenceLength =
+          JSONUTF8SequenceLength(ctx->cursor, (size_t)(ctx->end - ctx->cursor));
+      if (sequenceLength == 0) {
+        RaiseInvalidJSON(ctx, @"Invalid UTF-8");
+      }
+      ctx->cursor += sequenceLength;
+      continue;
+    }
+    if (c != '\\') {
+      ctx->cursor++;
+      continue;
+    }
+    escaped = YES;
+    JSONOutputBytes(&ctx->scratch, runStart, (size_t)(ctx->cursor - runStart));
+    ctx->cursor++;
+    if (ctx->cursor >= ctx->end) {
+      RaiseInvalidJSON(ctx, @"Unterminated string");
+    }
+    uint8_t escape = *ctx->cursor++;
+    switch (escape) {
+      case '"':
+      case '\\':
+      case '/':
+        JSONOutputByte(&ctx->scratch, escape);
+        break;
+      case 'b':
+        JSONOutputByte(&ctx->scratch, '\b');
+        break;
+      case 'f':
+        JSONOutputByte(&ctx->scratch, '\f');
+        break;
+      case 'n':
+        JSONOutputByte(&ctx->scratch, '\n');
+        break;
+      case 'r':
+        JSONOutputByte(&ctx->scratch, '\r');
+        break;
+      case 't':
+        JSONOutputByte(&ctx->scratch, '\t');
+        break;
+      case 'u': {
+        uint32_t codePoint = ReadJSONHex4(ctx);
+        if (codePoint >= 0xD800 && codePoint < 0xDC00) {
+          if (!ConsumeJSONLiteral(ctx, "\\u", 2)) {
+            RaiseInvalidJSON(ctx, @"Unpaired surrogate");
+          }
+          uint32_t low = ReadJSONHex4(ctx);
+          if (low < 0xDC00 || low >= 0xE000) {
+            RaiseInvalidJSON(ctx, @"Unpaired surrogate");
+          }
+          codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+        } else if (codePoint >= 0xDC00 && codePoint < 0xE000) {
+          RaiseInvalidJSON(ctx, @"Unpaired surrogate");
+        }
+        AppendJSONCodePoint(&ctx->scratch, codePoint);
+        break;
+      }
+      default:
+        RaiseInvalidJSON(ctx, @"Invalid escape");
+    }
+    runStart = ctx->cursor;
+  }
+  if (escaped) {
+    JSONOutputBytes(&ctx->scratch, runStart, (size_t)(ctx->cursor - runStart));
+    *outBytes = ctx->scratch.bytes;
+    *outLength = ctx->scratch.length;
+  } else {
+    *outBytes = runStart;
+    *outLength = (size_t)(ctx->cursor - runStart);
+  }
+  ctx->cursor++;
+}
+
+// Length of the JSON number at |bytes|, 0 if there isn't one.
+static size_t JSONNumberLength(const uint8_t *bytes, size_t length) {
+  size_t i = 0;
+  if (i < length && bytes[i] == '-') i++;
+  if (i >= length) return 0;
+  if (bytes[i] == '0') {
+    i++;
+  } else if (bytes[i] >= '1' && bytes[i] <= '9') {
+    while (i < length && bytes[i] >= '0' && bytes[i] <= '9') i++;
+  } else {
+    return 0;
+  }
+  if (i < length && bytes[i] == '.') {
+    i++;
+    size_t digits = i;
+    while (i < length && bytes[i] >= '0' && bytes[i] <= '9') i++;
+    if (i == digits) return 0;
+  }
+  if (i < length && (bytes[i] == 'e' || bytes[i] == 'E')) {
+    i++;
+    if (i < length && (bytes[i] == '+' || bytes[i] == '-')) i++;
+    size_t digits = i;
+    while (i < length && bytes[i] >= '0' && bytes[i] <= '9') i++;
+    if (i == digits) return 0;
+  }
+  return i;
+}
+
+// Reads a number, or a string (numbers can be quoted in the JSON mapping).
+static void ReadJSONNumberToken(FromJSONContext *ctx, const uint8_t **outBytes, size_t *outLength,
+                                BOOL *outQuoted) {
+  uint8_t c = PeekJSON(ctx);
+  if (c == '"') {
+    ReadJSONString(ctx, outBytes, outLength);
+    *outQuoted = YES;
+    return;
+  }
+  size_t length = JSONNumberLength(ctx->cursor, (size_t)(ctx->end - ctx->cursor));
+  if (length == 0) {
+    RaiseInvalidValue(ctx, @"Expected a number");
+  }
+  *outBytes = ctx->cursor;
+  *outLength = length;
+  *outQuoted = NO;
+  ctx->cursor += length;
+}
+
+static double ParseJSONDouble(FromJSONContext *ctx, const uint8_t *bytes, size_t length,
+                              BOOL quoted) {
+  if (quoted) {
+    if (length == 3 && memcmp(bytes, "NaN", 3) == 0) return NAN;
+    if (length == 8 && memcmp(bytes, "Infinity", 8) == 0) return INFINITY;
+    if (length == 9 && memcmp(bytes, "-Infinity", 9) == 0) return -INFINITY;
+  }
+  if (length == 0 || JSONNumberLength(bytes, length) != length) {
+    RaiseInvalidValue(ctx, @"Invalid number");
+  }
+  char buffer[128];
+  if (length >= sizeof(buffer)) {
+    RaiseInvalidValue(ctx, @"Number too long");
+  }
+  memcpy(buffer, bytes, length);
+  buffer[length] = '\0';
+  return strtod_l(buffer, NULL, NULL);
+}
+
+// Parses the magnitude of an integer, returning whether it is negative.
+// Integral numbers in exponent or fraction form (1e3, 5.0) are accepted like
+// the other runtimes do.
+static BOOL ParseJSONInteger(FromJSONContext *ctx, const uint8_t *bytes, size_t length,
+                             BOOL isSigned, uint64_t *outMagnitude) {
+  if (length == 0 || JSONNumberLength(bytes, length) != length) {
+    RaiseInvalidValue(ctx, @"Invalid integer");
+  }
+  BOOL negative = bytes[0] == '-';
+  size_t i = negative ? 1 : 0;
+  uint64_t magnitude = 0;
+  for (; i < length && bytes[i] >= '0' && bytes[i] <= '9'; i++) {
+    uint64_t digit = bytes[i] - '0';
+    if (magnitude > (UINT64_MAX - digit) / 10) {
+      RaiseInvalidValue(ctx, @"Integer out of range");
+    }
+    magnitude = magnitude * 10 + digit;
+  }
+  if (i < length) {
+    double value = ParseJSONDouble(ctx, bytes, length, NO);
+    if (value != floor(value) || fabs(value) >= 18446744073709551616.0) {
+      RaiseInvalidValue(ctx, @"Expected an integer");
+    }
+    magnitude = (uint64_t)fabs(value);
+  }
+  if (negative && !isSigned && magnitude != 0) {
+    RaiseInvalidValue(ctx, @"Negative value for an unsigned field");
+  }
+  *outMagnitude = magnitude;
+  return negative;
+}
+
+static int64_t ParseJSONSigned(FromJSONContext *ctx, const uint8_t *bytes, size_t length,
+                               int64_t min, int64_t max) {
+  uint64_t magnitude;
+  BOOL negative = ParseJSONInteger(ctx, bytes, length, YES, &magnitude);
+  if (negative) {
+    if (magnitude > (uint64_t)max + 1 || (magnitude != 0 && (int64_t)(0 - magnitude) < min)) {
+      RaiseInvalidValue(ctx, @"Integer out of range");
+    }
+    return (int64_t)(0 - magnitude);
+  }
+  if (magnitude > (uint64_t)max) {
+    RaiseInvalidValue(ctx, @"Integer out of range");
+  }
+  return (int64_t)magnitude;
+}
+
+static uint64_t ParseJSONUnsigned(FromJSONContext *ctx, const uint8_t *bytes, size_t length,
+                                  uint64_t max) {
+  uint64_t magnitude;
+  ParseJSONInteger(ctx, bytes, length, NO, &magnitude);
+  if (magnitude > max) {
+    RaiseInvalidValue(ctx, @"Integer out of range");
+  }
+  return magnitude;
+}
+
+// Binary writers.
+
+static void BinaryVarint(JSONOutput *out, uint64_t value) {
+  JSONOutputReserve(out, 10);
+  uint8_t *cursor = out->bytes + out->length;
+  while (value >= 0x80) {
+    *cursor++ = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  *cursor++ = (uint8_t)value;
+  out->length = (size_t)(cursor - out->bytes);
+}
+
+GPB_INLINE void BinaryTag(JSONOutput *out, uint32_t number, GPBWireFormat wireType) {
+  BinaryVarint(out, GPBWireFormatMakeTag(number, wireType));
+}
+
+static void BinaryFixed32(JSONOutput *out, uint32_t value) {
+  value = OSSwapHostToLittleInt32(value);
+  JSONOutputBytes(out, &value, sizeof(value));
+}
+
+static void BinaryFixed64(JSONOutput *out, uint64_t value) {
+  value = OSSwapHostToLittleInt64(value);
+  JSONOutputBytes(out, &value, sizeof(value));
+}
+
+// Length delimited values are written with a one byte length placeholder,
+// the body is moved once it is known the length needs more bytes.
+static size_t BinaryBeginLength(JSONOutput *out) {
+  JSONOutputByte(out, 0);
+  return out->length;
+}
+
+static void BinaryEndLength(JSONOutput *out, size_t bodyStart) {
+  size_t length = out->length - bodyStart;
+  size_t varintSize = 1;
+  for (size_t v = length; v >= 0x80; v >>= 7) {
+    varintSize++;
+  }
+  if (varintSize > 1) {
+    JSONOutputReserve(out, varintSize - 1);
+    memmove(out->bytes + bodyStart + varintSize - 1, out->bytes + bodyStart, length);
+    out->length += varintSize - 1;
+  }
+  uint8_t *cursor = out->bytes + bodyStart - 1;
+  size_t value = length;
+  while (value >= 0x80) {
+    *cursor++ = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  *cursor = (uint8_t)value;
+}
+
+static void BinaryBytes(JSONOutput *out, uint32_t number, const uint8_t *bytes, size_t length) {
+  BinaryTag(out, number, GPBWireFormatLengthDelimited);
+  BinaryVarint(out, length);
+  JSONOutputBytes(out, bytes, length);
+}
+
+static int JSONBase64Value(uint8_t c) {
+  if (c >= 'A' && c <= 'Z') return c - 'A';
+  if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+  if (c >= '0' && c <= '9') return c - '0' + 52;
+  if (c == '+' || c == '-') return 62;
+  if (c == '/' || c == '_') return 63;
+  return -1;
+}
+
+// Decodes standard or URL safe base64, padding optional.
+static void BinaryBase64(FromJSONContext *ctx, uint32_t number, const uint8_t *bytes,
+                         size_t length) {
+  while (length > 0 && bytes[length - 1] == '=') {
+    length--;
+  }
+  if (length % 4 == 1) {
+    RaiseInvalidValue(ctx, @"Invalid base64");
+  }
+  size_t decodedLength = length / 4 * 3 + (length % 4 ? length % 4 - 1 : 0);
+  JSONOutput *out = &ctx->out;
+  BinaryTag(out, number, GPBWireFormatLengthDelimited);
+  BinaryVarint(out, decodedLength);
+  JSONOutputReserve(out, decodedLength);
+  uint8_t *cursor = out->bytes + out->length;
+  uint32_t accumulator = 0;
+  int bits = 0;
+  for (size_t i = 0; i < length; i++) {
+    int value = JSONBase64Value(bytes[i]);
+    if (value < 0) {
+      RaiseInvalidValue(ctx, @"Invalid base64");
+    }
+    accumulator = (accumulator << 6) | (uint32_t)value;
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      *cursor++ = (uint8_t)(accumulator >> bits);
+    }
+  }
+  out->length += decodedLength;
+}
+
+static void WriteBinaryMessage(FromJSONContext *ctx, GPBJSONMessageInfo *info, int depth);
+static void WriteBinaryStructValue(FromJSONContext *ctx, int depth);
+
+static void SkipJSONValue(FromJSONContext *ctx, int depth) {
+  if (depth >= kJSONMaxDepth) {
+    RaiseJSONError(GPBJSONTranscoderErrorRecursionDepthExceeded, @"JSON nested too deep");
+  }
+  const uint8_t *bytes;
+  size_t length;
+  uint8_t c = PeekJSON(ctx);
+  switch (c) {
+    case '{':
+      ctx->cursor++;
+      if (ConsumeJSON(ctx, '}')) return;
+      do {
+        ReadJSONString(ctx, &bytes, &length);
+        ExpectJSON(ctx, ':');
+        SkipJSONValue(ctx, depth + 1);
+      } while (NextJSONElement(ctx, '}'));
+      return;
+    case '[':
+      ctx->cursor++;
+      if (ConsumeJSON(ctx, ']')) return;
+      do {
+        SkipJSONValue(ctx, depth + 1);
+      } while (NextJSONElement(ctx, ']'));
+      return;
+    case '"':
+      ReadJSONString(ctx, &bytes, &length);
+      return;
+    default:
+      if (ConsumeJSONLiteral(ctx, "true", 4) || ConsumeJSONLiteral(ctx, "false", 5) ||
+          ConsumeJSONLiteral(ctx, "null", 4)) {
+        return;
+      }
+      length = JSONNumberLength(ctx->cursor, (size_t)(ctx->end - ctx->cursor));
+      if (length == 0) {
+        RaiseInvalidJSON(ctx, @"Expected a value");
+      }
+      ctx->cursor += length;
+      return;
+  }
+}
+
+// Finds the value of an enum name, NO if the enum has no such value.
+static BOOL JSONEnumValueForName(GPBJSONEnumInfo *info, const uint8_t *name, size_t length,
+                                 int32_t *outValue) {
+  for (uint32_t i = 0; i < info->count_; i++) {
+    if (info->nameLengths_[i] == length + 2 && memcmp(info->names_[i] + 1, name, length) == 0) {
+      *outValue = info->values_[i];
+      return YES;
+    }
+  }
+  return NO;
+}
+
+// Writes one value of |type| for field |number| (the tag too when |withTag|).
+// Returns NO when the value was skipped, for unknown enum names.
+static BOOL WriteBinaryValue(FromJSONContext *ctx, GPBFieldDescriptor *field, GPBDataType type,
+                             uint32_t number, BOOL withTag, int depth) {
+  JSONOutput *out = &ctx->out;
+  const uint8_t *bytes;
+  size_t length;
+  BOOL quoted;
+  switch (type) {
+    case GPBDataTypeBool: {
+      BOOL value;
+      PeekJSON(ctx);
+      if (ConsumeJSONLiteral(ctx, "true", 4)) {
+        value = YES;
+      } else if (ConsumeJSONLiteral(ctx, "false", 5)) {
+        value = NO;
+      } else {
+        RaiseInvalidValue(ctx, @"Expected true or false");
+      }
+      if (withTag) BinaryTag(out, number, GPBWireFormatVarint);
+      BinaryVarint(out, value ? 1 : 0);
+      return YES;
+    }
+    case GPBDataTypeInt32:
+    case GPBDataTypeSInt32:
+    case GPBDataTypeSFixed32: {
+      ReadJSONNumberToken(ctx, &bytes, &length, &quoted);
+      int32_t value = (int32_t)ParseJSONSigned(ctx, bytes, length, INT32_MIN, INT32_MAX);
+      if (type == GPBDataTypeSFixed32) {
+        if (withTag) BinaryTag(out, number, GPBWireFormatFixed32);
+        BinaryFixed32(out, (uint32_t)value);
+      } else {
+        if (withTag) BinaryTag(out, number, GPBWireFormatVarint);
+        if (type == GPBDataTypeSInt32) {
+          BinaryVarint(out, GPBEncodeZigZag32(value));
+        } else {
+          // Negative int32 values are sign extended to 10 bytes on the wire.
+          BinaryVarint(out, (uint64_t)(int64_t)value);
+        }
+      }
+      return YES;
+    }
+    case GPBDataTypeInt64:
+    case GPBDataTypeSInt64:
+    case GPBDataTypeSFixed64: {
+      ReadJSONNumberToken(ctx, &bytes, &length, &quoted);
+      int64_t value = ParseJSONSigned(ctx, bytes, length, INT64_MIN, INT64_MAX);
+      if (type == GPBDataTypeSFixed64) {
+        if (withTag) BinaryTag(out, number, GPBWireFormatFixed64);
+        BinaryFixed64(out, (uint64_t)value);
+      } else {
+        if (withTag) BinaryTag(out, number, GPBWireFormatVarint);
+        BinaryVarint(out, type == GPBDataTypeSInt64 ? GPBEncodeZigZag64(value) : (uint64_t)value);
+      }
+      return YES;
+    }
+    case GPBDataTypeUInt32:
+    case GPBDataTypeFixed32: {
+      ReadJSONNumberToken(ctx, &bytes, &length, &quoted);
+      uint32_t value = (uint32_t)ParseJSONUnsigned(ctx, bytes, length, UINT32_MAX);
+      if (type == GPBDataTypeFixed32) {
+        if (withTag) BinaryTag(out, number, GPBWireFormatFixed32);
+        BinaryFixed32(out, value);
+      } else {
+        if (withTag) BinaryTag(out, number, GPBWireFormatVarint);
+        BinaryVarint(out, value);
+      }
+      return YES;
+    }
+    case GPBDataTypeUInt64:
+    case GPBDataTypeFixed64: {
+      ReadJSONNumberToken(ctx, &bytes, &length, &quoted);
+      uint64_t value = ParseJSONUnsigned(ctx, bytes, length, UINT64_MAX);
+      if (type == GPBDataTypeFixed64) {
+        if (withTag) BinaryTag(out, number, GPBWireFormatFixed64);
+        BinaryFixed64(out, value);
+      } else {
+        if (withTag) BinaryTag(out, number, GPBWireFormatVarint);
+        BinaryVarint(out, value);
+      }
+      return YES;
+    }
+    case GPBDataTypeFloat: {
+      ReadJSONNumberToken(ctx, &bytes, &length, &quoted);
+      double value = ParseJSONDouble(ctx, bytes, length, quoted);
+      if (isfinite(value) && fabs(value) > FLT_MAX) {
+        RaiseInvalidValue(ctx, @"Float out of range");
+      }
+      if (withTag) BinaryTag(out, number, GPBWireFormatFixed32);
+      BinaryFixed32(out, (uint32_t)GPBConvertFloatToInt32((float)value));
+      return YES;
+    }
+    case GPBDataTypeDouble: {
+      ReadJSONNumberToken(ctx, &bytes, &length, &quoted);
+      double value = ParseJSONDouble(ctx, bytes, length, quoted);
+      if (withTag) BinaryTag(out, number, GPBWireFormatFixed64);
+      BinaryFixed64(out, (uint64_t)GPBConvertDoubleToInt64(value));
+      return YES;
+    }
+    case GPBDataTypeString:
+      if (PeekJSON(ctx) != '"') {
+        RaiseInvalidValue(ctx, @"Expected a string");
+      }
+      ReadJSONString(ctx, &bytes, &length);
+      BinaryBytes(out, number, bytes, length);
+      return YES;
+    case GPBDataTypeBytes:
+      if (PeekJSON(ctx) != '"') {
+        RaiseInvalidValue(ctx, @"Expected a base64 string");
+      }
+      ReadJSONString(ctx, &bytes, &length);
+      BinaryBase64(ctx, number, bytes, length);
+      return YES;
+    case GPBDataTypeEnum: {
+      GPBJSONEnumInfo *info = JSONInfoForEnum(field.enumDescriptor);
+      int32_t value = 0;
+      if (PeekJSON(ctx) == '"') {
+        ReadJSONString(ctx, &bytes, &length);
+        if (!JSONEnumValueForName(info, bytes, length, &value)) {
+          if (ctx->options & GPBJSONTranscoderOptionIgnoreUnknownFields) {
+            return NO;
+          }
+          RaiseInvalidValue(ctx, @"Unknown enum name");
+        }
+      } else if (info->isNullValue_ && ConsumeJSONLiteral(ctx, "null", 4)) {
+        value = GPBNullValue_NullValue;
+      } else {
+        ReadJSONNumberToken(ctx, &bytes, &length, &quoted);
+        value = (int32_t)ParseJSONSigned(ctx, bytes, length, INT32_MIN, INT32_MAX);
+      }
+      if (withTag) BinaryTag(out, number, GPBWireFormatVarint);
+      BinaryVarint(out, (uint64_t)(int64_t)value);
+      return YES;
+    }
+    case GPBDataTypeMessage: {
+      BinaryTag(out, number, GPBWireFormatLengthDelimited);
+      size_t bodyStart = BinaryBeginLength(out);
+      WriteBinaryMessage(ctx, JSONInfoForField(field), depth + 1);
+      BinaryEndLength(out, bodyStart);
+      return YES;
+    }
+    case GPBDataTypeGroup:
+      RaiseJSONError(GPBJSONTranscoderErrorUnsupportedType,
+                     [NSString stringWithFormat:@"Group field %@ has no JSON form", field.name]);
+  }
+  return NO;
+}
+
+// Writes a map key, given as a JSON string, as field 1 of an entry.
+static void WriteBinaryMapKey(FromJSONContext *ctx, GPBDataType keyType, const uint8_t *bytes,
+                              size_t length) {
+  JSONOutput *out = &ctx->out;
+  switch (keyType) {
+    case GPBDataTypeString:
+      BinaryBytes(out, 1, bytes, length);
+      return;
+    case GPBDataTypeBool:
+      BinaryTag(out, 1, GPBWireFormatVarint);
+      if (length == 4 && memcmp(bytes, "true", 4) == 0) {
+        BinaryVarint(out, 1);
+      } else if (length == 5 && memcmp(bytes, "false", 5) == 0) {
+        BinaryVarint(out, 0);
+      } else {
+        RaiseInvalidValue(ctx, @"Invalid bool map key");
+      }
+      return;
+    default: {
+      // Integer keys: parse the key as if it were a quoted value.
+      const uint8_t *savedStart = ctx->start;
+      const uint8_t *savedCursor = ctx->cursor;
+      const uint8_t *savedEnd = ctx->end;
+      ctx->start = ctx->cursor = bytes;
+      ctx->end = bytes + length;
+      @try {
+        WriteBinaryValue(ctx, nil, keyType, 1, YES, 0);
+        if (ctx->cursor != ctx->end) {
+          RaiseInvalidValue(ctx, @"Invalid integer map key");
+        }
+      } @finally {
+        ctx->start = savedStart;
+        ctx->cursor = savedCursor;
+        ctx->end = savedEnd;
+      }
+      return;
+    }
+  }
+}
+
+static void WriteBinaryField(FromJSONContext *ctx, const JSONFieldInfo *fieldInfo, int depth) {
+  JSONOutput *out = &ctx->out;
+  GPBFieldDescriptor *field = fieldInfo->field;
+  BOOL isValueMessage = fieldInfo->dataType == GPBDataTypeMessage &&
+                        JSONInfoForField(field)->wellKnownType_ == JSONWellKnownTypeValue;
+  BOOL isNullValueEnum = fieldInfo->dataType == GPBDataTypeEnum &&
+                         JSONInfoForEnum(field.enumDescriptor)->isNullValue_;
+  BOOL nullIsValue =
+      fieldInfo->fieldType == GPBFieldTypeSingle && (isValueMessage || isNullValueEnum);
+  if (PeekJSON(ctx) == 'n' && !nullIsValue) {
+    // null leaves the field unset.
+    if (!ConsumeJSONLiteral(ctx, "null", 4)) {
+      RaiseInvalidJSON(ctx, @"Expected a value");
+    }
+    return;
+  }
+
+  switch (fieldInfo->fieldType) {
+    case GPBFieldTypeSingle:
+      WriteBinaryValue(ctx, field, fieldInfo->dataType, fieldInfo->number, YES, depth);
+      return;
+    case GPBFieldTypeRepeated: {
+      ExpectJSON(ctx, '[');
+      if (ConsumeJSON(ctx, ']')) {
+        return;
+      }
+      BOOL packed = field.packable && JSONDataTypeIsPackable(fieldInfo->dataType);
+      size_t bodyStart = 0;
+      if (packed) {
+        BinaryTag(out, fieldInfo->number, GPBWireFormatLengthDelimited);
+        bodyStart = BinaryBeginLength(out);
+      }
+      do {
+        if (PeekJSON(ctx) == 'n' && !isValueMessage) {
+          RaiseInvalidValue(ctx, @"null in a repeated field");
+        }
+        WriteBinaryValue(ctx, field, fieldInfo->dataType, fieldInfo->number, !packed, depth);
+      } while (NextJSONElement(ctx, ']'));
+      if (packed) {
+        BinaryEndLength(out, bodyStart);
+      }
+      return;
+    }
+    case GPBFieldTypeMap: {
+      ExpectJSON(ctx, '{');
+      if (ConsumeJSON(ctx, '}')) {
+        return;
+      }
+      GPBDataType keyType = field.mapKeyDataType;
+      do {
+        const uint8_t *key;
+        size_t keyLength;
+        ReadJSONString(ctx, &key, &keyLength);
+        size_t entryStart = out->length;
+        BinaryTag(out, fieldInfo->number, GPBWireFormatLengthDelimited);
+        size_t bodyStart = BinaryBeginLength(out);
+        WriteBinaryMapKey(ctx, keyType, key, keyLength);
+        ExpectJSON(ctx, ':');
+        if (!WriteBinaryValue(ctx, field, fieldInfo->dataType, 2, YES, depth)) {
+          // Unknown enum name, drop the entry.
+          out->length = entryStart;
+          continue;
+        }
+        BinaryEndLength(out, bodyStart);
+      } while (NextJSONElement(ctx, '}'));
+      return;
+    }
+  }
+}
+
+static void WriteBinaryTimestamp(FromJSONContext *ctx) {
+  const uint8_t *bytes;
+  size_t length;
+  if (PeekJSON(ctx) != '"') {
+    RaiseInvalidValue(ctx, @"Expected a Timestamp string");
+  }
+  ReadJSONString(ctx, &bytes, &length);
+  // YYYY-MM-DDTHH:MM:SS[.fraction](Z|+HH:MM|-HH:MM)
+  const uint8_t *p = bytes;
+  const uint8_t *end = bytes + length;
+#define TIMESTAMP_DIGITS(count, outValue)                 \
+  do {                                                    \
+    int value_ = 0;                                       \
+    for (int i_ = 0; i_ < (count); i_++) {                \
+      if (p >= end || *p < '0' || *p > '9') goto invalid; \
+      value_ = value_ * 10 + (*p++ - '0');                \
+    }                                                     \
+    (outValue) = value_;                                  \
+  } while (0)
+#define TIMESTAMP_CHAR(c)                    \
+  do {                                       \
+    if (p >= end || *p != (c)) goto invalid; \
+    p++;                                     \
+  } while (0)
+  {
+    int year, month, day, hour, minute, second;
+    int32_t nanos = 0;
+    TIMESTAMP_DIGITS(4, year);
+    TIMESTAMP_CHAR('-');
+    TIMESTAMP_DIGITS(2, month);
+    TIMESTAMP_CHAR('-');
+    TIMESTAMP_DIGITS(2, day);
+    TIMESTAMP_CHAR('T');
+    TIMESTAMP_DIGITS(2, hour);
+    TIMESTAMP_CHAR(':');
+    TIMESTAMP_DIGITS(2, minute);
+    TIMESTAMP_CHAR(':');
+    TIMESTAMP_DIGITS(2, second);
+    if (p < end && *p == '.') {
+      p++;
+      int digits = 0;
+      while (p < end && *p >= '0' && *p <= '9') {
+        if (digits == 9) goto invalid;
+        nanos = nanos * 10 + (*p++ - '0');
+        digits++;
+      }
+      if (digits == 0) goto invalid;
+      for (; digits < 9; digits++) {
+        nanos *= 10;
+      }
+    }
+    int64_t offset = 0;
+    if (p < end && *p == 'Z') {
+      p++;
+    } else if (p < end && (*p == '+' || *p == '-')) {
+      int sign = (*p++ == '-') ? -1 : 1;
+      int offsetHours, offsetMinutes;
+      TIMESTAMP_DIGITS(2, offsetHours);
+      TIMESTAMP_CHAR(':');
+      TIMESTAMP_DIGITS(2, offsetMinutes);
+      offset = sign * (offsetHours * 3600 + offsetMinutes * 60);
+    } else {
+      goto invalid;
+    }
+    if (p != end || month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 ||
+        second > 59) {
+      goto invalid;
+    }
+    int64_t seconds = JSONDaysFromCivil(year, (unsigned)month, (unsigned)day) * 86400 +
+                      hour * 3600 + minute * 60 + second - offset;
+    if (seconds < kJSONTimestampMinSeconds || seconds > kJSONTimestampMaxSeconds) {
+      goto invalid;
+    }
+    if (seconds != 0) {
+      BinaryTag(&ctx->out, GPBTimestamp_FieldNumber_Seconds, GPBWireFormatVarint);
+      BinaryVarint(&ctx->out, (uint64_t)seconds);
+    }
+    if (nanos != 0) {
+      BinaryTag(&ctx->out, GPBTimestamp_FieldNumber_Nanos, GPBWireFormatVarint);
+      BinaryVarint(&ctx->out, (uint64_t)nanos);
+    }
+    return;
+  }
+#undef TIMESTAMP_DIGITS
+#undef TIMESTAMP_CHAR
+invalid:
+  RaiseInvalidValue(ctx, @"Invalid Timestamp");
+}
+
+static void WriteBinaryDuration(FromJSONContext *ctx) {
+  const uint8_t *bytes;
+  size_t length;
+  if (PeekJSON(ctx) != '"') {
+    RaiseInvalidValue(ctx, @"Expected a Duration string");
+  }
+  ReadJSONString(ctx, &bytes, &length);
+  // [-]seconds[.fraction]s
+  const uint8_t *p = bytes;
+  const uint8_t *end = bytes + length;
+  BOOL negative = p < end && *p == '-';
+  if (negative) p++;
+  int64_t seconds = 0;
+  int32_t nanos = 0;
+  const uint8_t *digitsStart = p;
+  while (p < end && *p >= '0' && *p <= '9') {
+    seconds = seconds * 10 + (*p++ - '0');
+    if (seconds > kJSONDurationMaxSeconds) {
+      RaiseInvalidValue(ctx, @"Duration out of range");
+    }
+  }
+  if (p == digitsStart) {
+    RaiseInvalidValue(ctx, @"Invalid Duration");
+  }
+  if (p < end && *p == '.') {
+    p++;
+    int digits = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+      if (digits == 9) {
+        RaiseInvalidValue(ctx, @"Invalid Duration");
+      }
+      nanos = nanos * 10 + (*p++ - '0');
+      digits++;
+    }
+    if (digits == 0) {
+      RaiseInvalidValue(ctx, @"Invalid Duration");
+    }
+    for (; digits < 9; digits++) {
+      nanos *= 10;
+    }
+  }
+  if (p + 1 != end || *p != 's') {
+    RaiseInvalidValue(ctx, @"Invalid Duration");
+  }
+  if (negative) {
+    seconds = -seconds;
+    nanos = -nanos;
+  }
+  if (seconds != 0) {
+    BinaryTag(&ctx->out, GPBDuration_FieldNumber_Seconds, GPBWireFormatVarint);
+    BinaryVarint(&ctx->out, (uint64_t)seconds);
+  }
+  if (nanos != 0) {
+    BinaryTag(&ctx->out, GPBDuration_FieldNumber_Nanos, GPBWireFormatVarint);
+    BinaryVarint(&ctx->out, (uint64_t)(int64_t)nanos);
+  }
+}
+
+static void WriteBinaryFieldMask(FromJSONContext *ctx) {
+  const uint8_t *bytes;
+  size_t length;
+  if (PeekJSON(ctx) != '"') {
+    RaiseInvalidValue(ctx, @"Expected a FieldMask string");
+  }
+  ReadJSONString(ctx, &bytes, &length);
+  JSONOutput *out = &ctx->out;
+  size_t pathStart = 0;
+  for (size_t i = 0; i <= length; i++) {
+    if (i < length && bytes[i] != ',') {
+      continue;
+    }
+    if (i > pathStart) {
+      // Back to snake_case: an underscore before each capital, lowercased.
+      BinaryTag(out, GPBFieldMask_FieldNumber_PathsArray, GPBWireFormatLengthDelimited);
+      size_t bodyStart = BinaryBeginLength(out);
+      for (size_t n = pathStart; n < i; n++) {
+        uint8_t c = bytes[n];
+        if (c >= 'A' && c <= 'Z') {
+          JSONOutputByte(out, '_');
+          c = (uint8_t)(c - 'A' + 'a');
+        }
+        JSONOutputByte(out, c);
+      }
+      BinaryEndLength(out, bodyStart);
+    }
+    pathStart = i + 1;
+  }
+}
+
+// Writes the fields of a google.protobuf.Struct from a JSON object.
+static void WriteBinaryStruct(FromJSONContext *ctx, int depth) {
+  JSONOutput *out = &ctx->out;
+  ExpectJSON(ctx, '{');
+  if (ConsumeJSON(ctx, '}')) {
+    return;
+  }
+  do {
+    const uint8_t *key;
+    size_t keyLength;
+    ReadJSONString(ctx, &key, &keyLength);
+    BinaryTag(out, GPBStruct_FieldNumber_Fields, GPBWireFormatLengthDelimited);
+    size_t entryStart = BinaryBeginLength(out);
+    BinaryBytes(out, 1, key, keyLength);
+    ExpectJSON(ctx, ':');
+    BinaryTag(out, 2, GPBWireFormatLengthDelimited);
+    size_t valueStart = BinaryBeginLength(out);
+    WriteBinaryStructValue(ctx, depth + 1);
+    BinaryEndLength(out, valueStart);
+    BinaryEndLength(out, entryStart);
+  } while (NextJSONElement(ctx, '}'));
+}
+
+// Writes the fields of a google.protobuf.ListValue from a JSON array.
+static void WriteBinaryListValue(FromJSONContext *ctx, int depth) {
+  JSONOutput *out = &ctx->out;
+  ExpectJSON(ctx, '[');
+  if (ConsumeJSON(ctx, ']')) {
+    return;
+  }
+  do {
+    BinaryTag(out, GPBListValue_FieldNumber_ValuesArray, GPBWireFormatLengthDelimited);
+    size_t valueStart = BinaryBeginLength(out);
+    WriteBinaryStructValue(ctx, depth + 1);
+    BinaryEndLength(out, valueStart);
+  } while (NextJSONElement(ctx, ']'));
+}
+
+// Writes the fields of a google.protobuf.Value from any JSON value.
+static void WriteBinaryStructValue(FromJSONContext *ctx, int depth) {
+  if (depth >= kJSONMaxDepth) {
+    RaiseJSONError(GPBJSONTranscoderErrorRecursionDepthExceeded, @"JSON nested too deep");
+  }
+  JSONOutput *out = &ctx->out;
+  const uint8_t *bytes;
+  size_t length;
+  BOOL quoted;
+  uint8_t c = PeekJSON(ctx);
+  switch (c) {
+    case '{': {
+      BinaryTag(out, GPBValue_FieldNumber_StructValue, GPBWireFormatLengthDelimited);
+      size_t bodyStart = BinaryBeginLength(out);
+      WriteBinaryStruct(ctx, depth);
+      BinaryEndLength(out, bodyStart);
+      return;
+    }
+    case '[': {
+      BinaryTag(out, GPBValue_FieldNumber_ListValue, GPBWireFormatLengthDelimited);
+      size_t bodyStart = BinaryBeginLength(out);
+      WriteBinaryListValue(ctx, depth);
+      BinaryEndLength(out, bodyStart);
+      return;
+    }
+    case '"':
+      ReadJSONString(ctx, &bytes, &length);
+      BinaryBytes(out, GPBValue_FieldNumber_StringValue, bytes, length);
+      return;
+    default:
+      if (ConsumeJSONLiteral(ctx, "null", 4)) {
+        BinaryTag(out, GPBValue_FieldNumber_NullValue, GPBWireFormatVarint);
+        BinaryVarint(out, GPBNullValue_NullValue);
+      } else if (ConsumeJSONLiteral(ctx, "true", 4)) {
+        BinaryTag(out, GPBValue_FieldNumber_BoolValue, GPBWireFormatVarint);
+        BinaryVarint(out, 1);
+      } else if (ConsumeJSONLiteral(ctx, "false", 5)) {
+        BinaryTag(out, GPBValue_FieldNumber_BoolValue, GPBWireFormatVarint);
+        BinaryVarint(out, 0);
+      } else {
+        ReadJSONNumberToken(ctx, &bytes, &length, &quoted);
+        BinaryTag(out, GPBValue_FieldNumber_NumberValue, GPBWireFormatFixed64);
+        BinaryFixed64(out, (uint64_t)GPBConvertDoubleToInt64(
+                               ParseJSONDouble(ctx, bytes, length, NO)));
+      }
+      return;
+  }
+}
+
+// Writes the fields of a message from its JSON form.
+static void WriteBinaryMessage(FromJSONContext *ctx, GPBJSONMessageInfo *info, int depth) {
+  if (depth >= kJSONMaxDepth) {
+    RaiseJSONError(GPBJSONTranscoderErrorRecursionDepthExceeded, @"JSON nested too deep");
+  }
+  switch (info->wellKnownType_) {
+    case JSONWellKnownTypeNone:
+    case JSONWellKnownTypeEmpty:
+      break;
+    case JSONWellKnownTypeAny:
+      RaiseJSONError(GPBJSONTranscoderErrorUnsupportedType,
+                     @"Any has no JSON form without its type");
+    case JSONWellKnownTypeTimestamp:
+      WriteBinaryTimestamp(ctx);
+      return;
+    case JSONWellKnownTypeDuration:
+      WriteBinaryDuration(ctx);
+      return;
+    case JSONWellKnownTypeFieldMask:
+      WriteBinaryFieldMask(ctx);
+      return;
+    case JSONWellKnownTypeStruct:
+      WriteBinaryStruct(ctx, depth);
+      return;
+    case JSONWellKnownTypeListValue:
+      WriteBinaryListValue(ctx, depth);
+      return;
+    case JSONWellKnownTypeValue:
+      WriteBinaryStructValue(ctx, depth);
+      return;
+    case JSONWellKnownTypeWrapper: {
+      const JSONFieldInfo *fieldInfo = &info->fields_[0];
+      WriteBinaryValue(ctx, fieldInfo->field, fieldInfo->dataType, fieldInfo->number, YES, depth);
+      return;
+    }
+  }
+
+  ExpectJSON(ctx, '{');
+  if (ConsumeJSON(ctx, '}')) {
+    return;
+  }
+  do {
+    const uint8_t *name;
+    size_t nameLength;
+    ReadJSONString(ctx, &name, &nameLength);
+    const JSONFieldInfo *fieldInfo = JSONFieldForName(info, name, nameLength);
+    ExpectJSON(ctx, ':');
+    if (fieldInfo) {
+      WriteBinaryField(ctx, fieldInfo, depth);
+    } else if (ctx->options & GPBJSONTranscoderOptionIgnoreUnknownFields) {
+      SkipJSONValue(ctx, depth + 1);
+    } else {
+      NSString *fieldName = [[[NSString alloc] initWithBytes:name
+                                                      length:nameLength
+                                                    encoding:NSUTF8StringEncoding] autorelease];
+      RaiseJSONError(GPBJSONTranscoderErrorUnknownField,
+                     [NSString stringWithFormat:@"No field named %@", fieldName]);
+    }
+  } while (NextJSONElement(ctx, '}'));
+}
+
+#pragma mark - GPBJSONTranscoder
+
+@implementation GPBJSONTranscoder
+
++ (NSData *)JSONDataWithMessageData:(NSData *)data
+                         descriptor:(GPBDescriptor *)descriptor
+                            options:(GPBJSONTranscoderOptions)options
+                              error:(NSError **)errorPtr {
+  if (errorPtr) {
+    *errorPtr = nil;
+  }
+  GPBCodedInputStream *input = [[GPBCodedInputStream alloc] initWithData:data];
+  ToJSONContext ctx = {input, &input->state_, {NULL, 0, 0}, options};
+  NSData *result = nil;
+  @try {
+    // JSON is usually a bit larger than the binary form.
+    JSONOutputReserve(&ctx.out, data.length * 2 + 64);
+    WriteJSONMessage(&ctx, JSONInfoForDescriptor(descriptor), 0);
+    GPBCodedInputStreamCheckLastTagWas(ctx.state, 0);
+    result = JSONOutputTakeData(&ctx.out);
+  } @catch (NSException *exception) {
+    if (errorPtr) {
+      *errorPtr = JSONErrorFromException(exception);
+    }
+  }
+  free(ctx.out.bytes);
+  [input release];
+  return result;
+}
+
++ (NSData *)messageDataWithJSONData:(NSData *)JSONData
+                         descriptor:(GPBDescriptor *)descriptor
+                            options:(GPBJSONTranscoderOptions)options
+                              error:(NSError **)errorPtr {
+  if (errorPtr) {
+    *errorPtr = nil;
+  }
+  const uint8_t *bytes = JSONData.bytes;
+  FromJSONContext ctx = {bytes, bytes, bytes + JSONData.length, {NULL, 0, 0}, {NULL, 0, 0},
+                         options};
+  NSData *result = nil;
+  @try {
+    JSONOutputReserve(&ctx.out, JSONData.length / 2 + 64);
+    WriteBinaryMessage(&ctx, JSONInfoForDescriptor(descriptor), 0);
+    if (PeekJSON(&ctx) != 0) {
+      RaiseInvalidJSON(&ctx, @"Unexpected data after the value");
+    }
+    result = JSONOutputTakeData(&ctx.out);
+  } @catch (NSException *exception) {
+    if (errorPtr) {
+      *errorPtr = JSONErrorFromException(exception);
+    }
+  }
+  free(ctx.out.bytes);
+  free(ctx.scratch.bytes);
+  return result;
+}
+
+@end
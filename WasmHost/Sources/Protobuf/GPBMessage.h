@@ -17,6 +17,7 @@
 
 @class GPBCodedInputStream;
 @class GPBCodedOutputStream;
+@class GPBCompiledFieldMask;
 @class GPBUnknownFieldSet;
 @class GPBUnknownFields;
 
@@ -133,6 +134,34 @@ CF_EXTERN_C_END
                      extensionRegistry:(nullable id<GPBExtensionRegistry>)extensionRegistry
                                  error:(NSError **)errorPtr;
 
+/**
+ * Creates a new instance by parsing only the fields kept by @c fieldMask out of
+ * the data. This method should be sent to the generated message class the
+ * mask was compiled for. If there is an error the method returns nil and the
+ * error is returned in errorPtr (when provided).
+ *
+ * Every field not kept by the mask is skipped on the wire without being
+ * decoded, and is not added to the unknown fields, so the cost of the parse
+ * follows the fields asked for rather than the size of the data. Extensions
+ * are skipped too.
+ *
+ * @note The parsed message is not checked for required fields, the mask can
+ *       leave them out.
+ *
+ * @note The errors returned are likely coming from the domain and codes listed
+ *       at the top of this file and GPBCodedInputStream.h.
+ *
+ * @param data      The data to parse.
+ * @param fieldMask The fields to keep, compiled for this message class.
+ * @param errorPtr  An optional error pointer to fill in with a failure reason
+ *                  if the data can not be parsed.
+ *
+ * @return A new instance of the generated class.
+ **/
++ (nullable instancetype)parseFromData:(NSData *)data
+                             fieldMask:(GPBCompiledFieldMask *)fieldMask
+                                 error:(NSError **)errorPtr;
+
 /**
  * Creates a new instance by parsing the data from the given input stream. This
  * method should be sent to the generated message class that the data should
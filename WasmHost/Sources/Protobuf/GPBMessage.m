@@ -14,12 +14,15 @@
 #import <os/lock.h>
 #import <stdatomic.h>
 
+#import "GPBArena_PackagePrivate.h"
 #import "GPBArray.h"
 #import "GPBArray_PackagePrivate.h"
 #import "GPBCodedInputStream.h"
 #import "GPBCodedInputStream_PackagePrivate.h"
 #import "GPBCodedOutputStream.h"
 #import "GPBCodedOutputStream_PackagePrivate.h"
+#import "GPBCompiledFieldMask.h"
+#import "GPBCompiledFieldMask_PackagePrivate.h"
 #import "GPBDescriptor.h"
 #import "GPBDescriptor_PackagePrivate.h"
 #import "GPBDictionary.h"
@@ -117,9 +120,37 @@ NSString *const GPBMessageExceptionMessageTooLarge =
   //   https://developer.apple.com/library/archive/documentation/Performance/Conceptual/EnergyGuide-iOS/PrioritizeWorkWithQoS.html
   //   https://developer.apple.com/videos/play/wwdc2017/706/
   os_unfair_lock readOnlyLock_;
+
+  // Set when the message was allocated in an arena (see
+  // GPBCodedInputStreamOptionArena), the message holds a reference to it.
+  GPBArena *arena_;
+
+  // Size computed by the serialization identified by cachedSizeEpoch_, see
+  // BeginSerializedSizeCaching().
+  _Atomic(uint64_t) cachedSizeEpoch_;
+  _Atomic(size_t) cachedSize_;
 }
 @end
 
+// Writing a sub-message needs its size first, without a cache every level of a
+// tree walks its whole sub-tree again. Sizes are cached per message but only
+// for the serialization that computed them: each serialization takes a new
+// epoch, so a message (or an array it holds) mutated in between is never seen
+// with a stale size and nothing has to track mutations.
+static _Atomic(uint64_t) gSerializedSizeEpoch;
+static _Thread_local uint64_t tSerializedSizeEpoch;
+
+// Starts caching sizes on the current thread, returns the epoch to restore
+// with EndSerializedSizeCaching().
+static uint64_t BeginSerializedSizeCaching(void) {
+  uint64_t previous = tSerializedSizeEpoch;
+  tSerializedSizeEpoch = atomic_fetch_add_explicit(&gSerializedSizeEpoch, 1,
+                                                   memory_order_relaxed) + 1;
+  return previous;
+}
+
+static void EndSerializedSizeCaching(uint64_t previous) { tSerializedSizeEpoch = previous; }
+
 static id CreateArrayForField(GPBFieldDescriptor *field, GPBMessage *autocreator)
     __attribute__((ns_returns_retained));
 static id GetOrCreateArrayIvarWithField(GPBMessage *self, GPBFieldDescriptor *field);
@@ -1006,6 +1037,28 @@ static void ExtensionMergeFromInputStream(GPBExtensionDescriptor *extension, BOO
   }
 }
 
+static id AllocMessageInArena(Class msgClass, GPBArena *arena) __attribute__((ns_returns_retained));
+
+// Like +alloc, but the memory comes from |arena|.
+static id AllocMessageInArena(Class msgClass, GPBArena *arena) {
+  GPBDescriptor *descriptor = [msgClass descriptor];
+  size_t size = class_getInstanceSize(msgClass) + descriptor->storageSize_;
+  GPBMessage *message = objc_constructInstance(msgClass, GPBArenaAllocate(arena, size));
+  GPBArenaRetain(arena);
+  message->arena_ = arena;
+  return message;
+}
+
+static GPBMessage *CreateMessageForInput(Class msgClass, GPBCodedInputStream *input)
+    __attribute__((ns_returns_retained));
+
+// Returns a new message to parse from |input| into, allocated in the arena of
+// the input if it has one.
+static GPBMessage *CreateMessageForInput(Class msgClass, GPBCodedInputStream *input) {
+  GPBArena *arena = input->state_.arena;
+  return arena ? [AllocMessageInArena(msgClass, arena) init] : [[msgClass alloc] init];
+}
+
 static GPBMessage *GPBCreateMessageWithAutocreator(Class msgClass, GPBMessage *autocreator,
                                                    GPBFieldDescriptor *field) {
   GPBMessage *message = [[msgClass alloc] init];
@@ -1288,11 +1341,21 @@ static void MergeUnknownFieldDataIntoFieldSet(GPBMessage *self, NSData *data,
   return self;
 }
 
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wobjc-missing-super-calls"
 - (void)dealloc {
   [self internalClear:NO];
   NSCAssert(!autocreator_, @"Autocreator was not cleared before dealloc.");
+  GPBArena *arena = arena_;
+  if (arena) {
+    // The memory belongs to the arena, tear down the object without freeing it.
+    objc_destructInstance(self);
+    GPBArenaRelease(arena);
+    return;
+  }
   [super dealloc];
 }
+#pragma clang diagnostic pop
 
 - (void)copyFieldsInto:(GPBMessage *)message
                   zone:(NSZone *)zone
@@ -1542,6 +1605,16 @@ static void MergeUnknownFieldDataIntoFieldSet(GPBMessage *self, NSData *data,
         }
       } else if (fieldType == GPBFieldTypeRepeated) {
         NSArray *array = GPBGetObjectIvarWithFieldNoAutocreate(self, field);
+        if ([array isKindOfClass:[GPBLazyMessageArray class]]) {
+          // Only check what was parsed, lazy messages are not parsed just for this.
+          GPBLazyMessageArray *lazyArray = (GPBLazyMessageArray *)array;
+          for (NSUInteger i = 0, count = lazyArray.count; i < count; ++i) {
+            if ([lazyArray isMessageParsedAtIndex:i] && ![lazyArray[i] isInitialized]) {
+              return NO;
+            }
+          }
+          continue;
+        }
         for (GPBMessage *message in array) {
           if (!message.initialized) {
             return NO;
@@ -1598,15 +1671,29 @@ static void MergeUnknownFieldDataIntoFieldSet(GPBMessage *self, NSData *data,
     return nil;
   }
 #endif
+  uint64_t previousEpoch = BeginSerializedSizeCaching();
   size_t expectedSize = [self serializedSize];
   if (expectedSize > kMaximumMessageSize) {
+    EndSerializedSizeCaching(previousEpoch);
     return nil;
   }
-  NSMutableData *data = [NSMutableData dataWithLength:expectedSize];
-  GPBCodedOutputStream *stream = [[GPBCodedOutputStream alloc] initWithData:data];
+  // Encode straight into a buffer of the exact size, the sizes of the
+  // sub-messages come from the pass above.
+  uint8_t *bytes = malloc(MAX(expectedSize, (size_t)1));
+  if (!bytes) {
+    EndSerializedSizeCaching(previousEpoch);
+    [NSException raise:NSMallocException
+                format:@"Failed to allocate %lu bytes", (unsigned long)expectedSize];
+  }
+  NSData *data = nil;
+  GPBCodedOutputStream *stream = [[GPBCodedOutputStream alloc] initWithBytes:bytes
+                                                                      length:expectedSize];
   @try {
     [self writeToCodedOutputStream:stream];
-    [stream flush];
+    // The buffer isn't zeroed, never hand out a partially written one.
+    if ([stream bytesWritten] == expectedSize) {
+      data = [NSData dataWithBytesNoCopy:bytes length:expectedSize freeWhenDone:YES];
+    }
   } @catch (NSException *exception) {
     // This really shouldn't happen. Normally, this could mean there was a bug in the library and it
     // failed to match between computing the size and writing out the bytes. However, the more
@@ -1617,16 +1704,17 @@ static void MergeUnknownFieldDataIntoFieldSet(GPBMessage *self, NSData *data,
 #if defined(DEBUG) && DEBUG
     NSLog(@"%@: Internal exception while building message data: %@", [self class], exception);
 #endif
-    data = nil;
   }
-#if defined(DEBUG) && DEBUG
-  NSAssert(!data || [stream bytesWritten] == expectedSize, @"Internal error within the library");
-#endif
+  EndSerializedSizeCaching(previousEpoch);
+  if (!data) {
+    free(bytes);
+  }
   [stream release];
   return data;
 }
 
 - (NSData *)delimitedData {
+  uint64_t previousEpoch = BeginSerializedSizeCaching();
   size_t serializedSize = [self serializedSize];
   size_t varintSize = GPBComputeRawVarint32SizeForInteger(serializedSize);
   NSMutableData *data = [NSMutableData dataWithLength:(serializedSize + varintSize)];
@@ -1647,9 +1735,11 @@ static void MergeUnknownFieldDataIntoFieldSet(GPBMessage *self, NSData *data,
 #endif
     // If it happens, return an empty data.
     [stream release];
+    EndSerializedSizeCaching(previousEpoch);
     return [NSData data];
   }
   [stream release];
+  EndSerializedSizeCaching(previousEpoch);
   return data;
 }
 
@@ -1669,6 +1759,16 @@ static void MergeUnknownFieldDataIntoFieldSet(GPBMessage *self, NSData *data,
 }
 
 - (void)writeToCodedOutputStream:(GPBCodedOutputStream *)output {
+  if (tSerializedSizeEpoch == 0) {
+    // Outermost write, cache the sizes the sub-messages compute on the way.
+    uint64_t previousEpoch = BeginSerializedSizeCaching();
+    @try {
+      [self writeToCodedOutputStream:output];
+    } @finally {
+      EndSerializedSizeCaching(previousEpoch);
+    }
+    return;
+  }
   GPBDescriptor *descriptor = [self descriptor];
   NSArray *fieldsArray = descriptor->fields_;
   NSUInteger fieldCount = fieldsArray.count;
@@ -1717,6 +1817,15 @@ static void MergeUnknownFieldDataIntoFieldSet(GPBMessage *self, NSData *data,
 }
 
 - (void)writeDelimitedToCodedOutputStream:(GPBCodedOutputStream *)output {
+  if (tSerializedSizeEpoch == 0) {
+    uint64_t previousEpoch = BeginSerializedSizeCaching();
+    @try {
+      [self writeDelimitedToCodedOutputStream:output];
+    } @finally {
+      EndSerializedSizeCaching(previousEpoch);
+    }
+    return;
+  }
   size_t expectedSize = [self serializedSize];
   if (expectedSize > kMaximumMessageSize) {
     [NSException raise:GPBMessageExceptionMessageTooLarge
@@ -2376,10 +2485,41 @@ static void MergeUnknownFieldDataIntoFieldSet(GPBMessage *self, NSData *data,
                                error:errorPtr] autorelease];
 }
 
++ (instancetype)parseFromData:(NSData *)data
+                    fieldMask:(GPBCompiledFieldMask *)fieldMask
+                        error:(NSError **)errorPtr {
+  if (fieldMask.descriptor != [self descriptor]) {
+    [NSException raise:NSInvalidArgumentException
+                format:@"Field mask is for %@, not %@", fieldMask.descriptor.name,
+                       [self descriptor].name];
+  }
+  GPBMessage *message = [[self alloc] init];
+  GPBCodedInputStream *input = [[GPBCodedInputStream alloc] initWithData:data];
+  @try {
+    [message mergeFromCodedInputStream:input fieldMask:fieldMask];
+    [input checkLastTagWas:0];
+    if (errorPtr) {
+      *errorPtr = nil;
+    }
+  } @catch (NSException *exception) {
+    [input release];
+    [message release];
+    if (errorPtr) {
+      *errorPtr = ErrorFromException(exception);
+    }
+    return nil;
+  }
+  [input release];
+  return [message autorelease];
+}
+
 + (instancetype)parseFromCodedInputStream:(GPBCodedInputStream *)input
                         extensionRegistry:(id<GPBExtensionRegistry>)extensionRegistry
                                     error:(NSError **)errorPtr {
-  return [[[self alloc] initWithCodedInputStream:input
+  // The root of an arena parse lives in the arena too.
+  GPBArena *arena = input->state_.arena;
+  id message = arena ? AllocMessageInArena(self, arena) : [self alloc];
+  return [[message initWithCodedInputStream:input
                                extensionRegistry:extensionRegistry
                                            error:errorPtr] autorelease];
 }
@@ -2583,7 +2723,7 @@ static void MergeSingleFieldFromCodedInputStream(GPBMessage *self, GPBFieldDescr
         GPBMessage *message = GPBGetObjectIvarWithFieldNoAutocreate(self, field);
         [input readMessage:message extensionRegistry:extensionRegistry];
       } else {
-        GPBMessage *message = [[field.msgClass alloc] init];
+        GPBMessage *message = CreateMessageForInput(field.msgClass, input);
         GPBSetRetainedObjectIvarWithFieldPrivate(self, field, message);
         [input readMessage:message extensionRegistry:extensionRegistry];
       }
@@ -2597,7 +2737,7 @@ static void MergeSingleFieldFromCodedInputStream(GPBMessage *self, GPBFieldDescr
         GPBMessage *message = GPBGetObjectIvarWithFieldNoAutocreate(self, field);
         [input readGroup:GPBFieldNumber(field) message:message extensionRegistry:extensionRegistry];
       } else {
-        GPBMessage *message = [[field.msgClass alloc] init];
+        GPBMessage *message = CreateMessageForInput(field.msgClass, input);
         GPBSetRetainedObjectIvarWithFieldPrivate(self, field, message);
         [input readGroup:GPBFieldNumber(field) message:message extensionRegistry:extensionRegistry];
       }
@@ -2667,11 +2807,48 @@ static void MergeRepeatedPackedFieldFromCodedInputStream(GPBMessage *self,
   GPBCodedInputStreamPopLimit(state, limit);
 }
 
+// Returns the array to add the messages of a lazy field to, nil when the field
+// already holds a regular array and the messages have to be parsed as usual.
+static GPBLazyMessageArray *GetOrCreateLazyMessageArrayIvarWithField(
+    GPBMessage *self, GPBFieldDescriptor *field, GPBCodedInputStream *input,
+    id<GPBExtensionRegistry> extensionRegistry) {
+  id array = GPBGetObjectIvarWithFieldNoAutocreate(self, field);
+  if (!array) {
+    array = [[GPBLazyMessageArray alloc] initWithMessageClass:field.msgClass
+                                                        input:input
+                                            extensionRegistry:extensionRegistry];
+    GPBSetRetainedObjectIvarWithFieldPrivate(self, field, array);
+  }
+  return [array isKindOfClass:[GPBLazyMessageArray class]] ? array : nil;
+}
+
+// Arrays of objects parsed into an arena are CFArrays allocated in it, the
+// GPB*Array classes for scalars are regular objects.
+static id GetOrCreateArenaArrayIvarWithField(GPBMessage *self, GPBFieldDescriptor *field,
+                                             GPBArena *arena) {
+  if (!GPBFieldDataTypeIsObject(field) || GPBGetObjectIvarWithFieldNoAutocreate(self, field)) {
+    return GetOrCreateArrayIvarWithField(self, field);
+  }
+  NSMutableArray *array = (NSMutableArray *)CFArrayCreateMutable(GPBArenaGetAllocator(arena), 0,
+                                                                 &kCFTypeArrayCallBacks);
+  GPBSetRetainedObjectIvarWithFieldPrivate(self, field, array);
+  return array;
+}
+
 static void MergeRepeatedNotPackedFieldFromCodedInputStream(
     GPBMessage *self, GPBFieldDescriptor *field, GPBCodedInputStream *input,
     id<GPBExtensionRegistry> extensionRegistry) {
   GPBCodedInputStreamState *state = &input->state_;
-  id genericArray = GetOrCreateArrayIvarWithField(self, field);
+  if (GPBFieldIsLazy(field)) {
+    GPBLazyMessageArray *lazyArray =
+        GetOrCreateLazyMessageArrayIvarWithField(self, field, input, extensionRegistry);
+    if (lazyArray) {
+      [lazyArray addMessageInRange:GPBCodedInputStreamReadLengthDelimitedRange(state) input:input];
+      return;
+    }
+  }
+  id genericArray = state->arena ? GetOrCreateArenaArrayIvarWithField(self, field, state->arena)
+                                 : GetOrCreateArrayIvarWithField(self, field);
   switch (GPBGetFieldDataType(field)) {
 #define CASE_REPEATED_NOT_PACKED_POD(NAME, TYPE, ARRAY_TYPE) \
   case GPBDataType##NAME: {                                  \
@@ -2704,7 +2881,7 @@ static void MergeRepeatedNotPackedFieldFromCodedInputStream(
 #undef CASE_REPEATED_NOT_PACKED_POD
 #undef CASE_NOT_PACKED_OBJECT
     case GPBDataTypeMessage: {
-      GPBMessage *message = [[field.msgClass alloc] init];
+      GPBMessage *message = CreateMessageForInput(field.msgClass, input);
       [(NSMutableArray *)genericArray addObject:message];
       // The array will now retain message, so go ahead and release it in case
       // -readMessage:extensionRegistry: throws so it won't be leaked.
@@ -2713,7 +2890,7 @@ static void MergeRepeatedNotPackedFieldFromCodedInputStream(
       break;
     }
     case GPBDataTypeGroup: {
-      GPBMessage *message = [[field.msgClass alloc] init];
+      GPBMessage *message = CreateMessageForInput(field.msgClass, input);
       [(NSMutableArray *)genericArray addObject:message];
       // The array will now retain message, so go ahead and release it in case
       // -readGroup:extensionRegistry: throws so it won't be leaked.
@@ -2733,6 +2910,77 @@ static void MergeRepeatedNotPackedFieldFromCodedInputStream(
   }  // switch
 }
 
+// Merges the value following |tag| into the field of |entry| when |tag| is one
+// of the wire forms of the field, returns NO without reading anything if not.
+static BOOL MergeFieldFromCodedInputStream(GPBMessage *self, const GPBFieldTagEntry *entry,
+                                           uint32_t tag, GPBCodedInputStream *input,
+                                           id<GPBExtensionRegistry> extensionRegistry) {
+  GPBFieldDescriptor *fieldDescriptor = entry->field;
+  if (entry->tag == tag) {
+    GPBFieldType fieldType = fieldDescriptor.fieldType;
+    if (fieldType == GPBFieldTypeSingle) {
+      MergeSingleFieldFromCodedInputStream(self, fieldDescriptor, input, extensionRegistry);
+    } else if (fieldType == GPBFieldTypeRepeated) {
+      if (fieldDescriptor.isPackable) {
+        MergeRepeatedPackedFieldFromCodedInputStream(self, fieldDescriptor, input);
+      } else {
+        MergeRepeatedNotPackedFieldFromCodedInputStream(self, fieldDescriptor, input,
+                                                        extensionRegistry);
+      }
+    } else {  // fieldType == GPBFieldTypeMap
+      // GPB*Dictionary or NSDictionary, exact type doesn't matter at this
+      // point.
+      id map = GetOrCreateMapIvarWithField(self, fieldDescriptor);
+      [input readMapEntry:map
+          extensionRegistry:extensionRegistry
+                      field:fieldDescriptor
+              parentMessage:self];
+    }
+    return YES;
+  }
+
+  // Primitive, repeated types can be packed or unpacked on the wire, and
+  // are parsed either way.  The tag above is the preferred form, this
+  // checks the alternate form.
+  if (entry->alternateTag == tag) {
+    BOOL alternateIsPacked = !fieldDescriptor.isPackable;
+    if (alternateIsPacked) {
+      MergeRepeatedPackedFieldFromCodedInputStream(self, fieldDescriptor, input);
+    } else {
+      MergeRepeatedNotPackedFieldFromCodedInputStream(self, fieldDescriptor, input,
+                                                      extensionRegistry);
+    }
+    return YES;
+  }
+  return NO;
+}
+
+// Merges a message of a (singular or repeated) message field, keeping only the
+// fields of the submask of |entry|.
+static void MergeMaskedMessageFieldFromCodedInputStream(GPBMessage *self,
+                                                        const GPBCompiledFieldMaskEntry *entry,
+                                                        GPBCodedInputStream *input) {
+  GPBFieldDescriptor *field = entry->tagEntry.field;
+  GPBMessage *message;
+  if (field.fieldType == GPBFieldTypeSingle) {
+    if (GPBGetHasIvarField(self, field)) {
+      message = GPBGetObjectIvarWithFieldNoAutocreate(self, field);
+    } else {
+      message = CreateMessageForInput(field.msgClass, input);
+      GPBSetRetainedObjectIvarWithFieldPrivate(self, field, message);
+    }
+  } else {
+    GPBArena *arena = input->state_.arena;
+    NSMutableArray *array = arena ? GetOrCreateArenaArrayIvarWithField(self, field, arena)
+                                  : GetOrCreateArrayIvarWithField(self, field);
+    message = CreateMessageForInput(field.msgClass, input);
+    [array addObject:message];
+    // The array retains the message, released now in case reading it throws.
+    [message release];
+  }
+  [input readMessage:message fieldMask:entry->submask];
+}
+
 - (void)mergeFromCodedInputStream:(GPBCodedInputStream *)input
                 extensionRegistry:(id<GPBExtensionRegistry>)extensionRegistry
                         endingTag:(uint32_t)endingTag {
@@ -2743,12 +2991,9 @@ static void MergeRepeatedNotPackedFieldFromCodedInputStream(
   GPBDescriptor *descriptor = [self descriptor];
   GPBCodedInputStreamState *state = &input->state_;
   uint32_t tag = 0;
-  NSUInteger startingIndex = 0;
-  NSArray *fields = descriptor->fields_;
+  const GPBFieldTagTable *tagTable = GPBDescriptorTagTable(descriptor);
   BOOL isMessageSetWireFormat = descriptor.isWireFormat;
-  NSUInteger numFields = fields.count;
   while (YES) {
-    BOOL merged = NO;
     tag = GPBCodedInputStreamReadTag(state);
     if (tag == endingTag || tag == 0) {
       // If we got to the end (tag zero), when we were expecting the end group, this will
@@ -2756,72 +3001,12 @@ static void MergeRepeatedNotPackedFieldFromCodedInputStream(
       GPBCodedInputStreamCheckLastTagWas(state, endingTag);
       return;
     }
-    for (NSUInteger i = 0; i < numFields; ++i) {
-      if (startingIndex >= numFields) startingIndex = 0;
-      GPBFieldDescriptor *fieldDescriptor = fields[startingIndex];
-      if (GPBFieldTag(fieldDescriptor) == tag) {
-        GPBFieldType fieldType = fieldDescriptor.fieldType;
-        if (fieldType == GPBFieldTypeSingle) {
-          MergeSingleFieldFromCodedInputStream(self, fieldDescriptor, input, extensionRegistry);
-          // Well formed protos will only have a single field once, advance
-          // the starting index to the next field.
-          startingIndex += 1;
-        } else if (fieldType == GPBFieldTypeRepeated) {
-          if (fieldDescriptor.isPackable) {
-            MergeRepeatedPackedFieldFromCodedInputStream(self, fieldDescriptor, input);
-            // Well formed protos will only have a repeated field that is
-            // packed once, advance the starting index to the next field.
-            startingIndex += 1;
-          } else {
-            MergeRepeatedNotPackedFieldFromCodedInputStream(self, fieldDescriptor, input,
-                                                            extensionRegistry);
-          }
-        } else {  // fieldType == GPBFieldTypeMap
-          // GPB*Dictionary or NSDictionary, exact type doesn't matter at this
-          // point.
-          id map = GetOrCreateMapIvarWithField(self, fieldDescriptor);
-          [input readMapEntry:map
-              extensionRegistry:extensionRegistry
-                          field:fieldDescriptor
-                  parentMessage:self];
-        }
-        merged = YES;
-        break;
-      } else {
-        startingIndex += 1;
-      }
-    }  // for(i < numFields)
-
-    if (merged) continue;  // On to the next tag
-
-    // Primitive, repeated types can be packed or unpacked on the wire, and
-    // are parsed either way.  The above loop covered tag in the preferred
-    // for, so this need to check the alternate form.
-    for (NSUInteger i = 0; i < numFields; ++i) {
-      if (startingIndex >= numFields) startingIndex = 0;
-      GPBFieldDescriptor *fieldDescriptor = fields[startingIndex];
-      if ((fieldDescriptor.fieldType == GPBFieldTypeRepeated) &&
-          !GPBFieldDataTypeIsObject(fieldDescriptor) &&
-          (GPBFieldAlternateTag(fieldDescriptor) == tag)) {
-        BOOL alternateIsPacked = !fieldDescriptor.isPackable;
-        if (alternateIsPacked) {
-          MergeRepeatedPackedFieldFromCodedInputStream(self, fieldDescriptor, input);
-          // Well formed protos will only have a repeated field that is
-          // packed once, advance the starting index to the next field.
-          startingIndex += 1;
-        } else {
-          MergeRepeatedNotPackedFieldFromCodedInputStream(self, fieldDescriptor, input,
-                                                          extensionRegistry);
-        }
-        merged = YES;
-        break;
-      } else {
-        startingIndex += 1;
-      }
+    const GPBFieldTagEntry *entry =
+        GPBFieldTagTableLookup(tagTable, GPBWireFormatGetTagFieldNumber(tag));
+    if (entry && MergeFieldFromCodedInputStream(self, entry, tag, input, extensionRegistry)) {
+      continue;  // On to the next tag
     }
 
-    if (merged) continue;  // On to the next tag
-
     if (isMessageSetWireFormat) {
       if (GPBWireFormatMessageSetItemTag == tag) {
         [self parseMessageSet:input extensionRegistry:extensionRegistry];
@@ -2855,6 +3040,34 @@ static void MergeRepeatedNotPackedFieldFromCodedInputStream(
   }  // while(YES)
 }
 
+- (void)mergeFromCodedInputStream:(GPBCodedInputStream *)input
+                        fieldMask:(GPBCompiledFieldMask *)fieldMask {
+  GPBCodedInputStreamState *state = &input->state_;
+  while (YES) {
+    uint32_t tag = GPBCodedInputStreamReadTag(state);
+    if (tag == 0) {
+      return;
+    }
+    const GPBCompiledFieldMaskEntry *entry =
+        GPBCompiledFieldMaskLookup(fieldMask, GPBWireFormatGetTagFieldNumber(tag));
+    if (entry) {
+      if (!entry->submask) {
+        if (MergeFieldFromCodedInputStream(self, &entry->tagEntry, tag, input, nil)) {
+          continue;  // On to the next tag
+        }
+      } else if (entry->tagEntry.tag == tag) {
+        MergeMaskedMessageFieldFromCodedInputStream(self, entry, input);
+        continue;  // On to the next tag
+      }
+    }
+
+    // Not asked for, skipped without decoding it.
+    if (![input skipField:(int32_t)tag]) {
+      GPBRaiseStreamError(GPBCodedInputStreamErrorInvalidTag, @"Unexpected end-group tag");
+    }
+  }  // while(YES)
+}
+
 #pragma mark - MergeFrom Support
 
 - (void)mergeFrom:(GPBMessage *)other {
@@ -3365,7 +3578,23 @@ static void MergeRepeatedNotPackedFieldFromCodedInputStream(
 
 #pragma mark - SerializedSize
 
+static size_t ComputeSerializedSize(GPBMessage *self);
+
 - (size_t)serializedSize {
+  uint64_t epoch = tSerializedSizeEpoch;
+  if (epoch == 0) {
+    return ComputeSerializedSize(self);
+  }
+  if (atomic_load_explicit(&cachedSizeEpoch_, memory_order_acquire) == epoch) {
+    return atomic_load_explicit(&cachedSize_, memory_order_relaxed);
+  }
+  size_t result = ComputeSerializedSize(self);
+  atomic_store_explicit(&cachedSize_, result, memory_order_relaxed);
+  atomic_store_explicit(&cachedSizeEpoch_, epoch, memory_order_release);
+  return result;
+}
+
+static size_t ComputeSerializedSize(GPBMessage *self) {
   GPBDescriptor *descriptor = [[self class] descriptor];
   size_t result = 0;
 
@@ -3502,23 +3731,23 @@ static void MergeRepeatedNotPackedFieldFromCodedInputStream(
 
   // Add any unknown fields.
   @synchronized(self) {
-    if (unknownFieldData_) {
+    if (self->unknownFieldData_) {
 #if defined(DEBUG) && DEBUG
-      NSAssert(unknownFields_ == nil, @"Internal error both unknown states were set");
+      NSCAssert(self->unknownFields_ == nil, @"Internal error both unknown states were set");
 #endif
-      result += [unknownFieldData_ length];
+      result += [self->unknownFieldData_ length];
     } else {
       if (descriptor.wireFormat) {
-        result += [unknownFields_ serializedSizeAsMessageSet];
+        result += [self->unknownFields_ serializedSizeAsMessageSet];
       } else {
-        result += [unknownFields_ serializedSize];
+        result += [self->unknownFields_ serializedSize];
       }
     }
   }  // @synchronized(self)
 
   // Add any extensions.
-  for (GPBExtensionDescriptor *extension in extensionMap_) {
-    id value = [extensionMap_ objectForKey:extension];
+  for (GPBExtensionDescriptor *extension in self->extensionMap_) {
+    id value = [self->extensionMap_ objectForKey:extension];
     result += GPBComputeExtensionSerializedSizeIncludingTag(extension, value);
   }
 
@@ -0,0 +1,95 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#import <Foundation/Foundation.h>
+
+#import "GPBDescriptor.h"
+#import "GPBExtensionRegistry.h"
+#import "GPBMessage.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Parses messages out of data that arrives in chunks.
+ *
+ * Chunks of any size are pushed with @c -appendData:error: and every message
+ * is handed to the handler as soon as its last byte has been appended, so
+ * the first items of a large response can be used before the rest of it has
+ * been received. Only the bytes of the message not yet complete are kept, a
+ * chunk is not copied when it holds whole messages.
+ *
+ * The handler is called synchronously from @c -appendData:error:.
+ *
+ * @note A parser must only be used from one thread at a time.
+ **/
+__attribute__((objc_subclassing_restricted))
+@interface GPBMessageStreamParser : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Initializes a parser for a sequence of length delimited messages, as written
+ * by @c -[GPBMessage writeDelimitedToOutputStream:].
+ *
+ * @param messageClass      The class of the messages in the sequence.
+ * @param extensionRegistry The extension registry to use to look up extensions.
+ * @param handler           Called with every message of the sequence.
+ **/
+- (instancetype)initWithDelimitedMessageClass:(Class)messageClass
+                            extensionRegistry:(nullable id<GPBExtensionRegistry>)extensionRegistry
+                                      handler:(void (^)(GPBMessage *message))handler;
+
+/**
+ * Initializes a parser for a single message of @c messageClass whose repeated
+ * message field @c field is handed out element by element.
+ *
+ * The elements are not added to @c message, every other field is merged into
+ * it as it arrives.
+ *
+ * @param messageClass      The class of the message being parsed.
+ * @param field             A repeated message field of @c messageClass.
+ * @param extensionRegistry The extension registry to use to look up extensions.
+ * @param handler           Called with every element of @c field.
+ **/
+- (instancetype)initWithMessageClass:(Class)messageClass
+                       repeatedField:(GPBFieldDescriptor *)field
+                   extensionRegistry:(nullable id<GPBExtensionRegistry>)extensionRegistry
+                             handler:(void (^)(GPBMessage *element))handler;
+
+/**
+ * The message parsed so far, without the elements of the streamed field. Only
+ * set for parsers created with
+ * @c -initWithMessageClass:repeatedField:extensionRegistry:handler:.
+ **/
+@property(nonatomic, readonly, nullable) GPBMessage *message;
+
+/**
+ * Appends the next chunk of the input and hands out the messages it completes.
+ *
+ * @param data     The next bytes of the input.
+ * @param errorPtr An optional error pointer to fill in with a failure reason if
+ *                 the input can not be parsed.
+ *
+ * @return NO if the input is malformed, the parser then fails every later
+ *         call with the same error.
+ **/
+- (BOOL)appendData:(NSData *)data error:(NSError **)errorPtr;
+
+/**
+ * Checks the input ended on a message boundary, call it once all the input
+ * was appended.
+ *
+ * @param errorPtr An optional error pointer to fill in with a failure reason if
+ *                 the input is truncated or was malformed.
+ *
+ * @return NO if the input is truncated or was malformed.
+ **/
+- (BOOL)finishWithError:(NSError **)errorPtr;
+
+@end
+
+NS_ASSUME_NONNULL_END
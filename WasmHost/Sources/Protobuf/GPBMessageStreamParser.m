@@ -0,0 +1,394 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#import "GPBMessageStreamParser.h"
+
+#import "GPBCodedInputStream.h"
+#import "GPBCodedInputStream_PackagePrivate.h"
+#import "GPBMessage_PackagePrivate.h"
+#import "GPBUtilities_PackagePrivate.h"
+#import "GPBWireFormat.h"
+
+// Same limits as GPBCodedInputStream.
+static const NSUInteger kScanRecursionLimit = 100;
+static const size_t kScanMaxVarintBytes = 10;
+static const uint64_t kScanMaxFieldSize = 0x7fffffff;
+
+typedef NS_ENUM(NSInteger, GPBScanResult) {
+  GPBScanResultComplete,
+  GPBScanResultIncomplete,
+  GPBScanResultMalformed,
+};
+
+// Record boundaries are found by scanning ahead of the parse: a record is only
+// parsed once all of its bytes are there, so a parse never fails because the
+// input is truncated and never has to be resumed.
+
+static GPBScanResult ScanVarint(const uint8_t *bytes, size_t available, uint64_t *value,
+                                size_t *size) {
+  uint64_t result = 0;
+  for (size_t i = 0; i < kScanMaxVarintBytes; i++) {
+    if (i == available) {
+      return GPBScanResultIncomplete;
+    }
+    result |= (uint64_t)(bytes[i] & 0x7f) << (7 * i);
+    if ((bytes[i] & 0x80) == 0) {
+      *value = result;
+      *size = i + 1;
+      return GPBScanResultComplete;
+    }
+  }
+  return GPBScanResultMalformed;
+}
+
+// Scans the field starting at |bytes|. On success |*size| is the size of the
+// field, tag included. When incomplete, |*size| is the size the field needs if
+// it is known already, 0 otherwise.
+static GPBScanResult ScanField(const uint8_t *bytes, size_t available, NSUInteger depth,
+                               uint32_t *tag, size_t *size) {
+  *size = 0;
+  uint64_t rawTag;
+  size_t pos;
+  GPBScanResult result = ScanVarint(bytes, available, &rawTag, &pos);
+  if (result != GPBScanResultComplete) {
+    return result;
+  }
+  if (rawTag > UINT32_MAX || !GPBWireFormatIsValidTag((uint32_t)rawTag) ||
+      GPBWireFormatGetTagFieldNumber((uint32_t)rawTag) == 0) {
+    return GPBScanResultMalformed;
+  }
+  switch (GPBWireFormatGetTagWireType((uint32_t)rawTag)) {
+    case GPBWireFormatVarint: {
+      uint64_t value;
+      size_t valueSize;
+      result = ScanVarint(bytes + pos, available - pos, &value, &valueSize);
+      if (result != GPBScanResultComplete) {
+        return result;
+      }
+      pos += valueSize;
+      break;
+    }
+    case GPBWireFormatFixed64:
+    case GPBWireFormatFixed32:
+    case GPBWireFormatLengthDelimited: {
+      uint64_t length;
+      if (GPBWireFormatGetTagWireType((uint32_t)rawTag) == GPBWireFormatLengthDelimited) {
+        size_t lengthSize;
+        result = ScanVarint(bytes + pos, available - pos, &length, &lengthSize);
+        if (result != GPBScanResultComplete) {
+          return result;
+        }
+        if (length > kScanMaxFieldSize) {
+          return GPBScanResultMalformed;
+        }
+        pos += lengthSize;
+      } else {
+        length = GPBWireFormatGetTagWireType((uint32_t)rawTag) == GPBWireFormatFixed64 ? 8 : 4;
+      }
+      pos += (size_t)length;
+      if (pos > available) {
+        *size = pos;
+        return GPBScanResultIncomplete;
+      }
+      break;
+    }
+    case GPBWireFormatStartGroup: {
+      if (depth >= kScanRecursionLimit) {
+        return GPBScanResultMalformed;
+      }
+      uint32_t endTag = GPBWireFormatMakeTag(GPBWireFormatGetTagFieldNumber((uint32_t)rawTag),
+                                             GPBWireFormatEndGroup);
+      while (YES) {
+        uint32_t nestedTag;
+        size_t nestedSize;
+        result = ScanField(bytes + pos, available - pos, depth + 1, &nestedTag, &nestedSize);
+        if (result != GPBScanResultComplete) {
+          return result;
+        }
+        pos += nestedSize;
+        if (nestedTag == endTag) {
+          break;
+        }
+        if (GPBWireFormatGetTagWireType(nestedTag) == GPBWireFormatEndGroup) {
+          return GPBScanResultMalformed;
+        }
+      }
+      break;
+    }
+    case GPBWireFormatEndGroup:
+      // Only valid inside a group, the caller checks it closes the right one.
+      if (depth == 0) {
+        return GPBScanResultMalformed;
+      }
+      break;
+    default:
+      return GPBScanResultMalformed;
+  }
+  *tag = (uint32_t)rawTag;
+  *size = pos;
+  return GPBScanResultComplete;
+}
+
+static NSError *ParserErrorFromException(NSException *exception) {
+  NSError *error = nil;
+  if ([exception.name isEqual:GPBCodedInputStreamException]) {
+    error = exception.userInfo[GPBCodedInputStreamUnderlyingErrorKey];
+  }
+  if (!error) {
+    NSString *reason = exception.reason;
+    error = [NSError errorWithDomain:GPBMessageErrorDomain
+                                code:GPBMessageErrorCodeOther
+                            userInfo:[reason length] ? @{GPBErrorReasonKey : reason} : nil];
+  }
+  return error;
+}
+
+static NSError *NewStreamError(GPBCodedInputStreamErrorCode code) {
+  return [NSError errorWithDomain:GPBCodedInputStreamErrorDomain code:code userInfo:nil];
+}
+
+@implementation GPBMessageStreamParser {
+  Class messageClass_;
+  GPBFieldDescriptor *field_;
+  uint32_t elementTag_;
+  id<GPBExtensionRegistry> extensionRegistry_;
+  void (^handler_)(GPBMessage *message);
+  GPBMessage *message_;
+
+  // Bytes not parsed yet: the tail of buffer_ from offset_, followed by the
+  // chunks appended since. They are only joined in a new buffer once the next
+  // record can be complete (needed_), a large record arriving in many chunks
+  // is copied once.
+  NSData *buffer_;
+  size_t offset_;
+  NSMutableArray<NSData *> *chunks_;
+  size_t available_;
+  size_t needed_;
+  // Reads from buffer_.
+  GPBCodedInputStream *input_;
+  NSError *error_;
+}
+
+@synthesize message = message_;
+
+- (instancetype)initWithDelimitedMessageClass:(Class)messageClass
+                            extensionRegistry:(id<GPBExtensionRegistry>)extensionRegistry
+                                      handler:(void (^)(GPBMessage *message))handler {
+  if ((self = [super init])) {
+    messageClass_ = messageClass;
+    extensionRegistry_ = [extensionRegistry retain];
+    handler_ = [handler copy];
+    chunks_ = [[NSMutableArray alloc] init];
+  }
+  return self;
+}
+
+- (instancetype)initWithMessageClass:(Class)messageClass
+                       repeatedField:(GPBFieldDescriptor *)field
+                   extensionRegistry:(id<GPBExtensionRegistry>)extensionRegistry
+                             handler:(void (^)(GPBMessage *element))handler {
+  if (![[messageClass descriptor].fields containsObject:field] ||
+      field.fieldType != GPBFieldTypeRepeated || field.dataType != GPBDataTypeMessage) {
+    [self release];
+    [NSException raise:NSInvalidArgumentException
+                format:@"%@ is not a repeated message field of %@", field.name, messageClass];
+  }
+  if ((self = [self initWithDelimitedMessageClass:field.msgClass
+                                extensionRegistry:extensionRegistry
+                                          handler:handler])) {
+    field_ = [field retain];
+    elementTag_ = GPBWireFormatMakeTag(field.number, GPBWireFormatLengthDelimited);
+    message_ = [[messageClass alloc] init];
+  }
+  return self;
+}
+
+- (void)dealloc {
+  [field_ release];
+  [extensionRegistry_ release];
+  [handler_ release];
+  [message_ release];
+  [buffer_ release];
+  [chunks_ release];
+  [input_ release];
+  [error_ release];
+  [super dealloc];
+}
+
+- (BOOL)failWithError:(NSError *)error errorPtr:(NSError **)errorPtr {
+  if (!error_) {
+    error_ = [error retain];
+    // Nothing will be parsed anymore.
+    [chunks_ removeAllObjects];
+    [buffer_ release];
+    buffer_ = nil;
+  }
+  if (errorPtr) {
+    *errorPtr = error_;
+  }
+  return NO;
+}
+
+- (BOOL)appendData:(NSData *)data error:(NSError **)errorPtr {
+  if (error_) {
+    return [self failWithError:error_ errorPtr:errorPtr];
+  }
+  if (data.length) {
+    NSData *chunk = [data copy];
+    [chunks_ addObject:chunk];
+    [chunk release];
+    available_ += chunk.length;
+  }
+  if (available_ == 0 || available_ < needed_) {
+    if (errorPtr) {
+      *errorPtr = nil;
+    }
+    return YES;
+  }
+  [self joinChunks];
+
+  const uint8_t *bytes = (const uint8_t *)buffer_.bytes;
+  size_t length = buffer_.length;
+  needed_ = 0;
+  while (offset_ < length) {
+    uint32_t tag = 0;
+    size_t size;
+    GPBScanResult result;
+    if (field_) {
+      result = ScanField(bytes + offset_, length - offset_, 0, &tag, &size);
+    } else {
+      uint64_t messageSize;
+      size_t sizeSize;
+      result = ScanVarint(bytes + offset_, length - offset_, &messageSize, &sizeSize);
+      size = 0;
+      if (result == GPBScanResultComplete) {
+        if (messageSize > kScanMaxFieldSize) {
+          result = GPBScanResultMalformed;
+        } else {
+          size = sizeSize + (size_t)messageSize;
+          if (offset_ + size > length) {
+            result = GPBScanResultIncomplete;
+          }
+        }
+      }
+    }
+    if (result == GPBScanResultIncomplete) {
+      needed_ = size;
+      break;
+    }
+    if (result == GPBScanResultMalformed) {
+      return [self failWithError:NewStreamError(GPBCodedInputStreamErrorInvalidTag)
+                        errorPtr:errorPtr];
+    }
+
+    GPBMessage *parsed = nil;
+    @try {
+      parsed = [self parseRecordOfSize:size tag:tag];
+    } @catch (NSException *exception) {
+      return [self failWithError:ParserErrorFromException(exception) errorPtr:errorPtr];
+    }
+    offset_ += size;
+    available_ -= size;
+    if (parsed) {
+      // Outside of the @try, exceptions from the handler are not parse errors.
+      handler_(parsed);
+      [parsed release];
+    }
+  }
+  if (offset_ == length) {
+    [buffer_ release];
+    buffer_ = nil;
+    [input_ release];
+    input_ = nil;
+    offset_ = 0;
+  }
+  if (errorPtr) {
+    *errorPtr = nil;
+  }
+  return YES;
+}
+
+- (void)joinChunks {
+  if (chunks_.count == 0) {
+    return;
+  }
+  size_t tail = buffer_.length - offset_;
+  NSData *joined;
+  if (tail == 0 && chunks_.count == 1) {
+    joined = [chunks_[0] retain];
+  } else {
+    uint8_t *bytes = malloc(available_);
+    if (!bytes) {
+      [NSException raise:NSMallocException
+                  format:@"Failed to allocate %lu bytes", (unsigned long)available_];
+    }
+    memcpy(bytes, (const uint8_t *)buffer_.bytes + offset_, tail);
+    size_t pos = tail;
+    for (NSData *chunk in chunks_) {
+      memcpy(bytes + pos, chunk.bytes, chunk.length);
+      pos += chunk.length;
+    }
+    joined = [[NSData alloc] initWithBytesNoCopy:bytes length:available_ freeWhenDone:YES];
+  }
+  [chunks_ removeAllObjects];
+  [buffer_ release];
+  buffer_ = joined;
+  offset_ = 0;
+  [input_ release];
+  input_ = nil;
+}
+
+// Parses the record at offset_, returns the message to hand out if any.
+- (GPBMessage *)parseRecordOfSize:(size_t)size tag:(uint32_t)tag NS_RETURNS_RETAINED {
+  if (!input_) {
+    input_ = [[GPBCodedInputStream alloc] initWithData:buffer_];
+  }
+  GPBCodedInputStreamState *state = &input_->state_;
+  state->bufferPos = offset_;
+  state->currentLimit = offset_ + size;
+  state->lastTag = 0;
+  state->recursionDepth = 0;
+  if (field_ && tag != elementTag_) {
+    // Any other field goes into the message as if the whole input was parsed.
+    [message_ mergeFromCodedInputStream:input_
+                      extensionRegistry:extensionRegistry_
+                              endingTag:0];
+    return nil;
+  }
+  if (field_) {
+    GPBCodedInputStreamReadTag(state);
+  }
+  NSRange range = GPBCodedInputStreamReadLengthDelimitedRange(state);
+  state->bufferPos = range.location;
+  state->currentLimit = NSMaxRange(range);
+  state->lastTag = 0;
+  GPBMessage *message = [[messageClass_ alloc] init];
+  @try {
+    [message mergeFromCodedInputStream:input_ extensionRegistry:extensionRegistry_ endingTag:0];
+    [input_ checkLastTagWas:0];
+  } @catch (NSException *exception) {
+    [message release];
+    @throw;
+  }
+  return message;
+}
+
+- (BOOL)finishWithError:(NSError **)errorPtr {
+  if (error_) {
+    return [self failWithError:error_ errorPtr:errorPtr];
+  }
+  if (available_ > 0) {
+    return [self failWithError:NewStreamError(GPBCodedInputStreamErrorInvalidSize)
+                      errorPtr:errorPtr];
+  }
+  if (errorPtr) {
+    *errorPtr = nil;
+  }
+  return YES;
+}
+
+@end
@@ -57,6 +57,15 @@ typedef struct GPBMessage_Storage *GPBMessage_StoragePtr;
                 extensionRegistry:(id<GPBExtensionRegistry>)extensionRegistry
                         endingTag:(uint32_t)endingTag;
 
+// Parses a message of this type from the input and merges only the fields kept
+// by `fieldMask` into this message, everything else is skipped without being
+// added to the unknown fields. `fieldMask` must be for this message's
+// descriptor.
+//
+// NOTE: This will throw if there is an error while parsing.
+- (void)mergeFromCodedInputStream:(GPBCodedInputStream *)input
+                        fieldMask:(GPBCompiledFieldMask *)fieldMask;
+
 - (void)addUnknownMapEntry:(int32_t)fieldNum value:(NSData *)data;
 
 @end
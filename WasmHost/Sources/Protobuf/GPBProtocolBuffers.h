@@ -12,10 +12,13 @@
 #import "GPBArray.h"
 #import "GPBCodedInputStream.h"
 #import "GPBCodedOutputStream.h"
+#import "GPBCompiledFieldMask.h"
 #import "GPBDescriptor.h"
 #import "GPBDictionary.h"
 #import "GPBExtensionRegistry.h"
+#import "GPBJSONTranscoder.h"
 #import "GPBMessage.h"
+#import "GPBMessageStreamParser.h"
 #import "GPBRootObject.h"
 #import "GPBUnknownField.h"
 #import "GPBUnknownFieldSet.h"
@@ -15,14 +15,18 @@
 // warnings here.
 #pragma clang diagnostic ignored "-Wnullability-completeness"
 
+#import "GPBArena.m"
 #import "GPBArray.m"
 #import "GPBCodedInputStream.m"
 #import "GPBCodedOutputStream.m"
+#import "GPBCompiledFieldMask.m"
 #import "GPBDescriptor.m"
 #import "GPBDictionary.m"
 #import "GPBExtensionInternals.m"
 #import "GPBExtensionRegistry.m"
+#import "GPBJSONTranscoder.m"
 #import "GPBMessage.m"
+#import "GPBMessageStreamParser.m"
 #import "GPBRootObject.m"
 #import "GPBUnknownField.m"
 #import "GPBUnknownFieldSet.m"
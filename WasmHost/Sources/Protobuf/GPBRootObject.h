@@ -24,6 +24,29 @@ NS_ASSUME_NONNULL_BEGIN
  **/
 + (GPBExtensionRegistry *)extensionRegistry;
 
+/**
+ * Builds the descriptors of every message in the file, along with the enum
+ * descriptors and parsing tables they use, so the first parse or serialize of
+ * each message doesn't pay for it.
+ *
+ * Safe to call from any thread and more than once; a message whose descriptor
+ * is being built by another thread waits for it instead of building it again.
+ * Does nothing unless the Root class overrides +prewarmedMessageClasses.
+ **/
++ (void)prewarmDescriptors;
+
+/**
+ * @return The message classes of the file that +prewarmDescriptors builds the
+ *         descriptors of, empty unless the Root class overrides it.
+ **/
++ (NSArray<Class> *)prewarmedMessageClasses;
+
+/**
+ * Calls +prewarmDescriptors on a background queue, typically at launch before
+ * the first message of the file is needed.
+ **/
++ (void)prewarmDescriptorsInBackground;
+
 @end
 
 NS_ASSUME_NONNULL_END
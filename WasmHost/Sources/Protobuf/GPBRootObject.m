@@ -13,6 +13,7 @@
 #import <os/lock.h>
 
 #import "GPBDescriptor.h"
+#import "GPBDescriptor_PackagePrivate.h"
 #import "GPBExtensionRegistry.h"
 #import "GPBUtilities.h"
 #import "GPBUtilities_PackagePrivate.h"
@@ -120,6 +121,42 @@ static GPBExtensionRegistry *gDefaultExtensionRegistry = NULL;
   return gDefaultExtensionRegistry;
 }
 
++ (void)prewarmDescriptors {
+  GPBPrewarmMessageClasses([self prewarmedMessageClasses]);
+}
+
++ (NSArray<Class> *)prewarmedMessageClasses {
+  // Overridden, in categories, by the Root classes that list their messages.
+  return @[];
+}
+
++ (void)prewarmDescriptorsInBackground {
+  dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+    [self prewarmDescriptors];
+  });
+}
+
+void GPBPrewarmMessageClasses(NSArray<Class> *classes) {
+  for (Class messageClass in classes) {
+    @autoreleasepool {
+      // +descriptor is what builds the descriptor. The first message to the
+      // class runs +initialize, which calls it under the runtime's lock for
+      // that class, so concurrent callers wait for one build.
+      GPBDescriptor *descriptor = [messageClass descriptor];
+      (void)GPBDescriptorTagTable(descriptor);
+      for (GPBFieldDescriptor *field in descriptor->fields_) {
+        GPBDataType dataType = GPBGetFieldDataType(field);
+        if (GPBDataTypeIsMessage(dataType)) {
+          // Messages of other files, e.g. the well known types.
+          (void)GPBDescriptorTagTable([field.msgClass descriptor]);
+        } else if (dataType == GPBDataTypeEnum) {
+          (void)field.enumDescriptor;
+        }
+      }
+    }
+  }
+}
+
 + (void)globallyRegisterExtension:(GPBExtensionDescriptor *)field {
   const char *key = [field singletonNameC];
   os_unfair_lock_lock(&gExtensionSingletonDictionaryLock);
@@ -21,3 +21,7 @@
 // Returns YES if the selector was resolved and added to the class,
 // NO otherwise.
 BOOL GPBResolveExtensionClassMethod(Class self, SEL sel);
+
+// Builds the descriptors of the given message classes and what they use, for
+// +[GPBRootObject prewarmDescriptors].
+void GPBPrewarmMessageClasses(NSArray<Class> *classes);
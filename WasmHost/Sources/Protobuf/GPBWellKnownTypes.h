@@ -8,7 +8,9 @@
 #import <Foundation/Foundation.h>
 
 #import "GPBAny.pbobjc.h"
+#import "GPBArray.h"
 #import "GPBDuration.pbobjc.h"
+#import "GPBStruct.pbobjc.h"
 #import "GPBTimestamp.pbobjc.h"
 
 NS_ASSUME_NONNULL_BEGIN
@@ -24,6 +26,8 @@ typedef NS_ENUM(NSInteger, GPBWellKnownTypesErrorCode) {
   GPBWellKnownTypesErrorCodeFailedToComputeTypeURL = -100,
   /** type_url in a Any doesn’t match that of the requested GPBMessage class. */
   GPBWellKnownTypesErrorCodeTypeURLMismatch = -101,
+  /** An object can not be represented as a google.protobuf.Value. */
+  GPBWellKnownTypesErrorCodeUnsupportedValue = -102,
 };
 
 #pragma mark - GPBTimestamp
@@ -221,4 +225,85 @@ typedef NS_ENUM(NSInteger, GPBWellKnownTypesErrorCode) {
 
 @end
 
+#pragma mark - GPBStruct
+
+/**
+ * Category for GPBStruct to convert to and from Foundation containers.
+ *
+ * A google.protobuf.Value maps to NSNull, NSNumber (a CFBoolean for
+ * bool_value), NSString, NSDictionary or NSArray. A non empty ListValue
+ * holding only numbers maps to a GPBDoubleArray, its numbers are kept in one
+ * contiguous buffer instead of an NSNumber each. A Value with no kind set maps
+ * to NSNull.
+ *
+ * The class methods work on the wire format directly, no GPBValue is created.
+ **/
+@interface GPBStruct (GBPWellKnownTypes)
+
+/** The Foundation representation of this GPBStruct. */
+@property(nonatomic, readonly) NSDictionary<NSString *, id> *dictionary;
+
+/**
+ * Decodes serialized google.protobuf.Struct bytes into Foundation containers.
+ *
+ * @param data     The serialized Struct.
+ * @param errorPtr Pointer to an error that will be populated if the data is
+ *                 malformed.
+ *
+ * @return The decoded dictionary, or nil on failure.
+ **/
++ (nullable NSDictionary<NSString *, id> *)dictionaryFromData:(NSData *)data
+                                                        error:(NSError **)errorPtr;
+
+/**
+ * Encodes Foundation containers as a serialized google.protobuf.Struct.
+ *
+ * @param dictionary The dictionary to encode, its keys must be NSStrings.
+ * @param errorPtr   Pointer to an error that will be populated with
+ *                   GPBWellKnownTypesErrorCodeUnsupportedValue if some object
+ *                   can't be represented as a Value.
+ *
+ * @return The serialized Struct, or nil on failure.
+ **/
++ (nullable NSData *)dataFromDictionary:(NSDictionary<NSString *, id> *)dictionary
+                                  error:(NSError **)errorPtr;
+
+@end
+
+#pragma mark - GPBValue
+
+/**
+ * Category for GPBValue to convert to and from Foundation objects, with the
+ * mapping described on GPBStruct (GBPWellKnownTypes).
+ **/
+@interface GPBValue (GBPWellKnownTypes)
+
+/** The Foundation representation of this GPBValue. */
+@property(nonatomic, readonly) id object;
+
+/**
+ * Decodes serialized google.protobuf.Value bytes into a Foundation object.
+ *
+ * @param data     The serialized Value.
+ * @param errorPtr Pointer to an error that will be populated if the data is
+ *                 malformed.
+ *
+ * @return The decoded object, or nil on failure.
+ **/
++ (nullable id)objectFromData:(NSData *)data error:(NSError **)errorPtr;
+
+/**
+ * Encodes a Foundation object as a serialized google.protobuf.Value.
+ *
+ * @param object   The object to encode.
+ * @param errorPtr Pointer to an error that will be populated with
+ *                 GPBWellKnownTypesErrorCodeUnsupportedValue if some object
+ *                 can't be represented as a Value.
+ *
+ * @return The serialized Value, or nil on failure.
+ **/
++ (nullable NSData *)dataFromObject:(id)object error:(NSError **)errorPtr;
+
+@end
+
 NS_ASSUME_NONNULL_END
@@ -11,8 +11,11 @@
 
 #import "GPBWellKnownTypes.h"
 
+#import "GPBCodedInputStream_PackagePrivate.h"
+#import "GPBCodedOutputStream_PackagePrivate.h"
 #import "GPBUtilities.h"
 #import "GPBUtilities_PackagePrivate.h"
+#import "GPBWireFormat.h"
 
 NSString *const GPBWellKnownTypesErrorDomain = GPBNSStringifySymbol(GPBWellKnownTypesErrorDomain);
 
@@ -226,3 +229,579 @@ static NSString *ParseTypeFromURL(NSString *typeURLString) {
 }
 
 @end
+
+#pragma mark - GPBStruct / GPBValue
+
+// Containers nested deeper than this are rejected, on both decode and encode
+// (the latter also catches containers that contain themselves).
+static const int kStructMaxDepth = 100;
+
+// The tags of the fields making up Struct, its map entries, Value and ListValue,
+// as constants so they can be switched on.
+#define STRUCT_TAG(fieldNumber, wireType) (((fieldNumber) << 3) | (wireType))
+enum {
+  kStructFieldsTag = STRUCT_TAG(GPBStruct_FieldNumber_Fields, GPBWireFormatLengthDelimited),
+  kStructEntryKeyTag = STRUCT_TAG(1, GPBWireFormatLengthDelimited),
+  kStructEntryValueTag = STRUCT_TAG(2, GPBWireFormatLengthDelimited),
+  kValueNullTag = STRUCT_TAG(GPBValue_FieldNumber_NullValue, GPBWireFormatVarint),
+  kValueNumberTag = STRUCT_TAG(GPBValue_FieldNumber_NumberValue, GPBWireFormatFixed64),
+  kValueStringTag = STRUCT_TAG(GPBValue_FieldNumber_StringValue, GPBWireFormatLengthDelimited),
+  kValueBoolTag = STRUCT_TAG(GPBValue_FieldNumber_BoolValue, GPBWireFormatVarint),
+  kValueStructTag = STRUCT_TAG(GPBValue_FieldNumber_StructValue, GPBWireFormatLengthDelimited),
+  kValueListTag = STRUCT_TAG(GPBValue_FieldNumber_ListValue, GPBWireFormatLengthDelimited),
+  kListValuesTag = STRUCT_TAG(GPBListValue_FieldNumber_ValuesArray, GPBWireFormatLengthDelimited),
+};
+#undef STRUCT_TAG
+
+// Each element of a GPBDoubleArray is a Value holding only number_value:
+// the element tag, its length and the 9 bytes of the Value.
+static const size_t kStructNumberValueSize = 1 + 8;
+static const size_t kStructNumberElementSize = 1 + 1 + kStructNumberValueSize;
+
+static BOOL IsStructBool(id object) {
+  return CFGetTypeID((CFTypeRef)object) == CFBooleanGetTypeID();
+}
+
+static NSError *StructErrorFromException(NSException *exception) {
+  NSError *error = nil;
+  if ([exception.name isEqual:GPBCodedInputStreamException]) {
+    error = exception.userInfo[GPBCodedInputStreamUnderlyingErrorKey];
+  }
+  if (!error) {
+    NSString *reason = exception.reason;
+    error = [NSError errorWithDomain:GPBMessageErrorDomain
+                                code:GPBMessageErrorCodeOther
+                            userInfo:[reason length] ? @{GPBErrorReasonKey : reason} : nil];
+  }
+  return error;
+}
+
+static NSError *UnsupportedValueError(id object) {
+  NSString *reason =
+      [NSString stringWithFormat:@"%@ can't be represented as a google.protobuf.Value",
+                                 [object class]];
+  return [NSError errorWithDomain:GPBWellKnownTypesErrorDomain
+                             code:GPBWellKnownTypesErrorCodeUnsupportedValue
+                         userInfo:@{NSLocalizedDescriptionKey : reason}];
+}
+
+#pragma mark Decoding
+
+static NSDictionary *DecodeStruct(GPBCodedInputStream *input, int depth);
+static id DecodeList(GPBCodedInputStream *input, int depth);
+
+static void CheckStructDepth(int depth) {
+  if (depth >= kStructMaxDepth) {
+    GPBRaiseStreamError(GPBCodedInputStreamErrorRecursionDepthExceeded,
+                        @"Struct nested too deep");
+  }
+}
+
+// Reads a Value up to the current limit. Numbers are returned in |outNumber|
+// with nil, anything else as an autoreleased object.
+static id DecodeValue(GPBCodedInputStream *input, int depth, double *outNumber) {
+  GPBCodedInputStreamState *state = &input->state_;
+  id result = [NSNull null];
+  BOOL isNumber = NO;
+  // Fields of the oneof overwrite each other, the last one wins.
+  while (YES) {
+    int32_t tag = GPBCodedInputStreamReadTag(state);
+    if (tag == 0) {
+      break;
+    }
+    isNumber = NO;
+    switch (tag) {
+      case kValueNullTag:
+        GPBCodedInputStreamReadEnum(state);
+        result = [NSNull null];
+        break;
+      case kValueNumberTag:
+        *outNumber = GPBCodedInputStreamReadDouble(state);
+        result = nil;
+        isNumber = YES;
+        break;
+      case kValueStringTag:
+        result = [GPBCodedInputStreamReadRetainedString(state) autorelease];
+        break;
+      case kValueBoolTag:
+        result = GPBCodedInputStreamReadBool(state) ? (id)kCFBooleanTrue : (id)kCFBooleanFalse;
+        break;
+      case kValueStructTag:
+      case kValueListTag: {
+        CheckStructDepth(depth + 1);
+        int32_t length = GPBCodedInputStreamReadInt32(state);
+        size_t oldLimit = GPBCodedInputStreamPushLimit(state, length);
+        result = (tag == kValueStructTag) ? DecodeStruct(input, depth + 1)
+                                          : DecodeList(input, depth + 1);
+        GPBCodedInputStreamCheckLastTagWas(state, 0);
+        GPBCodedInputStreamPopLimit(state, oldLimit);
+        break;
+      }
+      default:
+        if (![input skipField:tag]) {
+          GPBRaiseStreamError(GPBCodedInputStreamErrorInvalidTag, @"Unexpected end group tag");
+        }
+        // An unknown field doesn't change the kind.
+        isNumber = (result == nil);
+        break;
+    }
+  }
+  return isNumber ? nil : result;
+}
+
+// Reads the fields of a Struct up to the current limit.
+static NSDictionary *DecodeStruct(GPBCodedInputStream *input, int depth) {
+  GPBCodedInputStreamState *state = &input->state_;
+  NSMutableDictionary *result = [NSMutableDictionary dictionary];
+  while (YES) {
+    int32_t tag = GPBCodedInputStreamReadTag(state);
+    if (tag == 0) {
+      break;
+    }
+    if (tag != kStructFieldsTag) {
+      if (![input skipField:tag]) {
+        GPBRaiseStreamError(GPBCodedInputStreamErrorInvalidTag, @"Unexpected end group tag");
+      }
+      continue;
+    }
+    int32_t entryLength = GPBCodedInputStreamReadInt32(state);
+    size_t entryLimit = GPBCodedInputStreamPushLimit(state, entryLength);
+    NSString *key = nil;
+    id value = nil;
+    while (YES) {
+      int32_t entryTag = GPBCodedInputStreamReadTag(state);
+      if (entryTag == 0) {
+        break;
+      }
+      if (entryTag == kStructEntryKeyTag) {
+        key = [GPBCodedInputStreamReadRetainedString(state) autorelease];
+      } else if (entryTag == kStructEntryValueTag) {
+        int32_t valueLength = GPBCodedInputStreamReadInt32(state);
+        size_t valueLimit = GPBCodedInputStreamPushLimit(state, valueLength);
+        double number = 0;
+        value = DecodeValue(input, depth, &number);
+        if (!value) {
+          value = @(number);
+        }
+        GPBCodedInputStreamCheckLastTagWas(state, 0);
+        GPBCodedInputStreamPopLimit(state, valueLimit);
+      } else if (![input skipField:entryTag]) {
+        GPBRaiseStreamError(GPBCodedInputStreamErrorInvalidTag, @"Unexpected end group tag");
+      }
+    }
+    GPBCodedInputStreamCheckLastTagWas(state, 0);
+    GPBCodedInputStreamPopLimit(state, entryLimit);
+    // Map entries default missing keys/values, and repeated keys keep the last
+    // value, like the map field of GPBStruct does.
+    result[key ?: @""] = value ?: [NSNull null];
+  }
+  return result;
+}
+
+// Reads the values of a ListValue up to the current limit. As long as every
+// value is a number they are collected in a GPBDoubleArray.
+static id DecodeList(GPBCodedInputStream *input, int depth) {
+  GPBCodedInputStreamState *state = &input->state_;
+  GPBDoubleArray *numbers = nil;
+  NSMutableArray *objects = nil;
+  while (YES) {
+    int32_t tag = GPBCodedInputStreamReadTag(state);
+    if (tag == 0) {
+      break;
+    }
+    if (tag != kListValuesTag) {
+      if (![input skipField:tag]) {
+        GPBRaiseStreamError(GPBCodedInputStreamErrorInvalidTag, @"Unexpected end group tag");
+      }
+      continue;
+    }
+    int32_t length = GPBCodedInputStreamReadInt32(state);
+    size_t oldLimit = GPBCodedInputStreamPushLimit(state, length);
+    double number = 0;
+    id value = DecodeValue(input, depth, &number);
+    GPBCodedInputStreamCheckLastTagWas(state, 0);
+    GPBCodedInputStreamPopLimit(state, oldLimit);
+
+    if (!value && !objects) {
+      if (!numbers) {
+        numbers = [GPBDoubleArray array];
+      }
+      [numbers addValue:number];
+      continue;
+    }
+    if (!objects) {
+      // First value that isn't a number, box the ones read so far.
+      objects = [NSMutableArray arrayWithCapacity:numbers.count + 1];
+      [numbers enumerateValuesWithBlock:^(double v, __unused NSUInteger idx, __unused BOOL *stop) {
+        [objects addObject:@(v)];
+      }];
+      numbers = nil;
+    }
+    [objects addObject:value ?: @(number)];
+  }
+  if (numbers) {
+    return numbers;
+  }
+  return objects ?: @[];
+}
+
+typedef id (*StructDecodeFunc)(GPBCodedInputStream *input);
+
+static id DecodeStructRoot(GPBCodedInputStream *input) { return DecodeStruct(input, 0); }
+
+static id DecodeValueRoot(GPBCodedInputStream *input) {
+  double number = 0;
+  id value = DecodeValue(input, 0, &number);
+  return value ?: @(number);
+}
+
+static id DecodeStructData(NSData *data, StructDecodeFunc decode, NSError **errorPtr) {
+  if (errorPtr) {
+    *errorPtr = nil;
+  }
+  GPBCodedInputStream *input = [[GPBCodedInputStream alloc] initWithData:data];
+  id result = nil;
+  @try {
+    result = decode(input);
+  } @catch (NSException *exception) {
+    result = nil;
+    if (errorPtr) {
+      *errorPtr = StructErrorFromException(exception);
+    }
+  }
+  [input release];
+  return result;
+}
+
+#pragma mark Encoding
+
+// Encoding is done in two passes: the first one validates the objects and
+// computes the length of every length delimited record, the second one writes
+// them into a buffer of the exact size. The lengths are recorded in the order
+// the records are written, so the second pass just reads them back in turn.
+typedef struct StructSizes {
+  size_t *sizes;
+  size_t count;
+  size_t capacity;
+  size_t next;
+} StructSizes;
+
+static size_t StructSizesReserve(StructSizes *sizes) {
+  if (sizes->count == sizes->capacity) {
+    size_t capacity = MAX(sizes->capacity * 2, (size_t)16);
+    size_t *grown = realloc(sizes->sizes, capacity * sizeof(size_t));
+    if (!grown) {
+      [NSException raise:NSMallocException
+                  format:@"Failed to allocate %lu bytes",
+                         (unsigned long)(capacity * sizeof(size_t))];
+    }
+    sizes->sizes = grown;
+    sizes->capacity = capacity;
+  }
+  return sizes->count++;
+}
+
+static size_t StructSizesNext(StructSizes *sizes) {
+  if (sizes->next >= sizes->count) {
+    [NSException raise:NSInternalInconsistencyException
+                format:@"Container mutated while being encoded"];
+  }
+  return sizes->sizes[sizes->next++];
+}
+
+static size_t LengthDelimitedSize(size_t length) {
+  // All the tags of these messages fit in one byte.
+  return 1 + GPBComputeSizeTSizeAsInt32NoTag(length) + length;
+}
+
+static BOOL StructBodySize(NSDictionary *dictionary, StructSizes *sizes, int depth,
+                           size_t *outSize, NSError **errorPtr);
+static BOOL ListBodySize(NSArray *array, StructSizes *sizes, int depth, size_t *outSize,
+                         NSError **errorPtr);
+
+// Size of the fields of a Value holding |object|.
+static BOOL ValueBodySize(id object, StructSizes *sizes, int depth, size_t *outSize,
+                          NSError **errorPtr) {
+  if (object == [NSNull null]) {
+    *outSize = 1 + 1;
+  } else if ([object isKindOfClass:[NSNumber class]]) {
+    *outSize = IsStructBool(object) ? 1 + 1 : kStructNumberValueSize;
+  } else if ([object isKindOfClass:[NSString class]]) {
+    *outSize = GPBComputeStringSize(GPBValue_FieldNumber_StringValue, object);
+  } else if ([object isKindOfClass:[GPBDoubleArray class]]) {
+    *outSize = LengthDelimitedSize([(GPBDoubleArray *)object count] * kStructNumberElementSize);
+  } else if ([object isKindOfClass:[NSDictionary class]] ||
+             [object isKindOfClass:[NSArray class]]) {
+    if (depth + 1 >= kStructMaxDepth) {
+      if (errorPtr) {
+        *errorPtr = UnsupportedValueError(object);
+      }
+      return NO;
+    }
+    size_t slot = StructSizesReserve(sizes);
+    size_t body = 0;
+    BOOL ok = [object isKindOfClass:[NSDictionary class]]
+                  ? StructBodySize(object, sizes, depth + 1, &body, errorPtr)
+                  : ListBodySize(object, sizes, depth + 1, &body, errorPtr);
+    if (!ok) {
+      return NO;
+    }
+    sizes->sizes[slot] = body;
+    *outSize = LengthDelimitedSize(body);
+  } else {
+    if (errorPtr) {
+      *errorPtr = UnsupportedValueError(object);
+    }
+    return NO;
+  }
+  return YES;
+}
+
+static BOOL StructBodySize(NSDictionary *dictionary, StructSizes *sizes, int depth,
+                           size_t *outSize, NSError **errorPtr) {
+  // Fast enumeration, not a block: an error set inside the block enumeration
+  // would belong to its autorelease pool and be gone before the caller reads it.
+  size_t total = 0;
+  for (id key in dictionary) {
+    if (![key isKindOfClass:[NSString class]]) {
+      if (errorPtr) {
+        *errorPtr = UnsupportedValueError(key);
+      }
+      return NO;
+    }
+    size_t valueSlot = StructSizesReserve(sizes);
+    size_t entrySlot = StructSizesReserve(sizes);
+    size_t valueSize = 0;
+    if (!ValueBodySize(dictionary[key], sizes, depth, &valueSize, errorPtr)) {
+      return NO;
+    }
+    size_t entrySize = GPBComputeStringSize(1, key) + LengthDelimitedSize(valueSize);
+    sizes->sizes[valueSlot] = valueSize;
+    sizes->sizes[entrySlot] = entrySize;
+    total += LengthDelimitedSize(entrySize);
+  }
+  *outSize = total;
+  return YES;
+}
+
+static BOOL ListBodySize(NSArray *array, StructSizes *sizes, int depth, size_t *outSize,
+                         NSError **errorPtr) {
+  size_t total = 0;
+  for (id object in array) {
+    size_t slot = StructSizesReserve(sizes);
+    size_t valueSize = 0;
+    if (!ValueBodySize(object, sizes, depth, &valueSize, errorPtr)) {
+      return NO;
+    }
+    sizes->sizes[slot] = valueSize;
+    total += LengthDelimitedSize(valueSize);
+  }
+  *outSize = total;
+  return YES;
+}
+
+static void WriteStructBody(GPBCodedOutputStream *output, NSDictionary *dictionary,
+                            StructSizes *sizes);
+static void WriteListBody(GPBCodedOutputStream *output, NSArray *array, StructSizes *sizes);
+
+static void WriteValueBody(GPBCodedOutputStream *output, id object, StructSizes *sizes) {
+  if (object == [NSNull null]) {
+    [output writeEnum:GPBValue_FieldNumber_NullValue value:GPBNullValue_NullValue];
+  } else if ([object isKindOfClass:[NSNumber class]]) {
+    if (IsStructBool(object)) {
+      [output writeBool:GPBValue_FieldNumber_BoolValue value:[object boolValue]];
+    } else {
+      [output writeDouble:GPBValue_FieldNumber_NumberValue value:[object doubleValue]];
+    }
+  } else if ([object isKindOfClass:[NSString class]]) {
+    [output writeString:GPBValue_FieldNumber_StringValue value:object];
+  } else if ([object isKindOfClass:[GPBDoubleArray class]]) {
+    GPBDoubleArray *numbers = object;
+    [output writeRawVarint32:kValueListTag];
+    [output writeRawVarintSizeTAs32:numbers.count * kStructNumberElementSize];
+    [numbers enumerateValuesWithBlock:^(double value, __unused NSUInteger idx,
+                                        __unused BOOL *stop) {
+      [output writeRawVarint32:kListValuesTag];
+      [output writeRawVarintSizeTAs32:kStructNumberValueSize];
+      [output writeDouble:GPBValue_FieldNumber_NumberValue value:value];
+    }];
+  } else if ([object isKindOfClass:[NSDictionary class]]) {
+    [output writeRawVarint32:kValueStructTag];
+    [output writeRawVarintSizeTAs32:StructSizesNext(sizes)];
+    WriteStructBody(output, object, sizes);
+  } else {
+    [output writeRawVarint32:kValueListTag];
+    [output writeRawVarintSizeTAs32:StructSizesNext(sizes)];
+    WriteListBody(output, object, sizes);
+  }
+}
+
+static void WriteStructBody(GPBCodedOutputStream *output, NSDictionary *dictionary,
+                            StructSizes *sizes) {
+  // Same enumeration as StructBodySize so the entries come in the order their sizes were recorded.
+  for (id key in dictionary) {
+    size_t valueSize = StructSizesNext(sizes);
+    size_t entrySize = StructSizesNext(sizes);
+    [output writeRawVarint32:kStructFieldsTag];
+    [output writeRawVarintSizeTAs32:entrySize];
+    [output writeString:1 value:key];
+    [output writeRawVarint32:kStructEntryValueTag];
+    [output writeRawVarintSizeTAs32:valueSize];
+    WriteValueBody(output, dictionary[key], sizes);
+  }
+}
+
+static void WriteListBody(GPBCodedOutputStream *output, NSArray *array, StructSizes *sizes) {
+  for (id object in array) {
+    [output writeRawVarint32:kListValuesTag];
+    [output writeRawVarintSizeTAs32:StructSizesNext(sizes)];
+    WriteValueBody(output, object, sizes);
+  }
+}
+
+static NSData *WriteStructData(id object, BOOL isStruct, size_t size, StructSizes *sizes,
+                               NSError **errorPtr) {
+  uint8_t *bytes = malloc(MAX(size, (size_t)1));
+  if (!bytes) {
+    [NSException raise:NSMallocException
+                format:@"Failed to allocate %lu bytes", (unsigned long)size];
+  }
+  NSData *data = nil;
+  GPBCodedOutputStream *output = [[GPBCodedOutputStream alloc] initWithBytes:bytes length:size];
+  @try {
+    if (isStruct) {
+      WriteStructBody(output, object, sizes);
+    } else {
+      WriteValueBody(output, object, sizes);
+    }
+    // The buffer isn't zeroed, never hand out a partially written one.
+    if ([output bytesWritten] == size) {
+      data = [NSData dataWithBytesNoCopy:bytes length:size freeWhenDone:YES];
+    }
+  } @catch (NSException *exception) {
+    if (errorPtr) {
+      *errorPtr = StructErrorFromException(exception);
+    }
+  }
+  if (!data) {
+    free(bytes);
+    // Only a container mutated by another thread while it is being encoded can
+    // make the two passes disagree.
+    if (errorPtr && !*errorPtr) {
+      *errorPtr = [NSError errorWithDomain:GPBMessageErrorDomain
+                                      code:GPBMessageErrorCodeOther
+                                  userInfo:@{
+                                    GPBErrorReasonKey : @"Container mutated while being encoded"
+                                  }];
+    }
+  }
+  [output release];
+  return data;
+}
+
+static NSData *EncodeStructData(id object, BOOL isStruct, NSError **errorPtr) {
+  if (errorPtr) {
+    *errorPtr = nil;
+  }
+  StructSizes sizes = {NULL, 0, 0, 0};
+  NSData *data = nil;
+  @try {
+    size_t size = 0;
+    BOOL ok = isStruct ? StructBodySize(object, &sizes, 0, &size, errorPtr)
+                       : ValueBodySize(object, &sizes, 0, &size, errorPtr);
+    if (ok) {
+      data = WriteStructData(object, isStruct, size, &sizes, errorPtr);
+    }
+  } @finally {
+    free(sizes.sizes);
+  }
+  return data;
+}
+
+#pragma mark Conversion of message trees
+
+static id ObjectFromValue(GPBValue *value);
+
+static NSDictionary *DictionaryFromStruct(GPBStruct *message) {
+  NSMutableDictionary *result = [NSMutableDictionary dictionaryWithCapacity:message.fields_Count];
+  NSMutableDictionary<NSString *, GPBValue *> *fields = message.fields;
+  for (NSString *key in fields) {
+    result[key] = ObjectFromValue(fields[key]);
+  }
+  return result;
+}
+
+static id ObjectFromList(GPBListValue *list) {
+  NSArray<GPBValue *> *values = list.valuesArray;
+  BOOL allNumbers = values.count > 0;
+  for (GPBValue *value in values) {
+    if (value.kindOneOfCase != GPBValue_Kind_OneOfCase_NumberValue) {
+      allNumbers = NO;
+      break;
+    }
+  }
+  if (allNumbers) {
+    GPBDoubleArray *numbers = [GPBDoubleArray arrayWithCapacity:values.count];
+    for (GPBValue *value in values) {
+      [numbers addValue:value.numberValue];
+    }
+    return numbers;
+  }
+  NSMutableArray *result = [NSMutableArray arrayWithCapacity:values.count];
+  for (GPBValue *value in values) {
+    [result addObject:ObjectFromValue(value)];
+  }
+  return result;
+}
+
+static id ObjectFromValue(GPBValue *value) {
+  switch (value.kindOneOfCase) {
+    case GPBValue_Kind_OneOfCase_NumberValue:
+      return @(value.numberValue);
+    case GPBValue_Kind_OneOfCase_StringValue:
+      return value.stringValue;
+    case GPBValue_Kind_OneOfCase_BoolValue:
+      return value.boolValue ? (id)kCFBooleanTrue : (id)kCFBooleanFalse;
+    case GPBValue_Kind_OneOfCase_StructValue:
+      return DictionaryFromStruct(value.structValue);
+    case GPBValue_Kind_OneOfCase_ListValue:
+      return ObjectFromList(value.listValue);
+    case GPBValue_Kind_OneOfCase_NullValue:
+    case GPBValue_Kind_OneOfCase_GPBUnsetOneOfCase:
+    default:
+      return [NSNull null];
+  }
+}
+
+@implementation GPBStruct (GBPWellKnownTypes)
+
+- (NSDictionary<NSString *, id> *)dictionary {
+  return DictionaryFromStruct(self);
+}
+
++ (NSDictionary<NSString *, id> *)dictionaryFromData:(NSData *)data error:(NSError **)errorPtr {
+  return DecodeStructData(data, DecodeStructRoot, errorPtr);
+}
+
++ (NSData *)dataFromDictionary:(NSDictionary<NSString *, id> *)dictionary
+                         error:(NSError **)errorPtr {
+  return EncodeStructData(dictionary, YES, errorPtr);
+}
+
+@end
+
+@implementation GPBValue (GBPWellKnownTypes)
+
+- (id)object {
+  return ObjectFromValue(self);
+}
+
++ (id)objectFromData:(NSData *)data error:(NSError **)errorPtr {
+  return DecodeStructData(data, DecodeValueRoot, errorPtr);
+}
+
++ (NSData *)dataFromObject:(id)object error:(NSError **)errorPtr {
+  return EncodeStructData(object, NO, errorPtr);
+}
+
+@end
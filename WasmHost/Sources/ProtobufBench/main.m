@@ -0,0 +1,326 @@
+//
+//  main.m
+//  WasmHost
+//
+//  Created by L7Studio on 19/10/26.
+//
+//  Benchmarks the protobuf runtime over the engine's schemas.
+//
+//      swift run -c release ProtobufBench [--filter name] [--time seconds] [--payloads dir]
+//
+//  Every benchmark reports the time per operation, the payload throughput and
+//  the heap blocks/bytes still allocated when the operation returns (the parsed
+//  tree, the serialized data...), which is what the arena and lazy parsing
+//  options change. Files in --payloads named `<MessageClass>[.<anything>].bin`,
+//  e.g. `WAMusicListTracks.search.bin`, are benchmarked as captured payloads.
+//
+
+#import <Foundation/Foundation.h>
+#import <time.h>
+#if __APPLE__
+#import <malloc/malloc.h>
+#endif
+@import Protobuf;
+@import WasmObjCProtobuf;
+
+typedef struct {
+    size_t blocks;
+    size_t bytes;
+} HeapUsage;
+
+static HeapUsage CurrentHeapUsage(void) {
+    HeapUsage usage = {0, 0};
+#if __APPLE__
+    malloc_statistics_t stats;
+    malloc_zone_statistics(NULL, &stats);
+    usage.blocks = stats.blocks_in_use;
+    usage.bytes = stats.size_in_use;
+#endif
+    return usage;
+}
+
+static uint64_t NowNanoseconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+@interface Bench : NSObject
+@property (nonatomic, copy) NSString *filter;
+@property (nonatomic) double minTime;
+@end
+
+@implementation Bench
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        _minTime = 0.5;
+    }
+    return self;
+}
+
+/// Runs `op` for at least `minTime` seconds, `size` is the payload size used for the throughput
+- (void)run:(NSString *)name size:(NSUInteger)size op:(id (^)(void))op {
+    if (self.filter.length && [name rangeOfString:self.filter].location == NSNotFound) {
+        return;
+    }
+    // Warm up caches (descriptors, classes) before measuring anything.
+    for (int i = 0; i < 3; i++) {
+        @autoreleasepool {
+            (void)op();
+        }
+    }
+    HeapUsage retained;
+    @autoreleasepool {
+        HeapUsage before = CurrentHeapUsage();
+        id result = op();
+        HeapUsage after = CurrentHeapUsage();
+        retained.blocks = after.blocks > before.blocks ? after.blocks - before.blocks : 0;
+        retained.bytes = after.bytes > before.bytes ? after.bytes - before.bytes : 0;
+        (void)result;
+    }
+
+    uint64_t iterations = 1;
+    uint64_t elapsed = 0;
+    while (YES) {
+        uint64_t start = NowNanoseconds();
+        for (uint64_t i = 0; i < iterations; i++) {
+            @autoreleasepool {
+                (void)op();
+            }
+        }
+        elapsed = NowNanoseconds() - start;
+        if (elapsed >= self.minTime * NSEC_PER_SEC || iterations >= (1ull << 30)) {
+            break;
+        }
+        iterations *= 2;
+    }
+    double nsPerOp = (double)elapsed / iterations;
+    double mbPerSecond = size ? size / nsPerOp * 1e9 / (1024 * 1024) : 0;
+    printf("%-52s %12.0f %10.1f %12zu %12zu\n", name.UTF8String, nsPerOp, mbPerSecond,
+           retained.blocks, retained.bytes);
+}
+
+/// The runtime operations measured for every payload
+- (void)runMessage:(GPBMessage *)message named:(NSString *)name {
+    Class clazz = message.class;
+    NSData *data = [message data];
+    GPBMessage *copy = [message copy];
+    NSUInteger size = data.length;
+    NSString *prefix = [NSString stringWithFormat:@"%@ (%lu B)", name, (unsigned long)size];
+
+    [self run:[prefix stringByAppendingString:@" parse"] size:size op:^id{
+        return [clazz parseFromData:data error:NULL];
+    }];
+    GPBCodedInputStreamOptions options[] = {
+        GPBCodedInputStreamOptionLazyStrings,
+        GPBCodedInputStreamOptionArena,
+        GPBCodedInputStreamOptionLazyStrings | GPBCodedInputStreamOptionArena,
+    };
+    NSArray<NSString *> *optionNames = @[ @"lazy strings", @"arena", @"lazy strings+arena" ];
+    for (NSUInteger i = 0; i < optionNames.count; i++) {
+        GPBCodedInputStreamOptions option = options[i];
+        NSString *benchName = [NSString stringWithFormat:@"%@ parse %@", prefix, optionNames[i]];
+        [self run:benchName size:size op:^id{
+            GPBCodedInputStream *input = [GPBCodedInputStream streamWithData:data options:option];
+            return [clazz parseFromCodedInputStream:input extensionRegistry:nil error:NULL];
+        }];
+    }
+    // Partial parse keeping only the first field, the rest is skipped on the wire.
+    NSString *firstField = [clazz descriptor].fields.firstObject.textFormatName;
+    GPBCompiledFieldMask *mask = [GPBCompiledFieldMask fieldMaskWithPaths:@[ firstField ?: @"" ]
+                                                               descriptor:[clazz descriptor]
+                                                                    error:NULL];
+    if (mask) {
+        NSString *benchName = [NSString stringWithFormat:@"%@ parse field mask %@", prefix, firstField];
+        [self run:benchName size:size op:^id{
+            return [clazz parseFromData:data fieldMask:mask error:NULL];
+        }];
+    }
+    [self run:[prefix stringByAppendingString:@" serialize"] size:size op:^id{
+        return [message data];
+    }];
+    [self run:[prefix stringByAppendingString:@" serializedSize"] size:size op:^id{
+        return @([message serializedSize]);
+    }];
+    [self run:[prefix stringByAppendingString:@" copy"] size:size op:^id{
+        return [message copy];
+    }];
+    [self run:[prefix stringByAppendingString:@" isEqual"] size:size op:^id{
+        return @([message isEqual:copy]);
+    }];
+    [self run:[prefix stringByAppendingString:@" Any pack+unpack"] size:size op:^id{
+        GPBAny *any = [GPBAny anyWithMessage:message error:NULL];
+        return [any unpackMessageClass:clazz error:NULL];
+    }];
+
+    // The JSON call path, with Foundation decoding the same JSON as the baseline.
+    GPBDescriptor *descriptor = [clazz descriptor];
+    NSData *JSONData = [GPBJSONTranscoder JSONDataWithMessageData:data
+                                                       descriptor:descriptor
+                                                          options:GPBJSONTranscoderOptionNone
+                                                            error:NULL];
+    if (!JSONData) {
+        return;
+    }
+    NSUInteger JSONSize = JSONData.length;
+    [self run:[prefix stringByAppendingString:@" binary to JSON"] size:size op:^id{
+        return [GPBJSONTranscoder JSONDataWithMessageData:data
+                                               descriptor:descriptor
+                                                  options:GPBJSONTranscoderOptionNone
+                                                    error:NULL];
+    }];
+    [self run:[prefix stringByAppendingString:@" JSON to binary"] size:JSONSize op:^id{
+        return [GPBJSONTranscoder messageDataWithJSONData:JSONData
+                                               descriptor:descriptor
+                                                  options:GPBJSONTranscoderOptionNone
+                                                    error:NULL];
+    }];
+    [self run:[prefix stringByAppendingString:@" NSJSONSerialization"] size:JSONSize op:^id{
+        return [NSJSONSerialization JSONObjectWithData:JSONData options:0 error:NULL];
+    }];
+}
+
+@end
+
+#pragma mark - Generated payloads
+
+static WAMusicAuthor *MakeAuthor(int i) {
+    WAMusicAuthor *author = [WAMusicAuthor message];
+    author.id_p = [NSString stringWithFormat:@"UC-author-channel-%06d", i];
+    author.name = [NSString stringWithFormat:@"Author name number %d", i];
+    author.thumbnail = [NSString stringWithFormat:@"https://yt3.ggpht.com/ytc/author-%d=s88-c-k-c0x00ffffff-no-rj", i];
+    return author;
+}
+
+/// A page of search results, `width` tracks wide
+static WAMusicListTracks *MakeListTracks(int width) {
+    WAMusicListTracks *list = [WAMusicListTracks message];
+    for (int i = 0; i < width; i++) {
+        WAMusicTrack *track = [WAMusicTrack message];
+        track.id_p = [NSString stringWithFormat:@"track-%05d", i];
+        track.title = [NSString stringWithFormat:@"Track title with some words – %d ♪", i];
+        track.kind = @"video";
+        track.author = MakeAuthor(i);
+        track.thumbnail = [NSString stringWithFormat:@"https://i.ytimg.com/vi/track-%05d/hqdefault.jpg", i];
+        [list.itemsArray addObject:track];
+    }
+    list.continuation = [@"" stringByPaddingToLength:256 withString:@"4qmFsgKDARIMVkx" startingAtIndex:0];
+    return list;
+}
+
+/// A details answer with `formats` formats, each carrying a metadata struct
+static WAMusicTrackDetails *MakeTrackDetails(int formats) {
+    WAMusicTrackDetails *details = [WAMusicTrackDetails message];
+    details.id_p = @"kPa7bsKwL-c";
+    details.title = @"Track title";
+    details.description_p = [@"" stringByPaddingToLength:512 withString:@"lorem ipsum " startingAtIndex:0];
+    details.author = MakeAuthor(0);
+    details.duration = 245.5;
+    details.views = 123456789;
+    details.dashManifestURL = @"https://manifest.googlevideo.com/api/manifest/dash";
+    details.hlsManifestURL = @"https://manifest.googlevideo.com/api/manifest/hls";
+    for (int i = 0; i < formats; i++) {
+        WAMusicTrackDetails_Format *format = [WAMusicTrackDetails_Format message];
+        format.id_p = [NSString stringWithFormat:@"%d", 100 + i];
+        format.URL = [NSString stringWithFormat:@"https://rr1.googlevideo.com/videoplayback?itag=%d", 100 + i];
+        format.quality = @"AUDIO_QUALITY_MEDIUM";
+        format.mimeType = @"audio/webm; codecs=\"opus\"";
+        format.exp = 1760000000 + i;
+        GPBValue *bitrate = [GPBValue message];
+        bitrate.numberValue = 128000 + i;
+        format.metadata.fields[@"bitrate"] = bitrate;
+        [details.formatsArray addObject:format];
+    }
+    return details;
+}
+
+/// A struct `depth` levels deep with `width` fields per level
+static GPBStruct *MakeStruct(int width, int depth) {
+    GPBStruct *root = [GPBStruct message];
+    for (int i = 0; i < width; i++) {
+        GPBValue *value = [GPBValue message];
+        if (i == 0 && depth > 1) {
+            value.structValue = MakeStruct(width, depth - 1);
+        } else if (i % 3 == 0) {
+            value.numberValue = i * 1.5;
+        } else if (i % 3 == 1) {
+            value.boolValue = YES;
+        } else {
+            value.stringValue = [NSString stringWithFormat:@"value %d", i];
+        }
+        root.fields[[NSString stringWithFormat:@"field_%d", i]] = value;
+    }
+    return root;
+}
+
+static void RunGenerated(Bench *bench) {
+    for (int width = 10; width <= 1000; width *= 10) {
+        [bench runMessage:MakeListTracks(width) named:[NSString stringWithFormat:@"ListTracks x%d", width]];
+    }
+    for (int formats = 4; formats <= 64; formats *= 4) {
+        [bench runMessage:MakeTrackDetails(formats) named:[NSString stringWithFormat:@"TrackDetails x%d", formats]];
+    }
+    int shapes[][2] = {{10, 1}, {100, 1}, {4, 8}, {4, 32}};
+    for (size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
+        GPBStruct *value = MakeStruct(shapes[i][0], shapes[i][1]);
+        [bench runMessage:value named:[NSString stringWithFormat:@"Struct %dw %dd", shapes[i][0], shapes[i][1]]];
+    }
+    WAEngineVersion *version = [WAEngineVersion message];
+    version.id_p = @"music_tube";
+    version.name = @"3ba54735ff20";
+    version.sha = @"3ba54735ff20c928fbf0fdb3a71076410b3a0499ef5e6c89f1dd3ddf6450c15b";
+    version.URL = @"https://scwasm.sfo3.cdn.digitaloceanspaces.com/music_tube.wasm";
+    [bench runMessage:version named:@"EngineVersion"];
+}
+
+#pragma mark - Captured payloads
+
+static void RunCaptured(Bench *bench, NSString *directory) {
+    NSArray<NSString *> *files = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:directory error:NULL];
+    for (NSString *file in [files sortedArrayUsingSelector:@selector(compare:)]) {
+        if (![file.pathExtension isEqual:@"bin"]) {
+            continue;
+        }
+        NSString *className = [file componentsSeparatedByString:@"."].firstObject;
+        Class clazz = NSClassFromString(className);
+        if (![clazz isSubclassOfClass:GPBMessage.class]) {
+            fprintf(stderr, "skipping %s: no message class %s\n", file.UTF8String, className.UTF8String);
+            continue;
+        }
+        NSData *data = [NSData dataWithContentsOfFile:[directory stringByAppendingPathComponent:file]];
+        NSError *error = nil;
+        GPBMessage *message = [clazz parseFromData:data error:&error];
+        if (!message) {
+            fprintf(stderr, "skipping %s: %s\n", file.UTF8String, error.localizedDescription.UTF8String);
+            continue;
+        }
+        [bench runMessage:message named:file.stringByDeletingPathExtension];
+    }
+}
+
+int main(int argc, const char *argv[]) {
+    @autoreleasepool {
+        Bench *bench = [[Bench alloc] init];
+        NSString *payloads = nil;
+        NSArray<NSString *> *args = [NSProcessInfo processInfo].arguments;
+        for (NSUInteger i = 1; i + 1 < args.count; i += 2) {
+            if ([args[i] isEqual:@"--filter"]) {
+                bench.filter = args[i + 1];
+            } else if ([args[i] isEqual:@"--time"]) {
+                bench.minTime = args[i + 1].doubleValue;
+            } else if ([args[i] isEqual:@"--payloads"]) {
+                payloads = args[i + 1];
+            } else {
+                fprintf(stderr, "usage: %s [--filter name] [--time seconds] [--payloads dir]\n", argv[0]);
+                return 1;
+            }
+        }
+        printf("%-52s %12s %10s %12s %12s\n", "benchmark", "ns/op", "MB/s", "allocs/op", "bytes/op");
+        RunGenerated(bench);
+        if (payloads) {
+            RunCaptured(bench, payloads);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+//
+//  ActionCatalog.swift
+//  WasmHost
+//
+//  Created by L7Studio on 19/10/26.
+//
+import AsyncWasm
+import Foundation
+import WasmSwiftProtobuf
+
+/// In-memory index of the guest's actions by id.
+///
+/// Lookups are served from memory. Once the index is older than `ttl`, or the module was reloaded, it is
+/// still returned while a single background call refreshes it, so only the very first lookup waits for
+/// the guest.
+final class TaskActionCatalog: @unchecked Sendable {
+	typealias Fetch = @Sendable () async throws -> WaTListActions
+	/// Monotonic time in seconds
+	typealias Clock = @Sendable () -> TimeInterval
+
+	struct Index {
+		let list: WaTListActions
+		let actions: [String: [WaTAction]]
+
+		init(_ list: WaTListActions) {
+			self.list = list
+			self.actions = Dictionary(grouping: list.actions, by: { $0.id })
+		}
+	}
+
+	let ttl: TimeInterval
+	/// Delay before a failed background refresh is tried again
+	let retryInterval: TimeInterval
+	private let now: Clock
+	private let lock = NSLock()
+	private var index: Index?
+	private var expiresAt: TimeInterval = 0
+	// bumped on reload, refreshes started against the previous module are dropped
+	private var generation = 0
+	private var refreshing: Task<Index, Error>?
+
+	init(ttl: TimeInterval = 5 * 60, retryInterval: TimeInterval = 10,
+		 now: @escaping Clock = { ProcessInfo.processInfo.systemUptime }) {
+		self.ttl = ttl
+		self.retryInterval = retryInterval
+		self.now = now
+	}
+
+	var isLoaded: Bool {
+		locked { index != nil }
+	}
+
+	/// Refresh running for the current module, if any
+	var pendingRefresh: Task<Index, Error>? {
+		locked { refreshing }
+	}
+
+	func index(fetch: @escaping Fetch) async throws -> Index {
+		let now = self.now()
+		let (index, task): (Index?, Task<Index, Error>?) = locked {
+			if let index {
+				if now >= expiresAt, refreshing == nil {
+					refreshing = start(fetch)
+				}
+				return (index, nil)
+			}
+			if refreshing == nil {
+				refreshing = start(fetch)
+			}
+			return (nil, refreshing)
+		}
+		if let index {
+			return index
+		}
+		return try await task!.value
+	}
+
+	/// Starts a background refresh unless the index is fresh or one is running already.
+	func refresh(fetch: @escaping Fetch) {
+		let now = self.now()
+		locked {
+			if refreshing == nil, index == nil || now >= expiresAt {
+				refreshing = start(fetch)
+			}
+		}
+	}
+
+	/// Expires the index, it keeps being returned until the next refresh lands.
+	func invalidate() {
+		locked {
+			expiresAt = 0
+			generation += 1
+			refreshing = nil
+		}
+	}
+
+	/// Sets an already expired index, e.g. read back from disk, when there is none yet.
+	func seed(_ list: WaTListActions) {
+		locked {
+			if index == nil {
+				index = Index(list)
+				expiresAt = 0
+			}
+		}
+	}
+
+	// must be called with the lock held
+	private func start(_ fetch: @escaping Fetch) -> Task<Index, Error> {
+		let generation = self.generation
+		return Task {
+			do {
+				let index = Index(try await fetch())
+				locked {
+					if generation == self.generation {
+						self.index = index
+						self.expiresAt = self.now() + ttl
+						self.refreshing = nil
+					}
+				}
+				return index
+			} catch {
+				locked {
+					if generation == self.generation {
+						self.expiresAt = self.now() + retryInterval
+						self.refreshing = nil
+					}
+				}
+				WALogger.host.debug("[actions] refresh failed: \(error)")
+				throw error
+			}
+		}
+	}
+
+	private func locked<T>(_ body: () throws -> T) rethrows -> T {
+		lock.lock()
+		defer { lock.unlock() }
+		return try body()
+	}
+}
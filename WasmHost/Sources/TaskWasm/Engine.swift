@@ -32,10 +32,19 @@ public protocol TaskWasmProtocol: AsyncWasmProtocol {
 	/// - Returns: <#description#>
 	func create(action: WaTAction, args: [String: Google_Protobuf_Value]) async throws -> WaTTask
 	func status(task: WaTTask) async throws -> WaTTask
+	/// Updates of a task, starting with its latest known state
+	/// - Parameters:
+	///   - task: task to follow
+	///   - interval: shortest delay between two updates
+	/// - Returns: stream of changed tasks, finished once the task is completed or failed
+	func updates(task: WaTTask, interval: TimeInterval) -> AsyncStream<WaTTask>
 	func actions() async throws -> WaTListActions
 	func actions(for id: String) async throws -> [WaTAction]
 }
 extension TaskWasmProtocol {
+	public func updates(task: WaTTask) -> AsyncStream<WaTTask> {
+		updates(task: task, interval: 0.5)
+	}
 	public func actions<ID>(for id: ID) async throws -> [WaTAction] where ID: RawRepresentable, ID.RawValue == String {
 		try await actions(for: id.rawValue)
 	}
@@ -107,28 +116,65 @@ open class TaskWasmEngine: AsyncWasmEngine, TaskWasmProtocol {
 		return try await cast(grpc_call(AsyncifyCommand(call: caller)))
 	}
 	public func status(task: WaTTask) async throws -> WaTTask {
+		try await cast(statusData(task: task))
+	}
+	func statusData(task: WaTTask) async throws -> Data {
 		var args = task.metadata.fields
 		args["task_id"] = Google_Protobuf_Value(stringValue: task.id)
 		args["provider_id"] = Google_Protobuf_Value(stringValue: task.provider)
 		let caller = try AsyncifyCommand.Call(id: WaTCallID.getStatus, args: args)
-		return try await cast(grpc_call(AsyncifyCommand(call: caller)))
+		return try await grpc_call(AsyncifyCommand(call: caller))
+	}
+	public func updates(task: WaTTask, interval: TimeInterval) -> AsyncStream<WaTTask> {
+		taskUpdates.stream(task: task, interval: interval, poll: { [weak self] task in
+			guard let self else { throw CancellationError() }
+			return try await self.statusData(task: task)
+		}, decode: { [weak self] data in
+			guard let self else { throw CancellationError() }
+			return try await self.cast(data)
+		})
 	}
+	let taskUpdates = TaskUpdates()
+	let catalog = TaskActionCatalog()
+	
 	public func actions() async throws -> WaTListActions {
+		try await catalog.index(fetch: actionsFetcher()).list
+	}
+	public func actions(for id: String) async throws -> [WaTAction] {
+		try await catalog.index(fetch: actionsFetcher()).actions[id] ?? []
+	}
+	/// Drops the actions of the previous module on reload and loads the new ones once it runs.
+	open override func didChange(state: EngineState) {
+		super.didChange(state: state)
+		switch state {
+		case .reload:
+			catalog.invalidate()
+		case .running:
+			catalog.refresh(fetch: actionsFetcher())
+		default:
+			break
+		}
+	}
+	func actionsFetcher() -> TaskActionCatalog.Fetch {
 #if CACHE_WASM_LIST_ACTIONS
-		try await storage.async.removeExpiredObjects()
-		guard (try? await storage.async.objectExists(forKey: Self.cacheActionsKey)) ?? false else {
-			let data = try await self.fetch_actions()
-			try await storage.async.setObject(data, forKey: Self.cacheActionsKey)
-			return try await cast(data)
+		// the disk copy only spares the first guest call after launch, it is refreshed right away
+		if !catalog.isLoaded, let data = try? storage.object(forKey: Self.cacheActionsKey),
+		   let list = try? WaTListActions(serializedBytes: data) {
+			catalog.seed(list)
 		}
-		let data = try await storage.async.object(forKey: Self.cacheActionsKey)
-		return try await cast(data)
-#else
-		return try await cast(await self.fetch_actions())
 #endif
+		return { [weak self] in
+			guard let self else { throw CancellationError() }
+			return try await self.loadActions()
+		}
 	}
-	public func actions(for id: String) async throws -> [WaTAction] {
-		try await actions().actions.filter({ $0.id == id })
+	func loadActions() async throws -> WaTListActions {
+		let data = try await self.fetch_actions()
+		let list: WaTListActions = try await cast(data)
+#if CACHE_WASM_LIST_ACTIONS
+		try? await storage.async.setObject(data, forKey: Self.cacheActionsKey)
+#endif
+		return list
 	}
 	
 	@objc(listActionsWithCompletionHandler:)
@@ -0,0 +1,159 @@
+//
+//  TaskUpdates.swift
+//  WasmHost
+//
+//  Created by L7Studio on 19/10/26.
+//
+import AsyncWasm
+import Foundation
+import WasmSwiftProtobuf
+
+extension WaTTask {
+	/// Whether the task reached a final status
+	public var isFinished: Bool {
+		status == .completed || status == .error
+	}
+}
+
+/// Streams of task updates.
+///
+/// The guest has no channel to push task changes, so updates come from polling its status call.
+/// All the subscribers of a task share one poll, run at the shortest interval they asked for.
+/// A response identical to the previous one is not decoded, and a task is only delivered when its
+/// status or progress changed; a slow subscriber only sees the most recent one. The poll stops once
+/// the task is finished or its last subscriber is gone.
+final class TaskUpdates: @unchecked Sendable {
+	/// Serialized status response of the guest for a task
+	typealias Poll = @Sendable (WaTTask) async throws -> Data
+	typealias Decode = @Sendable (Data) async throws -> WaTTask
+
+	private final class Subscription {
+		var continuations: [UUID: AsyncStream<WaTTask>.Continuation] = [:]
+		var interval: TimeInterval
+		var latest: WaTTask
+		var poller: Task<Void, Never>?
+
+		init(task: WaTTask, interval: TimeInterval) {
+			self.latest = task
+			self.interval = interval
+		}
+	}
+
+	/// Consecutive failed polls after which the streams finish
+	let maxFailures: Int
+	private let lock = NSLock()
+	private var subscriptions: [String: Subscription] = [:]
+
+	init(maxFailures: Int = 3) {
+		self.maxFailures = maxFailures
+	}
+
+	func stream(task: WaTTask, interval: TimeInterval, poll: @escaping Poll,
+				decode: @escaping Decode = { try WaTTask(serializedBytes: $0) }) -> AsyncStream<WaTTask> {
+		AsyncStream(bufferingPolicy: .bufferingNewest(1)) { continuation in
+			guard !task.isFinished else {
+				continuation.yield(task)
+				continuation.finish()
+				return
+			}
+			let key = Self.key(task)
+			let id = UUID()
+			continuation.onTermination = { [weak self] _ in
+				self?.remove(id, from: key)
+			}
+			let latest: WaTTask = locked {
+				let sub = subscriptions[key] ?? Subscription(task: task, interval: interval)
+				subscriptions[key] = sub
+				sub.continuations[id] = continuation
+				sub.interval = min(sub.interval, interval)
+				if sub.poller == nil {
+					sub.poller = start(key, sub, poll: poll, decode: decode)
+				}
+				return sub.latest
+			}
+			continuation.yield(latest)
+		}
+	}
+
+	private func start(_ key: String, _ sub: Subscription, poll: @escaping Poll,
+					   decode: @escaping Decode) -> Task<Void, Never> {
+		Task {
+			var task = locked { sub.latest }
+			var response: Data?
+			var failures = 0
+			while !Task.isCancelled {
+				let interval = locked { sub.interval }
+				try? await Task.sleep(nanoseconds: UInt64(max(interval, 0) * 1_000_000_000))
+				guard !Task.isCancelled else {
+					return
+				}
+				var changed = false
+				do {
+					let data = try await poll(task)
+					guard !Task.isCancelled else {
+						return
+					}
+					failures = 0
+					if data != response {
+						let next = try await decode(data)
+						response = data
+						changed = next.status != task.status || next.progress != task.progress
+						// the next poll is made with the newest metadata even when nothing is delivered
+						task = next
+					}
+				} catch {
+					failures += 1
+					WALogger.host.debug("[\(key)] status failed (\(failures)): \(error)")
+				}
+				let finished = task.isFinished || failures >= maxFailures
+				guard changed || finished else {
+					continue
+				}
+				let continuations: [AsyncStream<WaTTask>.Continuation] = locked {
+					sub.latest = task
+					if finished, subscriptions[key] === sub {
+						subscriptions[key] = nil
+					}
+					return Array(sub.continuations.values)
+				}
+				for continuation in continuations {
+					if changed {
+						continuation.yield(task)
+					}
+					if finished {
+						continuation.finish()
+					}
+				}
+				if finished {
+					return
+				}
+			}
+		}
+	}
+
+	private func remove(_ id: UUID, from key: String) {
+		locked {
+			guard let sub = subscriptions[key], sub.continuations.removeValue(forKey: id) != nil,
+				  sub.continuations.isEmpty else {
+				return
+			}
+			sub.poller?.cancel()
+			subscriptions[key] = nil
+		}
+	}
+
+	/// Whether a poll is running for `task`
+	func isPolling(_ task: WaTTask) -> Bool {
+		locked { subscriptions[Self.key(task)] != nil }
+	}
+
+	private func locked<T>(_ body: () throws -> T) rethrows -> T {
+		lock.lock()
+		defer { lock.unlock() }
+		return try body()
+	}
+
+	private static func key(_ task: WaTTask) -> String {
+		"\(task.provider)/\(task.id)"
+	}
+}
@@ -0,0 +1,125 @@
+//
+//  WasmObjCProtobuf+Prewarm.m
+//  WasmHost
+//
+//  Created by L7Studio on 19/10/26.
+//
+// +prewarmedMessageClasses of the generated Root classes. protoc doesn't emit
+// it, so the message lists live here and must follow the .proto files: add a
+// message here when one is added to music.proto, engine.proto or types.proto.
+// testPrewarmedMessageClassesMatchFiles fails when they drift apart.
+
+#import "GPBProtocolBuffers_RuntimeSupport.h"
+
+#import "Engine.pbobjc.h"
+#import "Music.pbobjc.h"
+#import "Types.pbobjc.h"
+
+GPBObjCClassDeclaration(WAEngineVersion);
+
+GPBObjCClassDeclaration(WAMusicAuthor);
+GPBObjCClassDeclaration(WAMusicEntry);
+GPBObjCClassDeclaration(WAMusicListOptions);
+GPBObjCClassDeclaration(WAMusicListOptions_Discover);
+GPBObjCClassDeclaration(WAMusicListOptions_Search);
+GPBObjCClassDeclaration(WAMusicListSuggestions);
+GPBObjCClassDeclaration(WAMusicListTracks);
+GPBObjCClassDeclaration(WAMusicOptions);
+GPBObjCClassDeclaration(WAMusicTrack);
+GPBObjCClassDeclaration(WAMusicTrackDetails);
+GPBObjCClassDeclaration(WAMusicTrackDetails_Format);
+GPBObjCClassDeclaration(WAMusicTranscript);
+GPBObjCClassDeclaration(WAMusicTranscript_Segment);
+
+GPBObjCClassDeclaration(WATypesArgument);
+GPBObjCClassDeclaration(WATypesBytes);
+GPBObjCClassDeclaration(WATypesEntry);
+GPBObjCClassDeclaration(WATypesError);
+GPBObjCClassDeclaration(WATypesField);
+GPBObjCClassDeclaration(WATypesFormat);
+GPBObjCClassDeclaration(WATypesFormat_Audio);
+GPBObjCClassDeclaration(WATypesFormat_Image);
+GPBObjCClassDeclaration(WATypesFormat_Video);
+GPBObjCClassDeclaration(WATypesImage);
+GPBObjCClassDeclaration(WATypesListStrings);
+GPBObjCClassDeclaration(WATypesPoint);
+GPBObjCClassDeclaration(WATypesPointer);
+GPBObjCClassDeclaration(WATypesRect);
+GPBObjCClassDeclaration(WATypesSize);
+GPBObjCClassDeclaration(WATypesString);
+GPBObjCClassDeclaration(WATypesValidator);
+GPBObjCClassDeclaration(WATypesValidator_Double);
+GPBObjCClassDeclaration(WATypesValidator_Int);
+GPBObjCClassDeclaration(WATypesValidator_Media);
+GPBObjCClassDeclaration(WATypesValidator_String);
+GPBObjCClassDeclaration(WATypesVoid);
+GPBObjCClassDeclaration(WATypesWAFuture);
+GPBObjCClassDeclaration(WATypesWAString);
+
+@implementation WAEngineEngineRoot (Prewarm)
+
++ (NSArray<Class> *)prewarmedMessageClasses {
+  static Class const classes[] = {
+    GPBObjCClass(WAEngineVersion),
+  };
+  return [NSArray arrayWithObjects:(const id *)classes count:sizeof(classes) / sizeof(Class)];
+}
+
+@end
+
+@implementation WAMusicMusicRoot (Prewarm)
+
++ (NSArray<Class> *)prewarmedMessageClasses {
+  static Class const classes[] = {
+    GPBObjCClass(WAMusicOptions),
+    GPBObjCClass(WAMusicListOptions),
+    GPBObjCClass(WAMusicListOptions_Discover),
+    GPBObjCClass(WAMusicListOptions_Search),
+    GPBObjCClass(WAMusicEntry),
+    GPBObjCClass(WAMusicTrackDetails),
+    GPBObjCClass(WAMusicTrackDetails_Format),
+    GPBObjCClass(WAMusicTranscript),
+    GPBObjCClass(WAMusicTranscript_Segment),
+    GPBObjCClass(WAMusicAuthor),
+    GPBObjCClass(WAMusicTrack),
+    GPBObjCClass(WAMusicListTracks),
+    GPBObjCClass(WAMusicListSuggestions),
+  };
+  return [NSArray arrayWithObjects:(const id *)classes count:sizeof(classes) / sizeof(Class)];
+}
+
+@end
+
+@implementation WATypesTypesRoot (Prewarm)
+
++ (NSArray<Class> *)prewarmedMessageClasses {
+  static Class const classes[] = {
+    GPBObjCClass(WATypesImage),
+    GPBObjCClass(WATypesBytes),
+    GPBObjCClass(WATypesPointer),
+    GPBObjCClass(WATypesString),
+    GPBObjCClass(WATypesVoid),
+    GPBObjCClass(WATypesError),
+    GPBObjCClass(WATypesWAFuture),
+    GPBObjCClass(WATypesWAString),
+    GPBObjCClass(WATypesField),
+    GPBObjCClass(WATypesEntry),
+    GPBObjCClass(WATypesRect),
+    GPBObjCClass(WATypesPoint),
+    GPBObjCClass(WATypesSize),
+    GPBObjCClass(WATypesArgument),
+    GPBObjCClass(WATypesValidator),
+    GPBObjCClass(WATypesValidator_Int),
+    GPBObjCClass(WATypesValidator_Double),
+    GPBObjCClass(WATypesValidator_String),
+    GPBObjCClass(WATypesValidator_Media),
+    GPBObjCClass(WATypesFormat),
+    GPBObjCClass(WATypesFormat_Audio),
+    GPBObjCClass(WATypesFormat_Video),
+    GPBObjCClass(WATypesFormat_Image),
+    GPBObjCClass(WATypesListStrings),
+  };
+  return [NSArray arrayWithObjects:(const id *)classes count:sizeof(classes) / sizeof(Class)];
+}
+
+@end
@@ -0,0 +1,268 @@
+//
+//  AsyncWasmKitTests.swift
+//  WasmHost
+//
+//  Created by L7Studio on 19/10/26.
+//
+#if canImport(AsyncWasmKit)
+import Foundation
+import XCTest
+@testable import AsyncWasmKit
+import SwiftProtobuf
+import WasmSwiftProtobuf
+
+final class AsyncWasmKitTests: XCTestCase {
+    final class CallCounter: @unchecked Sendable {
+        private let lock = NSLock()
+        private var value = 0
+        var count: Int { lock.lock(); defer { lock.unlock() }; return value }
+        func increment() -> Int { lock.lock(); defer { lock.unlock() }; value += 1; return value }
+    }
+    
+    var directory: URL!
+    
+    override func setUpWithError() throws {
+        try super.setUpWithError()
+        directory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+    }
+    
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: directory)
+        try super.tearDownWithError()
+    }
+    
+    func testTaskRegistryReplacesAbandonedTask() async throws {
+        let registry = WasmTaskRegistry(capacity: 4)
+        let abandoned = Task<Data, Error> {
+            try await Task.sleep(nanoseconds: 60_000_000_000)
+            return Data("old".utf8)
+        }
+        registry.insert(abandoned, for: 0x100)
+        // the call owning 0x100 never took its task, the guest frees and reuses the address
+        registry.insert(Task { Data("new".utf8) }, for: 0x100)
+        let task = try XCTUnwrap(registry.take(0x100))
+        let value = try await task.value
+        XCTAssertEqual(value, Data("new".utf8))
+        XCTAssertTrue(abandoned.isCancelled)
+        XCTAssertNil(registry.take(0x100))
+    }
+    
+    func testTaskRegistryReplacesOverflowedTask() async throws {
+        let registry = WasmTaskRegistry(capacity: 1)
+        registry.insert(Task { Data("a".utf8) }, for: 0x10)
+        let abandoned = Task<Data, Error> {
+            try await Task.sleep(nanoseconds: 60_000_000_000)
+            return Data("old".utf8)
+        }
+        registry.insert(abandoned, for: 0x20)
+        registry.insert(Task { Data("new".utf8) }, for: 0x20)
+        XCTAssertTrue(abandoned.isCancelled)
+        let value = try await XCTUnwrap(registry.take(0x20)).value
+        XCTAssertEqual(value, Data("new".utf8))
+        let first = try await XCTUnwrap(registry.take(0x10)).value
+        XCTAssertEqual(first, Data("a".utf8))
+    }
+    
+    func testTracerRecordsConcurrently() {
+        let tracer = WasmTracer(capacity: 1 << 14)
+        let request = UUID()
+        DispatchQueue.concurrentPerform(iterations: 8) { thread in
+            for i in 0..<1000 {
+                tracer.record(name: "span", category: "test", start: UInt64(i), duration: UInt64(i) * 2,
+                              thread: UInt64(thread), request: thread % 2 == 0 ? request : nil)
+            }
+        }
+        let events = tracer.snapshot()
+        XCTAssertEqual(events.count, 8000)
+        XCTAssertEqual(tracer.droppedCount, 0)
+        for event in events {
+            // every field of an event comes from the same record
+            XCTAssertEqual(event.name, "span")
+            XCTAssertEqual(event.category, "test")
+            XCTAssertEqual(event.duration, event.start * 2)
+            XCTAssertEqual(event.request, event.thread % 2 == 0 ? request : nil)
+        }
+        for thread in 0..<8 {
+            let starts = events.filter { $0.thread == UInt64(thread) }.map(\.start)
+            XCTAssertEqual(starts, (0..<1000).map(UInt64.init))
+        }
+    }
+    
+    func testTracerWrapsAround() {
+        let tracer = WasmTracer(capacity: 8)
+        for i in 0..<20 {
+            tracer.record(name: "span", category: "test", start: UInt64(i), duration: 0, thread: 0, request: nil)
+        }
+        // only the last lap is left, oldest first
+        XCTAssertEqual(tracer.snapshot().map(\.start), (12..<20).map(UInt64.init))
+        tracer.reset()
+        XCTAssertTrue(tracer.snapshot().isEmpty)
+        tracer.record(name: "x", category: "test", start: 20, duration: 0, thread: 0, request: nil)
+        XCTAssertEqual(tracer.snapshot().map(\.name), ["x"])
+    }
+    
+    /// Index whose probe counts its calls and reports the probe number as `probe`
+    func metadataIndex(_ counter: CallCounter) -> MediaMetadataIndex {
+        MediaMetadataIndex(store: directory.appendingPathComponent("metadata.plist")) { _ in
+            var metadata = Google_Protobuf_Struct()
+            metadata.fields["probe"] = Google_Protobuf_Value(numberValue: Double(counter.increment()))
+            return metadata
+        }
+    }
+    
+    func testMetadataIndexCachesProbes() async throws {
+        let counter = CallCounter()
+        let index = metadataIndex(counter)
+        let file = directory.appendingPathComponent("a.txt")
+        try Data("a".utf8).write(to: file)
+        let first = try await index.metadata(for: file)
+        let second = try await index.metadata(for: file)
+        XCTAssertEqual(first, second)
+        XCTAssertEqual(counter.count, 1)
+    }
+    
+    func testMetadataIndexReprobesChangedFiles() async throws {
+        let counter = CallCounter()
+        let index = metadataIndex(counter)
+        let file = directory.appendingPathComponent("a.txt")
+        try Data("a".utf8).write(to: file)
+        _ = try await index.metadata(for: file)
+        try Data("changed".utf8).write(to: file)
+        try FileManager.default.setAttributes([.modificationDate: Date().addingTimeInterval(10)], ofItemAtPath: file.path)
+        let changed = try await index.metadata(for: file)
+        XCTAssertEqual(changed.fields["probe"]?.numberValue, 2)
+        XCTAssertEqual(counter.count, 2)
+    }
+    
+    func testMetadataIndexSharesConcurrentProbes() async throws {
+        let counter = CallCounter()
+        let index = metadataIndex(counter)
+        let file = directory.appendingPathComponent("a.txt")
+        try Data("a".utf8).write(to: file)
+        let results = try await withThrowingTaskGroup(of: Google_Protobuf_Struct.self) { group in
+            for _ in 0..<8 {
+                group.addTask { try await index.metadata(for: file) }
+            }
+            return try await group.reduce(into: []) { $0.append($1) }
+        }
+        XCTAssertEqual(results.count, 8)
+        XCTAssertTrue(results.allSatisfy { $0.fields["probe"]?.numberValue == 1 })
+        XCTAssertEqual(counter.count, 1)
+    }
+    
+    /// Build a `WasmPatch` from `ops`, `.copy` reads from the base module and `.add` carries bytes
+    enum PatchOp {
+        case copy(offset: UInt64, count: UInt32)
+        case add(Data)
+    }
+    
+    func patch(_ ops: [PatchOp], targetSize: UInt64) -> Data {
+        func bigEndian<T: FixedWidthInteger>(_ value: T) -> Data {
+            withUnsafeBytes(of: value.bigEndian) { Data($0) }
+        }
+        var data = WasmPatch.magic
+        data.append(WasmPatch.version)
+        data.append(bigEndian(targetSize))
+        for op in ops {
+            switch op {
+            case let .copy(offset, count):
+                data.append(0x01)
+                data.append(bigEndian(offset))
+                data.append(bigEndian(count))
+            case let .add(bytes):
+                data.append(0x02)
+                data.append(bigEndian(UInt32(bytes.count)))
+                data.append(bytes)
+            }
+        }
+        data.append(0x00)
+        return data
+    }
+    
+    func testPatchRebuildsModule() throws {
+        let base = directory.appendingPathComponent("base.wasm")
+        let delta = directory.appendingPathComponent("base_next.patch")
+        let output = directory.appendingPathComponent("next.wasm")
+        try Data("\0asm-old-body-tail".utf8).write(to: base)
+        try patch([.copy(offset: 0, count: 5), .add(Data("new".utf8)), .copy(offset: 13, count: 5)],
+                  targetSize: 13).write(to: delta)
+        try WasmPatch.apply(base: base, patch: delta, to: output)
+        XCTAssertEqual(try Data(contentsOf: output), Data("\0asm-new-tail".utf8))
+    }
+    
+    func testPatchRejectsInvalidDelta() throws {
+        let base = directory.appendingPathComponent("base.wasm")
+        let delta = directory.appendingPathComponent("base_next.patch")
+        let output = directory.appendingPathComponent("next.wasm")
+        try Data("\0asm".utf8).write(to: base)
+        
+        try Data("WAPX".utf8).write(to: delta)
+        XCTAssertThrowsError(try WasmPatch.apply(base: base, patch: delta, to: output))
+        
+        try patch([.copy(offset: 2, count: 8)], targetSize: 8).write(to: delta)
+        XCTAssertThrowsError(try WasmPatch.apply(base: base, patch: delta, to: output)) { error in
+            guard case WasmUpdateError.invalidPatch = error else { return XCTFail("\(error)") }
+        }
+        
+        try patch([.add(Data("ab".utf8))], targetSize: 4).write(to: delta)
+        XCTAssertThrowsError(try WasmPatch.apply(base: base, patch: delta, to: output)) { error in
+            guard case WasmUpdateError.truncated(4, 2) = error else { return XCTFail("\(error)") }
+        }
+        
+        var cut = patch([.add(Data("abcd".utf8))], targetSize: 4)
+        cut.removeLast(3)
+        try cut.write(to: delta)
+        XCTAssertThrowsError(try WasmPatch.apply(base: base, patch: delta, to: output))
+    }
+    
+    func testVerifyChecksSha() throws {
+        let file = directory.appendingPathComponent("next.wasm")
+        try Data("\0asm".utf8).write(to: file)
+        let sha = try file.sha256()
+        var version = EngineVersion()
+        version.id = "next"
+        
+        // no sha published, installed unchecked
+        XCTAssertNoThrow(try WasmUpdateManager.verify(file, for: version))
+        
+        version.sha = sha.uppercased()
+        XCTAssertNoThrow(try WasmUpdateManager.verify(file, for: version))
+        
+        version.sha = String(repeating: "0", count: 64)
+        XCTAssertThrowsError(try WasmUpdateManager.verify(file, for: version)) { error in
+            guard case WasmUpdateError.integrityMismatch(_, sha) = error else { return XCTFail("\(error)") }
+        }
+        
+        for malformed in [String(sha.dropLast()), String(sha.dropLast()) + "z", sha + "0"] {
+            version.sha = malformed
+            XCTAssertThrowsError(try WasmUpdateManager.verify(file, for: version)) { error in
+                guard case WasmUpdateError.invalidSha = error else { return XCTFail("\(error)") }
+            }
+        }
+    }
+    
+    func testResumeDataIsKeyedBySourceAndVersion() throws {
+        let destination = directory.appendingPathComponent("next.wasm.download")
+        let url = URL(string: "https://example.com/next.wasm")!
+        let other = URL(string: "https://example.com/other.wasm")!
+        let resume = AsyncDownloader.resumeDataURL(for: url, version: "next", destination: destination)
+        
+        XCTAssertEqual(resume.deletingLastPathComponent(), directory)
+        XCTAssertTrue(resume.lastPathComponent.hasPrefix(destination.lastPathComponent + "."))
+        XCTAssertEqual(resume, AsyncDownloader.resumeDataURL(for: url, version: "next", destination: destination))
+        XCTAssertNotEqual(resume, AsyncDownloader.resumeDataURL(for: other, version: "next", destination: destination))
+        XCTAssertNotEqual(resume, AsyncDownloader.resumeDataURL(for: url, version: "other", destination: destination))
+        
+        let stale = AsyncDownloader.resumeDataURL(for: other, version: "other", destination: destination)
+        let unrelated = directory.appendingPathComponent("other.wasm.download.0011.resume")
+        for file in [resume, stale, unrelated] {
+            try Data("resume".utf8).write(to: file)
+        }
+        AsyncDownloader(url: url, destination: destination, version: "next").discardStaleResumeData()
+        XCTAssertTrue(FileManager.default.fileExists(atPath: resume.path))
+        XCTAssertFalse(FileManager.default.fileExists(atPath: stale.path))
+        XCTAssertTrue(FileManager.default.fileExists(atPath: unrelated.path))
+    }
+}
+#endif
@@ -49,6 +49,24 @@
     }];
 }
 
+-(void)testSearchMessage {
+    [self waitForEngineStarted];
+    XCTestExpectation *exp = [self expectationWithDescription:@"typed search with keyword"];
+    MusicWasmEngine *engine = (MusicWasmEngine *)self->_sut;
+    [engine searchMessageWithKeyword:@"i known"
+                               scope:@"all"
+                        continuation:nil
+                   completionHandler:^(WAMusicListTracks * _Nullable ret, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertNotNil(ret);
+        XCTAssertNotEqual(ret.itemsArray.count, 0);
+        [exp fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:60 handler:^(NSError *error) {
+        
+    }];
+}
+
 -(void)testSuggestion {
     [self waitForEngineStarted];
     XCTestExpectation *exp = [self expectationWithDescription:@"suggestion with query"];
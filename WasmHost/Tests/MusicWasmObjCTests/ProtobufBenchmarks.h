@@ -0,0 +1,17 @@
+//
+//  ProtobufBenchmarks.h
+//  WasmHost
+//
+//  Created by L7Studio on 19/10/26.
+//
+
+#import <XCTest/XCTest.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Microbenchmarks and fuzz tests of the protobuf runtime on the app's messages
+@interface ProtobufBenchmarks : XCTestCase
+
+@end
+
+NS_ASSUME_NONNULL_END
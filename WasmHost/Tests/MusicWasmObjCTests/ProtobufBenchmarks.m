@@ -0,0 +1,1356 @@
+//
+//  ProtobufBenchmarks.m
+//  WasmHost
+//
+//  Created by L7Studio on 19/10/26.
+//
+
+#import "ProtobufBenchmarks.h"
+#import <malloc/malloc.h>
+#import <objc/runtime.h>
+@import Protobuf;
+@import WasmObjCProtobuf;
+
+static const NSUInteger kLookupIterations = 200000;
+static const NSUInteger kParseIterations = 2000;
+static const NSUInteger kVarintFuzzIterations = 200000;
+static const NSUInteger kVarintCount = 100000;
+static const NSUInteger kNestingDepth = 64;
+
+/// `message Int32Map { map<int32, int32> entries = 1; }`, none of the generated protos has an
+/// integer keyed map field.
+@interface BenchInt32Map : GPBMessage
+@property(nonatomic, readwrite, strong, null_resettable) GPBInt32Int32Dictionary *entries;
+@end
+
+@implementation BenchInt32Map
+
+@dynamic entries;
+
+typedef struct BenchInt32Map__storage_ {
+    uint32_t _has_storage_[1];
+    __unsafe_unretained GPBInt32Int32Dictionary *entries;
+} BenchInt32Map__storage_;
+
++ (GPBDescriptor *)descriptor {
+    static GPBDescriptor *descriptor = nil;
+    if (!descriptor) {
+        static GPBFileDescription fileDescription = {
+            .package = "bench",
+            .prefix = "Bench",
+            .syntax = GPBFileSyntaxProto3,
+        };
+        static GPBMessageFieldDescription fields[] = {
+            {
+                .name = "entries",
+                .dataTypeSpecific.clazz = Nil,
+                .number = 1,
+                .hasIndex = GPBNoHasBit,
+                .offset = (uint32_t)offsetof(BenchInt32Map__storage_, entries),
+                .flags = GPBFieldMapKeyInt32,
+                .dataType = GPBDataTypeInt32,
+            },
+        };
+        descriptor = [GPBDescriptor allocDescriptorForClass:[BenchInt32Map class]
+                                                messageName:@"Int32Map"
+                                            fileDescription:&fileDescription
+                                                     fields:fields
+                                                 fieldCount:(uint32_t)(sizeof(fields) / sizeof(GPBMessageFieldDescription))
+                                                storageSize:sizeof(BenchInt32Map__storage_)
+                                                      flags:(GPBDescriptorInitializationFlags)(GPBDescriptorInitializationFlag_UsesClassRefs | GPBDescriptorInitializationFlag_Proto3OptionalKnown | GPBDescriptorInitializationFlag_ClosedEnumSupportKnown)];
+    }
+    return descriptor;
+}
+
+@end
+
+/// Field lookup the parser used before the tag table: scan the fields from a rotating index.
+static GPBFieldDescriptor *LinearFieldForTag(NSArray<GPBFieldDescriptor *> *fields,
+                                             NSUInteger *startingIndex, uint32_t tag) {
+    NSUInteger numFields = fields.count;
+    for (NSUInteger i = 0; i < numFields; ++i) {
+        if (*startingIndex >= numFields) *startingIndex = 0;
+        GPBFieldDescriptor *field = fields[*startingIndex];
+        if (GPBFieldTag(field) == tag) {
+            return field;
+        }
+        *startingIndex += 1;
+    }
+    return nil;
+}
+
+/// Byte at a time varint decoding, the reference the stream's fast path is checked against.
+/// - Returns: 0 on success or the `GPBCodedInputStreamErrorCode` the stream should raise
+static NSInteger ReferenceReadVarint(const uint8_t *bytes, size_t size, size_t limit, size_t *pos,
+                                     uint64_t *value) {
+    uint64_t result = 0;
+    for (int32_t shift = 0; shift < 64; shift += 7) {
+        if (*pos + 1 > size) return GPBCodedInputStreamErrorInvalidSize;
+        if (*pos + 1 > limit) {
+            *pos = limit;
+            return GPBCodedInputStreamErrorSubsectionLimitReached;
+        }
+        uint8_t b = bytes[(*pos)++];
+        result |= (uint64_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) {
+            *value = result;
+            return 0;
+        }
+    }
+    return GPBCodedInputStreamErrorInvalidVarInt;
+}
+
+@implementation ProtobufBenchmarks {
+    NSArray<GPBDescriptor *> *_descriptors;
+    NSData *_details;
+}
+
+- (void)setUp {
+    [super setUp];
+    _descriptors = @[
+        WAMusicTrackDetails.descriptor,
+        WAMusicTrackDetails_Format.descriptor,
+        WAMusicTrack.descriptor,
+        WAMusicAuthor.descriptor,
+        WATypesArgument.descriptor,
+        WATypesValidator.descriptor,
+        WATypesFormat.descriptor,
+    ];
+    _details = [[self makeTrackDetails] data];
+}
+
+- (void)tearDown {
+    // descriptors are shared by the whole process
+    [self listTracksItems].lazy = NO;
+    [super tearDown];
+}
+
+/// A details payload shaped like the engine's answers: a few formats and a page of related tracks
+- (WAMusicTrackDetails *)makeTrackDetails {
+    WAMusicAuthor *author = [WAMusicAuthor message];
+    author.id_p = @"UC-9-kyTW8ZkZNDHQJ6FgpwQ";
+    author.name = @"Music";
+    author.thumbnail = @"https://yt3.ggpht.com/author.jpg";
+
+    WAMusicTrackDetails *details = [WAMusicTrackDetails message];
+    details.id_p = @"kPa7bsKwL-c";
+    details.title = @"Track title";
+    details.description_p = [@"" stringByPaddingToLength:512 withString:@"lorem ipsum " startingAtIndex:0];
+    details.author = author;
+    details.thumbnail = @"https://i.ytimg.com/vi/kPa7bsKwL-c/hqdefault.jpg";
+    details.duration = 245.5;
+    details.views = 123456789;
+    details.dashManifestURL = @"https://manifest.googlevideo.com/api/manifest/dash";
+    details.hlsManifestURL = @"https://manifest.googlevideo.com/api/manifest/hls";
+    for (int i = 0; i < 24; i++) {
+        WAMusicTrackDetails_Format *format = [WAMusicTrackDetails_Format message];
+        format.id_p = [NSString stringWithFormat:@"%d", 100 + i];
+        format.URL = [NSString stringWithFormat:@"https://rr1.googlevideo.com/videoplayback?itag=%d", 100 + i];
+        format.quality = @"AUDIO_QUALITY_MEDIUM";
+        format.mimeType = @"audio/webm; codecs=\"opus\"";
+        format.exp = 1760000000 + i;
+        GPBValue *bitrate = [GPBValue message];
+        bitrate.numberValue = 128000 + i;
+        format.metadata.fields[@"bitrate"] = bitrate;
+        [details.formatsArray addObject:format];
+    }
+    for (int i = 0; i < 50; i++) {
+        WAMusicTrack *track = [WAMusicTrack message];
+        track.id_p = [NSString stringWithFormat:@"related-%d", i];
+        track.title = [NSString stringWithFormat:@"Related track %d", i];
+        track.kind = @"video";
+        track.author = author;
+        track.thumbnail = @"https://i.ytimg.com/vi/related/hqdefault.jpg";
+        [details.relatedTracksArray addObject:track];
+    }
+    return details;
+}
+
+/// Tags of the fields of `descriptor`, in the order least favourable to the rotating scan
+- (NSData *)tagsForDescriptor:(GPBDescriptor *)descriptor {
+    NSMutableData *tags = [NSMutableData data];
+    for (GPBFieldDescriptor *field in descriptor.fields.reverseObjectEnumerator) {
+        uint32_t tag = GPBFieldTag(field);
+        [tags appendBytes:&tag length:sizeof(tag)];
+    }
+    return tags;
+}
+
+- (void)testTagTableMatchesFields {
+    for (GPBDescriptor *descriptor in _descriptors) {
+        const GPBFieldTagTable *table = GPBDescriptorTagTable(descriptor);
+        XCTAssertEqual(table, GPBDescriptorTagTable(descriptor));
+        for (GPBFieldDescriptor *field in descriptor.fields) {
+            const GPBFieldTagEntry *entry = GPBFieldTagTableLookup(table, field.number);
+            XCTAssert(entry != NULL);
+            XCTAssertEqual(entry->field, field);
+            XCTAssertEqual(entry->tag, GPBFieldTag(field));
+        }
+        XCTAssert(GPBFieldTagTableLookup(table, 0) == NULL);
+        XCTAssert(GPBFieldTagTableLookup(table, 536870911) == NULL);
+    }
+}
+
+- (void)testLookupLinearScan {
+    NSArray<NSData *> *tags = [self tagsForAllDescriptors];
+    [self measureBlock:^{
+        NSUInteger found = 0;
+        for (NSUInteger n = 0; n < kLookupIterations; n++) {
+            for (NSUInteger d = 0; d < self->_descriptors.count; d++) {
+                NSArray *fields = self->_descriptors[d].fields;
+                const uint32_t *bytes = tags[d].bytes;
+                NSUInteger count = tags[d].length / sizeof(uint32_t);
+                NSUInteger startingIndex = 0;
+                for (NSUInteger i = 0; i < count; i++) {
+                    found += LinearFieldForTag(fields, &startingIndex, bytes[i]) != nil;
+                }
+            }
+        }
+        XCTAssertNotEqual(found, 0);
+    }];
+}
+
+- (void)testLookupTagTable {
+    NSArray<NSData *> *tags = [self tagsForAllDescriptors];
+    [self measureBlock:^{
+        NSUInteger found = 0;
+        for (NSUInteger n = 0; n < kLookupIterations; n++) {
+            for (NSUInteger d = 0; d < self->_descriptors.count; d++) {
+                const GPBFieldTagTable *table = GPBDescriptorTagTable(self->_descriptors[d]);
+                const uint32_t *bytes = tags[d].bytes;
+                NSUInteger count = tags[d].length / sizeof(uint32_t);
+                for (NSUInteger i = 0; i < count; i++) {
+                    const GPBFieldTagEntry *entry =
+                        GPBFieldTagTableLookup(table, GPBWireFormatGetTagFieldNumber(bytes[i]));
+                    found += (entry != NULL && entry->tag == bytes[i]);
+                }
+            }
+        }
+        XCTAssertNotEqual(found, 0);
+    }];
+}
+
+- (void)testParseTrackDetails {
+    NSError *error = nil;
+    WAMusicTrackDetails *parsed = [WAMusicTrackDetails parseFromData:_details error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(parsed, [self makeTrackDetails]);
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < kParseIterations; n++) {
+            @autoreleasepool {
+                [WAMusicTrackDetails parseFromData:self->_details error:NULL];
+            }
+        }
+    }];
+}
+
+- (void)testVarintFuzz {
+    uint8_t bytes[32];
+    for (NSUInteger n = 0; n < kVarintFuzzIterations; n++) {
+        size_t size = arc4random_uniform(sizeof(bytes) + 1);
+        // mostly continuation bytes so long and overlong encodings are common
+        for (size_t i = 0; i < size; i++) {
+            uint8_t b = (uint8_t)arc4random();
+            bytes[i] = arc4random_uniform(4) ? (b | 0x80) : (b & 0x7F);
+        }
+        size_t limit = arc4random_uniform(2) ? size : arc4random_uniform((uint32_t)size + 1);
+        NSData *data = [NSData dataWithBytes:bytes length:size];
+        GPBCodedInputStream *input = [GPBCodedInputStream streamWithData:data];
+        [input pushLimit:limit];
+        size_t pos = 0;
+        while (pos < size) {
+            uint64_t expected = 0;
+            NSInteger expectedError = ReferenceReadVarint(bytes, size, limit, &pos, &expected);
+            NSInteger error = 0;
+            uint64_t value = 0;
+            @try {
+                value = [input readUInt64];
+            } @catch (NSException *exception) {
+                XCTAssertEqualObjects(exception.name, GPBCodedInputStreamException);
+                error = [exception.userInfo[GPBCodedInputStreamUnderlyingErrorKey] code];
+            }
+            XCTAssertEqual(error, expectedError, @"%@", data);
+            if (error != 0) break;
+            XCTAssertEqual(value, expected, @"%@", data);
+            XCTAssertEqual(input.position, pos, @"%@", data);
+        }
+    }
+}
+
+/// Varints shaped like task status updates: ids, percentages, millisecond timestamps, byte counts
+- (NSData *)makeVarints {
+    NSMutableData *data = [NSMutableData data];
+    GPBCodedOutputStream *output = [GPBCodedOutputStream streamWithData:data];
+    uint64_t now = 1760000000000;
+    for (NSUInteger i = 0; i < kVarintCount / 4; i++) {
+        [output writeUInt64NoTag:i];
+        [output writeUInt64NoTag:arc4random_uniform(101)];
+        [output writeUInt64NoTag:now + i * 16];
+        [output writeUInt64NoTag:(uint64_t)arc4random() << arc4random_uniform(24)];
+    }
+    [output flush];
+    return data;
+}
+
+- (void)testReadVarints {
+    NSData *data = [self makeVarints];
+    [self measureBlock:^{
+        uint64_t sum = 0;
+        for (NSUInteger n = 0; n < 20; n++) {
+            GPBCodedInputStream *input = [GPBCodedInputStream streamWithData:data];
+            while (![input isAtEnd]) {
+                sum += [input readUInt64];
+            }
+        }
+        XCTAssertNotEqual(sum, 0);
+    }];
+}
+
+- (void)testParseTranscript {
+    WAMusicTranscript *transcript = [WAMusicTranscript message];
+    for (int32_t i = 0; i < 2000; i++) {
+        WAMusicTranscript_Segment *segment = [WAMusicTranscript_Segment message];
+        segment.text = @"la";
+        segment.offset = i * 1500;
+        segment.duration = 1500 + i % 700;
+        [transcript.segmentsArray addObject:segment];
+    }
+    NSData *data = [transcript data];
+    XCTAssertEqualObjects([WAMusicTranscript parseFromData:data error:NULL], transcript);
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < 200; n++) {
+            @autoreleasepool {
+                [WAMusicTranscript parseFromData:data error:NULL];
+            }
+        }
+    }];
+}
+
+/// A page of search results like `searchWithKeyword:` returns
+- (WAMusicListTracks *)makeListTracks {
+    WAMusicListTracks *list = [WAMusicListTracks message];
+    for (int i = 0; i < 500; i++) {
+        WAMusicAuthor *author = [WAMusicAuthor message];
+        author.id_p = [NSString stringWithFormat:@"UC-author-channel-%06d", i];
+        author.name = [NSString stringWithFormat:@"Author name number %d", i];
+        author.thumbnail = [NSString stringWithFormat:@"https://yt3.ggpht.com/ytc/author-%d=s88-c-k-c0x00ffffff-no-rj", i];
+        WAMusicTrack *track = [WAMusicTrack message];
+        track.id_p = [NSString stringWithFormat:@"track-%05d", i];
+        track.title = [NSString stringWithFormat:@"Track title with some words – %d ♪", i];
+        track.kind = @"video";
+        track.author = author;
+        track.thumbnail = [NSString stringWithFormat:@"https://i.ytimg.com/vi/track-%05d/hqdefault.jpg?sqp=-oaymwEjCOADEI4CSFryq4qpAxUIARUAAAAAGAElAADIQj0AgKJDeAE=", i];
+        [list.itemsArray addObject:track];
+    }
+    list.continuation = [@"" stringByPaddingToLength:256 withString:@"4qmFsgKDARIMVkx" startingAtIndex:0];
+    return list;
+}
+
+- (WAMusicListTracks *)parseListTracks:(NSData *)data options:(GPBCodedInputStreamOptions)options {
+    GPBCodedInputStream *input = [GPBCodedInputStream streamWithData:data options:options];
+    return [WAMusicListTracks parseFromCodedInputStream:input extensionRegistry:nil error:NULL];
+}
+
+- (void)testLazyStringsMatchEagerParse {
+    WAMusicListTracks *list = [self makeListTracks];
+    NSMutableData *data = [[list data] mutableCopy];
+    WAMusicListTracks *parsed = [self parseListTracks:data options:GPBCodedInputStreamOptionLazyStrings];
+    // the parsed strings must not see changes made to the input afterwards
+    memset(data.mutableBytes, 0, data.length);
+    XCTAssertEqualObjects(parsed, list);
+    XCTAssertEqualObjects(parsed.itemsArray[7].thumbnail, list.itemsArray[7].thumbnail);
+    XCTAssertEqualObjects([parsed.itemsArray[7].title copy], list.itemsArray[7].title);
+    XCTAssertEqualObjects([parsed data], [list data]);
+}
+
+- (void)testParseListTracksEager {
+    NSData *data = [[self makeListTracks] data];
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < 50; n++) {
+            @autoreleasepool {
+                [self parseListTracks:data options:GPBCodedInputStreamOptionNone];
+            }
+        }
+    }];
+}
+
+- (void)testParseListTracksLazyStrings {
+    NSData *data = [[self makeListTracks] data];
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < 50; n++) {
+            @autoreleasepool {
+                // the UI only reads what is on screen
+                WAMusicListTracks *list = [self parseListTracks:data options:GPBCodedInputStreamOptionLazyStrings];
+                for (NSUInteger i = 0; i < 20; i++) {
+                    (void)list.itemsArray[i].title.length;
+                }
+            }
+        }
+    }];
+}
+
+- (GPBFieldDescriptor *)listTracksItems {
+    return [WAMusicListTracks.descriptor fieldWithNumber:WAMusicListTracks_FieldNumber_ItemsArray];
+}
+
+/// Mark `itemsArray` of `WAMusicListTracks` lazy for the duration of the test, `tearDown` restores it
+- (void)useLazyListTracks {
+    [self listTracksItems].lazy = YES;
+}
+
+- (void)testLazyMessagesMatchEagerParse {
+    WAMusicListTracks *list = [self makeListTracks];
+    NSData *data = [list data];
+    [self useLazyListTracks];
+    WAMusicListTracks *parsed = [WAMusicListTracks parseFromData:data error:NULL];
+    XCTAssertEqual(parsed.itemsArray_Count, list.itemsArray_Count);
+    XCTAssertEqualObjects(parsed.itemsArray[42], list.itemsArray[42]);
+    XCTAssertEqualObjects(parsed, list);
+    XCTAssertEqualObjects([parsed data], data);
+
+    // mutations parse the rest and keep working as a regular array
+    parsed = [WAMusicListTracks parseFromData:data error:NULL];
+    [parsed.itemsArray removeObjectAtIndex:0];
+    [parsed.itemsArray addObject:list.itemsArray[0]];
+    XCTAssertEqual(parsed.itemsArray_Count, list.itemsArray_Count);
+    XCTAssertEqualObjects(parsed.itemsArray.lastObject, list.itemsArray[0]);
+    XCTAssertEqualObjects(parsed.itemsArray[0], list.itemsArray[1]);
+
+    // merging a second page appends to the same lazy array
+    WAMusicListTracks *merged = [WAMusicListTracks parseFromData:data error:NULL];
+    XCTAssertTrue([merged mergeFromData:data extensionRegistry:nil error:NULL]);
+    XCTAssertEqual(merged.itemsArray_Count, 2 * list.itemsArray_Count);
+    XCTAssertEqualObjects(merged.itemsArray[list.itemsArray_Count + 3], list.itemsArray[3]);
+}
+
+- (void)testLazyMessagesOutliveMutableInput {
+    WAMusicListTracks *list = [self makeListTracks];
+    NSMutableData *data = [[list data] mutableCopy];
+    [self useLazyListTracks];
+    WAMusicListTracks *parsed = [WAMusicListTracks parseFromData:data error:NULL];
+    // the lazy array references a frozen copy, not the caller's buffer
+    memset(data.mutableBytes, 0, data.length);
+    XCTAssertEqualObjects(parsed.itemsArray[7], list.itemsArray[7]);
+    XCTAssertEqualObjects(parsed, list);
+}
+
+- (void)testParseListTracksLazyMessages {
+    NSData *data = [[self makeListTracks] data];
+    [self useLazyListTracks];
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < 50; n++) {
+            @autoreleasepool {
+                // the UI only reads what is on screen
+                WAMusicListTracks *list = [WAMusicListTracks parseFromData:data error:NULL];
+                for (NSUInteger i = 0; i < 20; i++) {
+                    (void)list.itemsArray[i].title.length;
+                }
+            }
+        }
+    }];
+}
+
+/// Heap blocks held by the tree parsed from `data` with `options`
+- (size_t)blocksInUseParsingListTracks:(NSData *)data options:(GPBCodedInputStreamOptions)options {
+    malloc_statistics_t before, after;
+    @autoreleasepool {
+        malloc_zone_statistics(NULL, &before);
+        WAMusicListTracks *list = [self parseListTracks:data options:options];
+        malloc_zone_statistics(NULL, &after);
+        XCTAssertEqual(list.itemsArray_Count, 500u);
+    }
+    return after.blocks_in_use - before.blocks_in_use;
+}
+
+- (void)testArenaMatchesEagerParse {
+    WAMusicListTracks *list = [self makeListTracks];
+    NSData *data = [list data];
+    WAMusicListTracks *parsed = [self parseListTracks:data options:GPBCodedInputStreamOptionArena];
+    XCTAssertEqualObjects(parsed, list);
+    XCTAssertEqualObjects([parsed data], data);
+
+    // objects escaping the tree outlive the root
+    WAMusicTrack *track;
+    NSString *title;
+    @autoreleasepool {
+        WAMusicListTracks *root = [self parseListTracks:data options:GPBCodedInputStreamOptionArena];
+        track = root.itemsArray[3];
+        title = root.itemsArray[4].title;
+    }
+    XCTAssertEqualObjects(track, list.itemsArray[3]);
+    XCTAssertEqualObjects(title, list.itemsArray[4].title);
+
+    // the tree stays mutable
+    [parsed.itemsArray removeObjectAtIndex:0];
+    for (NSUInteger i = 0; i < 100; i++) {
+        [parsed.itemsArray addObject:list.itemsArray[i]];
+    }
+    parsed.itemsArray[1].author.name = @"renamed";
+    XCTAssertEqual(parsed.itemsArray_Count, list.itemsArray_Count + 99);
+    XCTAssertEqualObjects(parsed.itemsArray[1].author.name, @"renamed");
+
+    // malformed input fails the same way
+    NSData *truncated = [data subdataWithRange:NSMakeRange(0, data.length / 2)];
+    XCTAssertNil([self parseListTracks:truncated options:GPBCodedInputStreamOptionArena]);
+}
+
+/// Reports the heap blocks held by both trees. Block counts depend on the allocator and the OS
+/// version, this is a measurement to compare runs, not a pass/fail check.
+- (void)testArenaMallocCount {
+    NSData *data = [[self makeListTracks] data];
+    size_t eager = [self blocksInUseParsingListTracks:data options:GPBCodedInputStreamOptionNone];
+    size_t arena = [self blocksInUseParsingListTracks:data options:GPBCodedInputStreamOptionArena];
+    NSLog(@"ListTracks (%lu bytes) heap blocks, eager: %zu, arena: %zu",
+          (unsigned long)data.length, eager, arena);
+}
+
+- (void)testParseListTracksArena {
+    NSData *data = [[self makeListTracks] data];
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < 50; n++) {
+            @autoreleasepool {
+                [self parseListTracks:data options:GPBCodedInputStreamOptionArena];
+            }
+        }
+    }];
+}
+
+/// `GPBValue` nested `depth` lists deep, every level also holds a few scalars
+- (GPBValue *)makeNestedValue:(NSUInteger)depth {
+    GPBValue *value = [GPBValue message];
+    value.stringValue = @"leaf";
+    for (NSUInteger i = 0; i < depth; i++) {
+        GPBValue *parent = [GPBValue message];
+        parent.listValue = [GPBListValue message];
+        [parent.listValue.valuesArray addObject:value];
+        for (NSUInteger n = 0; n < 4; n++) {
+            GPBValue *number = [GPBValue message];
+            number.numberValue = i * 4 + n;
+            [parent.listValue.valuesArray addObject:number];
+        }
+        value = parent;
+    }
+    return value;
+}
+
+- (void)testCachedSizesFollowMutations {
+    GPBValue *root = [self makeNestedValue:kNestingDepth];
+    NSData *data = [root data];
+    XCTAssertEqual(data.length, root.serializedSize);
+    XCTAssertEqualObjects([GPBValue parseFromData:data error:NULL], root);
+
+    // grow a message deep in the tree, the next serialization must not use the old sizes
+    GPBValue *inner = root;
+    for (NSUInteger i = 0; i < kNestingDepth / 2; i++) {
+        inner = inner.listValue.valuesArray[0];
+    }
+    inner.listValue.valuesArray[1].stringValue = [@"" stringByPaddingToLength:300 withString:@"x" startingAtIndex:0];
+    NSData *grown = [root data];
+    XCTAssertEqual(grown.length, root.serializedSize);
+    XCTAssertGreaterThan(grown.length, data.length);
+    XCTAssertEqualObjects([GPBValue parseFromData:grown error:NULL], root);
+    XCTAssertEqualObjects([GPBValue parseDelimitedFromCodedInputStream:[GPBCodedInputStream streamWithData:[root delimitedData]]
+                                                     extensionRegistry:nil
+                                                                 error:NULL], root);
+}
+
+- (void)testSerializeNestedValue {
+    GPBValue *root = [self makeNestedValue:kNestingDepth];
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < 200; n++) {
+            @autoreleasepool {
+                (void)[root data];
+            }
+        }
+    }];
+}
+
+- (void)testSerializeListTracks {
+    WAMusicListTracks *list = [self makeListTracks];
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < 50; n++) {
+            @autoreleasepool {
+                (void)[list data];
+            }
+        }
+    }];
+}
+
+/// Encoded `WATypesImage` carrying a `length` bytes payload
+- (NSData *)makeImageData:(NSUInteger)length {
+    NSMutableData *payload = [NSMutableData dataWithLength:length];
+    arc4random_buf(payload.mutableBytes, length);
+    WATypesImage *image = [WATypesImage message];
+    image.id_p = @"cover";
+    image.data_p.raw = payload;
+    return [image data];
+}
+
+- (void)testZeroCopyBytes {
+    NSMutableData *data = [[self makeImageData:4 << 20] mutableCopy];
+    WATypesImage *expected = [WATypesImage parseFromData:data error:NULL];
+    GPBCodedInputStream *input = [GPBCodedInputStream streamWithData:data options:GPBCodedInputStreamOptionZeroCopyBytes];
+    WATypesImage *image = [WATypesImage parseFromCodedInputStream:input extensionRegistry:nil error:NULL];
+    XCTAssertEqualObjects(image, expected);
+
+    // the payload is a range of the stream's buffer, which must not follow changes to the caller's data
+    memset(data.mutableBytes, 0, data.length);
+    data = nil;
+    input = nil;
+    XCTAssertEqualObjects(image.data_p.raw, expected.data_p.raw);
+
+    // small values are still copied
+    NSData *small = [self makeImageData:16];
+    input = [GPBCodedInputStream streamWithData:small options:GPBCodedInputStreamOptionZeroCopyBytes];
+    image = [WATypesImage parseFromCodedInputStream:input extensionRegistry:nil error:NULL];
+    const uint8_t *raw = image.data_p.raw.bytes;
+    XCTAssertTrue(raw < (const uint8_t *)small.bytes || raw >= (const uint8_t *)small.bytes + small.length);
+}
+
+- (void)testZeroCopyBytesReferencesInput {
+    NSData *data = [self makeImageData:4 << 20];
+    GPBCodedInputStream *input = [GPBCodedInputStream streamWithData:data options:GPBCodedInputStreamOptionZeroCopyBytes];
+    WATypesImage *image = [WATypesImage parseFromCodedInputStream:input extensionRegistry:nil error:NULL];
+    const uint8_t *raw = image.data_p.raw.bytes;
+    XCTAssertTrue(raw >= (const uint8_t *)data.bytes && raw + image.data_p.raw.length <= (const uint8_t *)data.bytes + data.length);
+}
+
+- (void)testParseImageCopy {
+    NSData *data = [self makeImageData:4 << 20];
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < 20; n++) {
+            @autoreleasepool {
+                [WATypesImage parseFromData:data error:NULL];
+            }
+        }
+    }];
+}
+
+- (void)testParseImageZeroCopy {
+    NSData *data = [self makeImageData:4 << 20];
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < 20; n++) {
+            @autoreleasepool {
+                GPBCodedInputStream *input = [GPBCodedInputStream streamWithData:data options:GPBCodedInputStreamOptionZeroCopyBytes];
+                [WATypesImage parseFromCodedInputStream:input extensionRegistry:nil error:NULL];
+            }
+        }
+    }];
+}
+
+- (GPBMessageStreamParser *)makeItemsParser:(NSMutableArray<WAMusicTrack *> *)items {
+    GPBFieldDescriptor *field = [WAMusicListTracks.descriptor fieldWithNumber:WAMusicListTracks_FieldNumber_ItemsArray];
+    return [[GPBMessageStreamParser alloc] initWithMessageClass:WAMusicListTracks.class
+                                                  repeatedField:field
+                                              extensionRegistry:nil
+                                                        handler:^(GPBMessage *element) {
+        [items addObject:(WAMusicTrack *)element];
+    }];
+}
+
+- (void)testStreamParserRepeatedField {
+    WAMusicListTracks *list = [self makeListTracks];
+    NSData *data = [list data];
+    NSMutableArray<WAMusicTrack *> *items = [NSMutableArray array];
+    GPBMessageStreamParser *parser = [self makeItemsParser:items];
+    NSUInteger pos = 0;
+    while (pos < data.length) {
+        NSUInteger length = MIN(data.length - pos, 1 + arc4random_uniform(600));
+        NSError *error = nil;
+        XCTAssertTrue([parser appendData:[data subdataWithRange:NSMakeRange(pos, length)] error:&error], @"%@", error);
+        pos += length;
+        // Every complete element is handed out as soon as its bytes are there.
+        XCTAssertLessThanOrEqual(items.count, list.itemsArray.count);
+    }
+    XCTAssertTrue([parser finishWithError:NULL]);
+    XCTAssertEqualObjects(items, list.itemsArray);
+    WAMusicListTracks *rest = (WAMusicListTracks *)parser.message;
+    XCTAssertEqual(rest.itemsArray.count, 0u);
+    XCTAssertEqualObjects(rest.continuation, list.continuation);
+}
+
+- (void)testStreamParserDelimited {
+    WAMusicListTracks *list = [self makeListTracks];
+    NSMutableData *data = [NSMutableData data];
+    for (WAMusicTrack *track in list.itemsArray) {
+        [data appendData:[track delimitedData]];
+    }
+    NSMutableArray<WAMusicTrack *> *items = [NSMutableArray array];
+    GPBMessageStreamParser *parser = [[GPBMessageStreamParser alloc] initWithDelimitedMessageClass:WAMusicTrack.class
+                                                                                 extensionRegistry:nil
+                                                                                           handler:^(GPBMessage *message) {
+        [items addObject:(WAMusicTrack *)message];
+    }];
+    const uint8_t *bytes = data.bytes;
+    for (NSUInteger i = 0; i < data.length; i++) {
+        XCTAssertTrue([parser appendData:[NSData dataWithBytes:bytes + i length:1] error:NULL]);
+    }
+    XCTAssertTrue([parser finishWithError:NULL]);
+    XCTAssertNil(parser.message);
+    XCTAssertEqualObjects(items, list.itemsArray);
+}
+
+- (void)testStreamParserErrors {
+    NSData *data = [[self makeListTracks] data];
+    NSMutableArray<WAMusicTrack *> *items = [NSMutableArray array];
+    GPBMessageStreamParser *parser = [self makeItemsParser:items];
+    XCTAssertTrue([parser appendData:[data subdataWithRange:NSMakeRange(0, data.length - 1)] error:NULL]);
+    NSError *error = nil;
+    XCTAssertFalse([parser finishWithError:&error]);
+    XCTAssertEqualObjects(error.domain, GPBCodedInputStreamErrorDomain);
+    XCTAssertEqual(error.code, GPBCodedInputStreamErrorInvalidSize);
+
+    // Field number 0 is never valid, the parser stays failed.
+    parser = [self makeItemsParser:items];
+    const uint8_t invalid[] = {0x02, 0x00};
+    XCTAssertFalse([parser appendData:[NSData dataWithBytes:invalid length:sizeof(invalid)] error:&error]);
+    XCTAssertEqual(error.code, GPBCodedInputStreamErrorInvalidTag);
+    XCTAssertFalse([parser appendData:data error:NULL]);
+    XCTAssertFalse([parser finishWithError:NULL]);
+}
+
+- (void)testStreamParseListTracks {
+    NSData *data = [[self makeListTracks] data];
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < 50; n++) {
+            @autoreleasepool {
+                __block NSUInteger count = 0;
+                GPBFieldDescriptor *field = [WAMusicListTracks.descriptor fieldWithNumber:WAMusicListTracks_FieldNumber_ItemsArray];
+                GPBMessageStreamParser *parser = [[GPBMessageStreamParser alloc] initWithMessageClass:WAMusicListTracks.class
+                                                                                        repeatedField:field
+                                                                                    extensionRegistry:nil
+                                                                                              handler:^(GPBMessage *element) {
+                    count++;
+                }];
+                for (NSUInteger pos = 0; pos < data.length; pos += 16 * 1024) {
+                    [parser appendData:[data subdataWithRange:NSMakeRange(pos, MIN(data.length - pos, 16 * 1024))] error:NULL];
+                }
+                [parser finishWithError:NULL];
+            }
+        }
+    }];
+}
+
+- (void)testInt32DictionaryMatchesReference {
+    GPBInt32Int64Dictionary *dict = [[GPBInt32Int64Dictionary alloc] init];
+    NSMutableDictionary<NSNumber *, NSNumber *> *reference = [NSMutableDictionary dictionary];
+    for (NSUInteger n = 0; n < 200000; n++) {
+        // Few distinct keys so removals hit long probe sequences, 0 included.
+        int32_t key = (int32_t)arc4random_uniform(4096) - 2048;
+        if (arc4random_uniform(3) == 0) {
+            [dict removeInt64ForKey:key];
+            [reference removeObjectForKey:@(key)];
+        } else {
+            int64_t value = (int64_t)arc4random() << 16;
+            [dict setInt64:value forKey:key];
+            reference[@(key)] = @(value);
+        }
+    }
+    XCTAssertEqual(dict.count, reference.count);
+    for (int32_t key = -2048; key < 2048; key++) {
+        int64_t value;
+        BOOL found = [dict getInt64:&value forKey:key];
+        XCTAssertEqual(found, reference[@(key)] != nil);
+        if (found) {
+            XCTAssertEqual(value, reference[@(key)].longLongValue);
+        }
+    }
+    __block NSUInteger count = 0;
+    [dict enumerateKeysAndInt64sUsingBlock:^(int32_t key, int64_t value, BOOL *stop) {
+        XCTAssertEqual(value, reference[@(key)].longLongValue);
+        count++;
+    }];
+    XCTAssertEqual(count, reference.count);
+    XCTAssertEqualObjects([dict copy], dict);
+    XCTAssertThrows([dict enumerateKeysAndInt64sUsingBlock:^(int32_t key, int64_t value, BOOL *stop) {
+        [dict setInt64:value forKey:key + 100000];
+    }]);
+}
+
+- (void)testFloatingPointDictionaryEquality {
+    GPBInt32DoubleDictionary *dict = [[GPBInt32DoubleDictionary alloc] init];
+    [dict setDouble:NAN forKey:1];
+    [dict setDouble:2.5 forKey:2];
+    // values compare like the boxed entries they replaced, NaN included
+    XCTAssertEqualObjects([dict copy], dict);
+    GPBInt32DoubleDictionary *other = [dict copy];
+    [other setDouble:3 forKey:2];
+    XCTAssertNotEqualObjects(other, dict);
+}
+
+- (void)testUInt64ObjectDictionary {
+    GPBUInt64ObjectDictionary<NSString *> *dict = [[GPBUInt64ObjectDictionary alloc] init];
+    for (uint64_t key = 0; key < 1000; key++) {
+        [dict setObject:[NSString stringWithFormat:@"%llu", key] forKey:key * UINT32_MAX];
+    }
+    [dict setObject:@"replaced" forKey:0];
+    [dict removeObjectForKey:UINT32_MAX];
+    XCTAssertEqual(dict.count, 999u);
+    XCTAssertEqualObjects([dict objectForKey:0], @"replaced");
+    XCTAssertNil([dict objectForKey:UINT32_MAX]);
+    XCTAssertEqualObjects([dict objectForKey:2ull * UINT32_MAX], @"2");
+    GPBUInt64ObjectDictionary *copy = [dict copy];
+    XCTAssertEqualObjects(copy, dict);
+    [copy setObject:@"other" forKey:0];
+    XCTAssertNotEqualObjects(copy, dict);
+}
+
+- (void)measureInt32DictionaryOfSize:(NSUInteger)size {
+    int32_t *keys = malloc(size * sizeof(int32_t));
+    for (NSUInteger i = 0; i < size; i++) {
+        keys[i] = (int32_t)(i * 7919);
+    }
+    NSUInteger rounds = MAX(1u, 200000 / size);
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < rounds; n++) {
+            @autoreleasepool {
+                GPBInt32Int32Dictionary *dict = [[GPBInt32Int32Dictionary alloc] init];
+                for (NSUInteger i = 0; i < size; i++) {
+                    [dict setInt32:(int32_t)i forKey:keys[i]];
+                }
+                int64_t sum = 0;
+                for (NSUInteger i = 0; i < size; i++) {
+                    int32_t value;
+                    [dict getInt32:&value forKey:keys[i]];
+                    sum += value;
+                }
+                [dict enumerateKeysAndInt32sUsingBlock:^(int32_t key, int32_t value, BOOL *stop) {
+                    (void)key;
+                }];
+                XCTAssertEqual(sum, (int64_t)size * (int64_t)(size - 1) / 2);
+                (void)[dict copy];
+            }
+        }
+    }];
+    free(keys);
+}
+
+- (void)testInt32Dictionary10 {
+    [self measureInt32DictionaryOfSize:10];
+}
+
+- (void)testInt32Dictionary1000 {
+    [self measureInt32DictionaryOfSize:1000];
+}
+
+- (void)testInt32Dictionary100000 {
+    [self measureInt32DictionaryOfSize:100000];
+}
+
+- (BenchInt32Map *)makeInt32MapOfSize:(NSUInteger)size {
+    BenchInt32Map *message = [BenchInt32Map message];
+    for (NSUInteger i = 0; i < size; i++) {
+        [message.entries setInt32:(int32_t)i forKey:(int32_t)(i * 7919)];
+    }
+    return message;
+}
+
+/// Serializes, or parses when `parse` is set, a message holding a map of `size` entries
+- (void)measureInt32MapOfSize:(NSUInteger)size parse:(BOOL)parse {
+    BenchInt32Map *message = [self makeInt32MapOfSize:size];
+    NSData *data = [message data];
+    BenchInt32Map *parsed = [BenchInt32Map parseFromData:data error:NULL];
+    XCTAssertEqual(parsed.entries.count, size);
+    XCTAssertEqualObjects(parsed, message);
+    NSUInteger rounds = MAX(1u, 200000 / size);
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < rounds; n++) {
+            @autoreleasepool {
+                if (parse) {
+                    (void)[BenchInt32Map parseFromData:data error:NULL];
+                } else {
+                    (void)[message data];
+                }
+            }
+        }
+    }];
+}
+
+- (void)testInt32MapSerialize10 {
+    [self measureInt32MapOfSize:10 parse:NO];
+}
+
+- (void)testInt32MapSerialize1000 {
+    [self measureInt32MapOfSize:1000 parse:NO];
+}
+
+- (void)testInt32MapSerialize100000 {
+    [self measureInt32MapOfSize:100000 parse:NO];
+}
+
+- (void)testInt32MapParse10 {
+    [self measureInt32MapOfSize:10 parse:YES];
+}
+
+- (void)testInt32MapParse1000 {
+    [self measureInt32MapOfSize:1000 parse:YES];
+}
+
+- (void)testInt32MapParse100000 {
+    [self measureInt32MapOfSize:100000 parse:YES];
+}
+
+/// `GPBStruct` shaped like call arguments/metadata: scalars, nested structs and numeric lists
+- (GPBStruct *)makeStruct:(NSUInteger)entries {
+    GPBStruct *root = [GPBStruct message];
+    for (NSUInteger i = 0; i < entries; i++) {
+        GPBValue *value = [GPBValue message];
+        switch (i % 5) {
+            case 0:
+                value.stringValue = [NSString stringWithFormat:@"value %lu", (unsigned long)i];
+                break;
+            case 1:
+                value.numberValue = i * 0.5;
+                break;
+            case 2:
+                value.boolValue = (i & 1) != 0;
+                break;
+            case 3:
+                value.structValue.fields[@"id"] = [GPBValue message];
+                value.structValue.fields[@"id"].stringValue = @"kPa7bsKwL-c";
+                value.structValue.fields[@"none"] = [GPBValue message];
+                value.structValue.fields[@"none"].nullValue = GPBNullValue_NullValue;
+                break;
+            default:
+                for (NSUInteger n = 0; n < 64; n++) {
+                    GPBValue *number = [GPBValue message];
+                    number.numberValue = n * 1.25;
+                    [value.listValue.valuesArray addObject:number];
+                }
+                break;
+        }
+        root.fields[[NSString stringWithFormat:@"key%lu", (unsigned long)i]] = value;
+    }
+    return root;
+}
+
+- (void)testStructConversionMatchesMessages {
+    GPBStruct *message = [self makeStruct:100];
+    GPBValue *mixed = [GPBValue message];
+    [mixed.listValue.valuesArray addObject:message.fields[@"key1"]];
+    [mixed.listValue.valuesArray addObject:message.fields[@"key0"]];
+    message.fields[@"mixed"] = mixed;
+
+    NSError *error = nil;
+    NSDictionary *dictionary = [GPBStruct dictionaryFromData:[message data] error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(dictionary, message.dictionary);
+    XCTAssertTrue([dictionary[@"key4"] isKindOfClass:GPBDoubleArray.class]);
+    XCTAssertEqual([dictionary[@"key4"] count], 64u);
+    XCTAssertEqualObjects(dictionary[@"key2"], @NO);
+    XCTAssertEqualObjects(dictionary[@"key3"][@"none"], [NSNull null]);
+    XCTAssertEqualObjects(dictionary[@"mixed"], (@[@0.5, @"value 0"]));
+
+    NSData *encoded = [GPBStruct dataFromDictionary:dictionary error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects([GPBStruct parseFromData:encoded error:NULL], message);
+    NSData *value = [GPBValue dataFromObject:dictionary[@"key4"] error:&error];
+    XCTAssertEqualObjects([GPBValue parseFromData:value error:NULL], message.fields[@"key4"]);
+    XCTAssertEqualObjects([GPBValue objectFromData:value error:NULL], dictionary[@"key4"]);
+}
+
+- (void)testStructConversionErrors {
+    NSError *error = nil;
+    XCTAssertNil([GPBStruct dataFromDictionary:@{@"date": [NSDate date]} error:&error]);
+    XCTAssertEqual(error.code, GPBWellKnownTypesErrorCodeUnsupportedValue);
+    error = nil;
+    XCTAssertNil([GPBStruct dataFromDictionary:@{@1: @"key"} error:&error]);
+    XCTAssertEqual(error.code, GPBWellKnownTypesErrorCodeUnsupportedValue);
+    // an error raised deep in nested structs outlives the enumeration that found it
+    error = nil;
+    XCTAssertNil([GPBStruct dataFromDictionary:@{@"a": @{@"b": @{@"c": [NSDate date]}}} error:&error]);
+    XCTAssertEqual(error.code, GPBWellKnownTypesErrorCodeUnsupportedValue);
+    XCTAssertTrue([error.localizedDescription containsString:@"Date"]);
+    NSMutableArray *cycle = [NSMutableArray array];
+    [cycle addObject:cycle];
+    XCTAssertNil([GPBValue dataFromObject:cycle error:&error]);
+    [cycle removeAllObjects];
+
+    NSData *data = [[self makeStruct:10] data];
+    error = nil;
+    XCTAssertNil([GPBStruct dictionaryFromData:[data subdataWithRange:NSMakeRange(0, data.length - 3)] error:&error]);
+    XCTAssertEqualObjects(error.domain, GPBCodedInputStreamErrorDomain);
+}
+
+- (void)testParseStructMessage {
+    NSData *data = [[self makeStruct:2000] data];
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < 20; n++) {
+            @autoreleasepool {
+                (void)[GPBStruct parseFromData:data error:NULL];
+            }
+        }
+    }];
+}
+
+- (void)testParseStructDictionary {
+    NSData *data = [[self makeStruct:2000] data];
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < 20; n++) {
+            @autoreleasepool {
+                (void)[GPBStruct dictionaryFromData:data error:NULL];
+            }
+        }
+    }];
+}
+
+- (void)testEncodeStructDictionary {
+    NSDictionary *dictionary = [[self makeStruct:2000] dictionary];
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < 20; n++) {
+            @autoreleasepool {
+                (void)[GPBStruct dataFromDictionary:dictionary error:NULL];
+            }
+        }
+    }];
+}
+
+- (void)testJSONTranscoderRoundTrip {
+    WAMusicListTracks *list = [self makeListTracks];
+    NSError *error = nil;
+    NSData *JSONData = [GPBJSONTranscoder JSONDataWithMessageData:[list data]
+                                                       descriptor:[WAMusicListTracks descriptor]
+                                                          options:GPBJSONTranscoderOptionNone
+                                                            error:&error];
+    XCTAssertNil(error);
+    NSDictionary *object = [NSJSONSerialization JSONObjectWithData:JSONData options:0 error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqual([object[@"items"] count], 500u);
+    XCTAssertEqualObjects(object[@"items"][7][@"id"], list.itemsArray[7].id_p);
+    XCTAssertEqualObjects(object[@"items"][7][@"title"], list.itemsArray[7].title);
+    XCTAssertEqualObjects(object[@"items"][7][@"author"][@"name"], list.itemsArray[7].author.name);
+    XCTAssertEqualObjects(object[@"continuation"], list.continuation);
+
+    NSData *data = [GPBJSONTranscoder messageDataWithJSONData:JSONData
+                                                   descriptor:[WAMusicListTracks descriptor]
+                                                      options:GPBJSONTranscoderOptionNone
+                                                        error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects([WAMusicListTracks parseFromData:data error:NULL], list);
+
+    // Escapes and pretty printing produced by other encoders.
+    NSData *other = [@"{ \"items\" : [ { \"id\" : \"a\\\"b\\u00e9\\ud83c\\udfb5\" } ] }"
+                     dataUsingEncoding:NSUTF8StringEncoding];
+    data = [GPBJSONTranscoder messageDataWithJSONData:other
+                                           descriptor:[WAMusicListTracks descriptor]
+                                              options:GPBJSONTranscoderOptionNone
+                                                error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects([WAMusicListTracks parseFromData:data error:NULL].itemsArray[0].id_p, @"a\"bé🎵");
+}
+
+- (void)testJSONTranscoderWellKnownTypes {
+    GPBTimestamp *timestamp = [GPBTimestamp message];
+    timestamp.seconds = 1700000000;
+    timestamp.nanos = 5000000;
+    NSData *JSONData = [GPBJSONTranscoder JSONDataWithMessageData:[timestamp data]
+                                                       descriptor:[GPBTimestamp descriptor]
+                                                          options:GPBJSONTranscoderOptionNone
+                                                            error:NULL];
+    XCTAssertEqualObjects([[NSString alloc] initWithData:JSONData encoding:NSUTF8StringEncoding],
+                          @"\"2023-11-14T22:13:20.005Z\"");
+    NSData *data = [GPBJSONTranscoder messageDataWithJSONData:[@"\"2023-11-15T00:13:20.005+02:00\"" dataUsingEncoding:NSUTF8StringEncoding]
+                                                   descriptor:[GPBTimestamp descriptor]
+                                                      options:GPBJSONTranscoderOptionNone
+                                                        error:NULL];
+    XCTAssertEqualObjects([GPBTimestamp parseFromData:data error:NULL], timestamp);
+
+    GPBDuration *duration = [GPBDuration message];
+    duration.seconds = -1;
+    duration.nanos = -500000000;
+    JSONData = [GPBJSONTranscoder JSONDataWithMessageData:[duration data]
+                                               descriptor:[GPBDuration descriptor]
+                                                  options:GPBJSONTranscoderOptionNone
+                                                    error:NULL];
+    XCTAssertEqualObjects([[NSString alloc] initWithData:JSONData encoding:NSUTF8StringEncoding], @"\"-1.500s\"");
+    data = [GPBJSONTranscoder messageDataWithJSONData:JSONData
+                                           descriptor:[GPBDuration descriptor]
+                                              options:GPBJSONTranscoderOptionNone
+                                                error:NULL];
+    XCTAssertEqualObjects([GPBDuration parseFromData:data error:NULL], duration);
+
+    GPBStruct *message = [self makeStruct:100];
+    JSONData = [GPBJSONTranscoder JSONDataWithMessageData:[message data]
+                                               descriptor:[GPBStruct descriptor]
+                                                  options:GPBJSONTranscoderOptionNone
+                                                    error:NULL];
+    NSDictionary *object = [NSJSONSerialization JSONObjectWithData:JSONData options:0 error:NULL];
+    XCTAssertEqualObjects(object[@"key0"], @"value 0");
+    XCTAssertEqualObjects(object[@"key1"], @0.5);
+    XCTAssertEqualObjects(object[@"key3"][@"none"], [NSNull null]);
+    XCTAssertEqual([object[@"key4"] count], 64u);
+    data = [GPBJSONTranscoder messageDataWithJSONData:JSONData
+                                           descriptor:[GPBStruct descriptor]
+                                              options:GPBJSONTranscoderOptionNone
+                                                error:NULL];
+    XCTAssertEqualObjects([GPBStruct parseFromData:data error:NULL], message);
+}
+
+- (void)testJSONTranscoderDuplicatedFields {
+    // Concatenated messages repeat tags, the JSON must be the one of what the parser keeps.
+    WAMusicTrack *first = [WAMusicTrack message];
+    first.id_p = @"a";
+    first.title = @"first";
+    first.author.id_p = @"x";
+    first.author.name = @"one";
+    WAMusicTrack *second = [WAMusicTrack message];
+    second.id_p = @"b";
+    second.author.name = @"two";
+    second.author.thumbnail = @"t";
+    NSMutableData *data = [[first data] mutableCopy];
+    [data appendData:[second data]];
+    NSData *JSONData = [GPBJSONTranscoder JSONDataWithMessageData:data
+                                                       descriptor:[WAMusicTrack descriptor]
+                                                          options:GPBJSONTranscoderOptionNone
+                                                            error:NULL];
+    NSDictionary *object = [NSJSONSerialization JSONObjectWithData:JSONData options:0 error:NULL];
+    XCTAssertEqualObjects(object, (@{
+        @"id" : @"b",
+        @"title" : @"first",
+        @"author" : @{@"id" : @"x", @"name" : @"two", @"thumbnail" : @"t"},
+    }));
+    NSData *merged = [GPBJSONTranscoder JSONDataWithMessageData:[[WAMusicTrack parseFromData:data error:NULL] data]
+                                                     descriptor:[WAMusicTrack descriptor]
+                                                        options:GPBJSONTranscoderOptionNone
+                                                          error:NULL];
+    XCTAssertEqualObjects(object, [NSJSONSerialization JSONObjectWithData:merged options:0 error:NULL]);
+
+    // Only the last field set of a oneof is kept, a message set again after another field starts over.
+    WATypesBytes *pointer = [WATypesBytes message];
+    pointer.ptr.ptr = 1;
+    WATypesBytes *raw = [WATypesBytes message];
+    raw.raw = [NSData dataWithBytes:"q" length:1];
+    WATypesBytes *length = [WATypesBytes message];
+    length.ptr.len = 2;
+    data = [[pointer data] mutableCopy];
+    [data appendData:[raw data]];
+    [data appendData:[length data]];
+    JSONData = [GPBJSONTranscoder JSONDataWithMessageData:data
+                                               descriptor:[WATypesBytes descriptor]
+                                                  options:GPBJSONTranscoderOptionNone
+                                                    error:NULL];
+    object = [NSJSONSerialization JSONObjectWithData:JSONData options:0 error:NULL];
+    XCTAssertEqualObjects(object, (@{@"ptr" : @{@"len" : @2}}));
+    [data appendData:[raw data]];
+    JSONData = [GPBJSONTranscoder JSONDataWithMessageData:data
+                                               descriptor:[WATypesBytes descriptor]
+                                                  options:GPBJSONTranscoderOptionNone
+                                                    error:NULL];
+    object = [NSJSONSerialization JSONObjectWithData:JSONData options:0 error:NULL];
+    XCTAssertEqualObjects(object, (@{@"raw" : @"cQ=="}));
+}
+
+- (void)testJSONTranscoderErrors {
+    NSError *error = nil;
+    XCTAssertNil([GPBJSONTranscoder messageDataWithJSONData:[@"{\"items\": [" dataUsingEncoding:NSUTF8StringEncoding]
+                                                 descriptor:[WAMusicListTracks descriptor]
+                                                    options:GPBJSONTranscoderOptionNone
+                                                      error:&error]);
+    XCTAssertEqual(error.code, GPBJSONTranscoderErrorInvalidJSON);
+
+    NSData *unknown = [@"{\"next\": {\"page\": [1, 2]}, \"continuation\": \"abc\"}" dataUsingEncoding:NSUTF8StringEncoding];
+    XCTAssertNil([GPBJSONTranscoder messageDataWithJSONData:unknown
+                                                 descriptor:[WAMusicListTracks descriptor]
+                                                    options:GPBJSONTranscoderOptionNone
+                                                      error:&error]);
+    XCTAssertEqual(error.code, GPBJSONTranscoderErrorUnknownField);
+    NSData *data = [GPBJSONTranscoder messageDataWithJSONData:unknown
+                                                   descriptor:[WAMusicListTracks descriptor]
+                                                      options:GPBJSONTranscoderOptionIgnoreUnknownFields
+                                                        error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects([WAMusicListTracks parseFromData:data error:NULL].continuation, @"abc");
+
+    XCTAssertNil([GPBJSONTranscoder messageDataWithJSONData:[@"\"yesterday\"" dataUsingEncoding:NSUTF8StringEncoding]
+                                                 descriptor:[GPBTimestamp descriptor]
+                                                    options:GPBJSONTranscoderOptionNone
+                                                      error:&error]);
+    XCTAssertEqual(error.code, GPBJSONTranscoderErrorInvalidValue);
+
+    GPBAny *any = [GPBAny message];
+    any.typeURL = @"type.googleapis.com/google.protobuf.Empty";
+    XCTAssertNil([GPBJSONTranscoder JSONDataWithMessageData:[any data]
+                                                 descriptor:[GPBAny descriptor]
+                                                    options:GPBJSONTranscoderOptionNone
+                                                      error:&error]);
+    XCTAssertEqual(error.code, GPBJSONTranscoderErrorUnsupportedType);
+
+    data = [[self makeListTracks] data];
+    XCTAssertNil([GPBJSONTranscoder JSONDataWithMessageData:[data subdataWithRange:NSMakeRange(0, data.length - 3)]
+                                                 descriptor:[WAMusicListTracks descriptor]
+                                                    options:GPBJSONTranscoderOptionNone
+                                                      error:&error]);
+    XCTAssertEqualObjects(error.domain, GPBCodedInputStreamErrorDomain);
+}
+
+- (void)testTranscodeListTracksToJSON {
+    NSData *data = [[self makeListTracks] data];
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < 20; n++) {
+            @autoreleasepool {
+                (void)[GPBJSONTranscoder JSONDataWithMessageData:data
+                                                      descriptor:[WAMusicListTracks descriptor]
+                                                         options:GPBJSONTranscoderOptionNone
+                                                           error:NULL];
+            }
+        }
+    }];
+}
+
+- (void)testTranscodeJSONToListTracks {
+    NSData *JSONData = [GPBJSONTranscoder JSONDataWithMessageData:[[self makeListTracks] data]
+                                                       descriptor:[WAMusicListTracks descriptor]
+                                                          options:GPBJSONTranscoderOptionNone
+                                                            error:NULL];
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < 20; n++) {
+            @autoreleasepool {
+                (void)[GPBJSONTranscoder messageDataWithJSONData:JSONData
+                                                      descriptor:[WAMusicListTracks descriptor]
+                                                         options:GPBJSONTranscoderOptionNone
+                                                           error:NULL];
+            }
+        }
+    }];
+}
+
+/// Baseline for the transcoder: Foundation decoding the same JSON
+- (void)testDecodeListTracksJSONFoundation {
+    NSData *JSONData = [GPBJSONTranscoder JSONDataWithMessageData:[[self makeListTracks] data]
+                                                       descriptor:[WAMusicListTracks descriptor]
+                                                          options:GPBJSONTranscoderOptionNone
+                                                            error:NULL];
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < 20; n++) {
+            @autoreleasepool {
+                (void)[NSJSONSerialization JSONObjectWithData:JSONData options:0 error:NULL];
+            }
+        }
+    }];
+}
+
+- (void)testPrewarmDescriptorsConcurrently {
+    dispatch_apply(8, DISPATCH_APPLY_AUTO, ^(size_t i) {
+        [WAMusicMusicRoot prewarmDescriptors];
+        [WATypesTypesRoot prewarmDescriptors];
+        (void)[[WAMusicTrack descriptor] file];
+    });
+    GPBFileDescriptor *file = [[WAMusicTrack descriptor] file];
+    XCTAssertNotNil(file);
+    XCTAssertEqualObjects(file, [[WAMusicListTracks descriptor] file]);
+    XCTAssertEqualObjects(file.package, @"asyncify.music");
+}
+
+/// Generated messages whose descriptor belongs to `file`, found through the runtime so a message
+/// missing from a prewarm list is caught.
+- (NSSet<Class> *)messageClassesOfFile:(GPBFileDescriptor *)file {
+    NSMutableSet<Class> *classes = [NSMutableSet set];
+    unsigned int count = 0;
+    Class *all = objc_copyClassList(&count);
+    for (unsigned int i = 0; i < count; i++) {
+        // only generated messages are messaged, +descriptor of anything else isn't run
+        if (class_getSuperclass(all[i]) == [GPBMessage class] &&
+            [[[all[i] descriptor] file] isEqual:file]) {
+            [classes addObject:all[i]];
+        }
+    }
+    free(all);
+    return classes;
+}
+
+- (void)testPrewarmedMessageClassesMatchFiles {
+    NSDictionary<NSString *, Class> *roots = @{
+        NSStringFromClass([WAEngineEngineRoot class]) : [WAEngineVersion class],
+        NSStringFromClass([WAMusicMusicRoot class]) : [WAMusicTrack class],
+        NSStringFromClass([WATypesTypesRoot class]) : [WATypesImage class],
+    };
+    for (NSString *root in roots) {
+        NSArray<Class> *prewarmed = [NSClassFromString(root) prewarmedMessageClasses];
+        NSSet<Class> *expected = [self messageClassesOfFile:[[roots[root] descriptor] file]];
+        XCTAssertEqual(prewarmed.count, [NSSet setWithArray:prewarmed].count, @"%@ lists a class twice", root);
+        XCTAssertEqualObjects([NSSet setWithArray:prewarmed], expected, @"%@", root);
+    }
+    XCTAssertEqualObjects([GPBRootObject prewarmedMessageClasses], @[]);
+}
+
+- (void)testParseWithFieldMask {
+    WAMusicListTracks *list = [self makeListTracks];
+    NSError *error = nil;
+    GPBCompiledFieldMask *mask = [GPBCompiledFieldMask fieldMaskWithPaths:@[ @"items.id", @"items.title", @"items.author.name" ]
+                                                               descriptor:[WAMusicListTracks descriptor]
+                                                                    error:&error];
+    XCTAssertNil(error);
+    WAMusicListTracks *parsed = [WAMusicListTracks parseFromData:[list data] fieldMask:mask error:&error];
+    XCTAssertNil(error);
+
+    WAMusicListTracks *expected = [WAMusicListTracks message];
+    for (WAMusicTrack *track in list.itemsArray) {
+        WAMusicTrack *kept = [WAMusicTrack message];
+        kept.id_p = track.id_p;
+        kept.title = track.title;
+        kept.author.name = track.author.name;
+        [expected.itemsArray addObject:kept];
+    }
+    XCTAssertEqualObjects(parsed, expected);
+    XCTAssertTrue([[GPBUnknownFields alloc] initFromMessage:parsed].empty);
+
+    // a whole field wins over paths into it
+    mask = [GPBCompiledFieldMask fieldMaskWithPaths:@[ @"items.author.name", @"items.author", @"continuation" ]
+                                         descriptor:[WAMusicListTracks descriptor]
+                                              error:NULL];
+    parsed = [WAMusicListTracks parseFromData:[list data] fieldMask:mask error:NULL];
+    XCTAssertEqualObjects(parsed.itemsArray[3].author, list.itemsArray[3].author);
+    XCTAssertEqualObjects(parsed.continuation, list.continuation);
+    XCTAssertEqualObjects(parsed.itemsArray[3].id_p, @"");
+
+    XCTAssertNil([GPBCompiledFieldMask fieldMaskWithPaths:@[ @"items.duration" ]
+                                               descriptor:[WAMusicListTracks descriptor]
+                                                    error:&error]);
+    XCTAssertEqual(error.code, GPBCompiledFieldMaskErrorUnknownField);
+    XCTAssertNil([GPBCompiledFieldMask fieldMaskWithPaths:@[ @"continuation.id" ]
+                                               descriptor:[WAMusicListTracks descriptor]
+                                                    error:&error]);
+    XCTAssertEqual(error.code, GPBCompiledFieldMaskErrorNotAMessage);
+
+    NSData *data = [list data];
+    XCTAssertNil([WAMusicListTracks parseFromData:[data subdataWithRange:NSMakeRange(0, data.length - 3)]
+                                        fieldMask:mask
+                                            error:&error]);
+    XCTAssertEqualObjects(error.domain, GPBCodedInputStreamErrorDomain);
+}
+
+- (void)testParseListTracksWithFieldMask {
+    NSData *data = [[self makeListTracks] data];
+    GPBCompiledFieldMask *mask = [GPBCompiledFieldMask fieldMaskWithPaths:@[ @"items.id", @"items.title", @"items.thumbnail" ]
+                                                               descriptor:[WAMusicListTracks descriptor]
+                                                                    error:NULL];
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < 20; n++) {
+            @autoreleasepool {
+                (void)[WAMusicListTracks parseFromData:data fieldMask:mask error:NULL];
+            }
+        }
+    }];
+}
+
+/// Baseline for the field mask parse: the whole list decoded
+- (void)testParseListTracksWithoutFieldMask {
+    NSData *data = [[self makeListTracks] data];
+    [self measureBlock:^{
+        for (NSUInteger n = 0; n < 20; n++) {
+            @autoreleasepool {
+                (void)[WAMusicListTracks parseFromData:data error:NULL];
+            }
+        }
+    }];
+}
+
+- (NSArray<NSData *> *)tagsForAllDescriptors {
+    NSMutableArray<NSData *> *tags = [NSMutableArray array];
+    for (GPBDescriptor *descriptor in _descriptors) {
+        [tags addObject:[self tagsForDescriptor:descriptor]];
+    }
+    return tags;
+}
+
+@end
@@ -8,6 +8,8 @@ import Foundation
 import XCTest
 @testable import MusicWasm
 @testable import AsyncWasm
+@testable import TaskWasm
+import SwiftProtobuf
 import WasmSwiftProtobuf
 
 final class AsyncWasmTests: XCTestCase {
@@ -72,4 +74,434 @@ final class AsyncWasmTests: XCTestCase {
         
         XCTAssertEqual(try FooPrefix.bar.to_asyncify_call_id(), "BAR_BAR")
     }
+    
+    final class CallCounter: @unchecked Sendable {
+        private let lock = NSLock()
+        private var value = 0
+        var count: Int { lock.lock(); defer { lock.unlock() }; return value }
+        func increment() -> Int { lock.lock(); defer { lock.unlock() }; value += 1; return value }
+    }
+    
+    /// Clock the test moves forward by hand
+    final class ManualClock: @unchecked Sendable {
+        private let lock = NSLock()
+        private var value: TimeInterval = 1000
+        func now() -> TimeInterval { lock.lock(); defer { lock.unlock() }; return value }
+        func advance(_ seconds: TimeInterval) { lock.lock(); defer { lock.unlock() }; value += seconds }
+    }
+    
+    /// Stubbed guest calls numbered from 1, each one is held until the test releases it
+    final class GatedCalls: @unchecked Sendable {
+        private let lock = NSLock()
+        private var value = 0
+        private var released: Set<Int> = []
+        private var held: [Int: CheckedContinuation<Void, Never>] = [:]
+        private var arrivals: [Int: CheckedContinuation<Void, Never>] = [:]
+        
+        var count: Int { locked { value } }
+        
+        /// Number the call and wait until it is released
+        func enter() async -> Int {
+            let (n, arrival): (Int, CheckedContinuation<Void, Never>?) = locked {
+                value += 1
+                return (value, arrivals.removeValue(forKey: value))
+            }
+            arrival?.resume()
+            await withCheckedContinuation { continuation in
+                let isReleased: Bool = locked {
+                    if released.contains(n) {
+                        return true
+                    }
+                    held[n] = continuation
+                    return false
+                }
+                if isReleased {
+                    continuation.resume()
+                }
+            }
+            return n
+        }
+        
+        /// Wait until call `n` was made
+        func started(_ n: Int) async {
+            await withCheckedContinuation { continuation in
+                let isStarted: Bool = locked {
+                    if value >= n {
+                        return true
+                    }
+                    arrivals[n] = continuation
+                    return false
+                }
+                if isStarted {
+                    continuation.resume()
+                }
+            }
+        }
+        
+        func release(_ n: Int) {
+            let continuation = locked {
+                released.insert(n)
+                return held.removeValue(forKey: n)
+            }
+            continuation?.resume()
+        }
+        
+        private func locked<T>(_ body: () throws -> T) rethrows -> T {
+            lock.lock()
+            defer { lock.unlock() }
+            return try body()
+        }
+    }
+    
+    func key(_ keyword: String, continuation: String? = nil) -> MusicResponseCache.Key {
+        var args = ["keyword": Google_Protobuf_Value(stringValue: keyword)]
+        if let continuation {
+            args["continuation"] = Google_Protobuf_Value(stringValue: continuation)
+        }
+        return MusicResponseCache.Key(id: MusicActionID.search.rawValue, args: args, premium: false, copts: [:])
+    }
+    
+    func testResponseCacheCoalescesCalls() async throws {
+        let calls = GatedCalls()
+        let cache = MusicResponseCache(now: { 0 })
+        let fetch: @Sendable () async throws -> Data = {
+            let n = await calls.enter()
+            return Data("page \(n)".utf8)
+        }
+        let results = try await withThrowingTaskGroup(of: Data.self) { group in
+            for i in 0..<8 {
+                group.addTask {
+                    try await cache.data(for: self.key(i % 2 == 0 ? "Die With  a Smile" : " die with a smile"), fetch: fetch)
+                }
+            }
+            // lookups made while the call is held join it, later ones find its response
+            await calls.started(1)
+            calls.release(1)
+            return try await group.reduce(into: []) { $0.append($1) }
+        }
+        XCTAssertEqual(calls.count, 1)
+        XCTAssertEqual(results, Array(repeating: Data("page 1".utf8), count: 8))
+        // the continuation is part of the key
+        _ = try await cache.data(for: key("die with a smile", continuation: "next")) { Data("page 2".utf8) }
+        XCTAssertGreaterThan(cache.totalBytes, 0)
+    }
+    
+    func testResponseCacheRevalidatesStaleEntries() async throws {
+        var configuration = MusicResponseCache.Configuration()
+        configuration.ttl = 60
+        configuration.staleWhileRevalidate = 300
+        let clock = ManualClock()
+        let calls = GatedCalls()
+        let cache = MusicResponseCache(configuration: configuration, now: { clock.now() })
+        let fetch: @Sendable () async throws -> Data = {
+            let n = await calls.enter()
+            return Data("page \(n)".utf8)
+        }
+        calls.release(1)
+        _ = try await cache.data(for: key("a"), fetch: fetch)
+        clock.advance(59)
+        let cached = try await cache.data(for: key("a"), fetch: fetch)
+        XCTAssertEqual(cached, Data("page 1".utf8))
+        XCTAssertNil(cache.inflight(for: key("a")))
+        clock.advance(2)
+        // stale, returned right away while the refresh is held
+        let stale = try await cache.data(for: key("a"), fetch: fetch)
+        XCTAssertEqual(stale, Data("page 1".utf8))
+        let refresh = try XCTUnwrap(cache.inflight(for: key("a")))
+        calls.release(2)
+        _ = try await refresh.value
+        let fresh = try await cache.data(for: key("a"), fetch: fetch)
+        XCTAssertEqual(fresh, Data("page 2".utf8))
+        XCTAssertEqual(calls.count, 2)
+        // past staleWhileRevalidate the entry is dropped and the lookup waits for the guest
+        clock.advance(360)
+        calls.release(3)
+        let expired = try await cache.data(for: key("a"), fetch: fetch)
+        XCTAssertEqual(expired, Data("page 3".utf8))
+        XCTAssertEqual(calls.count, 3)
+    }
+    
+    /// Answers `HEAD` requests with the status in the `status` query item
+    final class StatusURLProtocol: URLProtocol {
+        static let requests = CallCounter()
+        override class func canInit(with request: URLRequest) -> Bool { true }
+        override class func canonicalRequest(for request: URLRequest) -> URLRequest { request }
+        override func startLoading() {
+            _ = Self.requests.increment()
+            let status = URLComponents(url: request.url!, resolvingAgainstBaseURL: false)?
+                .queryItems?.first(where: { $0.name == "status" })?.value.flatMap(Int.init) ?? 200
+            let resp = HTTPURLResponse(url: request.url!, statusCode: status, httpVersion: nil, headerFields: nil)!
+            client?.urlProtocol(self, didReceive: resp, cacheStoragePolicy: .notAllowed)
+            client?.urlProtocolDidFinishLoading(self)
+        }
+        override func stopLoading() {}
+    }
+    
+    func format(_ id: String, quality: String, status: Int) -> MusicTrackDetails.Format {
+        var format = MusicTrackDetails.Format()
+        format.id = id
+        format.quality = quality
+        format.mimeType = "audio/webm; codecs=\"opus\""
+        format.url = "https://rr1.googlevideo.com/videoplayback?itag=\(id)&status=\(status)"
+        format.exp = Int64(Date().timeIntervalSince1970) + 3600
+        return format
+    }
+    
+    func testFormatValidatorRanksReachableFormats() async throws {
+        let config = URLSessionConfiguration.ephemeral
+        config.protocolClasses = [StatusURLProtocol.self]
+        let validator = MusicFormatValidator(session: URLSession(configuration: config))
+        let formats = [
+            format("251", quality: "AUDIO_QUALITY_HIGH", status: 403),
+            format("250", quality: "AUDIO_QUALITY_MEDIUM", status: 200),
+            format("249", quality: "AUDIO_QUALITY_LOW", status: 200),
+        ]
+        let playable = await validator.playable(formats)
+        XCTAssertEqual(playable.first?.id, "250")
+        XCTAssertFalse(playable.contains(where: { $0.id == "251" }))
+        
+        // probes are remembered until the formats expire
+        let requests = StatusURLProtocol.requests.count
+        let again = await validator.playable(Array(formats.prefix(2)))
+        XCTAssertEqual(again.first?.id, "250")
+        XCTAssertEqual(StatusURLProtocol.requests.count, requests)
+        
+        let dead = await validator.playable([format("140", quality: "AUDIO_QUALITY_MEDIUM", status: 404)])
+        XCTAssertTrue(dead.isEmpty)
+    }
+    
+    func testFormatQualityRank() {
+        XCTAssertEqual(MusicFormatValidator.rank(quality: "1080p60"), 1080)
+        XCTAssertEqual(MusicFormatValidator.rank(quality: "720p"), 720)
+        XCTAssertEqual(MusicFormatValidator.rank(quality: "hd720"), 720)
+        XCTAssertGreaterThan(MusicFormatValidator.rank(quality: "1080p"), MusicFormatValidator.rank(quality: "720p60"))
+        XCTAssertEqual(MusicFormatValidator.rank(quality: "AUDIO_QUALITY_MEDIUM"), 2)
+        XCTAssertEqual(MusicFormatValidator.rank(quality: "audio"), 0)
+        XCTAssertEqual(MusicFormatValidator.rank(quality: ""), 0)
+    }
+    
+    func testResponseCacheByteBudget() async throws {
+        var configuration = MusicResponseCache.Configuration()
+        configuration.byteBudget = 64 << 10
+        configuration.shardCount = 1
+        let cache = MusicResponseCache(configuration: configuration)
+        for i in 0..<32 {
+            _ = try await cache.data(for: key("\(i)")) { Data(count: 8 << 10) }
+            XCTAssertLessThanOrEqual(cache.totalBytes, configuration.byteBudget)
+        }
+        // the most recent response is kept, the first one was evicted
+        let counter = CallCounter()
+        _ = try await cache.data(for: key("31")) { Data(count: counter.increment()) }
+        _ = try await cache.data(for: key("0")) { Data(count: counter.increment()) }
+        XCTAssertEqual(counter.count, 1)
+    }
+    
+    func testResponseCacheRemoveAllDropsRunningCalls() async throws {
+        let calls = GatedCalls()
+        let cache = MusicResponseCache(now: { 0 })
+        let fetch: @Sendable () async throws -> Data = {
+            let n = await calls.enter()
+            return Data("page \(n)".utf8)
+        }
+        let old = Task { try await cache.data(for: self.key("a"), fetch: fetch) }
+        await calls.started(1)
+        cache.removeAll()
+        // neither joins the call started before removeAll nor gets its response cached
+        calls.release(2)
+        let new = try await cache.data(for: key("a"), fetch: fetch)
+        XCTAssertEqual(new, Data("page 2".utf8))
+        calls.release(1)
+        let oldData = try await old.value
+        XCTAssertEqual(oldData, Data("page 1".utf8))
+        let cached = try await cache.data(for: key("a"), fetch: fetch)
+        XCTAssertEqual(cached, Data("page 2".utf8))
+        XCTAssertEqual(calls.count, 2)
+    }
+    
+    func testTaskUpdatesShareOnePoll() async throws {
+        let updates = TaskUpdates()
+        let counter = CallCounter()
+        var task = WaTTask()
+        task.id = "task"
+        task.status = .processing
+        let poll: TaskUpdates.Poll = { task in
+            var task = task
+            let n = counter.increment()
+            task.metadata.fields["progress"] = Google_Protobuf_Value(numberValue: Double(n) / 4)
+            if n == 4 {
+                task.status = .completed
+            }
+            return try task.serializedData()
+        }
+        let streams = (0..<2).map { _ in updates.stream(task: task, interval: 0.01, poll: poll) }
+        for stream in streams {
+            var last: WaTTask?
+            for await update in stream {
+                last = update
+            }
+            XCTAssertEqual(last?.status, .completed)
+            XCTAssertEqual(last?.metadata.fields["progress"]?.numberValue, 1)
+        }
+        XCTAssertEqual(counter.count, 4)
+        // a finished task is delivered as is, without polling
+        task.status = .completed
+        var delivered = [WaTTask]()
+        for await update in updates.stream(task: task, interval: 0.01, poll: poll) {
+            delivered.append(update)
+        }
+        XCTAssertEqual(delivered, [task])
+        XCTAssertEqual(counter.count, 4)
+    }
+    
+    func testTaskUpdatesSkipUnchangedResponses() async throws {
+        let updates = TaskUpdates()
+        let polls = CallCounter()
+        let decodes = CallCounter()
+        var task = WaTTask()
+        task.id = "task"
+        task.status = .processing
+        let responses: [WaTTask] = (1...4).map { n in
+            var next = task
+            next.metadata.fields["progress"] = Google_Protobuf_Value(numberValue: 0.5)
+            // metadata churn that is neither status nor progress
+            next.metadata.fields["tick"] = Google_Protobuf_Value(numberValue: Double(min(n, 2)))
+            if n == 4 {
+                next.status = .completed
+            }
+            return next
+        }
+        let poll: TaskUpdates.Poll = { _ in
+            try responses[polls.increment() - 1].serializedData()
+        }
+        let decode: TaskUpdates.Decode = { data in
+            _ = decodes.increment()
+            return try WaTTask(serializedBytes: data)
+        }
+        var delivered = [WaTTask]()
+        for await update in updates.stream(task: task, interval: 0, poll: poll, decode: decode) {
+            delivered.append(update)
+        }
+        XCTAssertEqual(polls.count, 4)
+        // the third response repeats the second one byte for byte
+        XCTAssertEqual(decodes.count, 3)
+        XCTAssertEqual(delivered.last?.status, .completed)
+        XCTAssertFalse(delivered.contains { $0.metadata.fields["tick"]?.numberValue == 2 && $0.status == .processing })
+    }
+    
+    func testTaskUpdatesStopWithoutSubscribers() async throws {
+        let updates = TaskUpdates()
+        var task = WaTTask()
+        task.id = "task"
+        task.status = .processing
+        let poll: TaskUpdates.Poll = { task in try task.serializedData() }
+        do {
+            for await update in updates.stream(task: task, interval: 60, poll: poll) {
+                XCTAssertEqual(update, task)
+                XCTAssertTrue(updates.isPolling(task))
+                break
+            }
+        }
+        XCTAssertFalse(updates.isPolling(task))
+    }
+    
+    /// Action list whose only action, `a`, is named `name`
+    static func actionList(_ name: String) -> WaTListActions {
+        var action = WaTAction()
+        action.id = "a"
+        action.name = name
+        var list = WaTListActions()
+        list.actions = [action]
+        return list
+    }
+    
+    func testActionCatalogServesStaleIndexWhileRefreshing() async throws {
+        let clock = ManualClock()
+        let calls = GatedCalls()
+        let catalog = TaskActionCatalog(ttl: 60, retryInterval: 10, now: { clock.now() })
+        let fetch: TaskActionCatalog.Fetch = {
+            let n = await calls.enter()
+            return Self.actionList("v\(n)")
+        }
+        calls.release(1)
+        let first = try await catalog.index(fetch: fetch)
+        XCTAssertEqual(first.actions["a"]?.first?.name, "v1")
+        clock.advance(61)
+        // expired, every lookup gets the old index while the only refresh is held
+        let names = try await withThrowingTaskGroup(of: String?.self) { group in
+            for _ in 0..<8 {
+                group.addTask { try await catalog.index(fetch: fetch).actions["a"]?.first?.name }
+            }
+            return try await group.reduce(into: []) { $0.append($1) }
+        }
+        XCTAssertEqual(names, Array(repeating: "v1", count: 8))
+        await calls.started(2)
+        let refresh = try XCTUnwrap(catalog.pendingRefresh)
+        calls.release(2)
+        _ = try await refresh.value
+        let refreshed = try await catalog.index(fetch: fetch)
+        XCTAssertEqual(refreshed.actions["a"]?.first?.name, "v2")
+        XCTAssertEqual(calls.count, 2)
+    }
+    
+    func testActionCatalogDropsRefreshesOfReloadedModule() async throws {
+        let calls = GatedCalls()
+        let catalog = TaskActionCatalog(now: { 0 })
+        let fetch: TaskActionCatalog.Fetch = {
+            let n = await calls.enter()
+            return Self.actionList("v\(n)")
+        }
+        calls.release(1)
+        _ = try await catalog.index(fetch: fetch)
+        catalog.invalidate()
+        catalog.refresh(fetch: fetch)
+        await calls.started(2)
+        let replaced = try XCTUnwrap(catalog.pendingRefresh)
+        catalog.invalidate()
+        let stale = try await catalog.index(fetch: fetch)
+        XCTAssertEqual(stale.actions["a"]?.first?.name, "v1")
+        await calls.started(3)
+        let current = try XCTUnwrap(catalog.pendingRefresh)
+        calls.release(3)
+        _ = try await current.value
+        // the refresh of the replaced module lands last and is dropped
+        calls.release(2)
+        _ = try await replaced.value
+        let index = try await catalog.index(fetch: fetch)
+        XCTAssertEqual(index.actions["a"]?.first?.name, "v3")
+        XCTAssertEqual(calls.count, 3)
+    }
+    
+    func testActionCatalogWaitsBeforeRetrying() async throws {
+        let clock = ManualClock()
+        let calls = GatedCalls()
+        let catalog = TaskActionCatalog(ttl: 60, retryInterval: 10, now: { clock.now() })
+        let fetch: TaskActionCatalog.Fetch = {
+            let n = await calls.enter()
+            if n == 2 {
+                throw URLError(.timedOut)
+            }
+            return Self.actionList("v\(n)")
+        }
+        calls.release(1)
+        _ = try await catalog.index(fetch: fetch)
+        catalog.invalidate()
+        _ = try await catalog.index(fetch: fetch)
+        let failed = try XCTUnwrap(catalog.pendingRefresh)
+        calls.release(2)
+        _ = try? await failed.value
+        // the failed refresh isn't tried again before retryInterval
+        clock.advance(9)
+        let stale = try await catalog.index(fetch: fetch)
+        XCTAssertEqual(stale.actions["a"]?.first?.name, "v1")
+        XCTAssertNil(catalog.pendingRefresh)
+        XCTAssertEqual(calls.count, 2)
+        clock.advance(2)
+        _ = try await catalog.index(fetch: fetch)
+        let retry = try XCTUnwrap(catalog.pendingRefresh)
+        calls.release(3)
+        _ = try await retry.value
+        let retried = try await catalog.index(fetch: fetch)
+        XCTAssertEqual(retried.actions["a"]?.first?.name, "v3")
+        XCTAssertEqual(calls.count, 3)
+    }
 }